@@ -0,0 +1,77 @@
+#ifndef FLASHgg_DiPhotonCleanedObjects_h
+#define FLASHgg_DiPhotonCleanedObjects_h
+
+#include "DataFormats/Common/interface/Ptr.h"
+#include "flashgg/DataFormats/interface/DiPhotonCandidate.h"
+#include "flashgg/DataFormats/interface/Electron.h"
+#include "flashgg/DataFormats/interface/Jet.h"
+#include "flashgg/DataFormats/interface/Muon.h"
+
+namespace flashgg {
+
+    // Leptons and jets selected and cleaned against one diphoton, computed once per event by
+    // DiPhotonCleanedObjectsProducer, which writes one collection per configured selection (the product
+    // instance is the selection name) for the tag producers to read.
+    // Each collection is aligned with the diphoton collection: element i belongs to diphoton i.
+    class DiPhotonCleanedObjects
+    {
+
+    public:
+        DiPhotonCleanedObjects();
+        DiPhotonCleanedObjects( edm::Ptr<DiPhotonCandidate> );
+        virtual ~DiPhotonCleanedObjects() {}
+
+        const edm::Ptr<DiPhotonCandidate> diPhoton() const { return diPhoton_; }
+        unsigned int jetCollectionIndex() const { return jetCollectionIndex_; }
+
+        // leptons passing the selection, in the order of the input collections
+        const std::vector<edm::Ptr<Muon> > &muons() const { return muons_; }
+        const std::vector<edm::Ptr<Electron> > &electrons() const { return electrons_; }
+        // min(DeltaR) between each selected lepton and the two photons
+        const std::vector<float> &muonPhotonDr() const { return muonPhotonDr_; }
+        const std::vector<float> &electronPhotonDr() const { return electronPhotonDr_; }
+        bool muonPassesPhotonDr( unsigned int i, float cut ) const { return muonPhotonDr_[i] >= cut; }
+        bool electronPassesPhotonDr( unsigned int i, float cut ) const { return electronPhotonDr_[i] >= cut; }
+
+        // jets of the diphoton's vertex passing the selection and cleaned against the photons and
+        // the leptons above, in the order of the input collection, with their b-tag discriminant
+        const std::vector<edm::Ptr<Jet> > &jets() const { return jets_; }
+        const std::vector<float> &jetBDiscriminators() const { return jetBDiscriminators_; }
+        unsigned int nJets() const { return jets_.size(); }
+        float ht() const { return ht_; }
+        // b-tag working points of the selection, and number of cleaned jets above each of them
+        const std::vector<double> &bWorkingPoints() const { return bWorkingPoints_; }
+        unsigned int nBJets( unsigned int wp ) const { return nBJets_.at( wp ); }
+        bool jetPassesBWorkingPoint( unsigned int i, unsigned int wp ) const { return jetBDiscriminators_[i] > bWorkingPoints_.at( wp ); }
+
+        void setJetCollectionIndex( unsigned int val ) { jetCollectionIndex_ = val; }
+        void addMuon( edm::Ptr<Muon> muon, float photonDr ) { muons_.push_back( muon ); muonPhotonDr_.push_back( photonDr ); }
+        void addElectron( edm::Ptr<Electron> ele, float photonDr ) { electrons_.push_back( ele ); electronPhotonDr_.push_back( photonDr ); }
+        void setBWorkingPoints( const std::vector<double> &bWorkingPoints );
+        void addJet( edm::Ptr<Jet> jet, float bDiscriminator );
+
+    private:
+        edm::Ptr<DiPhotonCandidate> diPhoton_;
+        unsigned int jetCollectionIndex_;
+        std::vector<edm::Ptr<Muon> > muons_;
+        std::vector<edm::Ptr<Electron> > electrons_;
+        std::vector<float> muonPhotonDr_;
+        std::vector<float> electronPhotonDr_;
+        std::vector<edm::Ptr<Jet> > jets_;
+        std::vector<float> jetBDiscriminators_;
+        std::vector<double> bWorkingPoints_;
+        std::vector<unsigned int> nBJets_;
+        float ht_;
+    };
+
+}
+
+#endif
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
+
@@ -24,8 +24,11 @@ namespace flashgg {
         Jet();
         Jet( const pat::Jet & );
         ~Jet();
+        // PU jet ID per vertex. Without a stored result for the vertex, passesPuJetId is true, rms is the simple RMS
+        // and betaStar is -1, so hasPuJetId is true for any vertex; hasStoredPuJetId tells whether a result was stored for it.
         void setPuJetId( const edm::Ptr<reco::Vertex> vtx, const PileupJetIdentifier & );
-        bool hasPuJetId( const edm::Ptr<reco::Vertex> vtx ) const;
+        bool hasPuJetId( const edm::Ptr<reco::Vertex> vtx ) const { return true; }
+        bool hasStoredPuJetId( const edm::Ptr<reco::Vertex> vtx ) const;
         bool passesPuJetId( const edm::Ptr<reco::Vertex> vtx, PileupJetIdentifier::Id level = PileupJetIdentifier::kLoose ) const;
         void setSimpleRMS( float theRMS )  { simpleRMS_ = theRMS; }
         void setSimpleMVA( float theMVA )  { simpleMVA_ = theMVA; }
@@ -56,6 +59,8 @@ namespace flashgg {
         void setMuEnergies(std::vector<float> val) { muEnergies_ = val; }
 
     private:
+        const MinimalPileupJetIdentifier *puJetId( const edm::Ptr<reco::Vertex> &vtx ) const;
+
         std::map<edm::Ptr<reco::Vertex>, MinimalPileupJetIdentifier> puJetId_;
         float qglikelihood_;
         float simpleRMS_; // simpler storage for PFCHS where this is not vertex-dependent
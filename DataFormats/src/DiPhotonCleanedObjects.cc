@@ -0,0 +1,38 @@
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
+
+
+namespace flashgg {
+
+    DiPhotonCleanedObjects::DiPhotonCleanedObjects() :
+        jetCollectionIndex_( 0 ),
+        ht_( 0. ) {}
+
+    DiPhotonCleanedObjects::DiPhotonCleanedObjects( edm::Ptr<DiPhotonCandidate> dipho ) :
+        diPhoton_( dipho ),
+        jetCollectionIndex_( dipho->jetCollectionIndex() ),
+        ht_( 0. ) {}
+
+    void DiPhotonCleanedObjects::setBWorkingPoints( const std::vector<double> &bWorkingPoints )
+    {
+        bWorkingPoints_ = bWorkingPoints;
+        nBJets_.assign( bWorkingPoints.size(), 0 );
+    }
+
+    void DiPhotonCleanedObjects::addJet( edm::Ptr<Jet> jet, float bDiscriminator )
+    {
+        jets_.push_back( jet );
+        jetBDiscriminators_.push_back( bDiscriminator );
+        ht_ += jet->pt();
+        for( unsigned int wp = 0 ; wp < bWorkingPoints_.size() ; wp++ ) {
+            if( bDiscriminator > bWorkingPoints_[wp] ) { nBJets_[wp]++; }
+        }
+    }
+}
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
+
@@ -25,31 +25,33 @@ void Jet::setPuJetId( const edm::Ptr<reco::Vertex> vtx, const PileupJetIdentifie
     puJetId_.insert( std::make_pair( vtx, min_id ) );
 }
 
-bool Jet::hasPuJetId( const edm::Ptr<reco::Vertex> vtx ) const
+const MinimalPileupJetIdentifier *Jet::puJetId( const edm::Ptr<reco::Vertex> &vtx ) const
 {
-    //    return ( puJetId_.count( vtx ) > 0 );
-    return true;
+    auto it = puJetId_.find( vtx );
+    return ( it == puJetId_.end() ? 0 : &it->second );
+}
+
+bool Jet::hasStoredPuJetId( const edm::Ptr<reco::Vertex> vtx ) const
+{
+    return ( puJetId( vtx ) != 0 );
 }
 
 bool Jet::passesPuJetId( const edm::Ptr<reco::Vertex> vtx, PileupJetIdentifier::Id level ) const
 {
-    assert( hasPuJetId( vtx ) );
-    //    return PileupJetIdentifier::passJetId( puJetId_.at( vtx ).idFlag, level );
-    return true;
+    const MinimalPileupJetIdentifier *id = puJetId( vtx );
+    return ( id ? PileupJetIdentifier::passJetId( id->idFlag, level ) : true );
 }
 
 float Jet::rms( const edm::Ptr<reco::Vertex> vtx ) const
 {
-    assert( hasPuJetId( vtx ) );
-    //    return puJetId_.at( vtx ).RMS;
-    return simpleRMS_;
+    const MinimalPileupJetIdentifier *id = puJetId( vtx );
+    return ( id ? id->RMS : simpleRMS_ );
 }
 
 float Jet::betaStar( const edm::Ptr<reco::Vertex> vtx ) const
 {
-    assert( hasPuJetId( vtx ) );
-    //    return puJetId_.at( vtx ).betaStar;
-    return -1.;
+    const MinimalPileupJetIdentifier *id = puJetId( vtx );
+    return ( id ? id->betaStar : -1. );
 }
 
 bool Jet::passesPuJetId( const edm::Ptr<DiPhotonCandidate> dipho, PileupJetIdentifier::Id level ) const
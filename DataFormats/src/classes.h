@@ -1,4 +1,5 @@
 #include "DataFormats/Common/interface/Ptr.h"
+#include "DataFormats/Common/interface/PtrVector.h"
 #include "DataFormats/Common/interface/Wrapper.h"
 #include "DataFormats/JetReco/interface/PileupJetIdentifier.h"
 #include "DataFormats/PatCandidates/interface/Electron.h"
@@ -7,6 +8,7 @@
 #include "flashgg/DataFormats/interface/GenDiPhoton.h"
 #include "flashgg/DataFormats/interface/DiPhotonCandidate.h"
 #include "flashgg/DataFormats/interface/DiPhotonMVAResult.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
 #include "flashgg/DataFormats/interface/NoTag.h"
 #include "flashgg/DataFormats/interface/UntaggedTag.h"
 #include "flashgg/DataFormats/interface/SigmaMpTTag.h"
@@ -135,6 +137,10 @@ namespace  {
         std::vector<std::vector<flashgg::Jet> >                    vec_vec_fgg_jet;
         edm::Wrapper<std::vector<flashgg::Jet> >                   wrp_vec_fgg_jet;
         edm::Wrapper<std::vector<std::vector<flashgg::Jet> > > wrp_vec_vec_fgg_jet;
+        edm::PtrVector<flashgg::Jet>                                   ptrvec_fgg_jet;
+        edm::Wrapper<edm::PtrVector<flashgg::Jet> >                    wrp_ptrvec_fgg_jet;
+        std::vector<edm::PtrVector<flashgg::Jet> >                     vec_ptrvec_fgg_jet;
+        edm::Wrapper<std::vector<edm::PtrVector<flashgg::Jet> > >      wrp_vec_ptrvec_fgg_jet;
         std::vector<pat::Muon>                                        vec_fgg_muon;
         flashgg::Muon						                                fgg_mu;
         edm::Ptr<flashgg::Muon> 					                    ptr_fgg_mu;
@@ -170,6 +176,10 @@ namespace  {
         std::vector<flashgg::DiPhotonMVAResult> vec_res;
         edm::Wrapper<std::vector<flashgg::DiPhotonMVAResult> > wrp_vec_res;
 
+        flashgg::DiPhotonCleanedObjects                               fgg_clo;
+        std::vector<flashgg::DiPhotonCleanedObjects>                  vec_fgg_clo;
+        edm::Wrapper<std::vector<flashgg::DiPhotonCleanedObjects> >   wrp_vec_fgg_clo;
+
         flashgg::VBFMVAResult vbf_res;
         std::vector<flashgg::VBFMVAResult> vec_vbf_res;
         edm::Wrapper<std::vector<flashgg::VBFMVAResult> > wrp_vec_vbf_res;
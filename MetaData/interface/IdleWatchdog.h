@@ -1,26 +1,96 @@
 #ifndef _flashgg_IdleWatchdog_h_
 #define _flashgg_IdleWatchdog_h_
 
-#include "FWCore/ParameterSet/interface/ParameterSet.h"
-#include "TStopwatch.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace edm {
+    class ParameterSet;
+    class ActivityRegistry;
+    class StreamContext;
+    namespace service {
+        class SystemBounds;
+    }
+}
 
 namespace flashgg {
 
+    // Service watching the progress of the job. Every `interval` seconds it samples the number of processed events,
+    // the process CPU time, the resident memory and the bytes read by the process (/proc/self/io, network reads
+    // included), and writes the rates over the last `window` samples to a JSON status file, replaced atomically,
+    // that the job tools in MetaData/python read while the job is running.
+    //
+    // Two conditions are watched, each for `tolerance` consecutive samples:
+    //  - stall:  CPU efficiency (CPU time over wall time times threads) below minCpuEfficiency, e.g. waiting for input;
+    //  - memory: after warmupEvents, resident memory growing faster than maxRssGrowth MB per 1000 events,
+    //            or above maxRss MB (0 disables either).
+    // and trigger their policy (stallPolicy, memoryPolicy): "warn" reports it, "checkpoint" asks the framework to
+    // stop after the events in flight so that the output files are closed cleanly, "exit" aborts the job with
+    // exit code 99 (stall) or 98 (memory).
+    // Sampling runs on its own thread, so that a job blocked on its input is still caught.
     class IdleWatchdog
     {
     public:
-        IdleWatchdog( const edm::ParameterSet & );
+        IdleWatchdog( const edm::ParameterSet &, edm::ActivityRegistry & );
+        ~IdleWatchdog();
+
+    private:
+        enum Policy { warn, checkpoint, exit };
+        enum Condition { stall = 0, memory = 1 };
+
+        struct Sample {
+            double wall, cpu;
+            unsigned long events;
+            long rss;        // kB
+            long long read;  // bytes, -1 if not available
+        };
 
+        static Policy policy( const std::string &name, const std::string &parameter );
+        static const char *policyName( Policy );
+        static Sample sample( unsigned long events );
+
+        void preallocate( const edm::service::SystemBounds & );
+        void postBeginJob();
+        void postEndJob();
+        void postEvent( const edm::StreamContext & );
+        void postOpenFile( const std::string &, bool );
+
+        void run();
         void check();
-        void reset();
+        void trigger( Condition, const std::string &reason );
+        void writeStatus( const char *state );
 
-    protected:
-        double minIdleFraction_;
-        int checkEvery_, tolerance_;
-        int nFailures_, ievent_;
+        std::string statusFile_;
+        double interval_;
+        unsigned int window_;
+        double minCpuEfficiency_;
+        double maxRssGrowth_, maxRss_;
+        unsigned long warmupEvents_;
+        int tolerance_;
+        Policy policies_[2];
 
-        TStopwatch stopWatch_;
+        unsigned int nThreads_;
+        std::atomic<unsigned long> nEvents_;
 
+        // below: used by the sampling thread, and by the framework callbacks under mutex_
+        std::mutex mutex_;
+        std::condition_variable wakeUp_;
+        std::thread thread_;
+        bool stop_;
+        Sample start_;
+        std::deque<Sample> samples_;
+        int failures_[2];
+        bool triggered_[2];
+        std::vector<std::string> warnings_;
+        std::string inputFile_;
+        unsigned int nInputFiles_;
+        bool checkpointed_;
+        bool writeFailed_;
     };
 }
 #endif // _flashgg_IdleWatchdog_h_
@@ -31,4 +101,3 @@ namespace flashgg {
 // c-basic-offset:4
 // End:
 // vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
-
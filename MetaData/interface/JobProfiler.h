@@ -0,0 +1,120 @@
+#ifndef _flashgg_JobProfiler_h_
+#define _flashgg_JobProfiler_h_
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace edm {
+    class ParameterSet;
+    class ActivityRegistry;
+    class StreamContext;
+    class ModuleCallingContext;
+    namespace service {
+        class SystemBounds;
+    }
+}
+
+namespace flashgg {
+
+    // Service recording, for every event and every module, the wall time and CPU time spent in the module and
+    // the net growth of the heap during its call, into a CSV file written along the job output.
+    // Module times are exclusive: the modules run on demand from a getByToken are not counted in the caller.
+    // Modules can add their own sub-timers, see ProfilerSubTimers below.
+    //
+    // File format: lines starting with '#' describe the entries, "#entry,<id>,<label>,<type>", and the job,
+    // "#job,<events>,<seconds>"; the others are "<event>,<entry>,<wall us>,<cpu us>,<memory>", where the memory
+    // is the net heap growth in bytes for modules (process wide: only indicative with several threads), 0 for
+    // sub-timers, and the resident size in kB for the event itself (entry 0).
+    // Validation/scripts/summarize_profile.py turns them into per-module percentiles and throughput.
+    class JobProfiler
+    {
+    public:
+        JobProfiler( const edm::ParameterSet &, edm::ActivityRegistry & );
+        ~JobProfiler();
+
+        // id of a sub-timer name
+        unsigned int subTimerId( const std::string &name );
+        // adds a sub-timer measurement to the module currently running on this thread
+        void addSubTime( unsigned int nameId, double wall, double cpu );
+
+        // in seconds
+        static double wallTime();
+        static double threadCpuTime();
+
+    private:
+        static double processCpuTime();
+        static long residentMemory();
+
+        struct Frame {
+            unsigned int entry;
+            double wall, cpu, pausedWall, pausedCpu, pauseStartWall, pauseStartCpu;
+            long heap, pausedHeap, pauseStartHeap;
+            std::vector<std::pair<unsigned int, std::pair<double, double> > > subTimes;
+        };
+
+        void preallocate( const edm::service::SystemBounds & );
+        void postBeginJob();
+        void postEndJob();
+        void preEvent( const edm::StreamContext & );
+        void postEvent( const edm::StreamContext & );
+        void preModuleEvent( const edm::StreamContext &, const edm::ModuleCallingContext & );
+        void postModuleEvent( const edm::StreamContext &, const edm::ModuleCallingContext & );
+        void preModuleEventDelayedGet( const edm::StreamContext &, const edm::ModuleCallingContext & );
+        void postModuleEventDelayedGet( const edm::StreamContext &, const edm::ModuleCallingContext & );
+
+        long heapInUse() const;
+        static std::vector<Frame> &frames();
+
+        // call with mutex_ held
+        unsigned int newEntry( const std::string &label, const std::string &type );
+        void write( unsigned long long event, unsigned int entry, double wall, double cpu, long memory );
+
+        std::string fileName_;
+        bool recordHeap_;
+
+        std::ofstream out_;
+        std::mutex mutex_;
+        std::unordered_map<unsigned int, unsigned int> moduleEntries_;
+        std::vector<std::string> entryLabels_;
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int> subTimerEntries_;
+        std::vector<std::string> subTimerNames_;
+
+        std::vector<std::pair<double, double> > eventStart_; // per stream
+        unsigned long nEvents_;
+        double jobStart_;
+    };
+
+    // Named timers for parts of the event processing of a module, e.g. one per systematic method.
+    // They are recorded by the JobProfiler as the entries "<module label>/<name>", inclusive of the modules
+    // run on demand in between start and stop. Without the service in the job they do nothing.
+    class ProfilerSubTimers
+    {
+    public:
+        ProfilerSubTimers();
+
+        unsigned int add( const std::string &name );
+        bool active() const { return profiler_ != 0; }
+
+        void start( unsigned int i );
+        void stop( unsigned int i );
+
+    private:
+        JobProfiler *profiler_;
+        std::vector<unsigned int> ids_;
+        std::vector<std::pair<double, double> > started_;
+    };
+}
+
+#endif // _flashgg_JobProfiler_h_
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,15 @@
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ServiceRegistry/interface/ActivityRegistry.h"
+#include "FWCore/ServiceRegistry/interface/ServiceMaker.h"
+
+#include "flashgg/MetaData/interface/JobProfiler.h"
+
+typedef flashgg::JobProfiler FlashggJobProfiler;
+DEFINE_FWK_SERVICE( FlashggJobProfiler );
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -127,6 +127,26 @@ class JobConfig(object):
                                VarParsing.VarParsing.multiplicity.singleton, # singleton or list
                                VarParsing.VarParsing.varType.string,          # string, int, or float
                                "WeightName")
+        self.options.register ('profile',
+                               False, # default value
+                               VarParsing.VarParsing.multiplicity.singleton, # singleton or list
+                               VarParsing.VarParsing.varType.bool,          # string, int, or float
+                               "profile: per-module timing and memory in <outputFile>_profile.csv")
+        self.options.register ('watchdog',
+                               False, # default value
+                               VarParsing.VarParsing.multiplicity.singleton, # singleton or list
+                               VarParsing.VarParsing.varType.bool,          # string, int, or float
+                               "watchdog: progress, CPU efficiency and memory of the job in <outputFile>_status.json")
+        self.options.register ('watchdogStatus',
+                               "", # default value
+                               VarParsing.VarParsing.multiplicity.singleton, # singleton or list
+                               VarParsing.VarParsing.varType.string,          # string, int, or float
+                               "watchdogStatus: status file of the watchdog, if not <outputFile>_status.json")
+        self.options.register ('watchdogPolicy',
+                               "", # default value
+                               VarParsing.VarParsing.multiplicity.singleton, # singleton or list
+                               VarParsing.VarParsing.varType.string,          # string, int, or float
+                               "watchdogPolicy: action on stalls and memory growth, e.g. stall=exit,memory=checkpoint (warn, checkpoint or exit)")
 
         
         self.parsed = False
@@ -408,6 +428,21 @@ class JobConfig(object):
             setattr( getattr( process, name ), attr, tfile )
             
 
+        if self.profile and not isFwlite:
+            process.add_( cms.Service("FlashggJobProfiler",
+                                      fileName=cms.untracked.string(self.outputFile.replace(".root","_profile.csv"))
+                                      ) )
+
+        if self.watchdog and not isFwlite:
+            statusFile = self.watchdogStatus if self.watchdogStatus != "" else self.outputFile.replace(".root","_status.json")
+            watchdog = cms.Service("FlashggIdleWatchdog",
+                                   statusFile=cms.untracked.string(statusFile)
+                                   )
+            for policy in filter(None,self.watchdogPolicy.split(",")):
+                cond,action = policy.split("=")
+                setattr(watchdog,"%sPolicy" % cond,cms.untracked.string(action))
+            process.add_( watchdog )
+
         if self.dumpPython != "":
             from gzip import open
             pyout = open("%s.gz" % self.dumpPython,"w+")
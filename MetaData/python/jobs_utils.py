@@ -117,6 +117,15 @@ class JobsManager(object):
                 make_option("--no-copy-proxy",dest="copy_proxy",action="store_false",
                             default=True,help="Do not try to copy the grid proxy to the worker nodes."
                             ),
+                make_option("--watchdog",dest="watchdog",action="store_true",default=False,
+                            help="Run the jobs with the FlashggIdleWatchdog service and report their progress while waiting. default: %default"
+                            ),
+                make_option("--watchdog-policy",dest="watchdogPolicy",type="string",default="",
+                            help="Watchdog actions on stalls and memory growth, e.g. stall=exit,memory=checkpoint (warn, checkpoint or exit). default: service defaults"
+                            ),
+                make_option("--progress-every",dest="progressEvery",type="float",default=300.,
+                            help="Seconds between two progress reports of the jobs run with the watchdog. default: %default"
+                            ),
                 ]
                               )
         
@@ -354,7 +363,8 @@ class JobsManager(object):
                     print " now submitting jobs",
                     for ijob in range(maxJobs):
                         ## FIXME allow specific job selection
-                        iargs = jobargs+shell_args("nJobs=%d jobId=%d" % (maxJobs, ijob))
+                        output = hadd.replace(".root","_%d.root" % ijob)
+                        iargs = jobargs+shell_args("nJobs=%d jobId=%d" % (maxJobs, ijob))+self.watchdogArgs(output)
                         dnjobs += 1 
                         batchId = -1
                         if not options.dry_run:
@@ -362,7 +372,6 @@ class JobsManager(object):
                             if self.options.queue and self.options.asyncLsf:
                                 batchId = out[1]
                             print ".",
-                        output = hadd.replace(".root","_%d.root" % ijob)
                         outfiles.append( output )
                         doutfiles[dsetName][1].append( outfiles[-1] )
                         poutfiles[name][1].append( outfiles[-1] )
@@ -374,6 +383,7 @@ class JobsManager(object):
                         print ret,out
                         continue
                     output = self.getHadd(out,outfile)
+                    jobargs = jobargs+self.watchdogArgs(output)
 
                     batchId = -1
                     if not options.dry_run:
@@ -459,8 +469,52 @@ class JobsManager(object):
 
     # -------------------------------------------------------------------------------------------------------------------
     def wait(self,parallel,handler=None):
+        if handler and self.hasWatchdog():
+            return parallel.wait(handler,progressEvery=self.options.progressEvery)
         return parallel.wait(handler)
 
+    # -------------------------------------------------------------------------------------------------------------------
+    def statusFile(self,output):
+        # absolute, so that batch jobs write it in the output folder if it is on a shared file system
+        return os.path.abspath(output.replace(".root","_status.json"))
+
+    # -------------------------------------------------------------------------------------------------------------------
+    def watchdogArgs(self,output):
+        if not self.options.watchdog:
+            return []
+        args = ["watchdog=1","watchdogStatus=%s" % self.statusFile(output)]
+        if self.options.watchdogPolicy:
+            args.append("watchdogPolicy=%s" % self.options.watchdogPolicy)
+        return args
+
+    # -------------------------------------------------------------------------------------------------------------------
+    def hasWatchdog(self):
+        # also true when continuing a task submitted with --watchdog
+        return any( "watchdog=1" in job[1] for job in self.task_config["jobs"] )
+
+    # -------------------------------------------------------------------------------------------------------------------
+    def reportProgress(self):
+        statuses = []
+        for job in self.task_config["jobs"]:
+            if job[4] == 0:
+                continue
+            statuses.append( (job[2], readJobStatus(self.statusFile(job[2]))) )
+        rates = sorted( status["eventsPerSecond"] for output,status in statuses if status and status["state"] == "running" )
+        median = rates[len(rates)/2] if rates else 0.
+
+        print ""
+        print "--- Progress of the unfinished jobs (status files of the watchdog)"
+        for output,status in statuses:
+            line = "%-60s %s" % ( os.path.basename(output).replace(".root",""), formatJobStatus(status) )
+            # slow nodes and leaking configurations
+            if status and status["state"] == "running" and status["eventsPerSecond"] < 0.5*median:
+                line += "  SLOW"
+            print line
+            if status:
+                for warning in status["warnings"]:
+                    print "    warning: %s" % warning
+        print ""
+
     # -------------------------------------------------------------------------------------------------------------------
     def handleJobOutput(self,job,jobargs,ret):
         print "------------"
@@ -549,6 +603,9 @@ class JobsManager(object):
                 if self.options.verbose:
                     for jfile,batchId in lst:
                         print "%s: %s" % (jfile,batchId[0])
+                        status = readJobStatus(self.statusFile(jfile))
+                        if status:
+                            print "    %s" % formatJobStatus(status)
             print 
                 
     # -------------------------------------------------------------------------------------------------------------------
@@ -1,15 +1,16 @@
-from Queue import Queue
+from Queue import Queue, Empty
 
 import commands
 import subprocess
 import os,sys
+import json
 import getpass
 import copy
 
 from threading import Thread, Semaphore
 import threading 
 from multiprocessing import cpu_count
-from time import sleep
+from time import sleep, time
 from math import floor
 
 # -----------------------------------------------------------------------------------------------------
@@ -1101,6 +1102,32 @@ class IclustMonitor(LsfMonitor):
                 # i.e. job is no longer on the list, and hence done
                 self.jobFinished(jobid,None)
                     
+# -----------------------------------------------------------------------------------------------------
+def readJobStatus(fname):
+    """ status file written by the FlashggIdleWatchdog service (MetaData/interface/IdleWatchdog.h), None if not there (yet) """
+    try:
+        with open(fname) as fin:
+            status = json.loads(fin.read())
+    except (IOError, ValueError):
+        return None
+    status["age"] = time() - status.get("updated",0)
+    return status
+
+# -----------------------------------------------------------------------------------------------------
+def formatJobStatus(status):
+    if not status:
+        return "no status"
+    ret = "%-10s %9d ev %8.2f ev/s  cpu %3.0f%%  rss %6.0f MB" % ( status["state"], status["events"], status["eventsPerSecond"],
+                                                                 100.*status["cpuEfficiency"], status["rssMB"] )
+    if status["rssGrowthMBPerKEvent"] is not None:
+        ret += " (%+.1f MB/kev)" % status["rssGrowthMBPerKEvent"]
+    if status["readMBPerSecond"] is not None:
+        ret += "  read %6.2f MB/s" % status["readMBPerSecond"]
+    ret += "  %s" % status["host"]
+    if status["state"] == "running" and status["age"] > 3.*max(status.get("window",0.),60.):
+        ret += "  (not updated for %d s)" % status["age"]
+    return ret
+
 # -----------------------------------------------------------------------------------------------------
 class Wrap:
     def __init__(self, func, args, retqueue, runqueue):
@@ -1229,7 +1256,7 @@ class Parallel:
         if self.lsfQueue and self.asyncLsf:
             self.lsfMon.stop = True
         
-    def wait(self,handler=None,printOutput=True,struggleThr=0.):
+    def wait(self,handler=None,printOutput=True,struggleThr=0.,progressEvery=0.):
         returns = []
         self.sem.acquire()
         njobs = int(self.njobs)
@@ -1240,7 +1267,16 @@ class Parallel:
             print ""
             print "--- Running jobs: %d. Total jobs: %d (total submissions: %s)" % (nleft, njobs, self.njobs)
             print ""
-            job, jobargs, ret = self.returned.get()
+            # the handler can report the progress of the running jobs while waiting
+            if progressEvery > 0. and handler and hasattr(handler,"reportProgress"):
+                while True:
+                    try:
+                        job, jobargs, ret = self.returned.get(True,progressEvery)
+                        break
+                    except Empty:
+                        handler.reportProgress()
+            else:
+                job, jobargs, ret = self.returned.get()
             if printOutput:
                 try:
                     print "Job finished: '%s' '%s'" % ( job, " ".join([str(a) for a in jobargs]) )
@@ -1,52 +1,301 @@
 #include "flashgg/MetaData/interface/IdleWatchdog.h"
 
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ServiceRegistry/interface/ActivityRegistry.h"
+#include "FWCore/ServiceRegistry/interface/SystemBounds.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "FWCore/Utilities/interface/UnixSignalHandlers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <cassert>
+#include <sstream>
+#include <time.h>
+#include <unistd.h>
 
 using namespace std;
 
+namespace {
+    string quote( const string &str )
+    {
+        string ret = "\"";
+        for( char c : str ) {
+            if( c == '"' || c == '\\' ) { ret += '\\'; }
+            if( c == '\n' ) { ret += "\\n"; continue; }
+            ret += c;
+        }
+        return ret + "\"";
+    }
+}
+
 namespace flashgg {
 
-    IdleWatchdog::IdleWatchdog( const edm::ParameterSet &iConfig ) :
-        minIdleFraction_( iConfig.getUntrackedParameter<double>( "minIdleFraction", 0.2 ) ),
-        checkEvery_( iConfig.getUntrackedParameter<int>( "checkEvery", 1000 ) ),
-        tolerance_( iConfig.getUntrackedParameter<int>( "tolerance", 5 ) )
+    IdleWatchdog::IdleWatchdog( const edm::ParameterSet &iConfig, edm::ActivityRegistry &iRegistry ) :
+        statusFile_( iConfig.getUntrackedParameter<string>( "statusFile", "flashggStatus.json" ) ),
+        interval_( iConfig.getUntrackedParameter<double>( "interval", 60. ) ),
+        window_( iConfig.getUntrackedParameter<unsigned int>( "window", 5 ) ),
+        minCpuEfficiency_( iConfig.getUntrackedParameter<double>( "minCpuEfficiency", 0.2 ) ),
+        maxRssGrowth_( iConfig.getUntrackedParameter<double>( "maxRssGrowth", 20. ) ),
+        maxRss_( iConfig.getUntrackedParameter<double>( "maxRss", 0. ) ),
+        warmupEvents_( iConfig.getUntrackedParameter<unsigned int>( "warmupEvents", 1000 ) ),
+        tolerance_( iConfig.getUntrackedParameter<int>( "tolerance", 5 ) ),
+        nThreads_( 1 ),
+        nEvents_( 0 ),
+        stop_( false ),
+        nInputFiles_( 0 ),
+        checkpointed_( false ),
+        writeFailed_( false )
     {
+        policies_[stall] = policy( iConfig.getUntrackedParameter<string>( "stallPolicy", "exit" ), "stallPolicy" );
+        policies_[memory] = policy( iConfig.getUntrackedParameter<string>( "memoryPolicy", "warn" ), "memoryPolicy" );
+        if( interval_ <= 0. || window_ == 0 || tolerance_ <= 0 ) {
+            throw cms::Exception( "Configuration" ) << "IdleWatchdog: interval, window and tolerance must be positive";
+        }
+        for( int cond = 0; cond < 2; ++cond ) {
+            failures_[cond] = 0;
+            triggered_[cond] = false;
+        }
+        start_ = sample( 0 );
+
+        iRegistry.watchPreallocate( this, &IdleWatchdog::preallocate );
+        iRegistry.watchPostBeginJob( this, &IdleWatchdog::postBeginJob );
+        iRegistry.watchPostEndJob( this, &IdleWatchdog::postEndJob );
+        iRegistry.watchPostEvent( this, &IdleWatchdog::postEvent );
+        iRegistry.watchPostOpenFile( this, &IdleWatchdog::postOpenFile );
     }
 
+    IdleWatchdog::~IdleWatchdog()
+    {
+        // job ended without endJob, e.g. on an exception
+        if( thread_.joinable() ) {
+            {
+                lock_guard<mutex> lock( mutex_ );
+                stop_ = true;
+            }
+            wakeUp_.notify_all();
+            thread_.join();
+        }
+    }
+
+    IdleWatchdog::Policy IdleWatchdog::policy( const string &name, const string &parameter )
+    {
+        if( name == "warn" ) { return warn; }
+        if( name == "checkpoint" ) { return checkpoint; }
+        if( name == "exit" ) { return exit; }
+        throw cms::Exception( "Configuration" ) << "IdleWatchdog: unknown " << parameter << " '" << name << "', should be warn, checkpoint or exit";
+    }
+
+    const char *IdleWatchdog::policyName( Policy pol )
+    {
+        return ( pol == warn ? "warn" : ( pol == checkpoint ? "checkpoint" : "exit" ) );
+    }
+
+    IdleWatchdog::Sample IdleWatchdog::sample( unsigned long events )
+    {
+        Sample ret;
+        ret.events = events;
+        ret.wall = chrono::duration<double>( chrono::steady_clock::now().time_since_epoch() ).count();
+        timespec ts;
+        clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+        ret.cpu = ts.tv_sec + 1.e-9 * ts.tv_nsec;
+
+        long size = 0, resident = 0;
+        ifstream statm( "/proc/self/statm" );
+        statm >> size >> resident;
+        ret.rss = resident * ( sysconf( _SC_PAGESIZE ) / 1024 );
+
+        // rchar: all the bytes read by the process, from local files and sockets alike
+        ret.read = -1;
+        ifstream io( "/proc/self/io" );
+        string key;
+        long long value;
+        while( io >> key >> value ) {
+            if( key == "rchar:" ) {
+                ret.read = value;
+                break;
+            }
+        }
+        return ret;
+    }
+
+    void IdleWatchdog::preallocate( const edm::service::SystemBounds &bounds )
+    {
+        nThreads_ = max( 1u, bounds.maxNumberOfThreads() );
+    }
+
+    // the clock starts after the initialization, which may take long before the first event
+    void IdleWatchdog::postBeginJob()
+    {
+        lock_guard<mutex> lock( mutex_ );
+        start_ = sample( nEvents_ );
+        samples_.assign( 1, start_ );
+        writeStatus( "running" );
+        thread_ = std::thread( &IdleWatchdog::run, this );
+    }
+
+    void IdleWatchdog::postEndJob()
+    {
+        {
+            lock_guard<mutex> lock( mutex_ );
+            stop_ = true;
+        }
+        wakeUp_.notify_all();
+        if( thread_.joinable() ) { thread_.join(); }
+
+        lock_guard<mutex> lock( mutex_ );
+        samples_.push_back( sample( nEvents_ ) );
+        if( samples_.size() > window_ + 1 ) { samples_.pop_front(); }
+        writeStatus( checkpointed_ ? "checkpoint" : "finished" );
+    }
+
+    void IdleWatchdog::postEvent( const edm::StreamContext & )
+    {
+        nEvents_.fetch_add( 1, memory_order_relaxed );
+    }
+
+    void IdleWatchdog::postOpenFile( const string &lfn, bool )
+    {
+        lock_guard<mutex> lock( mutex_ );
+        ++nInputFiles_;
+        inputFile_ = lfn;
+    }
+
+    void IdleWatchdog::run()
+    {
+        unique_lock<mutex> lock( mutex_ );
+        while( ! wakeUp_.wait_for( lock, chrono::duration<double>( interval_ ), [this] { return stop_; } ) ) {
+            check();
+        }
+    }
+
+    // call with mutex_ held
     void IdleWatchdog::check()
     {
-        ++ievent_;
-        if( ( ( ievent_ - 1 ) % checkEvery_ ) != 0 ) {
-            return;
+        samples_.push_back( sample( nEvents_ ) );
+        if( samples_.size() > window_ + 1 ) { samples_.pop_front(); }
+        const Sample &now = samples_.back();
+        const Sample &last = samples_[samples_.size() - 2];
+        const Sample &first = samples_.front();
+
+        double efficiency = ( now.cpu - last.cpu ) / ( ( now.wall - last.wall ) * nThreads_ );
+        bool stalled = ( efficiency < minCpuEfficiency_ );
+
+        double rssGrowth = 0.;
+        if( first.events >= warmupEvents_ && now.events > first.events ) {
+            rssGrowth = ( now.rss - first.rss ) / 1024. / ( now.events - first.events ) * 1000.;
         }
+        bool growing = ( ( maxRssGrowth_ > 0. && rssGrowth > maxRssGrowth_ ) || ( maxRss_ > 0. && now.rss / 1024. > maxRss_ ) );
 
+        bool failed[2] = { stalled, growing };
+        for( int cond = 0; cond < 2; ++cond ) {
+            if( ! failed[cond] ) {
+                failures_[cond] = 0;
+                // warnings are given again if the condition comes back
+                if( policies_[cond] == warn ) { triggered_[cond] = false; }
+            } else {
+                ++failures_[cond];
+            }
+        }
 
-        // cout << "checking " << endl;
-        stopWatch_.Stop();
-        float cputime  = stopWatch_.CpuTime();
-        float realtime = stopWatch_.RealTime();
+        writeStatus( checkpointed_ ? "checkpoint" : "running" );
 
-        // std::cout << cputime << " " << realtime << std::endl;
-        if( cputime / realtime < minIdleFraction_ ) {
-            --nFailures_;
-        } else {
-            nFailures_ = tolerance_;
+        if( failures_[stall] >= tolerance_ ) {
+            ostringstream reason;
+            reason << "CPU efficiency " << setprecision( 2 ) << efficiency << " below " << minCpuEfficiency_
+                   << " for " << failures_[stall] << " checks, at event " << now.events;
+            trigger( stall, reason.str() );
+        }
+        if( failures_[memory] >= tolerance_ ) {
+            ostringstream reason;
+            reason << fixed << setprecision( 1 ) << "resident memory " << now.rss / 1024. << " MB, growing by " << rssGrowth
+                   << " MB per 1000 events, for " << failures_[memory] << " checks, at event " << now.events;
+            trigger( memory, reason.str() );
         }
+    }
+
+    // call with mutex_ held
+    void IdleWatchdog::trigger( Condition cond, const string &reason )
+    {
+        if( triggered_[cond] ) { return; }
+        triggered_[cond] = true;
+        Policy pol = policies_[cond];
+        warnings_.push_back( reason );
+        cerr << "IdleWatchdog: " << reason << " (policy: " << policyName( pol ) << ")" << endl;
 
-        if( nFailures_ == 0 ) {
-            cerr << "IdleWatchdog job too inefficient. Aborting minIdleFraction: " << minIdleFraction_ << " tolerance: " << tolerance_ << " aborting " << endl;
-            exit( 99 );
+        if( pol == warn ) {
+            writeStatus( checkpointed_ ? "checkpoint" : "running" );
+        } else if( pol == checkpoint ) {
+            // same as SIGUSR2: no new events are started, the output files are closed normally
+            edm::shutdown_flag.store( true );
+            checkpointed_ = true;
+            writeStatus( "checkpoint" );
+        } else {
+            // called from the watchdog thread: the framework threads cannot be wound down, so exit right away
+            writeStatus( cond == stall ? "stalled" : "memory" );
+            cerr << "IdleWatchdog: aborting" << endl;
+            _Exit( cond == stall ? 99 : 98 );
         }
-        stopWatch_.Start();
     }
 
-    void IdleWatchdog::reset()
+    // call with mutex_ held
+    void IdleWatchdog::writeStatus( const char *state )
     {
-        ievent_ = 0;
-        nFailures_ = tolerance_;
-        stopWatch_.Stop();
-        stopWatch_.Start();
+        const Sample &now = samples_.empty() ? start_ : samples_.back();
+        const Sample &first = samples_.empty() ? start_ : samples_.front();
+        double dwall = now.wall - first.wall;
+        unsigned long devents = now.events - first.events;
+
+        char host[256] = "";
+        gethostname( host, sizeof( host ) - 1 );
+
+        ostringstream out;
+        out << fixed << setprecision( 3 );
+        out << "{\n";
+        out << "  \"state\": " << quote( state ) << ",\n";
+        out << "  \"host\": " << quote( host ) << ",\n";
+        out << "  \"pid\": " << getpid() << ",\n";
+        out << "  \"updated\": " << time( 0 ) << ",\n";
+        out << "  \"elapsed\": " << now.wall - start_.wall << ",\n";
+        out << "  \"events\": " << now.events << ",\n";
+        out << "  \"threads\": " << nThreads_ << ",\n";
+        out << "  \"window\": " << dwall << ",\n";
+        out << "  \"eventsPerSecond\": " << ( dwall > 0. ? devents / dwall : 0. ) << ",\n";
+        out << "  \"cpuEfficiency\": " << ( dwall > 0. ? ( now.cpu - first.cpu ) / ( dwall * nThreads_ ) : 0. ) << ",\n";
+        out << "  \"rssMB\": " << now.rss / 1024. << ",\n";
+        if( devents > 0 && first.events >= warmupEvents_ ) {
+            out << "  \"rssGrowthMBPerKEvent\": " << ( now.rss - first.rss ) / 1024. / devents * 1000. << ",\n";
+        } else {
+            out << "  \"rssGrowthMBPerKEvent\": null,\n";
+        }
+        if( now.read >= 0 && first.read >= 0 && dwall > 0. ) {
+            out << "  \"readMBPerSecond\": " << ( now.read - first.read ) / ( 1024. * 1024. ) / dwall << ",\n";
+        } else {
+            out << "  \"readMBPerSecond\": null,\n";
+        }
+        out << "  \"inputFiles\": " << nInputFiles_ << ",\n";
+        out << "  \"inputFile\": " << quote( inputFile_ ) << ",\n";
+        out << "  \"warnings\": [";
+        for( size_t iw = 0; iw < warnings_.size(); ++iw ) {
+            out << ( iw > 0 ? ", " : "" ) << quote( warnings_[iw] );
+        }
+        out << "]\n";
+        out << "}\n";
+
+        // readers never see a partial file
+        string tmpName = statusFile_ + ".tmp";
+        ofstream file( tmpName.c_str() );
+        file << out.str();
+        file.close();
+        if( ! file || rename( tmpName.c_str(), statusFile_.c_str() ) != 0 ) {
+            if( ! writeFailed_ ) {
+                cerr << "IdleWatchdog: cannot write the status file " << statusFile_ << endl;
+                writeFailed_ = true;
+            }
+        }
     }
 
 }
@@ -57,4 +306,3 @@ namespace flashgg {
 // c-basic-offset:4
 // End:
 // vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
-
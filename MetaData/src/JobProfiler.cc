@@ -0,0 +1,284 @@
+#include "flashgg/MetaData/interface/JobProfiler.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ServiceRegistry/interface/ActivityRegistry.h"
+#include "FWCore/ServiceRegistry/interface/ModuleCallingContext.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/ServiceRegistry/interface/StreamContext.h"
+#include "FWCore/ServiceRegistry/interface/SystemBounds.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "DataFormats/Provenance/interface/ModuleDescription.h"
+
+#include <chrono>
+#include <iomanip>
+#include <malloc.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace flashgg {
+
+    JobProfiler::JobProfiler( const edm::ParameterSet &iConfig, edm::ActivityRegistry &iRegistry ) :
+        fileName_( iConfig.getUntrackedParameter<string>( "fileName", "flashggProfile.csv" ) ),
+        recordHeap_( iConfig.getUntrackedParameter<bool>( "recordHeap", true ) ),
+        eventStart_( 1 ),
+        nEvents_( 0 ),
+        jobStart_( wallTime() )
+    {
+        out_.open( fileName_.c_str() );
+        if( ! out_.is_open() ) {
+            throw cms::Exception( "Configuration" ) << "JobProfiler: cannot open " << fileName_ << " for writing";
+        }
+        out_ << fixed << setprecision( 1 );
+        out_ << "# flashgg JobProfiler: event,entry,wall_us,cpu_us,memory" << "\n";
+        newEntry( "event", "Event" );
+
+        iRegistry.watchPreallocate( this, &JobProfiler::preallocate );
+        iRegistry.watchPostBeginJob( this, &JobProfiler::postBeginJob );
+        iRegistry.watchPostEndJob( this, &JobProfiler::postEndJob );
+        iRegistry.watchPreEvent( this, &JobProfiler::preEvent );
+        iRegistry.watchPostEvent( this, &JobProfiler::postEvent );
+        iRegistry.watchPreModuleEvent( this, &JobProfiler::preModuleEvent );
+        iRegistry.watchPostModuleEvent( this, &JobProfiler::postModuleEvent );
+        iRegistry.watchPreModuleEventDelayedGet( this, &JobProfiler::preModuleEventDelayedGet );
+        iRegistry.watchPostModuleEventDelayedGet( this, &JobProfiler::postModuleEventDelayedGet );
+    }
+
+    JobProfiler::~JobProfiler()
+    {
+        if( out_.is_open() ) { out_.close(); }
+    }
+
+    double JobProfiler::wallTime()
+    {
+        return chrono::duration<double>( chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    double JobProfiler::threadCpuTime()
+    {
+        timespec ts;
+        clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+        return ts.tv_sec + 1.e-9 * ts.tv_nsec;
+    }
+
+    double JobProfiler::processCpuTime()
+    {
+        timespec ts;
+        clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+        return ts.tv_sec + 1.e-9 * ts.tv_nsec;
+    }
+
+    long JobProfiler::residentMemory()
+    {
+        long size = 0, resident = 0;
+        ifstream statm( "/proc/self/statm" );
+        statm >> size >> resident;
+        return resident * ( sysconf( _SC_PAGESIZE ) / 1024 );
+    }
+
+    long JobProfiler::heapInUse() const
+    {
+        if( ! recordHeap_ ) { return 0; }
+        // glibc allocator only: reads 0 when malloc is replaced, e.g. by jemalloc
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 33 ) )
+        struct mallinfo2 info = mallinfo2();
+#else
+        struct mallinfo info = mallinfo();
+#endif
+        return long( info.uordblks ) + long( info.hblkhd );
+    }
+
+    vector<JobProfiler::Frame> &JobProfiler::frames()
+    {
+        // modules run on demand are nested in their caller on the same thread
+        static thread_local vector<Frame> stack;
+        return stack;
+    }
+
+    unsigned int JobProfiler::newEntry( const string &label, const string &type )
+    {
+        unsigned int entry = entryLabels_.size();
+        entryLabels_.push_back( label );
+        out_ << "#entry," << entry << "," << label << "," << type << "\n";
+        return entry;
+    }
+
+    void JobProfiler::write( unsigned long long event, unsigned int entry, double wall, double cpu, long memory )
+    {
+        out_ << event << "," << entry << "," << 1.e6 * wall << "," << 1.e6 * cpu << "," << memory << "\n";
+    }
+
+    unsigned int JobProfiler::subTimerId( const string &name )
+    {
+        lock_guard<mutex> lock( mutex_ );
+        for( unsigned int i = 0 ; i < subTimerNames_.size() ; i++ ) {
+            if( subTimerNames_[i] == name ) { return i; }
+        }
+        subTimerNames_.push_back( name );
+        return subTimerNames_.size() - 1;
+    }
+
+    void JobProfiler::addSubTime( unsigned int nameId, double wall, double cpu )
+    {
+        vector<Frame> &stack = frames();
+        if( stack.empty() ) { return; }
+        auto &subTimes = stack.back().subTimes;
+        for( auto &sub : subTimes ) {
+            if( sub.first == nameId ) {
+                sub.second.first += wall;
+                sub.second.second += cpu;
+                return;
+            }
+        }
+        subTimes.emplace_back( nameId, make_pair( wall, cpu ) );
+    }
+
+    void JobProfiler::preallocate( const edm::service::SystemBounds &bounds )
+    {
+        eventStart_.resize( bounds.maxNumberOfStreams() );
+    }
+
+    void JobProfiler::postBeginJob()
+    {
+        jobStart_ = wallTime();
+    }
+
+    void JobProfiler::postEndJob()
+    {
+        lock_guard<mutex> lock( mutex_ );
+        out_ << "#job," << nEvents_ << "," << ( wallTime() - jobStart_ ) << "\n";
+        out_.close();
+    }
+
+    void JobProfiler::preEvent( const edm::StreamContext &sc )
+    {
+        eventStart_[sc.streamID().value()] = make_pair( wallTime(), processCpuTime() );
+    }
+
+    void JobProfiler::postEvent( const edm::StreamContext &sc )
+    {
+        const auto &start = eventStart_[sc.streamID().value()];
+        double wall = wallTime() - start.first;
+        double cpu = processCpuTime() - start.second;
+        long resident = residentMemory();
+
+        lock_guard<mutex> lock( mutex_ );
+        ++nEvents_;
+        write( sc.eventID().event(), 0, wall, cpu, resident );
+    }
+
+    void JobProfiler::preModuleEvent( const edm::StreamContext &, const edm::ModuleCallingContext &mcc )
+    {
+        unsigned int entry;
+        {
+            const edm::ModuleDescription &desc = *mcc.moduleDescription();
+            lock_guard<mutex> lock( mutex_ );
+            auto it = moduleEntries_.find( desc.id() );
+            if( it == moduleEntries_.end() ) {
+                entry = newEntry( desc.moduleLabel(), desc.moduleName() );
+                moduleEntries_[desc.id()] = entry;
+            } else {
+                entry = it->second;
+            }
+        }
+
+        vector<Frame> &stack = frames();
+        stack.emplace_back();
+        Frame &frame = stack.back();
+        frame.entry = entry;
+        frame.pausedWall = frame.pausedCpu = 0.;
+        frame.pausedHeap = 0;
+        frame.heap = heapInUse();
+        frame.cpu = threadCpuTime();
+        frame.wall = wallTime();
+    }
+
+    void JobProfiler::postModuleEvent( const edm::StreamContext &sc, const edm::ModuleCallingContext & )
+    {
+        double wall = wallTime();
+        double cpu = threadCpuTime();
+        long heap = heapInUse();
+
+        vector<Frame> &stack = frames();
+        if( stack.empty() ) { return; }
+        Frame frame = std::move( stack.back() );
+        stack.pop_back();
+
+        unsigned long long event = sc.eventID().event();
+        lock_guard<mutex> lock( mutex_ );
+        write( event, frame.entry, wall - frame.wall - frame.pausedWall, cpu - frame.cpu - frame.pausedCpu, heap - frame.heap - frame.pausedHeap );
+        for( const auto &sub : frame.subTimes ) {
+            auto key = make_pair( frame.entry, sub.first );
+            auto it = subTimerEntries_.find( key );
+            unsigned int entry;
+            if( it == subTimerEntries_.end() ) {
+                entry = newEntry( entryLabels_[frame.entry] + "/" + subTimerNames_[sub.first], "SubTimer" );
+                subTimerEntries_[key] = entry;
+            } else {
+                entry = it->second;
+            }
+            write( event, entry, sub.second.first, sub.second.second, 0 );
+        }
+    }
+
+    // the time spent waiting for the modules run on demand is not attributed to the caller,
+    // whichever thread they run on
+    void JobProfiler::preModuleEventDelayedGet( const edm::StreamContext &, const edm::ModuleCallingContext & )
+    {
+        vector<Frame> &stack = frames();
+        if( stack.empty() ) { return; }
+        Frame &frame = stack.back();
+        frame.pauseStartHeap = heapInUse();
+        frame.pauseStartCpu = threadCpuTime();
+        frame.pauseStartWall = wallTime();
+    }
+
+    void JobProfiler::postModuleEventDelayedGet( const edm::StreamContext &, const edm::ModuleCallingContext & )
+    {
+        double wall = wallTime();
+        double cpu = threadCpuTime();
+        long heap = heapInUse();
+
+        vector<Frame> &stack = frames();
+        if( stack.empty() ) { return; }
+        Frame &frame = stack.back();
+        frame.pausedWall += wall - frame.pauseStartWall;
+        frame.pausedCpu += cpu - frame.pauseStartCpu;
+        frame.pausedHeap += heap - frame.pauseStartHeap;
+    }
+
+    ProfilerSubTimers::ProfilerSubTimers() :
+        profiler_( 0 )
+    {
+        edm::Service<JobProfiler> profiler;
+        if( profiler.isAvailable() ) { profiler_ = &( *profiler ); }
+    }
+
+    unsigned int ProfilerSubTimers::add( const string &name )
+    {
+        ids_.push_back( profiler_ ? profiler_->subTimerId( name ) : 0 );
+        started_.emplace_back( 0., 0. );
+        return ids_.size() - 1;
+    }
+
+    void ProfilerSubTimers::start( unsigned int i )
+    {
+        if( ! profiler_ ) { return; }
+        started_[i] = make_pair( JobProfiler::wallTime(), JobProfiler::threadCpuTime() );
+    }
+
+    void ProfilerSubTimers::stop( unsigned int i )
+    {
+        if( ! profiler_ ) { return; }
+        profiler_->addSubTime( ids_[i], JobProfiler::wallTime() - started_[i].first, JobProfiler::threadCpuTime() - started_[i].second );
+    }
+
+}
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
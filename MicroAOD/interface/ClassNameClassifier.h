@@ -7,10 +7,14 @@
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_map>
+#include <algorithm>
 #include <boost/type_index.hpp>
 
 namespace flashgg {
 
+    // Classifies objects by their (remapped) class name, with the integer conversion of the object as subcategory.
+    // Categories are numbered as their names are first met, either through categoryIndex() at configuration
+    // or at the first object of a new class, and classify() returns that index.
     template <class T>
     class ClassNameClassifier
     {
@@ -26,22 +30,43 @@ namespace flashgg {
         }
 
         std::pair<std::string, int> operator()( const T &obj ) const
+        {
+            auto cat = classify( obj );
+            return std::make_pair( names_[cat.first], cat.second );
+        }
+
+        // (category index, subcategory)
+        std::pair<int, int> classify( const T &obj ) const
         {
             int id = ( int )obj;
             std::type_index idx( typeid( obj ) );
             auto cached = cache_.find( idx );
             if( cached != cache_.end() ) { return std::make_pair( cached->second, id ); }
-            auto ret = std::make_pair( edm::stripNamespace( edm::TypeID( obj ).friendlyClassName() ), id );
-            auto rm = remap_.find( ret.first );
-            if( rm != remap_.end() ) { ret.first = rm->second; }
-            cache_.insert( std::make_pair( idx, ret.first ) );
-            return ret;
+            auto name = edm::stripNamespace( edm::TypeID( obj ).friendlyClassName() );
+            auto rm = remap_.find( name );
+            if( rm != remap_.end() ) { name = rm->second; }
+            int icat = categoryIndex( name );
+            cache_.insert( std::make_pair( idx, icat ) );
+            return std::make_pair( icat, id );
         }
 
+        // index of the category with the given name, booked if not met yet
+        int categoryIndex( const std::string &name ) const
+        {
+            auto it = std::find( names_.begin(), names_.end(), name );
+            if( it != names_.end() ) { return it - names_.begin(); }
+            names_.push_back( name );
+            return names_.size() - 1;
+        }
+
+        const std::string &categoryName( int icat ) const { return names_[icat]; }
+        size_t nCategories() const { return names_.size(); }
+
 
     private:
         std::map<std::string, std::string> remap_;
-        mutable std::unordered_map<std::type_index, std::string> cache_;
+        mutable std::vector<std::string> names_;
+        mutable std::unordered_map<std::type_index, int> cache_;
     };
 }
 
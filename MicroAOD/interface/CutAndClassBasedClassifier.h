@@ -4,6 +4,7 @@
 #include "CommonTools/Utils/interface/StringCutObjectSelector.h"
 
 #include "CutBasedClassifier.h"
+#include "ClassNameClassifier.h"
 
 namespace flashgg {
     template <class T>
@@ -20,16 +21,50 @@ namespace flashgg {
 
         std::pair<std::string, int> operator()( const T &obj ) const
         {
-            auto cutbased = CutBasedClassifier<T>::operator()(obj);
-            
-            auto classbased = ClassNameClassifier<T>::operator()(obj);
-            
-            std::string cat = classbased.first;
-            if( ! cutbased.first.empty() ) {
-                cat += (cat.empty()?"":":")+cutbased.first; // FIXME: define ad-hoc method with dedicated + operator
+            auto cat = classify( obj );
+            return std::make_pair( categoryName( cat.first ), cat.second );
+        }
+
+        // (category index, subcategory): the class index times the number of cut categories plus the cut index
+        std::pair<int, int> classify( const T &obj ) const
+        {
+            auto cutbased = CutBasedClassifier<T>::classify( obj );
+            auto classbased = ClassNameClassifier<T>::classify( obj );
+            return std::make_pair( combine( classbased.first, cutbased.first ), classbased.second );
+        }
+
+        // index of the category with the given "class:cut" name, -1 if none of the cut names matches
+        int categoryIndex( const std::string &name ) const
+        {
+            for( size_t icut = 0; icut < CutBasedClassifier<T>::nCategories(); ++icut ) {
+                auto &cut = CutBasedClassifier<T>::categoryName( icut );
+                std::string classname;
+                if( cut.empty() ) {
+                    classname = name;
+                } else if( name != cut ) {
+                    if( name.size() <= cut.size() || name.compare( name.size() - cut.size() - 1, std::string::npos, ":" + cut ) != 0 ) { continue; }
+                    classname = name.substr( 0, name.size() - cut.size() - 1 );
+                }
+                return combine( ClassNameClassifier<T>::categoryIndex( classname ), icut );
             }
-            return std::make_pair( cat, classbased.second  );
+            return -1;
         }
+
+        std::string categoryName( int icat ) const
+        {
+            int ncuts = CutBasedClassifier<T>::nCategories();
+            std::string cat = ClassNameClassifier<T>::categoryName( icat / ncuts );
+            auto &cut = CutBasedClassifier<T>::categoryName( icat % ncuts );
+            if( ! cut.empty() ) {
+                cat += (cat.empty()?"":":")+cut; // FIXME: define ad-hoc method with dedicated + operator
+            }
+            return cat;
+        }
+
+        size_t nCategories() const { return ClassNameClassifier<T>::nCategories() * CutBasedClassifier<T>::nCategories(); }
+
+    private:
+        int combine( int iclass, int icut ) const { return iclass * CutBasedClassifier<T>::nCategories() + icut; }
     };
 }
 
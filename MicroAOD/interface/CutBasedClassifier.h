@@ -3,7 +3,13 @@
 
 #include "CommonTools/Utils/interface/StringCutObjectSelector.h"
 
+#include <algorithm>
+
 namespace flashgg {
+    // Classifies objects by the first cut they pass.
+    // Categories are numbered at construction, one per distinct name, plus the unnamed category ("") of
+    // the objects that fail all the cuts: classify() returns that index, so that users can dispatch on a
+    // vector rather than on the name, which is kept for output naming.
     template <class T>
     class CutBasedClassifier
     {
@@ -18,20 +24,47 @@ namespace flashgg {
                 auto cut = cat.getParameter<std::string>( "cut" );
                 auto name = cat.getUntrackedParameter<std::string>( "name", Form( "cat%lu", cuts_.size() ) );
 
-                cuts_.push_back( std::make_pair( functor_type( cut ), name ) );
+                cuts_.push_back( std::make_pair( functor_type( cut ), addName( name ) ) );
             }
+            unclassified_ = addName( "" );
         }
 
         std::pair<std::string, int> operator()( const T &obj ) const
+        {
+            return std::make_pair( names_[classify( obj ).first], 0 );
+        }
+
+        // (category index, subcategory)
+        std::pair<int, int> classify( const T &obj ) const
         {
             for( auto &cut : cuts_ ) {
                 if( cut.first( obj ) ) { return std::make_pair( cut.second, 0 ); }
             }
-            return std::make_pair( "", 0 );
+            return std::make_pair( unclassified_, 0 );
         }
 
+        // index of the category with the given name, -1 if none
+        int categoryIndex( const std::string &name ) const
+        {
+            auto it = std::find( names_.begin(), names_.end(), name );
+            return ( it != names_.end() ? it - names_.begin() : -1 );
+        }
+
+        const std::string &categoryName( int icat ) const { return names_[icat]; }
+        size_t nCategories() const { return names_.size(); }
+
     private:
-        std::vector<std::pair<functor_type, std::string> > cuts_;
+        int addName( const std::string &name )
+        {
+            int icat = categoryIndex( name );
+            if( icat >= 0 ) { return icat; }
+            names_.push_back( name );
+            return names_.size() - 1;
+        }
+
+        std::vector<std::pair<functor_type, int> > cuts_;
+        std::vector<std::string> names_;
+        int unclassified_;
 
     };
 }
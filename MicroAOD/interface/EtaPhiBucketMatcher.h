@@ -0,0 +1,52 @@
+#ifndef flashgg_EtaPhiBucketMatcher_h
+#define flashgg_EtaPhiBucketMatcher_h
+
+#include <utility>
+#include <vector>
+
+namespace flashgg {
+
+    // Finds all the objects of a collection within maxDR of a given direction, replacing a loop over
+    // the whole collection. The objects are sorted into (eta, phi) cells at least maxDR wide, so that
+    // only the 3x3 cells around the query need to be checked.
+    // The matches are those of reco::deltaR( eta[j], phi[j], eta, phi ) < maxDR, returned by increasing
+    // index j, i.e. the same as the plain loop.
+    class EtaPhiBucketMatcher
+    {
+    public:
+        EtaPhiBucketMatcher( double maxDR );
+
+        void clear();
+        // objects get the index of their insertion order; build() must be called after the last one
+        void add( double eta, double phi );
+        void build();
+
+        unsigned int size() const { return eta_.size(); }
+        double eta( unsigned int j ) const { return eta_[j]; }
+        double phi( unsigned int j ) const { return phi_[j]; }
+        void match( double eta, double phi, std::vector<unsigned int> &matches ) const;
+        // all the objects in the 3x3 cells around the direction, by increasing index: a superset of the objects
+        // within maxDR, for users applying their own distance cuts
+        void neighbours( double eta, double phi, std::vector<unsigned int> &candidates ) const;
+
+    private:
+        int etaCell( double eta ) const;
+        int phiCell( double phi ) const;
+        long cellKey( int ieta, int iphi ) const { return ( long )ieta * nPhiCells_ + iphi; }
+
+        double maxDR_;
+        int nPhiCells_;
+        std::vector<double> eta_, phi_;
+        std::vector<std::pair<long, unsigned int> > cells_; // (cell key, index), sorted
+    };
+
+}
+
+#endif // flashgg_EtaPhiBucketMatcher_h
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
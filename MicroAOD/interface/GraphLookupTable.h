@@ -0,0 +1,90 @@
+#ifndef flashgg_GraphLookupTable_h
+#define flashgg_GraphLookupTable_h
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+class TGraph;
+
+namespace flashgg {
+
+    // Uniform-grid replacement for the linear TGraph::Eval, which scans all the knots on every call.
+    // - equally spaced knots are used directly as the grid and reproduce TGraph::Eval exactly;
+    // - otherwise the graph is resampled on a uniform grid, refined until it matches TGraph::Eval at
+    //   the original knots within tolerance * (ymax - ymin);
+    // - if that needs more than maxBins, the knots are kept and a uniform grid of cells pointing to the
+    //   first knot of each cell is used instead, which is again exact and O(1) on average.
+    // Outside the knot range the graph is linearly extrapolated, as TGraph::Eval does. NaN gives NaN.
+    class GraphLookupTable
+    {
+    public:
+        GraphLookupTable();
+        GraphLookupTable( const TGraph &graph, double tolerance = 1.e-4, unsigned int minBins = 1024, unsigned int maxBins = 1 << 16 );
+
+        double eval( double x ) const;
+        double operator()( double x ) const { return eval( x ); }
+
+        // batch evaluation; in grid mode it has no data-dependent branches, so that it can be vectorized
+        void eval( const float *x, float *y, size_t n ) const { evalImpl( x, y, n ); }
+        void eval( const double *x, double *y, size_t n ) const { evalImpl( x, y, n ); }
+
+        bool exact() const { return exact_; }
+        bool resampled() const { return knotX_.empty() && ! exact_; }
+        double maxDeviation() const { return maxDeviation_; }
+        size_t nBins() const { return vals_.size() - 1; }
+
+    private:
+        template<class T> void evalImpl( const T *x, T *y, size_t n ) const;
+        double evalKnots( double x ) const;
+        void fill( const std::vector<double> &kx, const std::vector<double> &ky, unsigned int nbins );
+        void index( std::vector<double> &kx, std::vector<double> &ky );
+
+        double xmin_, xmax_, step_, invStep_;
+        double loSlope_, hiSlope_;
+        std::vector<double> vals_;
+        std::vector<double> knotX_, knotY_;
+        std::vector<unsigned int> cellFirstKnot_;
+        bool exact_;
+        double maxDeviation_;
+    };
+
+    inline double GraphLookupTable::eval( double x ) const
+    {
+        if( ! knotX_.empty() ) { return evalKnots( x ); }
+        double ret;
+        evalImpl( &x, &ret, 1 );
+        return ret;
+    }
+
+    template<class T> void GraphLookupTable::evalImpl( const T *x, T *y, size_t n ) const
+    {
+        if( ! knotX_.empty() ) {
+            for( size_t ii = 0; ii < n; ++ii ) { y[ii] = evalKnots( x[ii] ); }
+            return;
+        }
+        const size_t lastBin = vals_.size() - 2;
+        const double umax = lastBin + 1;
+        const double *vals = &vals_[0];
+        for( size_t ii = 0; ii < n; ++ii ) {
+            double u = ( x[ii] - xmin_ ) * invStep_;
+            // clamped to [0, umax] before the conversion to an index; NaN goes to 0 and still gives NaN through u - uc
+            double uc = ( u > 0. ? std::min( u, umax ) : 0. );
+            size_t ibin = std::min( size_t( uc ), lastBin );
+            double frac = uc - ibin;
+            double val = vals[ibin] + frac * ( vals[ibin + 1] - vals[ibin] );
+            double slope = ( u < 0. ? loSlope_ : hiSlope_ );
+            y[ii] = val + ( u - uc ) * step_ * slope;
+        }
+    }
+
+}
+
+#endif // flashgg_GraphLookupTable_h
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
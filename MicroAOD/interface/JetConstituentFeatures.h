@@ -0,0 +1,86 @@
+#ifndef flashgg_JetConstituentFeatures_h
+#define flashgg_JetConstituentFeatures_h
+
+#include <vector>
+
+namespace pat {
+    class Jet;
+    class PackedCandidate;
+}
+
+namespace flashgg {
+
+    // Constituent-level jet variables computed in one pass.
+    // fill() reads the packed constituents of a jet once into flat arrays (pt, eta, phi, energy, pdgId,
+    // charge and the fromPV/high-purity vertex association), from which are then computed together:
+    // - the quark-gluon inputs ptD, axis1, axis2 and totalMult;
+    // - the simple RMS sums, leading track and soft lepton variables;
+    // - the energy in rings of dR around the jet axis, per particle type, for the given ring boundaries.
+    class JetConstituentFeatures
+    {
+    public:
+        enum RingType { kCharged = 0, kEM, kNeutral, kMuon, nRingTypes };
+
+        // minimum pt of the neutral constituents entering the quark-gluon inputs, as in the QGTagger training
+        // (pt < 1 GeV rejected); compared with the pt stored as float, which is exact since the packed pt is a float
+        static constexpr float qgNeutralMinPt = 1.f;
+
+        JetConstituentFeatures( const std::vector<double> &coneBoundaries );
+
+        // returns false, with nothing computed, if one of the constituents is not a pat::PackedCandidate
+        bool fill( const pat::Jet &jet );
+
+        unsigned int size() const { return pt_.size(); }
+        const std::vector<float> &coneBoundaries() const { return coneBoundaries_; }
+
+        // quark-gluon likelihood inputs
+        float ptD() const { return ptD_; }
+        float axis1() const { return axis1_; }
+        float axis2() const { return axis2_; }
+        float totalMult() const { return totalMult_; }
+
+        float sumPtDrSq() const { return sumPtDrSq_; }
+        float sumPtSq() const { return sumPtSq_; }
+        int numDaug03() const { return numDaug03_; }
+        float leadTrackPt() const { return leadTrackPt_; }
+
+        float softLepPt() const { return softLepPt_; }
+        float softLepRatio() const { return softLepRatio_; }
+        float softLepDr() const { return softLepDr_; }
+        float softLepPtRel() const { return softLepPtRel_; }
+        float softLepPtRelInv() const { return softLepPtRelInv_; }
+        int softLepPdgId() const { return softLepPdgId_; }
+
+        // coneBoundaries().size()+1 rings, the last one collecting everything beyond the last boundary
+        const std::vector<float> &ringEnergies( RingType type ) const { return ringEnergies_[type]; }
+
+    private:
+        void compute( const pat::Jet &jet );
+
+        std::vector<float> coneBoundaries_;
+
+        // constituent buffer
+        std::vector<const pat::PackedCandidate *> cands_;
+        std::vector<float> pt_, energy_;
+        std::vector<double> eta_, phi_;
+        std::vector<int> pdgId_, charge_, fromPV_;
+        std::vector<char> highPurity_;
+
+        float ptD_, axis1_, axis2_, totalMult_;
+        float sumPtDrSq_, sumPtSq_, leadTrackPt_;
+        int numDaug03_;
+        float softLepPt_, softLepRatio_, softLepDr_, softLepPtRel_, softLepPtRelInv_;
+        int softLepPdgId_;
+        std::vector<float> ringEnergies_[nRingTypes];
+    };
+
+}
+
+#endif // flashgg_JetConstituentFeatures_h
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
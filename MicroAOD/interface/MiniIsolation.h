@@ -0,0 +1,67 @@
+#ifndef flashgg_MiniIsolation_h
+#define flashgg_MiniIsolation_h
+
+#include "DataFormats/Common/interface/View.h"
+#include "DataFormats/PatCandidates/interface/PackedCandidate.h"
+#include "flashgg/MicroAOD/interface/EtaPhiBucketMatcher.h"
+
+#include <vector>
+
+namespace flashgg {
+
+    // Mini-isolation of leptons (https://twiki.cern.ch/twiki/bin/view/CMS/MiniIsolationSUSY) from the packed PF
+    // candidates, shared by the electron and muon producers.
+    // The candidates that enter the isolation (|pdgId| >= 7) are copied once per event into plain arrays and
+    // sorted into (eta, phi) cells at least maxCone wide, when the first lepton asks for its sums: events without
+    // a lepton to isolate do not pay for it. Each lepton then only looks at the candidates of the 3x3 cells around
+    // it, in their original order, so that the sums are the same as those of the loop over the whole collection.
+    class MiniIsolation
+    {
+    public:
+        struct DeadCones {
+            double ch, pu, ph, nh;
+        };
+
+        struct Sums {
+            double ch = 0.;  // charged hadrons from the PV
+            double nh = 0.;  // neutral hadrons
+            double ph = 0.;  // photons
+            double pu = 0.;  // charged candidates from PU
+            double ph2 = 0.; // photons above ptThreshPhotons2
+        };
+
+        // maxCone: the largest cone size that will be asked for
+        MiniIsolation( double maxCone );
+
+        // candidates of the event; kept by reference until the next call, and only indexed by the first sums()
+        void setCandidates( const edm::View<pat::PackedCandidate> & );
+
+        // pT-dependent cone size, max( rMin, min( rMax, ktScale / pt ) )
+        static double cone( double pt, double rMin, double rMax, double ktScale );
+
+        // sums of the pt of the candidates within dR <= cone of the direction, outside their dead cone;
+        // neutrals and PU charged ones only above ptThresh
+        Sums sums( double eta, double phi, double cone, const DeadCones &deadCones, double ptThresh, double ptThreshPhotons2 );
+
+    private:
+        void fill();
+
+        const edm::View<pat::PackedCandidate> *candidates_;
+        bool filled_;
+        EtaPhiBucketMatcher cells_;  // eta and phi of the candidates
+        std::vector<double> pt_;
+        std::vector<int> pdgId_;     // absolute value
+        std::vector<int> charge_;
+        std::vector<int> fromPV_;
+        std::vector<unsigned int> neighbours_; // scratch
+    };
+}
+
+#endif // flashgg_MiniIsolation_h
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -3,6 +3,9 @@
 
 #include "DataFormats/Math/interface/deltaR.h"
 #include "flashgg/DataFormats/interface/Photon.h"
+#include "flashgg/MicroAOD/interface/EtaPhiBucketMatcher.h"
+
+#include <algorithm>
 
 namespace flashgg {
 
@@ -41,6 +44,50 @@ namespace flashgg {
             return true;
         }
 
+        struct GenIsolation {
+            float isoSum;
+            bool frixioneIso;
+        };
+
+        // isoSum( genp, coll, dRMax ) and frixioneIso( genp, coll, delta0, eps0, n0 ) from the particles of the cells
+        // around genp: cells holds the eta and phi of coll, in the same order, in cells at least max( dRMax, delta0 ) wide.
+        // The neighbours within the cone are collected once, by increasing index for the cone sum, then sorted by dR for
+        // the Frixione profile, so that both results are the same as those of the loops over the whole collection.
+        template<class GenT, class GenCollT> static GenIsolation isolation( const GenT &genp, const GenCollT &coll, const EtaPhiBucketMatcher &cells,
+                float dRMax, float delta0, float eps0, float n0 )
+        {
+            GenIsolation result = { 0., true };
+            std::vector<unsigned int> neighbours;
+            cells.neighbours( genp.eta(), genp.phi(), neighbours );
+            std::vector<std::pair<float, double> > slices; // ( dR, et ) within delta0
+            for( unsigned int j : neighbours ) {
+                double dR = reco::deltaR( genp.eta(), genp.phi(), cells.eta( j ), cells.phi( j ) );
+                bool inIsoCone = ( dR < dRMax ), inFrixioneCone = ( float( dR ) < delta0 );
+                if( !( inIsoCone || inFrixioneCone ) || coll[j].p4() == genp.p4() ) { continue; }
+                if( inIsoCone ) { result.isoSum += coll[j].et(); }
+                if( inFrixioneCone ) { slices.emplace_back( float( dR ), coll[j].et() ); }
+            }
+            std::stable_sort( slices.begin(), slices.end(),
+                              []( const std::pair<float, double> &a, const std::pair<float, double> &b ) { return a.first < b.first; } );
+
+            // as in frixioneIso, particles at the same dR make a single slice
+            float sum = 0.;
+            const float eTimesEps        = genp.et() * eps0;
+            const float oneMinusCosDelta0 = 1 - cos( delta0 );
+            for( size_t i = 0; i < slices.size(); ) {
+                const float delta = slices[i].first;
+                float slice = 0.;
+                for( ; i < slices.size() && slices[i].first == delta; ++i ) { slice += slices[i].second; }
+                sum  += slice;
+                const float chi = eTimesEps * pow( ( 1 - cos( delta ) ) / oneMinusCosDelta0, n0 );
+                if( sum >= chi ) {
+                    result.frixioneIso = false;
+                    break;
+                }
+            }
+            return result;
+        }
+
         static void determineMatchType( flashgg::Photon &pho, std::vector<int> promptMothers = std::vector<int>(),
                                         flashgg::Photon::mcMatch_t defaultType = flashgg::Photon::kUnkown );
 
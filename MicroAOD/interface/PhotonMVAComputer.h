@@ -38,8 +38,8 @@ namespace flashgg {
         selector_type selector_;
         // mva_names, default
         std::vector<std::tuple<std::string, float> > toFill_;
-        // category -> vector< <min,max,rhocorr> >
-        std::map<std::string, std::vector<mva_type *> >  mvas_;
+        // classifier category index -> one filler per mva to fill (empty for categories not configured)
+        std::vector<std::vector<mva_type *> >  mvas_;
 
     };
 
@@ -14,6 +14,7 @@
 #include "flashgg/DataFormats/interface/Electron.h"
 #include "DataFormats/EgammaCandidates/interface/GsfElectronCore.h"
 #include "DataFormats/Common/interface/RefToPtr.h"
+#include "DataFormats/Provenance/interface/ProductID.h"
 
 
 #include <set>
@@ -21,6 +22,43 @@
 using namespace edm;
 using namespace std;
 
+namespace {
+    // Place in an output collection of the input objects already copied there, looked up by product and key:
+    // one key -> place table (-1 if not copied) per input product, so that no lookup scans the output collection.
+    class CopiedObjects
+    {
+    public:
+        int find( const ProductID &id, size_t key ) const
+        {
+            for( const auto &table : tables_ ) {
+                if( table.first == id ) { return ( key < table.second.size() ? table.second[key] : -1 ); }
+            }
+            return -1;
+        }
+
+        // an object already in the table is moved to the new place only if overwrite is true
+        void insert( const ProductID &id, size_t key, int place, bool overwrite )
+        {
+            vector<int> *table = nullptr;
+            for( auto &t : tables_ ) {
+                if( t.first == id ) {
+                    table = &t.second;
+                    break;
+                }
+            }
+            if( table == nullptr ) {
+                tables_.emplace_back( id, vector<int>() );
+                table = &tables_.back().second;
+            }
+            if( key >= table->size() ) { table->resize( key + 1, -1 ); }
+            if( overwrite || ( *table )[key] < 0 ) { ( *table )[key] = place; }
+        }
+
+    private:
+        vector<pair<ProductID, vector<int> > > tables_;
+    };
+}
+
 namespace flashgg {
 
     class EGammaMinimizer : public EDProducer
@@ -85,11 +123,11 @@ namespace flashgg {
         edm::RefProd<vector<reco::PhotonCore> > rPhotonCore = evt.getRefBeforePut<vector<reco::PhotonCore> >( photonCoreCollectionName_ );
         edm::RefProd<vector<reco::GsfElectronCore> > rElectronCore = evt.getRefBeforePut<vector<reco::GsfElectronCore> >( electronCoreCollectionName_ );
 
-        // Same order as output photon collection to keep track of what's copied already
-        vector<Ptr<Photon> > usedPhotonPtrs;
+        // Places in the output photon collection of the old photons copied already
+        CopiedObjects usedPhotons;
 
-        // Refs to old super clusters to keep track of what's been copied already
-        vector<edm::Ref<vector<reco::SuperCluster> > > usedSuperClusterRefs;
+        // Places in the output super cluster collection of the old super clusters copied already: the first copy is used
+        CopiedObjects usedSuperClusters;
 
         if( debug_ ) {
             std::cout << " Input DiPhoton collection size: " << diPhotons->size() << std::endl;
@@ -108,54 +146,54 @@ namespace flashgg {
             Ptr<Photon> pp1;
             Ptr<Photon> pp2;
 
-            bool donepp1 = false;
-            bool donepp2 = false;
-            for( unsigned int j = 0 ; j < usedPhotonPtrs.size() ; j++ ) {
-                // If photon already copied into new collection, point to same one
-                if( oldpp1 == usedPhotonPtrs[j] ) {
-                    donepp1 = true;
-                    pp1 = edm::refToPtr( edm::Ref<vector<Photon> >( rPhoton, j ) );
-                    if( debug_ ) { std::cout << "   Leading photon with pt " << oldpp1->pt() << " already in collection at place " << j << std::endl; }
-                }
-                if( oldpp2 == usedPhotonPtrs[j] ) {
-                    donepp2 = true;
-                    pp2 = edm::refToPtr( edm::Ref<vector<Photon> >( rPhoton, j ) );
-                    if( debug_ ) { std::cout << "   Subleading photon with pt " << oldpp2->pt() << " already in collection at place " << j << std::endl; }
-                }
+            // If photon already copied into new collection, point to same one
+            int j1 = usedPhotons.find( oldpp1.id(), oldpp1.key() );
+            int j2 = usedPhotons.find( oldpp2.id(), oldpp2.key() );
+            bool donepp1 = ( j1 >= 0 );
+            bool donepp2 = ( j2 >= 0 );
+            if( donepp1 ) {
+                pp1 = edm::refToPtr( edm::Ref<vector<Photon> >( rPhoton, j1 ) );
+                if( debug_ ) { std::cout << "   Leading photon with pt " << oldpp1->pt() << " already in collection at place " << j1 << std::endl; }
+            }
+            if( donepp2 ) {
+                pp2 = edm::refToPtr( edm::Ref<vector<Photon> >( rPhoton, j2 ) );
+                if( debug_ ) { std::cout << "   Subleading photon with pt " << oldpp2->pt() << " already in collection at place " << j2 << std::endl; }
             }
 
             // If photon not yet copied: copy photon, create pointers into new collection
             if( !donepp1 ) {
                 Photon p1( *oldpp1 );
                 p1.removeVerticesExcept( usedVertices );
-                pp1 = edm::refToPtr( edm::Ref<vector<Photon> >( rPhoton, usedPhotonPtrs.size() ) );
-                if( debug_ ) { std::cout << "   Putting copy of Leading photon with pt " << oldpp1->pt() << " in at place " << usedPhotonPtrs.size() << std::endl; }
+                pp1 = edm::refToPtr( edm::Ref<vector<Photon> >( rPhoton, photonColl->size() ) );
+                if( debug_ ) { std::cout << "   Putting copy of Leading photon with pt " << oldpp1->pt() << " in at place " << photonColl->size() << std::endl; }
 
                 reco::PhotonCore p1c( *( p1.photonCore() ) );
-                p1c.setSuperCluster( edm::Ref<vector<reco::SuperCluster> >( rSuperCluster, usedPhotonPtrs.size() ) );
-                p1.setPhotonCore( edm::Ref<vector<reco::PhotonCore> >( rPhotonCore, usedPhotonPtrs.size() ) );
+                p1c.setSuperCluster( edm::Ref<vector<reco::SuperCluster> >( rSuperCluster, photonColl->size() ) );
+                p1.setPhotonCore( edm::Ref<vector<reco::PhotonCore> >( rPhotonCore, photonColl->size() ) );
 
+                // photons, photon cores and their super clusters all share the same places
+                usedPhotons.insert( oldpp1.id(), oldpp1.key(), photonColl->size(), true );
+                usedSuperClusters.insert( oldpp1->superCluster().id(), oldpp1->superCluster().key(), scColl->size(), false );
                 scColl->push_back( *( oldpp1->superCluster() ) );
                 photonCoreColl->push_back( p1c );
                 photonColl->push_back( p1 );
-                usedPhotonPtrs.push_back( oldpp1 );
-                usedSuperClusterRefs.push_back( oldpp1->superCluster() );
             }
             if( !donepp2 ) {
                 Photon p2( *oldpp2 ); // copy Photon
                 p2.removeVerticesExcept( usedVertices );
-                pp2 = edm::refToPtr( edm::Ref<vector<Photon> >( rPhoton, usedPhotonPtrs.size() ) );
-                if( debug_ ) { std::cout << "   Putting copy of Subleading photon with pt " << oldpp2->pt() << " in at place " << usedPhotonPtrs.size() << std::endl; }
+                pp2 = edm::refToPtr( edm::Ref<vector<Photon> >( rPhoton, photonColl->size() ) );
+                if( debug_ ) { std::cout << "   Putting copy of Subleading photon with pt " << oldpp2->pt() << " in at place " << photonColl->size() << std::endl; }
 
                 reco::PhotonCore p2c( *( p2.photonCore() ) );
-                p2c.setSuperCluster( edm::Ref<vector<reco::SuperCluster> >( rSuperCluster, usedPhotonPtrs.size() ) );
-                p2.setPhotonCore( edm::Ref<vector<reco::PhotonCore> >( rPhotonCore, usedPhotonPtrs.size() ) );
+                p2c.setSuperCluster( edm::Ref<vector<reco::SuperCluster> >( rSuperCluster, photonColl->size() ) );
+                p2.setPhotonCore( edm::Ref<vector<reco::PhotonCore> >( rPhotonCore, photonColl->size() ) );
 
+                // photons, photon cores and their super clusters all share the same places
+                usedPhotons.insert( oldpp2.id(), oldpp2.key(), photonColl->size(), true );
+                usedSuperClusters.insert( oldpp2->superCluster().id(), oldpp2->superCluster().key(), scColl->size(), false );
                 scColl->push_back( *( oldpp2->superCluster() ) );
                 photonCoreColl->push_back( p2c );
                 photonColl->push_back( p2 );
-                usedPhotonPtrs.push_back( oldpp2 );
-                usedSuperClusterRefs.push_back( oldpp2->superCluster() );
             }
 
             // Can't use ordinary DiPhoton constructor with Ptrs because pp1 and pp2 are pointing into a collection that's not saved yet
@@ -172,20 +210,15 @@ namespace flashgg {
         for( unsigned int i = 0 ; i < electrons->size() ; i++ ) {
             Electron ele( *electrons->ptrAt( i ) );
             reco::GsfElectronCore elec( *ele.core() );
-            bool done = false;
-            for( unsigned int j = 0 ; j < usedSuperClusterRefs.size() ; j++ ) {
-                if( elec.superCluster() == usedSuperClusterRefs[j] ) {
-                    done = true;
-                    elec.setSuperCluster( edm::Ref<vector<reco::SuperCluster> >( rSuperCluster, j ) );
-                    if( debug_ ) { std::cout << "  Electron " << i << " with pt " << ele.pt() << " already has its supercluster at place " << j << std::endl; }
-                    break;
-                }
-            }
-            if( !done ) {
-                if( debug_ ) { std::cout << "  Electron " << i << " with pt " << ele.pt() << " has no supercluster yet, storing it at place " << usedSuperClusterRefs.size() << std::endl; }
-                elec.setSuperCluster( edm::Ref<vector<reco::SuperCluster> >( rSuperCluster, usedSuperClusterRefs.size() ) );
+            int j = usedSuperClusters.find( elec.superCluster().id(), elec.superCluster().key() );
+            if( j >= 0 ) {
+                elec.setSuperCluster( edm::Ref<vector<reco::SuperCluster> >( rSuperCluster, j ) );
+                if( debug_ ) { std::cout << "  Electron " << i << " with pt " << ele.pt() << " already has its supercluster at place " << j << std::endl; }
+            } else {
+                if( debug_ ) { std::cout << "  Electron " << i << " with pt " << ele.pt() << " has no supercluster yet, storing it at place " << scColl->size() << std::endl; }
+                elec.setSuperCluster( edm::Ref<vector<reco::SuperCluster> >( rSuperCluster, scColl->size() ) );
+                usedSuperClusters.insert( ele.superCluster().id(), ele.superCluster().key(), scColl->size(), false ); // ref to old sc from old core
                 scColl->push_back( *ele.superCluster() ); // copy old sc from old core
-                usedSuperClusterRefs.push_back( ele.superCluster() ); // ref to old sc from old core
             }
             ele.setCore( edm::Ref<vector<reco::GsfElectronCore> >( rElectronCore, i ) );
             electronCoreColl->push_back( elec );
@@ -19,6 +19,7 @@
 #include "TrackingTools/Records/interface/TransientTrackRecord.h"
 #include "TrackingTools/IPTools/interface/IPTools.h"
 #include "RecoEgamma/EgammaTools/interface/EffectiveAreas.h"
+#include "flashgg/MicroAOD/interface/MiniIsolation.h"
 
 using namespace std;
 using namespace edm;
@@ -68,6 +69,8 @@ namespace flashgg {
         double elecEEminiso_deadcone_ph_ = 0.08;
         double elecEEminiso_deadcone_nh_ = 0.0;
         double elecminiso_ptThresh_ = 0.0;
+
+        MiniIsolation miniIsolation_;
     };
 
     ElectronProducer::ElectronProducer( const ParameterSet &iConfig ):
@@ -89,7 +92,8 @@ namespace flashgg {
         eleMediumIdMapToken_(consumes<edm::ValueMap<bool> >(iConfig.getParameter<edm::InputTag>("eleMediumIdMap"))),
         eleTightIdMapToken_(consumes<edm::ValueMap<bool> >(iConfig.getParameter<edm::InputTag>("eleTightIdMap"))),
         eleVetoIdMapToken_(consumes<edm::ValueMap<bool> >(iConfig.getParameter<edm::InputTag>("eleVetoIdMap"))),
-        pfcandidateToken_( consumes<View<pat::PackedCandidate> >( iConfig.getParameter<InputTag> ( "pfCandidatesTag" ) ) )
+        pfcandidateToken_( consumes<View<pat::PackedCandidate> >( iConfig.getParameter<InputTag> ( "pfCandidatesTag" ) ) ),
+        miniIsolation_( max( iConfig.getParameter<double>( "elecminiso_r_min" ), iConfig.getParameter<double>( "elecminiso_r_max" ) ) )
     {
         
 
@@ -166,7 +170,7 @@ namespace flashgg {
 
         Handle<View<pat::PackedCandidate> > pfcandidates;
         evt.getByToken( pfcandidateToken_, pfcandidates );
-        const std::vector<edm::Ptr<pat::PackedCandidate> > &pfcands = pfcandidates->ptrs();
+        miniIsolation_.setCandidates( *pfcandidates );
 
         std::unique_ptr<vector<flashgg::Electron> > elecColl( new vector<flashgg::Electron> );
 
@@ -218,58 +222,17 @@ namespace flashgg {
 
             //MiniIsolation : https://twiki.cern.ch/twiki/bin/view/CMS/MiniIsolationSUSY
             float fggMiniIsoSumRel_ = 99999.;
-            double iso_nh_(0.); double iso_ch_(0.); 
-            double iso_ph_(0.); double iso_pu_(0.);
-            double elecminiso_deadcone_ch_ = elecEBminiso_deadcone_ch_;
-            double elecminiso_deadcone_pu_ = elecEBminiso_deadcone_pu_;
-            double elecminiso_deadcone_ph_ = elecEBminiso_deadcone_ph_;
-            double elecminiso_deadcone_nh_ = elecEBminiso_deadcone_nh_;
+            MiniIsolation::DeadCones deadCones = { elecEBminiso_deadcone_ch_, elecEBminiso_deadcone_pu_, elecEBminiso_deadcone_ph_, elecEBminiso_deadcone_nh_ };
             if(pelec_eta > 1.479){
-                elecminiso_deadcone_ch_ = elecEEminiso_deadcone_ch_;
-                elecminiso_deadcone_pu_ = elecEEminiso_deadcone_pu_;
-                elecminiso_deadcone_ph_ = elecEEminiso_deadcone_ph_;
-                elecminiso_deadcone_nh_ = elecEEminiso_deadcone_nh_;
+                deadCones = { elecEEminiso_deadcone_ch_, elecEEminiso_deadcone_pu_, elecEEminiso_deadcone_ph_, elecEEminiso_deadcone_nh_ };
             }
             double par_pt_ =  pelec->pt();
             if(par_pt_ > 5.){
-                double r_iso_ = max(elecminiso_r_min_,min(elecminiso_r_max_, elecminiso_kt_scale_/par_pt_ ));
-                for( unsigned int ipfc = 0 ; ipfc < pfcands.size() ; ipfc++ ) {
-                    Ptr<pat::PackedCandidate> pfc = pfcands[ ipfc ];
-                    if (abs(pfc->pdgId())<7) continue;
-                    
-                    double dr_ = reco::deltaR( *pfc, *pelec );
-                    //double dr_ = deltaR(pfc->eta(), pfc->phi(), pelec->eta(), pelec->phi() );
-                    if (dr_ > r_iso_) continue;
-                    
-                    //////////////////  NEUTRALS  /////////////////////////
-                    if (pfc->charge()==0){
-                        if (pfc->pt()>elecminiso_ptThresh_) {
-                            /////////// PHOTONS ////////////
-                            if (abs(pfc->pdgId())==22) {
-                                if(dr_ < elecminiso_deadcone_ph_) continue;
-                                iso_ph_ += pfc->pt();
-                                /////////// NEUTRAL HADRONS ////////////
-                            } else if (abs(pfc->pdgId())==130) {
-                                if(dr_ < elecminiso_deadcone_nh_) continue;
-                                iso_nh_ += pfc->pt();
-                            }
-                        }
-                        //////////////////  CHARGED from PV  /////////////////////////
-                    } else if (pfc->fromPV()>1){
-                        if (abs(pfc->pdgId())==211) {
-                            if(dr_ < elecminiso_deadcone_ch_) continue;
-                            iso_ch_ += pfc->pt();
-                        }
-                        //////////////////  CHARGED from PU  /////////////////////////
-                    } else {
-                        if (pfc->pt()>elecminiso_ptThresh_){
-                            if(dr_ < elecminiso_deadcone_pu_) continue;
-                            iso_pu_ += pfc->pt();
-                        }
-                    }
-                }// pfcand loop
-                //fggMiniIsoSumRel_ = ( iso_ch_ + max( 0., iso_nh_ + iso_ph_ - 0.5 * iso_pu_) ) / par_pt_ ;
-                fggMiniIsoSumRel_ = ( iso_ch_ + max( 0., iso_nh_ + iso_ph_ - Aeff*rho*(r_iso_/0.3)*(r_iso_/0.3) ) ) / par_pt_ ;
+                double r_iso_ = MiniIsolation::cone( par_pt_, elecminiso_r_min_, elecminiso_r_max_, elecminiso_kt_scale_ );
+                // no second photon sum for electrons
+                MiniIsolation::Sums iso = miniIsolation_.sums( pelec->eta(), pelec->phi(), r_iso_, deadCones, elecminiso_ptThresh_, elecminiso_ptThresh_ );
+                //fggMiniIsoSumRel_ = ( iso.ch + max( 0., iso.nh + iso.ph - 0.5 * iso.pu) ) / par_pt_ ;
+                fggMiniIsoSumRel_ = ( iso.ch + max( 0., iso.nh + iso.ph - Aeff*rho*(r_iso_/0.3)*(r_iso_/0.3) ) ) / par_pt_ ;
             }
             felec.setFggMiniIsoSumRel( fggMiniIsoSumRel_ );
 
@@ -10,6 +10,7 @@
 #include "flashgg/DataFormats/interface/GenDiPhoton.h"
 
 #include "flashgg/DataFormats/interface/GenPhotonExtra.h"
+#include "flashgg/MicroAOD/interface/EtaPhiBucketMatcher.h"
 
 #include "TMVA/Reader.h"
 #include "TMath.h"
@@ -33,13 +34,16 @@ namespace flashgg {
         EDGetTokenT<View<reco::GenJet> > genJetToken_;
         
         bool overlapRemoval_;
+        EtaPhiBucketMatcher jetCells_;
+        std::vector<unsigned int> neighbours_;
 
     };
 
     GenDiPhotonDiJetProducer::GenDiPhotonDiJetProducer( const ParameterSet &iConfig ) :
         genPhotonToken_( consumes<View<flashgg::GenPhotonExtra> >( iConfig.getParameter<InputTag> ( "src" ) ) ),
         genJetToken_( consumes<View<reco::GenJet> >( iConfig.getParameter<InputTag> ( "jets" ) ) ),
-        overlapRemoval_(false)
+        overlapRemoval_(false),
+        jetCells_( 1.01 * 0.3 ) // overlap cone, with a margin against rounding on its edge
     {
         if( iConfig.exists("overlapRemoval") ) { 
             overlapRemoval_ = iConfig.getParameter<bool>("overlapRemoval");
@@ -56,17 +60,31 @@ namespace flashgg {
         evt.getByToken( genJetToken_, jets );
 
         std::unique_ptr<vector<GenDiPhoton> > diphotons( new vector<GenDiPhoton> );
+
+        // jets overlapping with each photon, found once per photon from the jets in the cells around it
+        std::vector<std::vector<bool> > overlaps( photons->size(), std::vector<bool>( jets->size(), false ) );
+        if( overlapRemoval_ ) {
+            jetCells_.clear();
+            for( const auto &jet : *jets ) { jetCells_.add( jet.eta(), jet.phi() ); }
+            jetCells_.build();
+            for( size_t ii = 0 ; ii < photons->size() ; ++ii ) {
+                const auto &cand = photons->at( ii ).cand();
+                jetCells_.neighbours( cand.eta(), cand.phi(), neighbours_ );
+                for( unsigned int ij : neighbours_ ) {
+                    overlaps[ii][ij] = !( reco::deltaR( jetCells_.eta( ij ), jetCells_.phi( ij ), cand.eta(), cand.phi() ) > 0.3 );
+                }
+            }
+        }
+
         for( size_t ii = 0 ; ii < photons->size() ; ++ii ) {
             auto pi = photons->ptrAt( ii );
             for( size_t jj = ii + 1 ; jj < photons->size() ; ++jj ) {
                 auto pj = photons->ptrAt( jj );
+                // the first two jets, in collection order, not overlapping with either photon
                 std::vector<edm::Ptr<reco::GenJet> > seljets;
-                for( size_t ij = 0 ; ij < jets->size() ; ++ij ) {
-                    auto jet = jets->ptrAt( ij );
-                    if( ! overlapRemoval_ || 
-                        ( reco::deltaR(*jet,pi->cand()) > 0.3 
-                          && reco::deltaR(*jet,pj->cand()) > 0.3 ) ) {
-                        seljets.push_back(jet);
+                for( size_t ij = 0 ; ij < jets->size() && seljets.size() < 2 ; ++ij ) {
+                    if( ! overlaps[ii][ij] && ! overlaps[jj][ij] ) {
+                        seljets.push_back( jets->ptrAt( ij ) );
                     }
                 }
                 if( seljets.size() >= 2 ) { 
@@ -28,6 +28,7 @@ namespace flashgg {
         double isoConeSize_, epsilon0_, n0_;
         std::vector<int> promptMothers_;
         flashgg::GenPhotonExtra::match_type defaultType_;
+        EtaPhiBucketMatcher genParticleCells_;
     };
 
 
@@ -37,7 +38,8 @@ namespace flashgg {
         isoConeSize_( iConfig.getParameter<double>( "isoConeSize" ) ),
         epsilon0_( iConfig.getParameter<double>( "epsilon0" ) ),
         n0_( iConfig.getParameter<double>( "n0" ) ),
-        defaultType_( flashgg::Photon::kUnkown )
+        defaultType_( flashgg::Photon::kUnkown ),
+        genParticleCells_( 1.01 * isoConeSize_ ) // margin against rounding on the edge of the cone
     {
         if( iConfig.exists( "promptMothers" ) ) {
             promptMothers_ = iConfig.getParameter<std::vector<int> >( "promptMothers" );
@@ -57,12 +59,17 @@ namespace flashgg {
 
         unique_ptr<vector<flashgg::GenPhotonExtra> > extraColl( new vector<flashgg::GenPhotonExtra> );
 
+        genParticleCells_.clear();
+        for( const auto &part : *genParticles ) { genParticleCells_.add( part.eta(), part.phi() ); }
+        genParticleCells_.build();
+
         auto genPhotonPointers = genPhotons->ptrs();
         for( auto &genPho : genPhotonPointers ) {
             flashgg::GenPhotonExtra extra( genPho );
             extra.setType( PhotonMCUtils::determineMatchType( *genPho, promptMothers_, defaultType_ ) );
-            extra.setGenIso( PhotonMCUtils::isoSum( *genPho, *genParticles, isoConeSize_ ) );
-            extra.setFrixioneIso( PhotonMCUtils::frixioneIso( *genPho, *genParticles, isoConeSize_, epsilon0_, n0_ ) );
+            auto iso = PhotonMCUtils::isolation( *genPho, *genParticles, genParticleCells_, isoConeSize_, isoConeSize_, epsilon0_, n0_ );
+            extra.setGenIso( iso.isoSum );
+            extra.setFrixioneIso( iso.frixioneIso );
             extraColl->push_back( extra );
         }
 
@@ -14,6 +14,10 @@
 #include "flashgg/DataFormats/interface/VertexCandidateMap.h"
 #include "FWCore/Utilities/interface/EDMException.h"
 #include "DataFormats/Math/interface/deltaR.h"
+#include "flashgg/MicroAOD/interface/EtaPhiBucketMatcher.h"
+#include "flashgg/MicroAOD/interface/JetConstituentFeatures.h"
+
+#include <algorithm>
 
 
 using namespace std;
@@ -29,6 +33,16 @@ namespace flashgg {
         ~JetProducer();
     private:
         void produce( Event &, const EventSetup & ) override;
+
+        // "mini_" + name for the userFloats, userInts and bDiscriminators copied from the MINIAOD jets,
+        // rebuilt only when the list of names changes, i.e. in practice once per job
+        struct MiniKeyTable {
+            std::vector<std::string> names;
+            std::vector<std::string> keys;
+        };
+        const std::vector<std::string> &miniKeys( MiniKeyTable &table, const std::vector<std::string> &names ) const;
+        const std::vector<std::string> &miniKeys( MiniKeyTable &table, const std::vector<std::pair<std::string, float> > &discris ) const;
+
         EDGetTokenT<View<pat::Jet> > jetToken_;
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
         EDGetTokenT<reco::VertexCollection >  vertexToken_;
@@ -47,8 +61,14 @@ namespace flashgg {
         bool debug_;
         unsigned pudebug_matched_badrms_, pudebug_matched_;
         bool doPuJetID_;
+        bool storePuJetId_;
         float minPtForEneSum_, maxEtaForEneSum_;
         unsigned int nJetsForEneSum_;
+        EtaPhiBucketMatcher miniaodJetMatcher_;
+        std::vector<unsigned int> miniaodMatches_;
+        MiniKeyTable miniFloatKeys_, miniIntKeys_, miniDiscriKeys_;
+        JetConstituentFeatures constituentFeatures_;
+        std::vector<PileupJetIdentifier> puJetIds_; // PU jet ID variables and MVA of every jet of the collection, for its vertex
     };
 
 
@@ -66,9 +86,13 @@ namespace flashgg {
         miniaodJetToken_( consumes<View<pat::Jet> >( iConfig.getParameter<InputTag> ( "MiniAodJetTag" ) ) ),
         debug_( iConfig.getUntrackedParameter<bool>( "Debug",false ) ),
         doPuJetID_( iConfig.getParameter<bool>( "DoPuJetID") ),
+        storePuJetId_( iConfig.exists( "StorePuJetId" ) ? iConfig.getParameter<bool>( "StorePuJetId" ) : false ),
         minPtForEneSum_( iConfig.getParameter<double>("MinPtForEneSum") ),
         maxEtaForEneSum_( iConfig.getParameter<double>("MaxEtaForEneSum") ),
-        nJetsForEneSum_( iConfig.getParameter<unsigned int>("NJetsForEneSum") )
+        nJetsForEneSum_( iConfig.getParameter<unsigned int>("NJetsForEneSum") ),
+        miniaodJetMatcher_( 1.01 * 0.1 ), // matching cone, with a margin against rounding on its edge
+        constituentFeatures_( iConfig.exists( "ConeBoundaries" ) ? iConfig.getParameter<std::vector<double> >( "ConeBoundaries" )
+                              : std::vector<double>( { 0.05, 0.1, 0.2, 0.3, 0.4 } ) )
         //        usePuppi( iConfig.getUntrackedParameter<bool>( "UsePuppi", false ) )
     {
         auto pileupJetIdParameters = iConfig.getParameter<ParameterSet>( "PileupJetIdParameters" );
@@ -89,6 +113,31 @@ namespace flashgg {
         }
     }
     
+    const std::vector<std::string> &JetProducer::miniKeys( MiniKeyTable &table, const std::vector<std::string> &names ) const
+    {
+        if( names != table.names ) {
+            table.names = names;
+            table.keys.clear();
+            for( auto &name : names ) { table.keys.push_back( string( "mini_" ) + name ); }
+        }
+        return table.keys;
+    }
+
+    const std::vector<std::string> &JetProducer::miniKeys( MiniKeyTable &table, const std::vector<std::pair<std::string, float> > &discris ) const
+    {
+        bool same = ( discris.size() == table.names.size() );
+        for( unsigned int k = 0 ; same && k < discris.size() ; k++ ) { same = ( discris[k].first == table.names[k] ); }
+        if( !same ) {
+            table.names.clear();
+            table.keys.clear();
+            for( auto &discri : discris ) {
+                table.names.push_back( discri.first );
+                table.keys.push_back( string( "mini_" ) + discri.first );
+            }
+        }
+        return table.keys;
+    }
+
     void JetProducer::produce( Event &evt, const EventSetup & )
     {
         
@@ -139,6 +188,39 @@ namespace flashgg {
             }
         }
         
+        // the PU jet ID of the whole collection is computed w.r.t. one vertex: the PV for the 0th collection,
+        // otherwise the vertex of the first diphoton using this collection, if any
+        Ptr<reco::Vertex> puJetIdVertex;
+        if ( doPuJetID_ ) {
+            if ( jetCollectionIndex_ == 0 ) {
+                puJetIdVertex = Ptr<reco::Vertex>( primaryVertices, 0 );
+            } else {
+                for( unsigned int j = 0 ; j < diPhotons->size() ; j++ ) {
+                    if ( diPhotons->ptrAt( j )->jetCollectionIndex() == jetCollectionIndex_ ) {
+                        puJetIdVertex = diPhotons->ptrAt( j )->vtx();
+                        break;
+                    }
+                }
+            }
+        }
+
+        // PU jet ID of every jet of the collection, computed in one pass: variables once per jet and vertex
+        puJetIds_.clear();
+        if ( puJetIdVertex.isNonnull() ) {
+            puJetIds_.reserve( jets->size() );
+            for( unsigned int i = 0 ; i < jets->size() ; i++ ) {
+                puJetIds_.push_back( pileupJetIdAlgo_->computeIdVariables( &jets->at( i ), 0., puJetIdVertex.get(), vertexes, rho ) );
+            }
+        }
+
+        if (jetCollectionIndex_ == 0) {
+            miniaodJetMatcher_.clear();
+            for( unsigned int j = 0 ; j < miniaodJets->size() ; j++ ) {
+                miniaodJetMatcher_.add( miniaodJets->at( j ).eta(), miniaodJets->at( j ).phi() );
+            }
+            miniaodJetMatcher_.build();
+        }
+
         for( unsigned int i = 0 ; i < jets->size() ; i++ ) {
 
             Ptr<pat::Jet> pjet = jets->ptrAt( i );
@@ -151,29 +233,33 @@ namespace flashgg {
 
             // Copy over userFloats, userInts, and bDiscriminators from MINIAOD jet collection to 0th vertex
             if (jetCollectionIndex_ == 0) {
-                bool matched = false;
-                for( unsigned int j = 0 ; j < miniaodJets->size() ; j++ ) {
-                    if (reco::deltaR(miniaodJets->ptrAt(j)->eta(),miniaodJets->ptrAt(j)->phi(),fjet.eta(),fjet.phi()) < 0.1) {
-                        matched = true;
-                        if (debug_) {
-                            std::cout << " Matched 0th vertex jet " << i << " (ptRaw=" << fjet.correctedP4("Uncorrected").pt() <<  ")  to MINIAOD jet " << j 
-                                      << " (ptRaw=" << miniaodJets->ptrAt(j)->correctedP4("Uncorrected").pt() <<  ")" << std::endl;
-                        }
-                        for (auto x = miniaodJets->ptrAt(j)->userFloatNames().begin() ; x != miniaodJets->ptrAt(j)->userFloatNames().end() ; x++) {
-                            //                            std::cout << "    UserFloat " << *x << " has value " << miniaodJets->ptrAt(j)->userFloat(*x) << std::endl;
-                            fjet.addUserFloat(string("mini_")+(*x),miniaodJets->ptrAt(j)->userFloat(*x));
-                        }
-                        for (auto x = miniaodJets->ptrAt(j)->userIntNames().begin() ; x != miniaodJets->ptrAt(j)->userIntNames().end() ; x++) {
-                            //                            std::cout << "    UserInt " << *x << " has value " << miniaodJets->ptrAt(j)->userInt(*x) << std::endl;
-                            fjet.addUserInt(string("mini_")+(*x),miniaodJets->ptrAt(j)->userInt(*x));
-                        }
-                        for (auto x = miniaodJets->ptrAt(j)->getPairDiscri().begin() ; x != miniaodJets->ptrAt(j)->getPairDiscri().end() ; x++) {
-                            //                            std::cout << "    bDiscriminator " << x->first << " has value " << x->second << std::endl;
-                            fjet.addBDiscriminatorPair(std::make_pair(string("mini_")+(x->first),x->second));
-                        }
+                miniaodJetMatcher_.neighbours( fjet.eta(), fjet.phi(), miniaodMatches_ );
+                miniaodMatches_.erase( std::remove_if( miniaodMatches_.begin(), miniaodMatches_.end(), [&]( unsigned int j ) {
+                            return !( reco::deltaR( miniaodJetMatcher_.eta( j ), miniaodJetMatcher_.phi( j ), fjet.eta(), fjet.phi() ) < 0.1 );
+                        } ), miniaodMatches_.end() );
+                for( unsigned int j : miniaodMatches_ ) {
+                    const pat::Jet &miniaodJet = miniaodJets->at( j );
+                    if (debug_) {
+                        std::cout << " Matched 0th vertex jet " << i << " (ptRaw=" << fjet.correctedP4("Uncorrected").pt() <<  ")  to MINIAOD jet " << j 
+                                  << " (ptRaw=" << miniaodJet.correctedP4("Uncorrected").pt() <<  ")" << std::endl;
+                    }
+                    const std::vector<std::string> &floatNames = miniaodJet.userFloatNames();
+                    const std::vector<std::string> &floatKeys = miniKeys( miniFloatKeys_, floatNames );
+                    for (unsigned int k = 0 ; k < floatNames.size() ; k++) {
+                        fjet.addUserFloat(floatKeys[k],miniaodJet.userFloat(floatNames[k]));
+                    }
+                    const std::vector<std::string> &intNames = miniaodJet.userIntNames();
+                    const std::vector<std::string> &intKeys = miniKeys( miniIntKeys_, intNames );
+                    for (unsigned int k = 0 ; k < intNames.size() ; k++) {
+                        fjet.addUserInt(intKeys[k],miniaodJet.userInt(intNames[k]));
+                    }
+                    const std::vector<std::pair<std::string, float> > &discris = miniaodJet.getPairDiscri();
+                    const std::vector<std::string> &discriKeys = miniKeys( miniDiscriKeys_, discris );
+                    for (unsigned int k = 0 ; k < discris.size() ; k++) {
+                        fjet.addBDiscriminatorPair(std::make_pair(discriKeys[k],discris[k].second));
                     }
                 }
-                if (!matched) {
+                if (miniaodMatches_.empty()) {
                     std::cout << " NO MATCH for 0th vertex jet " << i << " ptRaw,eta is " << fjet.correctedP4("Uncorrected").pt() << " " << fjet.eta() << std::endl;
                 }
             }
@@ -192,26 +278,34 @@ namespace flashgg {
             }
 
 
+            // constituents are read once for the QG, simple RMS, soft lepton and energy ring variables
+            if (computeSimpleRMS || computeRegVars) {
+                if ( !constituentFeatures_.fill( *pjet ) ) {
+                    throw cms::Exception( "NoPackedConstituent" ) << " For jet " << i << " failed to get a packed constituent" << std::endl;
+                }
+            }
+
             //store btagging userfloats
             if (computeRegVars) {
                 if (debug_) { std::cout << " start of computeRegVars" << std::endl; }
 
-                int nSecVertices = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->nVertices();
+                const reco::CandSecondaryVertexTagInfo *svTagInfo = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex");
+                int nSecVertices = svTagInfo->nVertices();
                 float vtxMass = 0, vtxPx = 0, vtxPy = 0, vtxPz = 0, vtx3DVal = 0, vtx3DSig = 0, vtxPosX = 0, vtxPosY = 0, vtxPosZ = 0;
                 int vtxNTracks = 0;
                 //float ptD=0.;
 
                 if(nSecVertices > 0){
-                    vtxNTracks = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->secondaryVertex(0).numberOfSourceCandidatePtrs();
-                    vtxMass = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->secondaryVertex(0).p4().mass();
-                    vtxPx = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->secondaryVertex(0).p4().px();
-                    vtxPy = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->secondaryVertex(0).p4().py();
-                    vtxPz = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->secondaryVertex(0).p4().pz();
-                    vtxPosX = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->secondaryVertex(0).vertex().x();
-                    vtxPosY = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->secondaryVertex(0).vertex().y();
-                    vtxPosZ = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->secondaryVertex(0).vertex().z();
-                    vtx3DVal = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->flightDistance(0).value();
-                    vtx3DSig = pjet->tagInfoCandSecondaryVertex("pfSecondaryVertex")->flightDistance(0).significance();
+                    vtxNTracks = svTagInfo->secondaryVertex(0).numberOfSourceCandidatePtrs();
+                    vtxMass = svTagInfo->secondaryVertex(0).p4().mass();
+                    vtxPx = svTagInfo->secondaryVertex(0).p4().px();
+                    vtxPy = svTagInfo->secondaryVertex(0).p4().py();
+                    vtxPz = svTagInfo->secondaryVertex(0).p4().pz();
+                    vtxPosX = svTagInfo->secondaryVertex(0).vertex().x();
+                    vtxPosY = svTagInfo->secondaryVertex(0).vertex().y();
+                    vtxPosZ = svTagInfo->secondaryVertex(0).vertex().z();
+                    vtx3DVal = svTagInfo->flightDistance(0).value();
+                    vtx3DSig = svTagInfo->flightDistance(0).significance();
                 }
 
                 
@@ -229,56 +323,10 @@ namespace flashgg {
                 fjet.addUserFloat("vtx3DVal", vtx3DVal);
                 fjet.addUserFloat("vtx3DSig", vtx3DSig);
 
-                float ptD(0.0), totalMult(0.0), axis1(0.0), axis2(0.0);
-                float sum_dEta(0.0), sum_dPhi(0.0), sum_dEta2(0.0), sum_dPhi2(0.0), sum_dEta_dPhi(0.0), sum_weight(0.0), sum_pt(0.0);
-
-                for(const auto & d : pjet->getJetConstituentsQuick()){
-                    if (d->charge()) { // charged particles
-                        auto p = dynamic_cast<const pat::PackedCandidate*>(d);
-                        if (!p) std::cout << "ERROR: QGTagging variables cannot be computed for these jets!" << std::endl;
-                        if (!(p->fromPV() > 1 && p->trackHighPurity())) continue;
-                        ++totalMult;
-                    }   else { // neutral particles
-                        if (d->pt() < 1.0) continue;
-                        ++totalMult;
-                    } // charged, neutral particles
-
-                    float dEta   = d->eta() - pjet->eta();
-                    float dPhi   = reco::deltaPhi(d->phi(), pjet->phi());
-                    float pT = d->pt();
-                    float weight = pT*pT;
-
-                    sum_dEta      += dEta      * weight;
-                    sum_dPhi      += dPhi      * weight;
-                    sum_dEta2     += dEta*dEta * weight;
-                    sum_dEta_dPhi += dEta*dPhi * weight;
-                    sum_dPhi2     += dPhi*dPhi * weight;
-                    sum_weight     += pT*pT; //(d->pt())*(d->pt());
-                    sum_pt         += pT; //d->pt();
-
-                }
-
-                // calculate axis2 and ptD
-                if (sum_weight > 0) {
-                    ptD = sqrt(sum_weight)/sum_pt;
-                    float ave_dEta  = sum_dEta  / sum_weight;
-                    float ave_dPhi  = sum_dPhi  / sum_weight;
-                    float ave_dEta2 = sum_dEta2 / sum_weight;
-                    float ave_dPhi2 = sum_dPhi2 / sum_weight;
-                    float a = ave_dEta2 - ave_dEta*ave_dEta;
-                    float b = ave_dPhi2 - ave_dPhi*ave_dPhi;
-                    float c = -(sum_dEta_dPhi/sum_weight - ave_dEta*ave_dPhi);
-                    float delta = sqrt(fabs( (a-b)*(a-b) + 4*c*c ));
-                    if(a+b-delta > 0) axis2 = sqrt(0.5*(a+b-delta));
-                    else              axis2 = 0.0;
-                    if(a+b+delta > 0) axis1 = sqrt(0.5*(a+b+delta));
-                    else              axis1 = 0.0;
-                }
-                
-                fjet.addUserFloat("ptD", ptD);                    
-                fjet.addUserFloat("totalMult", totalMult);                    
-                fjet.addUserFloat("axis1", axis1);                    
-                fjet.addUserFloat("axis2", axis2);                    
+                fjet.addUserFloat("ptD", constituentFeatures_.ptD());
+                fjet.addUserFloat("totalMult", constituentFeatures_.totalMult());
+                fjet.addUserFloat("axis1", constituentFeatures_.axis1());
+                fjet.addUserFloat("axis2", constituentFeatures_.axis2());
 
                 if (debug_) { std::cout << " end of computeRegVars" << std::endl; }
 
@@ -288,99 +336,29 @@ namespace flashgg {
 
                 if (debug_) { std::cout << " start of computeSimpleRMS || computeRegVars" << std::endl; }
 
-                float leadTrackPt_ = 0, softLepPt = 0, softLepRatio = 0, softLepDr = 0;
-                float sumPtDrSq = 0.;
-                float sumPtSq = 0.;
-                float softLepPtRel = 0.;
-                float softLepPtRelInv=0.;
-
-                float cone_boundaries[] = { 0.05, 0.1, 0.2, 0.3, 0.4 }; // hardcoded boundaries: should be made configurable
-                size_t ncone_boundaries = sizeof(cone_boundaries)/sizeof(float);
-                std::vector<float> chEnergies(ncone_boundaries+1,0.);
-                std::vector<float> emEnergies(ncone_boundaries+1,0.); 
-                std::vector<float> neEnergies(ncone_boundaries+1,0.); 
-                std::vector<float> muEnergies(ncone_boundaries+1,0.);
-                int numDaug03 = 0;
-
-                int softLepPdgId=0;
-
-
-                for ( unsigned k = 0; k < fjet.numberOfSourceCandidatePtrs(); ++k ) {
-                    reco::CandidatePtr pfJetConstituent = fjet.sourceCandidatePtr(k);
-                    
-                    const reco::Candidate* kcand = pfJetConstituent.get();
-                    const pat::PackedCandidate* lPack = dynamic_cast<const pat::PackedCandidate *>( kcand );
-                    if ( !lPack ) throw cms::Exception( "NoPackedConstituent" ) << " For jet " << i << " failed to get constituent " << k << std::endl;
-                    float candPt = kcand->pt();
-                    float candDr   = reco::deltaR(*kcand,fjet);
-                    sumPtDrSq += candPt*candPt*candDr*candDr;
-                    sumPtSq += candPt*candPt;
-
-                    if( candPt > 0.3 ) { ++numDaug03; }
-                    if(lPack->charge() != 0 && candPt > leadTrackPt_) leadTrackPt_ = candPt;
-
-                    if(abs(lPack->pdgId()) == 11 || abs(lPack->pdgId()) == 13) {
-                        if(candPt > softLepPt){
-                            softLepPt = candPt;
-                            softLepRatio = candPt/pjet->pt();
-                            softLepDr = candDr;
-                            softLepPtRel = ( pjet->px()*lPack->px() + pjet->py()*lPack->py() + pjet->pz()*lPack->pz() ) / pjet->p();
-                            softLepPtRel = sqrt( lPack->p()*lPack->p() - softLepPtRel*softLepPtRel );
-
-                            softLepPtRelInv = ( pjet->px()*lPack->px() + pjet->py()*lPack->py() + pjet->pz()*lPack->pz() ) / lPack->p();
-                            softLepPtRelInv = sqrt( pjet->p()*pjet->p() - softLepPtRelInv*softLepPtRelInv );
-
-                            softLepPdgId = lPack->pdgId();
-                        }
-                    }
-                    
-                    int pdgid = abs(lPack->pdgId());
-                    size_t icone = std::lower_bound(&cone_boundaries[0],&cone_boundaries[ncone_boundaries],candDr) - &cone_boundaries[0];
-                    float candEnergy = kcand->energy();
-                    // std::cout << "pdgId " << pdgid << " candDr " << candDr << " icone " << icone << " " << candEnergy << std::endl; 
-                    if( pdgid == 22 || pdgid == 11 ) {
-                        // std::cout << " fill EM" << std::endl;
-                        emEnergies[icone] += candEnergy;
-                    } else if ( pdgid == 13 ) { 
-                        // std::cout << " fill mu" << std::endl;
-                        muEnergies[icone] += candEnergy;
-                    } else if ( lPack-> charge() != 0 ) {
-                        // std::cout << " fill ch" << std::endl;
-                        chEnergies[icone] += candEnergy;
-                    } else {
-                        // std::cout << " fill ne" << std::endl;
-                        neEnergies[icone] += candEnergy;
-                    }
-                }
-                
-                
                 if (debug_) { std::cout << " before set in  computeSimpleRMS || computeRegVars" << std::endl; }
                 
                 if (computeSimpleRMS) {
-                    if (sumPtSq == 0.) throw cms::Exception( "NoConstituents" ) << " For jet " << i << " we get sumPtSq of 0!" << std::endl;
-                    fjet.setSimpleRMS( sumPtDrSq / sumPtSq );
+                    if (constituentFeatures_.sumPtSq() == 0.) throw cms::Exception( "NoConstituents" ) << " For jet " << i << " we get sumPtSq of 0!" << std::endl;
+                    fjet.setSimpleRMS( constituentFeatures_.sumPtDrSq() / constituentFeatures_.sumPtSq() );
                 }
 
                 if (computeRegVars) {
-                    fjet.addUserFloat("leadTrackPt", leadTrackPt_);
-                    fjet.addUserFloat("softLepPt", softLepPt);
-                    fjet.addUserFloat("softLepRatio", softLepRatio);
-                    fjet.addUserFloat("softLepDr", softLepDr);
-                    fjet.addUserFloat("softLepPtRel", softLepPtRel); 
-                    fjet.addUserFloat("softLepPtRelInv", softLepPtRelInv); 
-                    fjet.addUserInt("softLepPdgId", softLepPdgId); 
-                    fjet.addUserInt("numDaug03", numDaug03);
-
-                    //                    for(size_t icone = 0; icone < ncone_boundaries+1; ++icone) {
-                    //                         std::cout << "icone " << icone << " " << emEnergies[icone] << " " << muEnergies[icone] << " " << chEnergies[icone] << " " << neEnergies[icone] << std::endl;
-                    //                    }
-                    
+                    fjet.addUserFloat("leadTrackPt", constituentFeatures_.leadTrackPt());
+                    fjet.addUserFloat("softLepPt", constituentFeatures_.softLepPt());
+                    fjet.addUserFloat("softLepRatio", constituentFeatures_.softLepRatio());
+                    fjet.addUserFloat("softLepDr", constituentFeatures_.softLepDr());
+                    fjet.addUserFloat("softLepPtRel", constituentFeatures_.softLepPtRel());
+                    fjet.addUserFloat("softLepPtRelInv", constituentFeatures_.softLepPtRelInv());
+                    fjet.addUserInt("softLepPdgId", constituentFeatures_.softLepPdgId());
+                    fjet.addUserInt("numDaug03", constituentFeatures_.numDaug03());
+
                     if( fjet.pt() > minPtForEneSum_ && abs(fjet.eta()) < maxEtaForEneSum_ && ( nJetsForEneSum_ == 0 || i <= nJetsForEneSum_ ) ) {
                         /// std::cout << "saving cones " << std::endl;
-                        fjet.setChEnergies(chEnergies);
-                        fjet.setEmEnergies(emEnergies);
-                        fjet.setNeEnergies(neEnergies);
-                        fjet.setMuEnergies(muEnergies);
+                        fjet.setChEnergies(constituentFeatures_.ringEnergies(JetConstituentFeatures::kCharged));
+                        fjet.setEmEnergies(constituentFeatures_.ringEnergies(JetConstituentFeatures::kEM));
+                        fjet.setNeEnergies(constituentFeatures_.ringEnergies(JetConstituentFeatures::kNeutral));
+                        fjet.setMuEnergies(constituentFeatures_.ringEnergies(JetConstituentFeatures::kMuon));
                     }
                 }
 
@@ -403,10 +381,7 @@ namespace flashgg {
 
             if ( doPuJetID_ ) {
                 if ( jetCollectionIndex_ == 0 && doPuJetID_ ) {
-                    if (debug_) std::cout << "before computeIdVariables" << std::endl;
-                    PileupJetIdentifier lPUJetId = pileupJetIdAlgo_->computeIdVariables( pjet.get(), 0., &vertexes[0], vertexes, rho );
-                    if (debug_) std::cout << "after computeIdVariables" << std::endl;
-                    //                fjet.setPuJetId( primaryVertices->ptrAt( 0 ), lPUJetId );
+                    const PileupJetIdentifier &lPUJetId = puJetIds_[i];
                     if (debug_ && fjet.pt() > 20) {
                         std::cout << "[STANDARD] pt=" << fjet.pt() << " eta=" << fjet.eta() 
                                   << " lPUJetId RMS, betaStar, mva: " << lPUJetId.RMS() << " " << lPUJetId.betaStar() << " " << lPUJetId.mva() 
@@ -476,25 +451,20 @@ namespace flashgg {
                         }
                     }
                     fjet.setSimpleMVA( lPUJetId.mva() );
-                } else {
-                    for( unsigned int j = 0 ; j < diPhotons->size() ; j++ ) {
-                        Ptr<DiPhotonCandidate> diPhoton = diPhotons->ptrAt( j );
-                        if ( diPhoton->jetCollectionIndex() == jetCollectionIndex_ ) {
-                            Ptr<reco::Vertex> vtx = diPhoton->vtx();
-                            PileupJetIdentifier lPUJetId = pileupJetIdAlgo_->computeIdVariables( pjet.get(), 0., vtx.get(), vertexes, rho );
-                            if (debug_ && fjet.pt() > 20) {
-                                std::cout << "[NON-STANDARD] pt=" << fjet.pt() << " eta=" << fjet.eta()
-                                          << " lPUJetID RMS, betaStar, mva: " << lPUJetId.RMS() << " " << lPUJetId.betaStar() << " " << lPUJetId.mva()
-                                          << "; simpleRMS " << fjet.rms() << "; match=" << (bool)(fjet.genJet()) << std::endl;
-                                PileupJetIdentifier lPUJetId0 = pileupJetIdAlgo_->computeIdVariables( pjet.get(), 0., &vertexes[0], vertexes, rho );
-                                std::cout << "[NON-S W VTX0] pt=" << fjet.pt() << " eta=" << fjet.eta()
-                                      << " lPUJetID RMS, betaStar, mva: " << lPUJetId0.RMS() << " " << lPUJetId0.betaStar() << " " << lPUJetId0.mva()
-                                          << "; simpleRMS " << fjet.rms() << "; match=" << (bool)(fjet.genJet()) << std::endl;
-                            }
-                            fjet.setSimpleMVA( lPUJetId.mva() );
-                            break;
-                        }
+                    if ( storePuJetId_ ) { fjet.setPuJetId( puJetIdVertex, lPUJetId ); }
+                } else if ( puJetIdVertex.isNonnull() ) {
+                    const PileupJetIdentifier &lPUJetId = puJetIds_[i];
+                    if (debug_ && fjet.pt() > 20) {
+                        std::cout << "[NON-STANDARD] pt=" << fjet.pt() << " eta=" << fjet.eta()
+                                  << " lPUJetID RMS, betaStar, mva: " << lPUJetId.RMS() << " " << lPUJetId.betaStar() << " " << lPUJetId.mva()
+                                  << "; simpleRMS " << fjet.rms() << "; match=" << (bool)(fjet.genJet()) << std::endl;
+                        PileupJetIdentifier lPUJetId0 = pileupJetIdAlgo_->computeIdVariables( pjet.get(), 0., &vertexes[0], vertexes, rho );
+                        std::cout << "[NON-S W VTX0] pt=" << fjet.pt() << " eta=" << fjet.eta()
+                                  << " lPUJetID RMS, betaStar, mva: " << lPUJetId0.RMS() << " " << lPUJetId0.betaStar() << " " << lPUJetId0.mva()
+                                  << "; simpleRMS " << fjet.rms() << "; match=" << (bool)(fjet.genJet()) << std::endl;
                     }
+                    fjet.setSimpleMVA( lPUJetId.mva() );
+                    if ( storePuJetId_ ) { fjet.setPuJetId( puJetIdVertex, lPUJetId ); }
                 }
             } else {
                 fjet.setSimpleMVA ( -999. );
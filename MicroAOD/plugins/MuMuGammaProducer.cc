@@ -10,6 +10,9 @@
 #include "flashgg/DataFormats/interface/MuMuGammaCandidate.h"
 #include "flashgg/MicroAOD/interface/PhotonIdUtils.h"
 
+#include <cmath>
+#include <iostream>
+
 //-----------J. Tao from IHEP-Beijing--------------
 
 using namespace edm;
@@ -24,6 +27,12 @@ namespace flashgg {
         MuMuGammaProducer( const ParameterSet & );
     private:
         void produce( Event &, const EventSetup & ) override;
+        void endJob() override;
+
+        // preselection of the dimuon-photon pairs on the four-momenta alone, before the candidate is built
+        bool preselect( const reco::Candidate::LorentzVector &dimuon, double muLeadEta, double muLeadPhi, double muSubleadEta, double muSubleadPhi,
+                        const reco::Candidate::LorentzVector &photon ) const;
+
         EDGetTokenT<View<flashgg::DiMuonCandidate> > dimuToken_;
         EDGetTokenT<View<flashgg::Photon> > photonToken_;
         EDGetTokenT<View<reco::Vertex> > vertexToken_;
@@ -31,6 +40,11 @@ namespace flashgg {
         double minPhotonPT_;
         //double maxPhotonEta_;
 
+        // optional "preselection" PSet: mumugamma mass window, photon pt and range of the smaller dR(mu, gamma)
+        bool preselection_;
+        double preselMinMass_, preselMaxMass_, preselMinPhotonPT_, preselMinDeltaR_, preselMaxDeltaR_;
+        unsigned long nPairs_, nAccepted_, nPreselected_;
+
     };
 
     MuMuGammaProducer::MuMuGammaProducer( const ParameterSet &iConfig ) :
@@ -39,6 +53,20 @@ namespace flashgg {
         vertexToken_( consumes<View<reco::Vertex> >( iConfig.getParameter<InputTag> ( "VertexTag" ) ) )
     {
         minPhotonPT_ = iConfig.getParameter<double>( "minPhotonPT" );
+
+        preselection_ = iConfig.exists( "preselection" );
+        preselMinMass_ = preselMinPhotonPT_ = preselMinDeltaR_ = 0.;
+        preselMaxMass_ = preselMaxDeltaR_ = -1.; // < 0: no upper bound
+        if( preselection_ ) {
+            const ParameterSet &presel = iConfig.getParameter<ParameterSet>( "preselection" );
+            if( presel.exists( "minMass" ) ) { preselMinMass_ = presel.getParameter<double>( "minMass" ); }
+            if( presel.exists( "maxMass" ) ) { preselMaxMass_ = presel.getParameter<double>( "maxMass" ); }
+            if( presel.exists( "minPhotonPT" ) ) { preselMinPhotonPT_ = presel.getParameter<double>( "minPhotonPT" ); }
+            if( presel.exists( "minDeltaR" ) ) { preselMinDeltaR_ = presel.getParameter<double>( "minDeltaR" ); }
+            if( presel.exists( "maxDeltaR" ) ) { preselMaxDeltaR_ = presel.getParameter<double>( "maxDeltaR" ); }
+        }
+        nPairs_ = nAccepted_ = nPreselected_ = 0;
+
         produces<vector<flashgg::MuMuGammaCandidate> >();
     }
 
@@ -65,19 +93,36 @@ namespace flashgg {
         unique_ptr<vector<flashgg::MuMuGammaCandidate> > MuMuGammaColl( new vector<flashgg::MuMuGammaCandidate> );
         //    cout << "evt.id().event()= " << evt.id().event() << "\tevt.isRealData()= " << evt.isRealData() << "\tdimuonPointers.size()= " << dimuonPointers.size() << "\tpvPointers.size()= " << pvPointers.size() << endl;
 
+        // The vertex is the same for all the pairs: the photon 4-momenta are recomputed, and the photon acceptance
+        // applied, once per photon
+        std::vector<flashgg::Photon> correctedPhotons;
+        std::vector<bool> acceptedPhotons;
+        if( ! dimuonPointers.empty() ) {
+            correctedPhotons.reserve( photonPointers.size() );
+            for( unsigned int j = 0; j < photonPointers.size() ; j++ ) {
+                correctedPhotons.push_back( PhotonIdUtils::pho4MomCorrection( photonPointers[j], pvx ) );
+                const flashgg::Photon &photon_corr = correctedPhotons.back();
+                float PhotonSCEta = photon_corr.superCluster()->position().Eta();
+                float PhotonET =  photon_corr.pt();
+                acceptedPhotons.push_back( !( fabs( PhotonSCEta ) > 2.5 || ( fabs( PhotonSCEta ) > 1.4442 && fabs( PhotonSCEta ) < 1.566 ) )
+                                           && !( PhotonET < minPhotonPT_ ) );
+            }
+        }
+
         for( unsigned int i = 0 ; i < dimuonPointers.size() ; i++ ) {
             Ptr<flashgg::DiMuonCandidate> dimuon = dimuonPointers[i];
             //flashgg::DiMuonCandidate dimu = flashgg::DiMuonCandidate(*dimuon);
+            const reco::Candidate::LorentzVector &dimuonP4 = dimuon->p4();
+            double muLeadEta = dimuon->leadingMuon()->eta(), muLeadPhi = dimuon->leadingMuon()->phi();
+            double muSubleadEta = dimuon->subleadingMuon()->eta(), muSubleadPhi = dimuon->subleadingMuon()->phi();
             for( unsigned int j = 0; j < photonPointers.size() ; j++ ) {
-                Ptr<flashgg::Photon> photon = photonPointers[j];
-                // A number of things need to be done once the vertex is chosen
-                // recomputing photon 4-momenta accordingly
-                flashgg::Photon photon_corr = PhotonIdUtils::pho4MomCorrection( photon, pvx );
-
-                float PhotonSCEta = photon_corr.superCluster()->position().Eta();
-                if( fabs( PhotonSCEta ) > 2.5 || ( fabs( PhotonSCEta ) > 1.4442 && fabs( PhotonSCEta ) < 1.566 ) ) { continue; }
+                nPairs_++;
+                if( ! acceptedPhotons[j] ) { continue; }
+                nAccepted_++;
+                const flashgg::Photon &photon_corr = correctedPhotons[j];
+                if( preselection_ && ! preselect( dimuonP4, muLeadEta, muLeadPhi, muSubleadEta, muSubleadPhi, photon_corr.p4() ) ) { continue; }
+                nPreselected_++;
                 float PhotonET =  photon_corr.pt();
-                if( PhotonET < minPhotonPT_ ) { continue; }
 
                 //MuMuGammaCandidate mumugamma(dimu, photon_corr);
                 MuMuGammaCandidate mumugamma( dimuon, photon_corr, pvx );
@@ -143,6 +188,28 @@ namespace flashgg {
         evt.put( std::move( MuMuGammaColl ) );
 
     }
+
+    bool MuMuGammaProducer::preselect( const reco::Candidate::LorentzVector &dimuon, double muLeadEta, double muLeadPhi, double muSubleadEta,
+                                       double muSubleadPhi, const reco::Candidate::LorentzVector &photon ) const
+    {
+        if( photon.pt() < preselMinPhotonPT_ ) { return false; }
+        double px = dimuon.px() + photon.px(), py = dimuon.py() + photon.py(), pz = dimuon.pz() + photon.pz(), e = dimuon.energy() + photon.energy();
+        double mass2 = e * e - px * px - py * py - pz * pz;
+        double mass = ( mass2 > 0. ? sqrt( mass2 ) : 0. );
+        if( mass < preselMinMass_ || ( preselMaxMass_ >= 0. && mass > preselMaxMass_ ) ) { return false; }
+        double dR = min( reco::deltaR( photon.eta(), photon.phi(), muLeadEta, muLeadPhi ), reco::deltaR( photon.eta(), photon.phi(), muSubleadEta, muSubleadPhi ) );
+        if( dR < preselMinDeltaR_ || ( preselMaxDeltaR_ >= 0. && dR > preselMaxDeltaR_ ) ) { return false; }
+        return true;
+    }
+
+    void MuMuGammaProducer::endJob()
+    {
+        if( ! preselection_ ) { return; }
+        std::cout << "[MuMuGammaProducer] dimuon-photon pairs: " << nPairs_ << ", photon accepted: " << nAccepted_
+                  << ", preselected: " << nPreselected_;
+        if( nAccepted_ > 0 ) { std::cout << " (" << 100. * nPreselected_ / nAccepted_ << "% of the accepted)"; }
+        std::cout << std::endl;
+    }
 }
 
 typedef flashgg::MuMuGammaProducer FlashggMuMuGammaProducer;
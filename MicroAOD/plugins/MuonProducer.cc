@@ -10,6 +10,7 @@
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "DataFormats/PatCandidates/interface/Muon.h"
 #include "flashgg/DataFormats/interface/Muon.h"
+#include "flashgg/MicroAOD/interface/MiniIsolation.h"
 
 using namespace std;
 using namespace edm;
@@ -36,11 +37,13 @@ namespace flashgg {
         double muminiso_ptThresh_ = 0.5;
         double muminiso_ptThresh_phot_ = 1.0;
 
+        MiniIsolation miniIsolation_;
     };
 
     MuonProducer::MuonProducer( const ParameterSet &iConfig ):
         muonToken_( consumes<View<pat::Muon> >( iConfig.getParameter<InputTag>( "muonTag" ) ) ),
-        pfcandidateToken_( consumes<View<pat::PackedCandidate> >( iConfig.getParameter<InputTag> ( "pfCandidatesTag" ) ) )
+        pfcandidateToken_( consumes<View<pat::PackedCandidate> >( iConfig.getParameter<InputTag> ( "pfCandidatesTag" ) ) ),
+        miniIsolation_( max( iConfig.getParameter<double>( "muminiso_r_min" ), iConfig.getParameter<double>( "muminiso_r_max" ) ) )
     {
 
         muminiso_r_min_ = iConfig.getParameter<double>( "muminiso_r_min" );
@@ -64,7 +67,7 @@ namespace flashgg {
 
         Handle<View<pat::PackedCandidate> > pfcandidates;
         evt.getByToken( pfcandidateToken_, pfcandidates );
-        const std::vector<edm::Ptr<pat::PackedCandidate> > &pfcands = pfcandidates->ptrs();
+        miniIsolation_.setCandidates( *pfcandidates );
 
         //        std::cout << "calling produce function " << std::endl;
 
@@ -82,57 +85,20 @@ namespace flashgg {
 
             //MiniIsolation : https://twiki.cern.ch/twiki/bin/view/CMS/MiniIsolationSUSY
             float fggMiniIsoSumRel_ = 99999.;
-            double iso_nh_(0.); double iso_ch_(0.); 
-            double iso_ph_(0.); double iso_pu_(0.); double iso_ph2_(0.); 
+            MiniIsolation::Sums iso;
             double par_pt_ =  pmu->pt();
             if(par_pt_ > 5.){
-                double r_iso_ = max(muminiso_r_min_,min(muminiso_r_max_, muminiso_kt_scale_/par_pt_ ));
-                for( unsigned int ipfc = 0 ; ipfc < pfcands.size() ; ipfc++ ) {
-                    Ptr<pat::PackedCandidate> pfc = pfcands[ ipfc ];
-                    if (abs(pfc->pdgId())<7) continue;
-                    
-                    double dr_ = reco::deltaR( *pfc, *pmu );
-                    //double dr_ = deltaR(pfc->eta(), pfc->phi(), pmu->eta(), pmu->phi() );
-                    if (dr_ > r_iso_) continue;
-                    
-                    //////////////////  NEUTRALS  /////////////////////////
-                    if (pfc->charge()==0){
-                        if (pfc->pt()>muminiso_ptThresh_) {
-                            /////////// PHOTONS ////////////
-                            if (abs(pfc->pdgId())==22) {
-                                if(dr_ < muminiso_deadcone_ph_) continue;
-                                iso_ph_ += pfc->pt();
-                                if(pfc->pt()>muminiso_ptThresh_phot_) {
-                                    iso_ph2_ += pfc->pt();
-                                }
-                                /////////// NEUTRAL HADRONS ////////////
-                            } else if (abs(pfc->pdgId())==130) {
-                                if(dr_ < muminiso_deadcone_nh_) continue;
-                                iso_nh_ += pfc->pt();
-                            }
-                        }
-                        //////////////////  CHARGED from PV  /////////////////////////
-                    } else if (pfc->fromPV()>1){
-                        if (abs(pfc->pdgId())==211) {
-                            if(dr_ < muminiso_deadcone_ch_) continue;
-                            iso_ch_ += pfc->pt();
-                        }
-                        //////////////////  CHARGED from PU  /////////////////////////
-                    } else {
-                        if (pfc->pt()>muminiso_ptThresh_){
-                            if(dr_ < muminiso_deadcone_pu_) continue;
-                            iso_pu_ += pfc->pt();
-                        }
-                    }
-                }// pfcand loop
-                fggMiniIsoSumRel_ = ( iso_ch_ + max( 0., iso_nh_ + iso_ph_ - 0.5 * iso_pu_) ) / par_pt_ ;
+                double r_iso_ = MiniIsolation::cone( par_pt_, muminiso_r_min_, muminiso_r_max_, muminiso_kt_scale_ );
+                MiniIsolation::DeadCones deadCones = { muminiso_deadcone_ch_, muminiso_deadcone_pu_, muminiso_deadcone_ph_, muminiso_deadcone_nh_ };
+                iso = miniIsolation_.sums( pmu->eta(), pmu->phi(), r_iso_, deadCones, muminiso_ptThresh_, muminiso_ptThresh_phot_ );
+                fggMiniIsoSumRel_ = ( iso.ch + max( 0., iso.nh + iso.ph - 0.5 * iso.pu) ) / par_pt_ ;
             }
             fmu.setFggMiniIsoSumRel( fggMiniIsoSumRel_ );
-            fmu.setFggMiniIsoCharged( iso_ch_ );
-            fmu.setFggMiniIsoNeutrals( iso_nh_ );
-            fmu.setFggMiniIsoPhotons( iso_ph_ );
-            fmu.setFggMiniIsoPUCharged( iso_pu_ );
-            fmu.setFggMiniIsoPhotons2( iso_ph2_ );
+            fmu.setFggMiniIsoCharged( iso.ch );
+            fmu.setFggMiniIsoNeutrals( iso.nh );
+            fmu.setFggMiniIsoPhotons( iso.ph );
+            fmu.setFggMiniIsoPUCharged( iso.pu );
+            fmu.setFggMiniIsoPhotons2( iso.ph2 );
 
             muColl->push_back( fmu );
         }
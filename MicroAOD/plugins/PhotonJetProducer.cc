@@ -21,6 +21,7 @@
 #include "DataFormats/PatCandidates/interface/PackedGenParticle.h"
 
 #include "TLorentzVector.h"
+#include <algorithm>
 #include <map>
 
 using namespace edm;
@@ -50,6 +51,7 @@ namespace flashgg {
 
         double minJetPt_;
         double maxJetEta_;
+        double maxPhotonJetDeltaR_; // <= 0: no cut
         double minPhotonPt_;
         double minPhotEBHoE_;
         double minPhotEEHoE_;
@@ -101,6 +103,17 @@ namespace flashgg {
         photIsolnEAreaChgHad_ = iConfig.getParameter<vector<double>>( "photIsolnEAreaChgHad" );
         photIsolnEAreaNeuHad_ = iConfig.getParameter<vector<double>>( "photIsolnEAreaNeuHad" );
         photIsolnEAreaPhot_ = iConfig.getParameter<vector<double>>( "photIsolnEAreaPhot" );
+        // the effective area bin of a photon is found by bisection on the bin edges
+        if( iphotIsolnAreaValN_ < 1 || photIsolnEAreaVal_.size() < ( size_t )iphotIsolnAreaValN_ || photIsolnEAreaChgHad_.size() < ( size_t )iphotIsolnAreaValN_
+                || photIsolnEAreaNeuHad_.size() < ( size_t )iphotIsolnAreaValN_ || photIsolnEAreaPhot_.size() < ( size_t )iphotIsolnAreaValN_ ) {
+            throw cms::Exception( "Configuration" ) << "PhotonJetProducer: iphotIsolnAreaValN is " << iphotIsolnAreaValN_
+                                                    << ", the effective area vectors must have at least as many values";
+        }
+        if( !std::is_sorted( photIsolnEAreaVal_.begin(), photIsolnEAreaVal_.begin() + iphotIsolnAreaValN_ ) ) {
+            throw cms::Exception( "Configuration" ) << "PhotonJetProducer: photIsolnEAreaVal must be in increasing order";
+        }
+        // optional preselection of the photon-jet pairs, before the vertex choice
+        maxPhotonJetDeltaR_ = ( iConfig.exists( "maxPhotonJetDeltaR" ) ? iConfig.getParameter<double>( "maxPhotonJetDeltaR" ) : 0. );
         
         produces<vector<flashgg::PhotonJetCandidate>>();
     }
@@ -142,6 +155,36 @@ namespace flashgg {
 
         unique_ptr<vector<PhotonJetCandidate> > PhotonJetColl( new vector<PhotonJetCandidate> );
 
+        const std::vector<edm::Ptr<reco::Vertex> > &vertexPtrs = primaryVertices->ptrs();
+        const std::vector<edm::Ptr<reco::Conversion> > &conversionPtrs = conversions->ptrs();
+        const std::vector<edm::Ptr<reco::Conversion> > &conversionSingleLegPtrs = conversionsSingleLeg->ptrs();
+
+        // place of the vertices in the input collection by key, for those of the product of the first one
+        std::vector<int> vertexPlaces;
+        for( unsigned int k = 0; k < vertexPtrs.size() ; k++ ) {
+            if( vertexPtrs[k].id() != vertexPtrs[0].id() ) { continue; }
+            if( vertexPtrs[k].key() >= vertexPlaces.size() ) { vertexPlaces.resize( vertexPtrs[k].key() + 1, -1 ); }
+            if( vertexPlaces[vertexPtrs[k].key()] < 0 ) { vertexPlaces[vertexPtrs[k].key()] = k; }
+        }
+
+        // -- jet selection, the same for all the photons: min pt, max eta, sumPttracks > minJetPt
+        std::vector<bool> selectedJets( jets->size(), false );
+        for( unsigned int j = 0 ; j < jets->size() ; j++ ) {
+            Ptr<pat::Jet> jet = jets->ptrAt( j );
+            if ( jet->pt() < minJetPt_ ) continue;
+            if ( fabs(jet->eta()) > maxJetEta_ ) continue;
+            TLorentzVector pTrks(0.,0.,0.,0.);
+            for (unsigned int icand = 0; icand < jet->numberOfDaughters(); icand++){
+                const reco::Candidate *jetconst = jet->daughter(icand);
+                //std::cout << jetconst->charge() << " " << jetconst->px()<< " "<< jetconst->py() << " " << jetconst->pz()<<std::endl;
+                if ( jetconst->charge()==0 ) continue;
+                TLorentzVector pTrk(jetconst->px(), jetconst->py(), jetconst->pz(), jetconst->energy());
+                pTrks+=pTrk;
+            }
+            //std::cout << "track sum pt = "<< pTrks.Pt() <<std::endl;
+            selectedJets[j] = !( pTrks.Pt() < minJetPt_ );
+        }
+
         // --- Photon selection (min pt, photon id)
         for ( unsigned int i = 0 ; i < photons->size() ; i++ ){
             Ptr<flashgg::Photon> photon = photons->ptrAt( i );
@@ -149,13 +192,10 @@ namespace flashgg {
             if (photPt_ < minPhotonPt_) continue;
             // photon ID cut based : //https://twiki.cern.ch/twiki/bin/view/CMS/CutBasedPhotonIdentificationRun2#Recommended_Working_points_for_2
             if ( !photon->passElectronVeto() ) continue;
-            int iphotEA_ = iphotIsolnAreaValN_ - 1;
-            for (int iEA = 0; iEA < iphotIsolnAreaValN_; iEA++){
-                if (fabs(photon->eta()) < photIsolnEAreaVal_.at(iEA)) {
-                    iphotEA_ = iEA;
-                    break;
-                }
-            }
+            // first bin with |eta| below its edge, the last one if none
+            int iphotEA_ = std::upper_bound( photIsolnEAreaVal_.begin(), photIsolnEAreaVal_.begin() + iphotIsolnAreaValN_, fabs( photon->eta() ) )
+                           - photIsolnEAreaVal_.begin();
+            iphotEA_ = std::min( iphotEA_, iphotIsolnAreaValN_ - 1 );
 
             if ( photon->isEB() ){
                 if ( photon->hadronicOverEm() > minPhotEBHoE_ )  continue;
@@ -180,35 +220,28 @@ namespace flashgg {
                         
             // -- loop over jets
             for( unsigned int j = 0 ; j < jets->size() ; j++ ) {
+                if ( !selectedJets[j] ) continue;
                 Ptr<pat::Jet> jet = jets->ptrAt( j );
-                if ( jet->pt() < minJetPt_ ) continue;
-                if ( fabs(jet->eta()) > maxJetEta_ ) continue;
                 // -- check that the jet is not overlapping with the photon
                 float dR = reco::deltaR(photon->eta(), photon->phi(), jet->eta(), jet->phi());
                 if ( dR < 0.4 ) continue;
-                // -- check sumPttracks > 30 
-                TLorentzVector pTrks(0.,0.,0.,0.);
-                for (unsigned int icand = 0; icand < jet->numberOfDaughters(); icand++){
-                    const reco::Candidate *jetconst = jet->daughter(icand);
-                    //std::cout << jetconst->charge() << " " << jetconst->px()<< " "<< jetconst->py() << " " << jetconst->pz()<<std::endl;
-                    if ( jetconst->charge()==0 ) continue;
-                    TLorentzVector pTrk(jetconst->px(), jetconst->py(), jetconst->pz(), jetconst->energy());
-                    pTrks+=pTrk;
-                }
-                //std::cout << "track sum pt = "<< pTrks.Pt() <<std::endl;
-                if (pTrks.Pt()< minJetPt_ ) continue;
+                if ( maxPhotonJetDeltaR_ > 0. && dR > maxPhotonJetDeltaR_ ) continue;
 
                 // -- now build gamma+jet candidate 
-                Ptr<reco::Vertex> pvx = vertexSelector_->select( photon, jet, primaryVertices->ptrs(), *vertexCandidateMap, conversions->ptrs(), conversionsSingleLeg->ptrs(),
+                Ptr<reco::Vertex> pvx = vertexSelector_->select( photon, jet, vertexPtrs, *vertexCandidateMap, conversionPtrs, conversionSingleLegPtrs,
                                                                  vertexPoint, useSingleLeg_ );
 
 
                 int ivtx = 0;
-                for( unsigned int k = 0; k < primaryVertices->size() ; k++ )
-                    if( pvx == primaryVertices->ptrAt( k ) ) {
-                        ivtx = k;
-                        break;
-                    }
+                if( !vertexPtrs.empty() && pvx.id() == vertexPtrs[0].id() && pvx.key() < vertexPlaces.size() && vertexPlaces[pvx.key()] >= 0 ) {
+                    ivtx = vertexPlaces[pvx.key()];
+                } else {
+                    for( unsigned int k = 0; k < vertexPtrs.size() ; k++ )
+                        if( pvx == vertexPtrs[k] ) {
+                            ivtx = k;
+                            break;
+                        }
+                }
 
 
                 PhotonJetCandidate photonjet( photon, jet, pvx );
@@ -1,19 +1,30 @@
 #include "flashgg/MicroAOD/interface/IsolationAlgoBase.h"
 #include "flashgg/MicroAOD/interface/PhotonIdUtils.h"
+#include "flashgg/MicroAOD/interface/EtaPhiBucketMatcher.h"
 #include "DataFormats/Common/interface/View.h"
 #include "DataFormats/Common/interface/Handle.h"
 #include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/Math/interface/deltaPhi.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <limits>
+#include <memory>
 
 /// #include "FWCore/Utilities/interface/RandomNumberGenerator.h"
 /// #include "CLHEP/Random/RandomEngine.h"
 
 namespace flashgg {
 
+    // Isolation in a cone rotated in phi from the photon: the rotations are tried in turn (by default +pi/2 and -pi/2)
+    // and the first one with no veto object within `veto` is used. The directions of the veto objects are sorted into
+    // (eta, phi) cells once per event, so that each trial only looks at the objects around the rotated cone.
     class RandomConeIsolationAlgo : public IsolationAlgoBase
     {
     public:
         RandomConeIsolationAlgo( const edm::ParameterSet &conf, edm::ConsumesCollector && iC )  : IsolationAlgoBase( conf, std::forward<edm::ConsumesCollector>(iC) ),
-            conesize_( conf.getParameter<double>( "coneSize" ) )
+            conesize_( conf.getParameter<double>( "coneSize" ) ),
+            rotations_{0.5 * TMath::Pi(), -0.5 * TMath::Pi()}
         {
             if( conf.exists( "charged" ) ) {
                 chargedVetos_ = conf.getParameter<std::vector<double> >( "charged" );
@@ -35,6 +46,14 @@ namespace flashgg {
                     auto token = iC.consumes<edm::View<reco::Candidate> >(vetoCollections_[i]);
                     tokenVetos_.push_back(token);
                 }
+                // the cells get a 1% margin against rounding on the edge of the veto cone; nothing is vetoed with veto <= 0
+                if( veto_ > 0. ) { vetoCells_.reset( new EtaPhiBucketMatcher( 1.01 * veto_ ) ); }
+            }
+            if( conf.exists( "rotations" ) ) {
+                rotations_ = conf.getParameter<std::vector<double> >( "rotations" );
+                if( rotations_.empty() ) {
+                    throw cms::Exception( "Configuration" ) << "RandomConeIsolationAlgo " << name() << ": empty list of rotations";
+                }
             }
 
             utils_.removeOverlappingCandidates( conf.getParameter<bool>( "doOverlapRemoval" ) );
@@ -60,33 +79,41 @@ namespace flashgg {
         std::vector<double> chargedVetos_, photonVetos_, neutralVetos_;
         std::vector<edm::InputTag> vetoCollections_;
         std::vector<edm::EDGetTokenT<edm::View<reco::Candidate> > > tokenVetos_;
+        std::vector<double> rotations_;
+        std::unique_ptr<EtaPhiBucketMatcher> vetoCells_; // directions of the veto objects of vetoEvent_
+        edm::Event::CacheIdentifier_t vetoEvent_ = std::numeric_limits<edm::Event::CacheIdentifier_t>::max();
+        std::vector<unsigned int> neighbours_;
     };
 
     void RandomConeIsolationAlgo::begin( const pat::Photon &pho, const edm::Event &event, const edm::EventSetup & )
     {
-        std::vector<edm::Handle<edm::View<reco::Candidate> > > vetos( vetoCollections_.size() );
-
-        for( size_t icoll = 0; icoll < vetoCollections_.size(); ++icoll ) {
-            //            event.getByLabel( vetoCollections_[icoll], vetos[icoll] );
-            event.getByToken( tokenVetos_[icoll], vetos[icoll] );
+        if( vetoCells_ && event.cacheIdentifier() != vetoEvent_ ) {
+            vetoCells_->clear();
+            for( auto &token : tokenVetos_ ) {
+                edm::Handle<edm::View<reco::Candidate> > vetos;
+                event.getByToken( token, vetos );
+                for( auto &cand : *vetos ) { vetoCells_->add( cand.eta(), cand.phi() ); }
+            }
+            vetoCells_->build();
+            vetoEvent_ = event.cacheIdentifier();
         }
 
         found_ = false;
-        std::vector<double> test{0.5 * TMath::Pi(), -0.5 * TMath::Pi()};
-        for( auto it : test ) {
+        for( auto it : rotations_ ) {
             deltaPhi_ = it;
             found_ = true;
-            for( auto &coll : vetos ) {
-                for( auto &cand : *coll ) {
-                    float dEta = pho.eta() - cand.eta();
-                    float dPhi = reco::deltaPhi( pho.phi() + deltaPhi_, cand.phi() );
+            if( vetoCells_ ) {
+                double phi = pho.phi() + deltaPhi_;
+                vetoCells_->neighbours( pho.eta(), phi, neighbours_ );
+                for( unsigned int j : neighbours_ ) {
+                    float dEta = pho.eta() - vetoCells_->eta( j );
+                    float dPhi = reco::deltaPhi( phi, vetoCells_->phi( j ) );
                     float dR = sqrt( dEta * dEta + dPhi * dPhi );
                     if( dR < veto_ ) {
                         found_ = false;
                         break;
                     }
                 }
-                if( ! found_ ) { break; }
             }
             if( found_ ) { break; }
         }
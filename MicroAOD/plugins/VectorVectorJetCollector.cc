@@ -10,6 +10,7 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/EDMException.h"
+#include "DataFormats/Common/interface/PtrVector.h"
 
 #include "flashgg/DataFormats/interface/Jet.h"
 
@@ -29,22 +30,28 @@ namespace flashgg {
 
         std::vector<edm::InputTag> inputTagJets_;
         std::vector<edm::EDGetTokenT<View<flashgg::Jet> > > tokenJets_;
+        // store PtrVectors to the input collections instead of copies of the jets:
+        // the input collections must then be kept in the output as well
+        bool storeReferences_;
     };
 
     VectorVectorJetCollector::VectorVectorJetCollector( const ParameterSet &iConfig ) :
-        inputTagJets_( iConfig.getParameter<std::vector<edm::InputTag> >( "inputTagJets" ) )
+        inputTagJets_( iConfig.getParameter<std::vector<edm::InputTag> >( "inputTagJets" ) ),
+        storeReferences_( iConfig.exists( "StoreReferences" ) ? iConfig.getParameter<bool>( "StoreReferences" ) : false )
     {
         for (unsigned i = 0 ; i < inputTagJets_.size() ; i++) {
             auto token = consumes<View<flashgg::Jet> >(inputTagJets_[i]);
             tokenJets_.push_back(token);
         }
-        produces<vector<vector<Jet> > >();
+        if( storeReferences_ ) {
+            produces<vector<PtrVector<Jet> > >();
+        } else {
+            produces<vector<vector<Jet> > >();
+        }
     }
 
     void VectorVectorJetCollector::produce( Event &evt, const EventSetup & )
     {
-        unique_ptr<vector<vector<Jet> > > result( new vector<vector<Jet> > );
-
         size_t output_size = 0;
         JetViewVector Jets( inputTagJets_.size() );
         for( size_t j = 0; j < inputTagJets_.size(); ++j ) {
@@ -53,8 +60,18 @@ namespace flashgg {
             if( Jets[j]->size() > 0 ) { output_size = j + 1; }
         }
 
-        result->resize( output_size );
+        if( storeReferences_ ) {
+            unique_ptr<vector<PtrVector<Jet> > > refs( new vector<PtrVector<Jet> >( output_size ) );
+            for( size_t j = 0 ; j < refs->size() ; ++j ) {
+                for( size_t k = 0 ; k < Jets[j]->size() ; ++k ) {
+                    refs->at( j ).push_back( Jets[j]->ptrAt( k ) );
+                }
+            }
+            evt.put( std::move( refs ) );
+            return;
+        }
 
+        unique_ptr<vector<vector<Jet> > > result( new vector<vector<Jet> >( output_size ) );
         for( size_t j = 0 ; j < result->size() ; ++j ) {
             for( size_t k = 0 ; k < Jets[j]->size() ; ++k ) {
                 result->at( j ).push_back( *( Jets[j]->ptrAt( k ) ) );
@@ -52,7 +52,7 @@ class MicroAODCustomize(object):
                                0,
                               VarParsing.VarParsing.multiplicity.singleton,
                               VarParsing.VarParsing.varType.int,
-                               'timing')
+                               'timing: 1 TimeMemoryInfo, 2 FlashggJobProfiler')
         self.options.register ('puppi',
                                0,
                               VarParsing.VarParsing.multiplicity.singleton,
@@ -82,6 +82,12 @@ class MicroAODCustomize(object):
                                VarParsing.VarParsing.varType.bool,
                               'runEGMPhoID'
                               )
+        self.options.register('jetReferences',
+                              False,
+                               VarParsing.VarParsing.multiplicity.singleton,
+                               VarParsing.VarParsing.varType.bool,
+                              'jetReferences'
+                              )
         self.options.register('addMicroAODHLTFilter',
                               True,
                                VarParsing.VarParsing.multiplicity.singleton,
@@ -126,6 +132,8 @@ class MicroAODCustomize(object):
         else: # e.g. 2                                                                                                                               
             self.customizePFCHS(process)
             self.customizePuppi(process)
+        if self.jetReferences:
+            self.customizeJetReferences(process)
         if self.processType == "data":
             self.customizeData(process)
             if "Mu" in customize.datasetName:
@@ -167,6 +175,8 @@ class MicroAODCustomize(object):
             self.customizeFileNames(process)
         if self.timing == 1:
             self.customizeTiming(process)
+        elif self.timing == 2:
+            self.customizeProfiler(process)
         if self.bunchSpacing == 25:
             pass #default
         elif self.bunchSpacing == 50:
@@ -545,6 +555,11 @@ class MicroAODCustomize(object):
         TimeMemoryCustomize(process)
         process.MessageLogger.cerr.threshold = 'WARNING'
 
+    def customizeProfiler(self,process):
+        # per-module and per-event timing and memory, see MetaData/interface/JobProfiler.h
+        process.add_(cms.Service("FlashggJobProfiler",
+                                 fileName=cms.untracked.string("microAOD_profile.csv")))
+
     def customizePFCHS(self,process):    
         # need to allow unscheduled processes otherwise reclustering function will fail
         if not hasattr(process,"options"):
@@ -572,6 +587,16 @@ class MicroAODCustomize(object):
                                  debug       = False,
                                  label = '' + str(vtx))
 
+    # store PtrVectors to the per-vertex jet collections instead of copies of the jets in flashggFinalJets and flashggFinalPuppiJets
+    # the Taggers job must then unpack them with flashggUnpackedJets.JetsAreReferences = True
+    def customizeJetReferences(self,process):
+        if self.puppi != 1:
+            process.flashggFinalJets.StoreReferences = cms.bool(True)
+            process.out.outputCommands.append('keep *_flashggSelectedPFCHSJets*_*_*')
+        if self.puppi != 0:
+            process.flashggFinalPuppiJets.StoreReferences = cms.bool(True)
+            process.out.outputCommands.append('keep *_selectedFlashggPUPPIJets*_*_*')
+
     def customizeRemovePFCHS(self,process):
         for pathName in process.paths:
             path = getattr(process,pathName)
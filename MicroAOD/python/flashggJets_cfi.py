@@ -161,10 +161,12 @@ def addFlashggPFCHSJets(process,
                                JetCollectionIndex = cms.uint32(vertexIndex),
                                Debug = cms.untracked.bool(debug),
                                DoPuJetID = cms.bool(True),
+                               StorePuJetId = cms.bool(False),
                                ComputeRegVars = cms.bool(True),
                                MinPtForEneSum = cms.double(0.),
                                MaxEtaForEneSum = cms.double(2.5),
                                NJetsForEneSum = cms.uint32(0),
+                               ConeBoundaries = cms.vdouble(0.05, 0.1, 0.2, 0.3, 0.4),
                                MiniAodJetTag = cms.InputTag("slimmedJets")
                                )
   setattr( process, 'flashggPFCHSJets'+ label, flashggJets)
@@ -281,11 +283,13 @@ for i in range(0,maxJetCollections):
 
   
 flashggFinalJets = cms.EDProducer("FlashggVectorVectorJetCollector",
-                                  inputTagJets= JetCollectionVInputTag
+                                  inputTagJets= JetCollectionVInputTag,
+                                  StoreReferences = cms.bool(False) # True: PtrVectors to the input collections, which must then be kept
 )
 
 flashggFinalPuppiJets = cms.EDProducer("FlashggVectorVectorJetCollector",
-                                  inputTagJets= PuppiJetCollectionVInputTag
+                                  inputTagJets= PuppiJetCollectionVInputTag,
+                                  StoreReferences = cms.bool(False) # True: PtrVectors to the input collections, which must then be kept
 )
 
   
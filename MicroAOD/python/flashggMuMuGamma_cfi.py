@@ -8,4 +8,6 @@ flashggMuMuGamma = cms.EDProducer('FlashggMuMuGammaProducer',
                                   VertexTag=cms.InputTag('offlineSlimmedPrimaryVertices'),
                                   ##Parameters                                                
                                   minPhotonPT=cms.double(10.)
+                                  ## Optional preselection of the pairs before the candidates are built, e.g. Z->mumugamma only:
+                                  ## preselection=cms.PSet(minMass=cms.double(60.), maxMass=cms.double(120.), maxDeltaR=cms.double(0.8), minPhotonPT=cms.double(20.))
                                   )
@@ -21,6 +21,7 @@ flashggPhotonJet = cms.EDProducer('FlashggPhotonJetProducer',
 
                                   minJetPt = cms.double(30.),
                                   maxJetEta = cms.double(2.5),
+                                  maxPhotonJetDeltaR = cms.double(0.), # skip the pairs further apart before the vertex choice, 0: no cut
 				  minPhotonPt = cms.double(55.),
 				  minPhotEBHoE = cms.double(0.05), #medium from https://twiki.cern.ch/twiki/bin/view/CMS/CutBasedPhotonIdentificationRun2#Recommended_Working_points_for_2
 				  minPhotEEHoE = cms.double(0.05),
@@ -0,0 +1,97 @@
+#include "flashgg/MicroAOD/interface/EtaPhiBucketMatcher.h"
+
+#include "DataFormats/Math/interface/deltaR.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace flashgg;
+
+EtaPhiBucketMatcher::EtaPhiBucketMatcher( double maxDR ) :
+    maxDR_( maxDR ),
+    nPhiCells_( std::max( 1, int( 2. * M_PI / maxDR ) ) )
+{
+    // with fewer than 3 cells the neighbours of a cell are not distinct: use a single one
+    if( nPhiCells_ < 3 ) { nPhiCells_ = 1; }
+}
+
+void EtaPhiBucketMatcher::clear()
+{
+    eta_.clear();
+    phi_.clear();
+    cells_.clear();
+}
+
+void EtaPhiBucketMatcher::add( double eta, double phi )
+{
+    eta_.push_back( eta );
+    phi_.push_back( phi );
+}
+
+void EtaPhiBucketMatcher::build()
+{
+    cells_.resize( eta_.size() );
+    for( unsigned int j = 0; j < eta_.size(); ++j ) {
+        cells_[j] = std::make_pair( cellKey( etaCell( eta_[j] ), phiCell( phi_[j] ) ), j );
+    }
+    std::sort( cells_.begin(), cells_.end() );
+}
+
+int EtaPhiBucketMatcher::etaCell( double eta ) const
+{
+    return int( std::floor( eta / maxDR_ ) );
+}
+
+int EtaPhiBucketMatcher::phiCell( double phi ) const
+{
+    double reduced = std::remainder( phi, 2. * M_PI ); // in [-pi, pi]
+    int iphi = int( ( reduced + M_PI ) / ( 2. * M_PI ) * nPhiCells_ );
+    return std::min( std::max( iphi, 0 ), nPhiCells_ - 1 );
+}
+
+void EtaPhiBucketMatcher::match( double eta, double phi, std::vector<unsigned int> &matches ) const
+{
+    neighbours( eta, phi, matches );
+    matches.erase( std::remove_if( matches.begin(), matches.end(),
+                                   [&]( unsigned int j ) { return !( reco::deltaR( eta_[j], phi_[j], eta, phi ) < maxDR_ ); } ),
+                   matches.end() );
+}
+
+void EtaPhiBucketMatcher::neighbours( double eta, double phi, std::vector<unsigned int> &candidates ) const
+{
+    candidates.clear();
+    int ieta = etaCell( eta );
+    int iphi = phiCell( phi );
+    // ranges of phi cells to look at: the 3 neighbouring cells are consecutive keys unless phi wraps around
+    int phiRanges[3][2];
+    int nRanges = 0;
+    if( nPhiCells_ == 1 ) {
+        phiRanges[nRanges][0] = 0; phiRanges[nRanges++][1] = 0;
+    } else if( iphi == 0 ) {
+        phiRanges[nRanges][0] = 0; phiRanges[nRanges++][1] = 1;
+        phiRanges[nRanges][0] = nPhiCells_ - 1; phiRanges[nRanges++][1] = nPhiCells_ - 1;
+    } else if( iphi == nPhiCells_ - 1 ) {
+        phiRanges[nRanges][0] = 0; phiRanges[nRanges++][1] = 0;
+        phiRanges[nRanges][0] = iphi - 1; phiRanges[nRanges++][1] = iphi;
+    } else {
+        phiRanges[nRanges][0] = iphi - 1; phiRanges[nRanges++][1] = iphi + 1;
+    }
+    for( int jeta = ieta - 1; jeta <= ieta + 1; ++jeta ) {
+        for( int k = 0; k < nRanges; ++k ) {
+            long lastKey = cellKey( jeta, phiRanges[k][1] );
+            auto it = std::lower_bound( cells_.begin(), cells_.end(), std::make_pair( cellKey( jeta, phiRanges[k][0] ), 0u ) );
+            for( ; it != cells_.end() && it->first <= lastKey; ++it ) {
+                candidates.push_back( it->second );
+            }
+        }
+    }
+    std::sort( candidates.begin(), candidates.end() );
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,122 @@
+#include "flashgg/MicroAOD/interface/GraphLookupTable.h"
+
+#include "TGraph.h"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace flashgg;
+
+GraphLookupTable::GraphLookupTable() :
+    xmin_( 0. ), xmax_( 0. ), step_( 0. ), invStep_( 0. ), loSlope_( 0. ), hiSlope_( 0. ),
+    vals_( 2, 0. ), exact_( true ), maxDeviation_( 0. )
+{
+}
+
+GraphLookupTable::GraphLookupTable( const TGraph &graph, double tolerance, unsigned int minBins, unsigned int maxBins ) :
+    GraphLookupTable()
+{
+    int np = graph.GetN();
+    if( np == 0 ) { return; }
+
+    std::vector<int> order( np );
+    std::iota( order.begin(), order.end(), 0 );
+    std::stable_sort( order.begin(), order.end(), [&graph]( int a, int b ) { return graph.GetX()[a] < graph.GetX()[b]; } );
+    std::vector<double> kx( np ), ky( np );
+    for( int ip = 0; ip < np; ++ip ) {
+        kx[ip] = graph.GetX()[order[ip]];
+        ky[ip] = graph.GetY()[order[ip]];
+    }
+
+    xmin_ = kx.front();
+    xmax_ = kx.back();
+    if( np == 1 || xmax_ == xmin_ ) {
+        vals_.assign( 2, graph.Eval( xmin_ ) );
+        return;
+    }
+    if( kx[1] != kx[0] ) { loSlope_ = ( ky[1] - ky[0] ) / ( kx[1] - kx[0] ); }
+    if( kx[np - 1] != kx[np - 2] ) { hiSlope_ = ( ky[np - 1] - ky[np - 2] ) / ( kx[np - 1] - kx[np - 2] ); }
+
+    double range = xmax_ - xmin_;
+    double knotStep = range / ( np - 1 );
+    exact_ = true;
+    for( int ip = 1; ip < np - 1 && exact_; ++ip ) {
+        exact_ = std::abs( kx[ip] - ( xmin_ + ip * knotStep ) ) <= 1.e-9 * range;
+    }
+    if( exact_ ) {
+        step_ = knotStep;
+        invStep_ = 1. / step_;
+        vals_ = ky;
+        return;
+    }
+
+    auto yrange = std::minmax_element( ky.begin(), ky.end() );
+    double maxDeviation = tolerance * std::max( *yrange.second - *yrange.first, std::numeric_limits<double>::min() );
+    unsigned int nbins = std::max( minBins, ( unsigned int )np - 1 );
+    while( true ) {
+        fill( kx, ky, nbins );
+        maxDeviation_ = 0.;
+        for( int ip = 0; ip < np; ++ip ) {
+            maxDeviation_ = std::max( maxDeviation_, std::abs( eval( kx[ip] ) - graph.Eval( kx[ip] ) ) );
+        }
+        if( maxDeviation_ <= maxDeviation ) { return; }
+        if( nbins >= maxBins ) { break; }
+        nbins = std::min( 2 * nbins, maxBins );
+    }
+    index( kx, ky );
+}
+
+void GraphLookupTable::index( std::vector<double> &kx, std::vector<double> &ky )
+{
+    size_t ncells = 2 * kx.size();
+    step_ = ( xmax_ - xmin_ ) / ncells;
+    invStep_ = 1. / step_;
+    cellFirstKnot_.resize( ncells );
+    size_t ik = 0;
+    for( size_t icell = 0; icell < ncells; ++icell ) {
+        double x = xmin_ + icell * step_;
+        while( ik + 2 < kx.size() && kx[ik + 1] <= x ) { ++ik; }
+        cellFirstKnot_[icell] = ik;
+    }
+    knotX_.swap( kx );
+    knotY_.swap( ky );
+    vals_.assign( 2, 0. );
+    exact_ = true;
+    maxDeviation_ = 0.;
+}
+
+double GraphLookupTable::evalKnots( double x ) const
+{
+    if( std::isnan( x ) ) { return x; }
+    if( x <= xmin_ ) { return knotY_.front() + ( x - xmin_ ) * loSlope_; }
+    if( x >= xmax_ ) { return knotY_.back() + ( x - xmax_ ) * hiSlope_; }
+    size_t ik = cellFirstKnot_[std::min( size_t( ( x - xmin_ ) * invStep_ ), cellFirstKnot_.size() - 1 )];
+    while( ik > 0 && knotX_[ik] > x ) { --ik; }
+    while( knotX_[ik + 1] <= x ) { ++ik; }
+    if( knotX_[ik] == x ) { return knotY_[ik]; }
+    // same expression as TGraph::Eval, to reproduce it bit by bit
+    return knotY_[ik + 1] + ( x - knotX_[ik + 1] ) * ( knotY_[ik] - knotY_[ik + 1] ) / ( knotX_[ik] - knotX_[ik + 1] );
+}
+
+void GraphLookupTable::fill( const std::vector<double> &kx, const std::vector<double> &ky, unsigned int nbins )
+{
+    step_ = ( xmax_ - xmin_ ) / nbins;
+    invStep_ = 1. / step_;
+    vals_.resize( nbins + 1 );
+    size_t ik = 0;
+    for( unsigned int ibin = 0; ibin <= nbins; ++ibin ) {
+        double x = ( ibin == nbins ? xmax_ : xmin_ + ibin * step_ );
+        while( ik + 2 < kx.size() && kx[ik + 1] <= x ) { ++ik; }
+        double dx = kx[ik + 1] - kx[ik];
+        vals_[ibin] = ( dx > 0. ? ky[ik] + ( x - kx[ik] ) * ( ky[ik + 1] - ky[ik] ) / dx : ky[ik] );
+    }
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
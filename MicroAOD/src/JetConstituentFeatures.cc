@@ -0,0 +1,142 @@
+#include "flashgg/MicroAOD/interface/JetConstituentFeatures.h"
+
+#include "DataFormats/PatCandidates/interface/Jet.h"
+#include "DataFormats/PatCandidates/interface/PackedCandidate.h"
+#include "DataFormats/Math/interface/deltaR.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace flashgg;
+
+JetConstituentFeatures::JetConstituentFeatures( const std::vector<double> &coneBoundaries ) :
+    coneBoundaries_( coneBoundaries.begin(), coneBoundaries.end() )
+{
+    std::sort( coneBoundaries_.begin(), coneBoundaries_.end() );
+    for( unsigned int type = 0 ; type < nRingTypes ; type++ ) {
+        ringEnergies_[type].resize( coneBoundaries_.size() + 1, 0. );
+    }
+}
+
+bool JetConstituentFeatures::fill( const pat::Jet &jet )
+{
+    cands_.clear();
+    pt_.clear();
+    energy_.clear();
+    eta_.clear();
+    phi_.clear();
+    pdgId_.clear();
+    charge_.clear();
+    fromPV_.clear();
+    highPurity_.clear();
+
+    unsigned int n = jet.numberOfSourceCandidatePtrs();
+    for( unsigned int k = 0 ; k < n ; k++ ) {
+        const pat::PackedCandidate *cand = dynamic_cast<const pat::PackedCandidate *>( jet.sourceCandidatePtr( k ).get() );
+        if( !cand ) { return false; }
+        cands_.push_back( cand );
+        pt_.push_back( cand->pt() );
+        energy_.push_back( cand->energy() );
+        eta_.push_back( cand->eta() );
+        phi_.push_back( cand->phi() );
+        pdgId_.push_back( cand->pdgId() );
+        charge_.push_back( cand->charge() );
+        fromPV_.push_back( cand->fromPV() );
+        highPurity_.push_back( cand->trackHighPurity() );
+    }
+
+    compute( jet );
+    return true;
+}
+
+void JetConstituentFeatures::compute( const pat::Jet &jet )
+{
+    double jetEta = jet.eta(), jetPhi = jet.phi();
+
+    float sum_dEta( 0.0 ), sum_dPhi( 0.0 ), sum_dEta2( 0.0 ), sum_dPhi2( 0.0 ), sum_dEta_dPhi( 0.0 ), sum_weight( 0.0 ), sum_pt( 0.0 );
+    ptD_ = 0.; axis1_ = 0.; axis2_ = 0.; totalMult_ = 0.;
+    sumPtDrSq_ = 0.; sumPtSq_ = 0.; leadTrackPt_ = 0.;
+    numDaug03_ = 0;
+    softLepPt_ = 0.; softLepRatio_ = 0.; softLepDr_ = 0.; softLepPtRel_ = 0.; softLepPtRelInv_ = 0.;
+    softLepPdgId_ = 0;
+    for( unsigned int type = 0 ; type < nRingTypes ; type++ ) {
+        std::fill( ringEnergies_[type].begin(), ringEnergies_[type].end(), 0. );
+    }
+    int softLep = -1;
+
+    for( unsigned int k = 0 ; k < pt_.size() ; k++ ) {
+        float candPt = pt_[k];
+        float candDr = reco::deltaR( eta_[k], phi_[k], jetEta, jetPhi );
+        int pdgid = std::abs( pdgId_[k] );
+
+        // quark-gluon inputs: charged constituents associated to the PV with high purity tracks, neutrals above qgNeutralMinPt
+        if( charge_[k] ? ( fromPV_[k] > 1 && highPurity_[k] ) : !( candPt < qgNeutralMinPt ) ) {
+            ++totalMult_;
+            float dEta = eta_[k] - jetEta;
+            float dPhi = reco::deltaPhi( phi_[k], jetPhi );
+            float weight = candPt * candPt;
+            sum_dEta      += dEta      * weight;
+            sum_dPhi      += dPhi      * weight;
+            sum_dEta2     += dEta*dEta * weight;
+            sum_dEta_dPhi += dEta*dPhi * weight;
+            sum_dPhi2     += dPhi*dPhi * weight;
+            sum_weight    += candPt * candPt;
+            sum_pt        += candPt;
+        }
+
+        sumPtDrSq_ += candPt * candPt * candDr * candDr;
+        sumPtSq_ += candPt * candPt;
+        if( candPt > 0.3 ) { ++numDaug03_; }
+        if( charge_[k] != 0 && candPt > leadTrackPt_ ) { leadTrackPt_ = candPt; }
+
+        if( ( pdgid == 11 || pdgid == 13 ) && candPt > softLepPt_ ) {
+            softLepPt_ = candPt;
+            softLepDr_ = candDr;
+            softLep = k;
+        }
+
+        size_t icone = std::lower_bound( coneBoundaries_.begin(), coneBoundaries_.end(), candDr ) - coneBoundaries_.begin();
+        if( pdgid == 22 || pdgid == 11 ) {
+            ringEnergies_[kEM][icone] += energy_[k];
+        } else if( pdgid == 13 ) {
+            ringEnergies_[kMuon][icone] += energy_[k];
+        } else if( charge_[k] != 0 ) {
+            ringEnergies_[kCharged][icone] += energy_[k];
+        } else {
+            ringEnergies_[kNeutral][icone] += energy_[k];
+        }
+    }
+
+    if( sum_weight > 0 ) {
+        ptD_ = sqrt( sum_weight ) / sum_pt;
+        float ave_dEta  = sum_dEta  / sum_weight;
+        float ave_dPhi  = sum_dPhi  / sum_weight;
+        float ave_dEta2 = sum_dEta2 / sum_weight;
+        float ave_dPhi2 = sum_dPhi2 / sum_weight;
+        float a = ave_dEta2 - ave_dEta * ave_dEta;
+        float b = ave_dPhi2 - ave_dPhi * ave_dPhi;
+        float c = -( sum_dEta_dPhi / sum_weight - ave_dEta * ave_dPhi );
+        float delta = sqrt( fabs( ( a - b ) * ( a - b ) + 4 * c * c ) );
+        if( a + b - delta > 0 ) { axis2_ = sqrt( 0.5 * ( a + b - delta ) ); }
+        if( a + b + delta > 0 ) { axis1_ = sqrt( 0.5 * ( a + b + delta ) ); }
+    }
+
+    if( softLep >= 0 ) {
+        const pat::PackedCandidate *lep = cands_[softLep];
+        softLepRatio_ = softLepPt_ / jet.pt();
+        softLepPtRel_ = ( jet.px() * lep->px() + jet.py() * lep->py() + jet.pz() * lep->pz() ) / jet.p();
+        softLepPtRel_ = sqrt( lep->p() * lep->p() - softLepPtRel_ * softLepPtRel_ );
+        softLepPtRelInv_ = ( jet.px() * lep->px() + jet.py() * lep->py() + jet.pz() * lep->pz() ) / lep->p();
+        softLepPtRelInv_ = sqrt( jet.p() * jet.p() - softLepPtRelInv_ * softLepPtRelInv_ );
+        softLepPdgId_ = pdgId_[softLep];
+    }
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
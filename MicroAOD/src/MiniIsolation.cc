@@ -0,0 +1,93 @@
+#include "flashgg/MicroAOD/interface/MiniIsolation.h"
+
+#include "DataFormats/Math/interface/deltaR.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace flashgg;
+
+// the cells get a 1% margin, so that a candidate right on the edge of the largest cone cannot fall
+// outside of the neighbouring cells through rounding
+MiniIsolation::MiniIsolation( double maxCone ) :
+    candidates_( nullptr ),
+    filled_( false ),
+    cells_( 1.01 * maxCone )
+{
+}
+
+void MiniIsolation::setCandidates( const edm::View<pat::PackedCandidate> &candidates )
+{
+    candidates_ = &candidates;
+    filled_ = false;
+}
+
+void MiniIsolation::fill()
+{
+    cells_.clear();
+    pt_.clear();
+    pdgId_.clear();
+    charge_.clear();
+    fromPV_.clear();
+    for( const auto &pfc : *candidates_ ) {
+        int pdgId = std::abs( pfc.pdgId() );
+        if( pdgId < 7 ) { continue; }
+        cells_.add( pfc.eta(), pfc.phi() );
+        pt_.push_back( pfc.pt() );
+        pdgId_.push_back( pdgId );
+        charge_.push_back( pfc.charge() );
+        fromPV_.push_back( pfc.fromPV() );
+    }
+    cells_.build();
+    filled_ = true;
+}
+
+double MiniIsolation::cone( double pt, double rMin, double rMax, double ktScale )
+{
+    return std::max( rMin, std::min( rMax, ktScale / pt ) );
+}
+
+MiniIsolation::Sums MiniIsolation::sums( double eta, double phi, double cone, const DeadCones &deadCones, double ptThresh,
+                                         double ptThreshPhotons2 )
+{
+    if( !filled_ ) { fill(); }
+    Sums sums;
+    cells_.neighbours( eta, phi, neighbours_ );
+    for( unsigned int j : neighbours_ ) {
+        double dr = reco::deltaR( cells_.eta( j ), cells_.phi( j ), eta, phi );
+        if( dr > cone ) { continue; }
+
+        double pt = pt_[j];
+        if( charge_[j] == 0 ) {
+            if( pt > ptThresh ) {
+                if( pdgId_[j] == 22 ) {
+                    if( dr < deadCones.ph ) { continue; }
+                    sums.ph += pt;
+                    if( pt > ptThreshPhotons2 ) { sums.ph2 += pt; }
+                } else if( pdgId_[j] == 130 ) {
+                    if( dr < deadCones.nh ) { continue; }
+                    sums.nh += pt;
+                }
+            }
+        } else if( fromPV_[j] > 1 ) {
+            if( pdgId_[j] == 211 ) {
+                if( dr < deadCones.ch ) { continue; }
+                sums.ch += pt;
+            }
+        } else {
+            if( pt > ptThresh ) {
+                if( dr < deadCones.pu ) { continue; }
+                sums.pu += pt;
+            }
+        }
+    }
+    return sums;
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -23,15 +23,20 @@ namespace flashgg {
         
         // book fillers for each category
         auto categories = cfg.getParameter<vector<edm::ParameterSet> >( "categories" );
-        for( auto &cat : categories ) {
-            auto name = cat.getUntrackedParameter<string>( "name", Form( "cat%lu", mvas_.size() ) );
+        mvas_.resize( classifier_.nCategories() );
+        for( size_t icat = 0; icat < categories.size(); ++icat ) {
+            auto &cat = categories[icat];
+            auto name = cat.getUntrackedParameter<string>( "name", Form( "cat%lu", icat ) );
+            // categories with the same name share the fillers of the first one
+            auto &fillers = mvas_[classifier_.categoryIndex( name )];
+            if( ! fillers.empty() ) { continue; }
             for( auto &toFill : toFill_ ) {                
                 if( cat.exists( std::get<0>( toFill ) ) ) { 
                     // if this category has a rule to fill the mva book the filler
-                    mvas_[name].push_back( new mva_type( cat.getParameter<edm::ParameterSet>( std::get<0>( toFill ) ), this ) );
+                    fillers.push_back( new mva_type( cat.getParameter<edm::ParameterSet>( std::get<0>( toFill ) ), this ) );
                 } else { 
                     // otherwise store a NULL pointer
-                    mvas_[name].push_back( 0 );
+                    fillers.push_back( 0 );
                 }
             }
         }
@@ -40,10 +45,10 @@ namespace flashgg {
     PhotonMVAComputer::~PhotonMVAComputer()
     {
         for( auto &mva  : mvas_ ) {
-            for( auto &func : mva.second ) {
+            for( auto &func : mva ) {
                 if( func != 0 ) { delete func; }
             }
-            mva.second.clear();
+            mva.clear();
         }
     }
 
@@ -51,24 +56,23 @@ namespace flashgg {
     {
         // check if the photon passes the preselection
         bool selected = selector_( pho );
-        auto isel = mvas_.end();
+        const std::vector<mva_type *> *isel = 0;
         if( selected ) {
             // if so, find the corresponding category and filler
-            auto cat = classifier_( pho );
-            isel = mvas_.find( cat.first );
+            isel = &mvas_[classifier_.classify( pho ).first];
             // if the candidated doesn't fall in any category mark it as not preselected
-            selected = ( isel != mvas_.end() );
+            selected = ( ! isel->empty() );
         }
 
         if( selected ) {
             // fill mva values if candidate passes preselection
             for( size_t imva = 0; imva < toFill_.size(); ++imva ) {
-                if( isel->second[imva] == 0 ) { 
+                if( ( *isel )[imva] == 0 ) { 
                     // if no filler is specified for some MVA set value to default
                     pho.addUserFloat( std::get<0>( toFill_[imva] ), std::get<1>( toFill_[imva] ) );
                 } else {
                     // otherwise evaluate the MVA
-                    pho.addUserFloat( std::get<0>( toFill_[imva] ), ( *isel->second[imva] )( pho ) );
+                    pho.addUserFloat( std::get<0>( toFill_[imva] ), ( *( *isel )[imva] )( pho ) );
                 }
             }
         } else {
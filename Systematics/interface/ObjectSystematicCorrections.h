@@ -0,0 +1,91 @@
+#ifndef FLASHgg_ObjectSystematicCorrections_h
+#define FLASHgg_ObjectSystematicCorrections_h
+
+#include "flashgg/Systematics/interface/BaseSystMethod.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flashgg {
+
+    // The per-object loops of ObjectSystematicProducer over its 1D and 2D systematic methods, kept apart from the
+    // EDProducer so that they can be run outside of an edm::Event (e.g. in Taggers/bin/systematicsBenchmark)
+    template <typename flashgg_object, typename param_var>
+    struct ObjectSystematicCorrections {
+        typedef std::pair<param_var, param_var> param_pair;
+        typedef BaseSystMethod<flashgg_object, param_var> Method;
+        typedef BaseSystMethod<flashgg_object, param_pair> Method2D;
+        typedef std::vector<std::shared_ptr<Method> > Methods;
+        typedef std::vector<std::shared_ptr<Method2D> > Methods2D;
+
+        // applies every method to y: corrToShift (1D) or corrToShift2D (2D) with its shift, the others centrally;
+        // the weights of the weight methods are set per label and their product is the central weight.
+        // At most one of corrToShift and corrToShift2D is set, the nominal object is made with neither
+        static void apply( flashgg_object &y, const Methods &corrections, const Methods2D &corrections2D,
+                           const std::shared_ptr<Method> &corrToShift, param_var syst_shift,
+                           const std::shared_ptr<Method2D> &corrToShift2D, param_pair syst_shift2D )
+        {
+            const param_pair zero2D( param_var( 0 ), param_var( 0 ) );
+            float theWeight = 1.;
+            for( unsigned int ncorr = 0; ncorr < corrections.size(); ncorr++ ) {
+                if( corrToShift == corrections.at( ncorr ) ) {
+                    corrections.at( ncorr )->applyCorrection( y, syst_shift );
+                } else if( corrections.at( ncorr )->makesWeight() ) {
+                    y.setWeight( corrections.at( ncorr )->shiftLabel( 0 ), corrections.at( ncorr )->makeWeight( y, param_var( 0 ) ) ); // use very carefully, n.b. not scaled
+                    theWeight *= corrections.at( ncorr )->makeWeight( y, param_var( 0 ) );
+                } else {
+                    corrections.at( ncorr )->applyCorrection( y, param_var( 0 ) );
+                }
+            }
+            for( unsigned int ncorr = 0; ncorr < corrections2D.size(); ncorr++ ) {
+                if( corrToShift2D == corrections2D.at( ncorr ) ) {
+                    corrections2D.at( ncorr )->applyCorrection( y, syst_shift2D );
+                } else if( corrections2D.at( ncorr )->makesWeight() ) {
+                    y.setWeight( corrections2D.at( ncorr )->shiftLabel( zero2D ), corrections2D.at( ncorr )->makeWeight( y, zero2D ) ); // use very carefully, n.b. not scaled
+                    theWeight *= corrections2D.at( ncorr )->makeWeight( y, zero2D );
+                } else {
+                    corrections2D.at( ncorr )->applyCorrection( y, zero2D );
+                }
+            }
+            y.setCentralWeight( theWeight );
+        }
+
+        // the weights of the weight methods for each of their shifts, relative to the central weight of y
+        static void applyNonCentralWeights( flashgg_object &y, const Methods &corrections, const Methods2D &corrections2D,
+                                            const std::vector<std::vector<param_var> > &sigmas,
+                                            const std::vector<std::vector<param_pair> > &sigmas2D )
+        {
+            const param_pair zero2D( param_var( 0 ), param_var( 0 ) );
+            for( unsigned int ncorr = 0; ncorr < corrections.size(); ncorr++ ) {
+                if( corrections.at( ncorr )->makesWeight() ) {
+                    for( const auto &sig : sigmas.at( ncorr ) ) {
+                        float weightAdjust = ( corrections.at( ncorr )->makeWeight( y, sig ) / corrections.at( ncorr )->makeWeight( y, param_var( 0 ) ) );
+                        std::string label = corrections.at( ncorr )->shiftLabel( sig );
+                        y.setWeight( label, weightAdjust * y.centralWeight() );
+                    }
+                }
+            }
+            for( unsigned int ncorr = 0; ncorr < corrections2D.size(); ncorr++ ) {
+                if( corrections2D.at( ncorr )->makesWeight() ) {
+                    for( const auto &sig : sigmas2D.at( ncorr ) ) {
+                        float weightAdjust = ( corrections2D.at( ncorr )->makeWeight( y, sig ) / corrections2D.at( ncorr )->makeWeight( y, zero2D ) );
+                        std::string label = corrections2D.at( ncorr )->shiftLabel( sig );
+                        y.setWeight( label, weightAdjust * y.centralWeight() );
+                    }
+                }
+            }
+        }
+    };
+}
+
+#endif
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
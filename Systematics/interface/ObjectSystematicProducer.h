@@ -11,8 +11,10 @@
 #include "TrackingTools/IPTools/interface/IPTools.h"
 
 #include "flashgg/Systematics/interface/BaseSystMethod.h"
+#include "flashgg/Systematics/interface/ObjectSystematicCorrections.h"
 
 #include "flashgg/MicroAOD/interface/GlobalVariablesComputer.h"
+#include "flashgg/MetaData/interface/JobProfiler.h"
 
 //#include <type_traits>
 //#include <typeinfo>
@@ -51,6 +53,11 @@ namespace flashgg {
         std::vector<std::string> collectionLabelsNonCentral_;
 
         std::vector<std::vector<pair<param_var, param_var> > > sigmas2D_;
+
+        // with the JobProfiler service: one timer per systematic method (1D then 2D), covering its event
+        // initialization and the building of its shifted collections, and one for the central collection
+        ProfilerSubTimers subTimers_;
+        unsigned int centralTimer_;
     };
 
     template <typename flashgg_object, typename param_var, template <typename...> class output_container>
@@ -139,6 +146,10 @@ namespace flashgg {
 
             ipset2D++;
         }
+
+        for( const auto &corr : Corrections_ ) { subTimers_.add( corr->label() ); }
+        for( const auto &corr : Corrections2D_ ) { subTimers_.add( corr->label() ); }
+        centralTimer_ = subTimers_.add( "central" );
     }
 
     ///fucntion takes in the current corection one is looping through and compares with its own internal loop, given that this will be within the corr and sys loop it takes care of the 2n+1 collection number////
@@ -147,43 +158,7 @@ namespace flashgg {
             shared_ptr<BaseSystMethod<flashgg_object, param_var> > CorrToShift,
             param_var syst_shift )
     {
-        float theWeight = 1.;
-        //        std::cout << " 1d before 1d " << std::endl;
-        //        std::cout << " In ObjectSystematicProducer::ApplyCorrections pt m " << y.pt() << " " << y.mass() << std::endl;
-        for( unsigned int ncorr = 0; ncorr < Corrections_.size(); ncorr++ ) {
-            if( CorrToShift == Corrections_.at( ncorr ) ) {
-                Corrections_.at( ncorr )->applyCorrection( y, syst_shift );
-            } else if( Corrections_.at( ncorr )->makesWeight() ) {
-                //                std::cout << " Setting weight for " << Corrections_.at( ncorr )->shiftLabel( 0 ) <<
-                //                    " to " << Corrections_.at( ncorr )->makeWeight( y, param_var( 0 ) ) << std::endl;
-                y.setWeight( Corrections_.at( ncorr )->shiftLabel( 0 ), Corrections_.at( ncorr )->makeWeight( y, param_var( 0 ) ) ); // use very carefully, n.b. not scaled
-                theWeight *= Corrections_.at( ncorr )->makeWeight( y, param_var( 0 ) );
-            } else {
-                Corrections_.at( ncorr )->applyCorrection( y, param_var( 0 ) );
-            }
-        }
-        //        std::cout << " 1d before 2d " << std::endl;
-        for( unsigned int ncorr = 0; ncorr < Corrections2D_.size(); ncorr++ ) {
-            //            std::cout << " 2d ncorr=" << ncorr << "/" << Corrections2D_.size() << std::endl;
-            if( Corrections2D_.at( ncorr )->makesWeight() ) {
-                y.setWeight( Corrections2D_.at( ncorr )->shiftLabel( PAIR_ZERO ), Corrections2D_.at( ncorr )->makeWeight( y, PAIR_ZERO ) ); // use very carefully, n.b. not scaled
-                theWeight *= Corrections2D_.at( ncorr )->makeWeight( y, PAIR_ZERO );
-                //                std::cout << " 2d changed the weight to" << theWeight << std::endl;
-                //                std::cout << "    " << Corrections2D_.at( ncorr )->shiftLabel( PAIR_ZERO ) << std::endl;
-            } else {
-                Corrections2D_.at( ncorr )->applyCorrection( y, PAIR_ZERO );
-                //                std::cout << " 2d applied correction " << std::endl;
-                //                std::cout << "    " << Corrections2D_.at( ncorr )->shiftLabel( PAIR_ZERO ) << std::endl;
-            }
-        }
-        //        std::cout << " Applied a central weight of " << theWeight << " - as part of 1d shift" << std::endl;
-        //        if( CorrToShift == nullptr ) {
-        //            std::cout << "   Shift was central " << std::endl;
-        //        } else {
-        //            std::cout << "   Shift was " << CorrToShift->shiftLabel( syst_shift ) << std::endl;
-        //        }
-        y.setCentralWeight( theWeight );
-        //        std::cout << " 1d end " << std::endl;
+        ObjectSystematicCorrections<flashgg_object, param_var>::apply( y, Corrections_, Corrections2D_, CorrToShift, syst_shift, nullptr, PAIR_ZERO );
     }
 
     template <typename flashgg_object, typename param_var, template <typename...> class output_container>
@@ -191,58 +166,13 @@ namespace flashgg {
             shared_ptr<BaseSystMethod<flashgg_object, pair<param_var, param_var> > > CorrToShift,
             pair<param_var, param_var>  syst_shift )
     {
-        float theWeight = 1.;
-        //        std::cout << " In ObjectSystematicProducer::ApplyCorrections pt m " << y.pt() << " " << y.mass() << std::endl;
-        //        std::cout << "2d before 1d" << std::endl;
-        for( unsigned int ncorr = 0; ncorr < Corrections_.size(); ncorr++ ) {
-            if( Corrections_.at( ncorr )->makesWeight() ) {
-                //                std::cout << " Setting weight for " << Corrections_.at( ncorr )->shiftLabel( 0 ) << 
-                //                    " to " << Corrections_.at( ncorr )->makeWeight( y, param_var( 0 ) ) << std::endl;
-                y.setWeight( Corrections_.at( ncorr )->shiftLabel( 0 ), Corrections_.at( ncorr )->makeWeight( y, param_var( 0 ) ) ); // use very carefully, n.b. not scaled
-                theWeight *= Corrections_.at( ncorr )->makeWeight( y, param_var( 0 ) );
-            } else {
-                Corrections_.at( ncorr )->applyCorrection( y, param_var( 0 ) );
-            }
-        }
-        //        std::cout << "2d before 2d" << std::endl;
-        for( unsigned int ncorr = 0; ncorr < Corrections2D_.size(); ncorr++ ) {
-            if( CorrToShift == Corrections2D_.at( ncorr ) ) {
-                Corrections2D_.at( ncorr )->applyCorrection( y, syst_shift );
-            } else if( Corrections2D_.at( ncorr )->makesWeight() ) {
-                y.setWeight( Corrections2D_.at( ncorr )->shiftLabel( PAIR_ZERO ),
-                             Corrections2D_.at( ncorr )->makeWeight( y, PAIR_ZERO ) ); // use very carefully, n.b. not scaled        
-                theWeight *= Corrections2D_.at( ncorr )->makeWeight( y, PAIR_ZERO );
-            } else {
-                Corrections2D_.at( ncorr )->applyCorrection( y, PAIR_ZERO );
-            }
-        }
-        y.setCentralWeight( theWeight );
-        //        std::cout << " Applied a central weight of " << theWeight << " - as part of 2d shift" << std::endl;
+        ObjectSystematicCorrections<flashgg_object, param_var>::apply( y, Corrections_, Corrections2D_, nullptr, param_var( 0 ), CorrToShift, syst_shift );
     }
 
     template <typename flashgg_object, typename param_var, template <typename...> class output_container>
     void ObjectSystematicProducer<flashgg_object, param_var, output_container>::ApplyNonCentralWeights( flashgg_object &y )
     {
-        for( unsigned int ncorr = 0; ncorr < Corrections_.size(); ncorr++ ) {
-            if( Corrections_.at( ncorr )->makesWeight() ) {
-                for( const auto &sig : sigmas_.at( ncorr ) ) {
-                    float weightAdjust = ( Corrections_.at( ncorr )->makeWeight( y, sig ) / Corrections_.at( ncorr )->makeWeight( y, param_var( 0 ) ) );
-                    std::string label = Corrections_.at( ncorr )->shiftLabel( sig );
-                    y.setWeight( label, weightAdjust * y.centralWeight() );
-                    //                    std::cout << " Applying 1d non-central weight " << label << " of " << y.weight( label ) << " - pt eta " << y.pt() << " " << y.eta() << std::endl;
-                }
-            }
-        }
-        for( unsigned int ncorr = 0; ncorr < Corrections2D_.size(); ncorr++ ) {
-            if( Corrections2D_.at( ncorr )->makesWeight() ) {
-                for( const auto &sig : sigmas2D_.at( ncorr ) ) {
-                    float weightAdjust = ( Corrections2D_.at( ncorr )->makeWeight( y, sig ) / Corrections2D_.at( ncorr )->makeWeight( y, PAIR_ZERO ) );
-                    std::string label = Corrections2D_.at( ncorr )->shiftLabel( sig );
-                    y.setWeight( label, weightAdjust * y.centralWeight() );
-                    //                    std::cout << " Applying 2d non-central weight " << label << " of " << y.weight( label ) << " - pt eta " << y.pt() << " " << y.eta() << std::endl;
-                }
-            }
-        }
+        ObjectSystematicCorrections<flashgg_object, param_var>::applyNonCentralWeights( y, Corrections_, Corrections2D_, sigmas_, sigmas2D_ );
     }
 
     template <typename flashgg_object, typename param_var, template <typename...> class output_container>
@@ -253,15 +183,20 @@ namespace flashgg {
         evt.getByToken( ObjectToken_, objects );
 
         for( unsigned int ncorr = 0 ; ncorr < Corrections_.size() ; ncorr++ ) {
+            subTimers_.start( ncorr );
             Corrections_.at( ncorr )->eventInitialize( evt, setup );
+            subTimers_.stop( ncorr );
         }
         for( unsigned int ncorr = 0 ; ncorr < Corrections2D_.size() ; ncorr++ ) {
+            subTimers_.start( Corrections_.size() + ncorr );
             Corrections2D_.at( ncorr )->eventInitialize(evt, setup );
+            subTimers_.stop( Corrections_.size() + ncorr );
         }
 
         globalVars_.update(evt);
         
         // Build central collection
+        subTimers_.start( centralTimer_ );
         std::vector<float> centralWeights;
         unique_ptr<output_container<flashgg_object> > centralObjectColl( new output_container<flashgg_object> );
         for( unsigned int i = 0; i < objects->size(); i++ ) {
@@ -274,6 +209,7 @@ namespace flashgg {
             centralObjectColl->push_back( obj );
         }
         evt.put( std::move(centralObjectColl) ); // put central collection in event
+        subTimers_.stop( centralTimer_ );
 
         //        std::cout << " after producing central" << std::endl;
 
@@ -294,6 +230,7 @@ namespace flashgg {
                 for( const auto &sig : sigmas_.at( ncorr ) ) {
                     //                    std::cout << i << " " << ncoll << " " << sig << std::endl;
                     if( !Corrections_.at( ncorr )->makesWeight() ) {
+                        subTimers_.start( ncorr );
                         flashgg_object *p_obj = objects->ptrAt( i )->clone();
                         flashgg_object obj = *p_obj;
                         delete p_obj;
@@ -301,6 +238,7 @@ namespace flashgg {
                         obj.setCentralWeight( centralWeights[i] );
                         all_shifted_collections[ncoll]->push_back( obj );
                         ncoll++;
+                        subTimers_.stop( ncorr );
                     }
                 }
             }
@@ -308,6 +246,7 @@ namespace flashgg {
                 for( const auto &sig : sigmas2D_.at( ncorr ) ) {
                     //                    std::cout << i << " " << ncoll << " " << sig.first << " " << sig.second << std::endl;
                     if( !Corrections_.at( ncorr )->makesWeight() ) {
+                        subTimers_.start( Corrections_.size() + ncorr );
                         flashgg_object *p_obj = objects->ptrAt( i )->clone();
                         flashgg_object obj = *p_obj;
                         delete p_obj;
@@ -315,6 +254,7 @@ namespace flashgg {
                         obj.setCentralWeight( centralWeights[i] );
                         all_shifted_collections[ncoll]->push_back( obj );
                         ncoll++;
+                        subTimers_.stop( Corrections_.size() + ncorr );
                     }
                 }
             }
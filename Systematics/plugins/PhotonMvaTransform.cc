@@ -2,6 +2,7 @@
 #include "DataFormats/Common/interface/Handle.h"
 #include "DataFormats/Common/interface/PtrVector.h"
 #include "flashgg/DataFormats/interface/Photon.h"
+#include "flashgg/MicroAOD/interface/GraphLookupTable.h"
 #include "CommonTools/Utils/interface/StringCutObjectSelector.h"
 
 #include "TGraph.h"
@@ -22,7 +23,8 @@ namespace flashgg {
     private:
         selector_type overall_range_;
         edm::FileInPath correctionFile_;
-        std::vector<std::unique_ptr<TGraph> > corrections_;
+        std::vector<GraphLookupTable> corrections_;
+        std::vector<double> mvaVals_, correctedVals_;
     };
 
     PhotonMvaTransform::PhotonMvaTransform( const edm::ParameterSet &conf, edm::ConsumesCollector && iC, const GlobalVariablesComputer *gv ) :
@@ -33,10 +35,9 @@ namespace flashgg {
         std::cout<<correctionFile_.fullPath().c_str()<<std::endl;
         TFile* f = TFile::Open(correctionFile_.fullPath().c_str());
         //        f->Print();
-        corrections_.emplace_back( (TGraph*)((TGraph*) f->Get("trasfhebup"))->Clone());
-        corrections_.emplace_back((TGraph*)((TGraph*) f->Get("trasfhebdown"))->Clone() );
-        corrections_.emplace_back((TGraph*)((TGraph*) f->Get("trasfheeup"))->Clone() );
-        corrections_.emplace_back((TGraph*)((TGraph*) f->Get("trasfheedown"))->Clone() );
+        for( auto name : { "trasfhebup", "trasfhebdown", "trasfheeup", "trasfheedown" } ) {
+            corrections_.emplace_back( *( (TGraph*) f->Get( name ) ) );
+        }
         f->Close();
     }
 
@@ -87,13 +88,16 @@ namespace flashgg {
                 }
                 std::cout << std::endl;
             }
-            edm::Ptr<reco::Vertex> vtx;
-            float shift =0., mvaVal=0.;
+            mvaVals_.clear();
             for(auto keyval = beforeMap.begin(); keyval != beforeMap.end(); ++keyval) {
-                vtx = keyval->first;
-                mvaVal = keyval->second;
-                shift = shift_val + (mvaVal - corrections_[correctionIndex]->Eval(mvaVal))*abs(syst_shift);
-                y.shiftMvaValueBy(shift, vtx);
+                mvaVals_.push_back( keyval->second );
+            }
+            correctedVals_.resize( mvaVals_.size() );
+            corrections_[correctionIndex].eval( mvaVals_.data(), correctedVals_.data(), mvaVals_.size() );
+            size_t ival = 0;
+            for(auto keyval = beforeMap.begin(); keyval != beforeMap.end(); ++keyval, ++ival) {
+                float shift = shift_val + (mvaVals_[ival] - correctedVals_[ival])*abs(syst_shift);
+                y.shiftMvaValueBy(shift, keyval->first);
             }
             if ( debug_) {
                 auto afterMap = y.phoIdMvaD();
@@ -113,7 +113,7 @@ class DoubleHCustomize():
         from flashgg.Taggers.flashggTags_cff import UnpackedJetCollectionVInputTag
 
         ## customize here (regression, kin-fit, MVA...)
-        if self.customize.doBJetRegression : process.flashggDoubleHTag.JetTags = cms.VInputTag( ["bRegProducer%d" % icoll for icoll,coll in enumerate(UnpackedJetCollectionVInputTag) ] )
+        if self.customize.doBJetRegression : process.flashggDoubleHCleanedObjects.inputTagJets = cms.VInputTag( [cms.InputTag("bRegProducer",str(icoll)) for icoll,coll in enumerate(UnpackedJetCollectionVInputTag) ] )
 
        # if customize.doubleHReweightTarget != -1:
        #     process.load("flashgg.Taggers.flashggDoubleHReweight_cfi")
@@ -125,6 +125,7 @@ class DoubleHCustomize():
         if self.customize.doubleHTagsOnly:
             process.flashggTagSequence.remove(process.flashggVBFTag)
             process.flashggTagSequence.remove(process.flashggTTHLeptonicTag)
+            process.flashggTagSequence.remove(process.flashggTTHDiLeptonTag)
             process.flashggTagSequence.remove(process.flashggTTHHadronicTag)
             process.flashggTagSequence.remove(process.flashggVHEtTag)
             process.flashggTagSequence.remove(process.flashggVHLooseTag)
@@ -134,6 +135,7 @@ class DoubleHCustomize():
             process.flashggTagSequence.remove(process.flashggZHLeptonicTag)
             process.flashggTagSequence.remove(process.flashggVHLeptonicLooseTag)
             process.flashggTagSequence.remove(process.flashggVHHadronicTag)
+            process.flashggTagSequence.remove(process.flashggDiPhotonCleanedObjects)
             process.flashggTagSequence.remove(process.flashggVBFMVA)
             process.flashggTagSequence.remove(process.flashggVBFDiPhoDiJetMVA)
 
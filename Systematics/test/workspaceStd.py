@@ -125,6 +125,12 @@ customize.options.register('verboseSystDump',
                            VarParsing.VarParsing.varType.bool,
                            'verboseSystDump'
                            )
+customize.options.register('runTagsOnDemand',
+                           False,
+                           VarParsing.VarParsing.multiplicity.singleton,
+                           VarParsing.VarParsing.varType.bool,
+                           'runTagsOnDemand'
+                           )
 
 
 print "Printing defaults"
@@ -596,24 +602,11 @@ else :
 
 if customize.doBJetRegression:
 
-    bregProducers = []
-    bregJets = []
-    
-    from flashgg.Taggers.flashggTags_cff import UnpackedJetCollectionVInputTag
-    from flashgg.Taggers.flashggbRegressionProducer_cfi import flashggbRegressionProducer
-    recoJetCollections = UnpackedJetCollectionVInputTag
+    from flashgg.Taggers.flashggbRegressionProducer_cfi import flashggbRegressionProducerAllCollections
 
-
-    for icoll,coll in enumerate(recoJetCollections):
-        print "doing icoll "+str(icoll)
-
-        producer = flashggbRegressionProducer.clone(JetTag = coll)
-
-        setattr(process,"bRegProducer%d" %icoll,producer)
-        bregProducers.append(producer)
-        bregJets.append("bRegProducer%d" %icoll)
-            
-    process.bregProducers = cms.Sequence(reduce(lambda x,y: x+y, bregProducers))
+    # one producer for all the collections, so that all the jets in the event are regressed in a single batch
+    process.bRegProducer = flashggbRegressionProducerAllCollections.clone()
+    process.bregProducers = cms.Sequence(process.bRegProducer)
 #    process.bbggtree.inputTagJets=cms.VInputTag(bregJets)
     process.p.replace(process.jetSystematicsSequence,process.jetSystematicsSequence*process.flashggUnpackedJets+process.bregProducers)
 
@@ -703,6 +696,10 @@ if customize.verboseSystDump:
     turnOnAllSystematicsDebug(process)
     customize.maxEVents = 10
 
+if customize.runTagsOnDemand:
+    from flashgg.Taggers.flashggTagSequence_cfi import runTagProducersOnDemand
+    runTagProducersOnDemand(process,process.p)
+
 ##############
 ## Dump EDM ##
 ##############
@@ -0,0 +1,111 @@
+// CPU benchmark of the b-jet regression NN: per-jet vs batched evaluation,
+// as done in flashggbRegressionProducer, on synthetic jets.
+//
+// usage: bRegressionBenchmark <model.pb> [nEvents=1000] [jetsPerEvent=60] [intraOpThreads=1] [interOpThreads=1]
+
+#include "PhysicsTools/TensorFlow/interface/TensorFlow.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    const unsigned int nInputs = 43;
+    const unsigned int nOutputs = 3;
+
+    double runPerJet( tensorflow::Session *session, const std::vector<float> &inputs, unsigned int nJets, std::vector<float> &outputs )
+    {
+        auto start = std::chrono::steady_clock::now();
+        for( unsigned int ijet = 0 ; ijet < nJets ; ijet++ ) {
+            tensorflow::Tensor input( tensorflow::DT_FLOAT, {1, nInputs} );
+            std::copy( &inputs[ijet * nInputs], &inputs[( ijet + 1 ) * nInputs], input.flat<float>().data() );
+            std::vector<tensorflow::Tensor> result;
+            tensorflow::run( session, { { "ffwd_inp:0", input } }, { "ffwd_out/BiasAdd:0" }, &result );
+            for( unsigned int iout = 0 ; iout < nOutputs ; iout++ ) {
+                outputs[ijet * nOutputs + iout] = result[0].matrix<float>()( 0, iout );
+            }
+        }
+        return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    double runBatched( tensorflow::Session *session, const std::vector<float> &inputs, unsigned int nJets, std::vector<float> &outputs )
+    {
+        auto start = std::chrono::steady_clock::now();
+        tensorflow::Tensor input( tensorflow::DT_FLOAT, {nJets, nInputs} );
+        std::copy( inputs.begin(), inputs.begin() + nJets * nInputs, input.flat<float>().data() );
+        std::vector<tensorflow::Tensor> result;
+        tensorflow::run( session, { { "ffwd_inp:0", input } }, { "ffwd_out/BiasAdd:0" }, &result );
+        auto matrix = result[0].matrix<float>();
+        for( unsigned int ijet = 0 ; ijet < nJets ; ijet++ ) {
+            for( unsigned int iout = 0 ; iout < nOutputs ; iout++ ) {
+                outputs[ijet * nOutputs + iout] = matrix( ijet, iout );
+            }
+        }
+        return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    if( argc < 2 ) {
+        std::cerr << "usage: " << argv[0] << " <model.pb> [nEvents=1000] [jetsPerEvent=60] [intraOpThreads=1] [interOpThreads=1]" << std::endl;
+        return 1;
+    }
+    std::string modelFile = argv[1];
+    unsigned int nEvents = ( argc > 2 ? atoi( argv[2] ) : 1000 );
+    unsigned int jetsPerEvent = ( argc > 3 ? atoi( argv[3] ) : 60 );
+    int intraOpThreads = ( argc > 4 ? atoi( argv[4] ) : 1 );
+    int interOpThreads = ( argc > 5 ? atoi( argv[5] ) : 1 );
+
+    tensorflow::setLogging( "3" );
+    tensorflow::GraphDef *graphDef = tensorflow::loadGraphDef( modelFile );
+    tensorflow::SessionOptions sessionOptions;
+    sessionOptions.config.set_intra_op_parallelism_threads( intraOpThreads );
+    sessionOptions.config.set_inter_op_parallelism_threads( interOpThreads );
+    tensorflow::Session *session = tensorflow::createSession( graphDef, sessionOptions );
+
+    // synthetic jets: a fixed seed keeps the inputs identical from run to run;
+    // the number of jets per event (summed over the vertex collections) fluctuates around jetsPerEvent
+    std::mt19937 rng( 12345 );
+    std::uniform_real_distribution<float> feature( 0., 1. );
+    std::poisson_distribution<unsigned int> multiplicity( jetsPerEvent );
+
+    std::vector<float> inputs, perJetOutputs, batchedOutputs;
+    double perJetTime = 0., batchedTime = 0., maxDiff = 0.;
+    unsigned long totJets = 0;
+    for( unsigned int ievent = 0 ; ievent < nEvents ; ievent++ ) {
+        unsigned int nJets = std::max( 1u, multiplicity( rng ) );
+        inputs.resize( nJets * nInputs );
+        for( auto &x : inputs ) { x = feature( rng ); }
+        perJetOutputs.resize( nJets * nOutputs );
+        batchedOutputs.resize( nJets * nOutputs );
+
+        perJetTime += runPerJet( session, inputs, nJets, perJetOutputs );
+        batchedTime += runBatched( session, inputs, nJets, batchedOutputs );
+        for( unsigned int iout = 0 ; iout < perJetOutputs.size() ; iout++ ) {
+            maxDiff = std::max( maxDiff, ( double )std::abs( perJetOutputs[iout] - batchedOutputs[iout] ) );
+        }
+        totJets += nJets;
+    }
+
+    std::cout << "events: " << nEvents << " jets: " << totJets << " threads (intra/inter): " << intraOpThreads << "/" << interOpThreads << std::endl;
+    std::cout << "per-jet : " << perJetTime / totJets << " ns/jet, " << 1.e9 * nEvents / perJetTime << " events/s" << std::endl;
+    std::cout << "batched : " << batchedTime / totJets << " ns/jet, " << 1.e9 * nEvents / batchedTime << " events/s" << std::endl;
+    std::cout << "speed-up: " << perJetTime / batchedTime << " max output difference: " << maxDiff << std::endl;
+
+    tensorflow::closeSession( session );
+    delete graphDef;
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,149 @@
+// CPU benchmark of the per-candidate work of the dumpers and of the diphoton MVA on synthetic photons:
+// CategoryDumper::fill into a RooDataSet, with the string expressions of a typical photon dumper, and the
+// TMVA evaluation of the diphoton BDT as done in DiPhotonMVAProducer ("new" variables).
+// Only the RooDataSet output is exercised: the TTree and histogram outputs need the TFileService.
+// The BDT weights are read through FileInPath: run it from a CMSSW area.
+//
+// usage: dumperMvaBenchmark [nEvents=20000] [photonsPerEvent=2]
+
+#include "FWCore/FWLite/interface/FWLiteEnabler.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/FileInPath.h"
+#include "CommonTools/Utils/interface/StringObjectFunction.h"
+
+#include "flashgg/DataFormats/interface/Photon.h"
+#include "flashgg/Taggers/interface/CategoryDumper.h"
+#include "flashgg/Taggers/interface/GlobalVariablesDumper.h"
+
+#include "RooWorkspace.h"
+#include "TMVA/Reader.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    double elapsed( std::chrono::steady_clock::time_point start )
+    {
+        return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    typedef flashgg::CategoryDumper<StringObjectFunction<flashgg::Photon, true>, flashgg::Photon> PhotonCategoryDumper;
+}
+
+int main( int argc, char *argv[] )
+{
+    FWLiteEnabler::enable();
+
+    for( int i = 1; i < argc; ++i ) {
+        if( atoi( argv[i] ) < 1 ) {
+            std::cerr << "usage: " << argv[0] << " [nEvents=20000] [photonsPerEvent=2]" << std::endl << "all the counts must be at least 1" << std::endl;
+            return 1;
+        }
+    }
+    unsigned int nEvents = ( argc > 1 ? atoi( argv[1] ) : 20000 );
+    unsigned int nPhotons = ( argc > 2 ? atoi( argv[2] ) : 2 );
+
+    // fixed seed: identical events from run to run
+    std::mt19937 rng( 12345 );
+    std::uniform_real_distribution<double> ptDist( 20., 150. ), etaDist( -2.5, 2.5 ), phiDist( -M_PI, M_PI ), flat( 0., 1. );
+
+    // name := expression, as in the dumper configurations
+    std::vector<std::pair<std::string, std::string> > expressions = {
+        { "pt", "pt" }, { "eta", "eta" }, { "phi", "phi" }, { "energy", "energy" },
+        { "r9", "full5x5_r9" }, { "hoe", "hadronicOverEm" }, { "phoIso", "pfPhoIso03" }, { "chIso", "egChargedHadronIso" },
+        { "eleVeto", "passElectronVeto" }, { "ptOverE", "pt/energy" }, { "scaledEnergy", "userFloat('scale')" }
+    };
+    std::vector<edm::ParameterSet> variables;
+    for( const auto &expr : expressions ) {
+        edm::ParameterSet var;
+        var.addParameter<std::string>( "expr", expr.second );
+        var.addUntrackedParameter<std::string>( "name", expr.first );
+        variables.push_back( var );
+    }
+    edm::ParameterSet dumperConfig;
+    dumperConfig.addParameter<std::vector<edm::ParameterSet> >( "variables", variables );
+    dumperConfig.addParameter<std::vector<edm::ParameterSet> >( "histograms", std::vector<edm::ParameterSet>() );
+
+    flashgg::GlobalVariablesDumper globalDumper( ( edm::ParameterSet() ) );
+    PhotonCategoryDumper dumper( "photons_13TeV_all", dumperConfig, &globalDumper );
+    RooWorkspace ws( "cms_hgg_13TeV", "cms_hgg_13TeV" );
+    ws.factory( "weight[1.]" );
+    dumper.bookRooDataset( ws, "weight", std::map<std::string, std::string>() );
+
+    float leadptom, subleadptom, leadmva, subleadmva, leadeta, subleadeta, sigmarv, sigmawv, CosPhi, vtxprob;
+    TMVA::Reader reader( "!Color:Silent" );
+    reader.AddVariable( "leadptom", &leadptom );
+    reader.AddVariable( "subleadptom", &subleadptom );
+    reader.AddVariable( "leadmva", &leadmva );
+    reader.AddVariable( "subleadmva", &subleadmva );
+    reader.AddVariable( "leadeta", &leadeta );
+    reader.AddVariable( "subleadeta", &subleadeta );
+    reader.AddVariable( "sigmarv", &sigmarv );
+    reader.AddVariable( "sigmawv", &sigmawv );
+    reader.AddVariable( "CosPhi", &CosPhi );
+    reader.AddVariable( "vtxprob", &vtxprob );
+    reader.BookMVA( "BDT", edm::FileInPath( "flashgg/Taggers/data/Flashgg_DiPhoton_BDTG.weights.xml" ).fullPath() );
+
+    double fillTime = 0., mvaTime = 0.;
+    unsigned long nFilled = 0, nDiphotons = 0;
+    double checksum = 0.;
+    std::vector<double> noPdfWeights;
+
+    for( unsigned int ievent = 0; ievent < nEvents; ++ievent ) {
+        std::vector<flashgg::Photon> photons( nPhotons );
+        for( auto &photon : photons ) {
+            photon.setP4( reco::Candidate::LorentzVector( reco::Candidate::PolarLorentzVector( ptDist( rng ), etaDist( rng ), phiDist( rng ), 0. ) ) );
+            photon.updateEnergy( "scale", ( 0.99 + 0.02 * flat( rng ) ) * photon.energy() );
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for( const auto &photon : photons ) { dumper.fill( photon, 1., noPdfWeights ); }
+        fillTime += elapsed( start );
+        nFilled += photons.size();
+
+        // diphoton variables from the two leading photons, the photon ids and resolutions drawn flat
+        if( photons.size() < 2 ) { continue; }
+        const flashgg::Photon &g1 = photons[0], &g2 = photons[1];
+        double mass = ( g1.p4() + g2.p4() ).mass();
+        leadptom = g1.pt() / mass;
+        subleadptom = g2.pt() / mass;
+        leadmva = -0.2 + 1.2 * flat( rng );
+        subleadmva = -0.2 + 1.2 * flat( rng );
+        leadeta = g1.eta();
+        subleadeta = g2.eta();
+        sigmarv = 0.005 + 0.02 * flat( rng );
+        sigmawv = sigmarv + 0.01 * flat( rng );
+        CosPhi = std::cos( g1.phi() - g2.phi() );
+        vtxprob = flat( rng );
+
+        start = std::chrono::steady_clock::now();
+        checksum += reader.EvaluateMVA( "BDT" );
+        mvaTime += elapsed( start );
+        ++nDiphotons;
+    }
+
+    std::cout << "events: " << nEvents << " photons: " << nFilled << " dumped variables: " << expressions.size()
+              << " dataset entries: " << ws.data( "photons_13TeV_all" )->numEntries() << std::endl;
+    std::cout << "CategoryDumper::fill (RooDataSet): " << fillTime / nFilled << " ns/photon (" << fillTime / ( nFilled * expressions.size() )
+              << " ns/variable)" << std::endl;
+    if( nDiphotons > 0 ) {
+        std::cout << "diphoton BDT evaluation          : " << mvaTime / nDiphotons << " ns/diphoton" << std::endl;
+    }
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -6,21 +6,59 @@
 #include <iostream>
 #include "../src/WorkspaceCombiner.cc"
 #include <vector>
+#include <cstdlib>
 
 
+void usage( const char *name )
+{
+    cout << "usage: " << name << " [-j nWorkers] [-n filesPerMerge] [-t] [-v] output.root input1.root [input2.root ...]" << endl;
+    cout << "  -j: number of merges run in parallel (default 1: serial merge)" << endl;
+    cout << "  -n: number of input files per first-level merge (default: one chunk per worker);" << endl;
+    cout << "      it does not bound the memory, the last merge still holds all the datasets" << endl;
+    cout << "  -t: merge trees and histograms as well (with -j/-n: separate pass after the workspaces)" << endl;
+    cout << "  -v: verbose printout" << endl;
+}
+
 int main( int argc, char *argv[] )
 {
     bool doTreesAndHistograms = false;
+    bool verbose = false;
+    unsigned int nWorkers = 1, filesPerMerge = 0;
+
+    int arg = 1;
+    for( ; arg < argc && argv[arg][0] == '-'; arg++ ) {
+        string opt = argv[arg];
+        if( ( opt == "-j" || opt == "-n" ) && arg + 1 < argc ) {
+            ( opt == "-j" ? nWorkers : filesPerMerge ) = atoi( argv[++arg] );
+        } else if( opt == "-t" ) {
+            doTreesAndHistograms = true;
+        } else if( opt == "-v" ) {
+            verbose = true;
+        } else {
+            usage( argv[0] );
+            return 1;
+        }
+    }
+    if( argc - arg < 2 ) {
+        usage( argv[0] );
+        return 1;
+    }
 
     std::vector<string> input;
-    std::string outputfile = argv[1];
+    std::string outputfile = argv[arg];
 
-    for( int f = 2; f < argc; f++ ) { input.push_back( argv[f] ); }
+    for( int f = arg + 1; f < argc; f++ ) { input.push_back( argv[f] ); }
 
     WorkspaceCombiner merger;
+    merger.SetVerbose( verbose );
 
     merger.Init( outputfile, input );
 
+    if( nWorkers > 1 || filesPerMerge > 0 ) {
+        cout << "Merging " << input.size() << " files with " << nWorkers << " workers" << endl;
+        return ( merger.MergeParallel( nWorkers, filesPerMerge, doTreesAndHistograms ) ? 0 : 1 );
+    }
+
     cout << endl << "Initialization" << endl << endl;
 
     merger.GetWorkspaces( merger.GetFirstFile() );
@@ -0,0 +1,137 @@
+// CPU benchmark of the matching of the reclustered jets to the MINIAOD jets done in JetProducer:
+// nested loop vs EtaPhiBucketMatcher, and "mini_" key building per jet vs cached key table,
+// on synthetic high-pileup events.
+//
+// usage: jetMatchingBenchmark [nEvents=200] [miniaodJets=150] [jetsPerCollection=150] [nCollections=12] [userFloats=40]
+
+#include "flashgg/MicroAOD/interface/EtaPhiBucketMatcher.h"
+#include "DataFormats/Math/interface/deltaR.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    struct EtaPhi {
+        double eta, phi;
+    };
+
+    double elapsed( std::chrono::steady_clock::time_point start )
+    {
+        return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    unsigned int nEvents = ( argc > 1 ? atoi( argv[1] ) : 200 );
+    unsigned int nMiniaod = ( argc > 2 ? atoi( argv[2] ) : 150 );
+    unsigned int nJets = ( argc > 3 ? atoi( argv[3] ) : 150 );
+    unsigned int nCollections = ( argc > 4 ? atoi( argv[4] ) : 12 );
+    unsigned int nUserFloats = ( argc > 5 ? atoi( argv[5] ) : 40 );
+
+    // fixed seed: identical events from run to run
+    std::mt19937 rng( 12345 );
+    std::uniform_real_distribution<double> etaDist( -4.7, 4.7 ), phiDist( -M_PI, M_PI ), smear( -0.03, 0.03 );
+    std::uniform_int_distribution<int> coin( 0, 3 );
+
+    std::vector<std::string> names;
+    for( unsigned int k = 0; k < nUserFloats; ++k ) { names.push_back( "pileupJetIdUpdated:variable" + std::to_string( k ) ); }
+
+    flashgg::EtaPhiBucketMatcher matcher( 0.1 );
+    std::vector<unsigned int> matches, loopMatches;
+    std::vector<std::string> keys, cachedNames, cachedKeys;
+    double loopTime = 0., bucketTime = 0., concatTime = 0., tableTime = 0.;
+    unsigned long nMatched = 0, nQueries = 0, nDifferent = 0;
+    size_t keyLength = 0;
+
+    for( unsigned int ievent = 0; ievent < nEvents; ++ievent ) {
+        std::vector<EtaPhi> miniaod( nMiniaod );
+        for( auto &jet : miniaod ) { jet = EtaPhi{ etaDist( rng ), phiDist( rng ) }; }
+
+        for( unsigned int icoll = 0; icoll < nCollections; ++icoll ) {
+            // the reclustered jets are close to MINIAOD ones 3 times out of 4
+            std::vector<EtaPhi> jets( nJets );
+            for( auto &jet : jets ) {
+                if( coin( rng ) ) {
+                    const EtaPhi &mini = miniaod[rng() % nMiniaod];
+                    jet = EtaPhi{ mini.eta + smear( rng ), reco::reduceRange( mini.phi + smear( rng ) ) };
+                } else {
+                    jet = EtaPhi{ etaDist( rng ), phiDist( rng ) };
+                }
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::vector<unsigned int> > allLoopMatches( nJets );
+            for( unsigned int i = 0; i < nJets; ++i ) {
+                for( unsigned int j = 0; j < nMiniaod; ++j ) {
+                    if( reco::deltaR( miniaod[j].eta, miniaod[j].phi, jets[i].eta, jets[i].phi ) < 0.1 ) { allLoopMatches[i].push_back( j ); }
+                }
+            }
+            loopTime += elapsed( start );
+
+            start = std::chrono::steady_clock::now();
+            matcher.clear();
+            for( auto &mini : miniaod ) { matcher.add( mini.eta, mini.phi ); }
+            matcher.build();
+            std::vector<std::vector<unsigned int> > allBucketMatches( nJets );
+            for( unsigned int i = 0; i < nJets; ++i ) {
+                matcher.match( jets[i].eta, jets[i].phi, matches );
+                allBucketMatches[i] = matches;
+            }
+            bucketTime += elapsed( start );
+
+            for( unsigned int i = 0; i < nJets; ++i ) {
+                if( allLoopMatches[i] != allBucketMatches[i] ) { ++nDifferent; }
+                if( !allLoopMatches[i].empty() ) { ++nMatched; }
+                ++nQueries;
+            }
+
+            // keys of the copied userFloats, for each matched jet
+            start = std::chrono::steady_clock::now();
+            for( unsigned int i = 0; i < nJets; ++i ) {
+                for( unsigned int j = 0; j < allLoopMatches[i].size(); ++j ) {
+                    for( auto &name : names ) {
+                        std::string key = std::string( "mini_" ) + name;
+                        keyLength += key.size();
+                    }
+                }
+            }
+            concatTime += elapsed( start );
+
+            start = std::chrono::steady_clock::now();
+            for( unsigned int i = 0; i < nJets; ++i ) {
+                for( unsigned int j = 0; j < allLoopMatches[i].size(); ++j ) {
+                    if( names != cachedNames ) {
+                        cachedNames = names;
+                        cachedKeys.clear();
+                        for( auto &name : names ) { cachedKeys.push_back( std::string( "mini_" ) + name ); }
+                    }
+                    for( auto &key : cachedKeys ) { keyLength += key.size(); }
+                }
+            }
+            tableTime += elapsed( start );
+        }
+    }
+
+    std::cout << "events: " << nEvents << " MINIAOD jets: " << nMiniaod << " jets x collections: " << nJets << " x " << nCollections
+              << " matched: " << nMatched << "/" << nQueries << " differences: " << nDifferent << std::endl;
+    std::cout << "matching, nested loop : " << loopTime / nQueries << " ns/jet" << std::endl;
+    std::cout << "matching, eta-phi grid: " << bucketTime / nQueries << " ns/jet (speed-up " << loopTime / bucketTime << ")" << std::endl;
+    std::cout << "keys, concatenation   : " << concatTime / nMatched << " ns/matched jet" << std::endl;
+    std::cout << "keys, cached table    : " << tableTime / nMatched << " ns/matched jet (speed-up " << concatTime / tableTime << ")" << std::endl;
+    std::cout << "(checksum " << keyLength << ")" << std::endl;
+    return ( nDifferent == 0 ? 0 : 1 );
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
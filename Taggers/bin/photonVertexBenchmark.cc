@@ -0,0 +1,222 @@
+// CPU benchmark of the vertex choice for a diphoton (LegacyVertexSelector::select) and of the PhotonIdUtils
+// isolation sums (charged isolation with respect to every vertex and worst vertex, photon isolation),
+// on synthetic high-pileup events: vertices along the beam line with their charged candidates, neutral
+// candidates and two barrel photons. No conversions are generated, so the conversion pull is not exercised.
+// The vertex MVA weights are read through FileInPath: run it from a CMSSW area.
+//
+// usage: photonVertexBenchmark [nEvents=200] [nVertices=50] [candidatesPerVertex=40] [nNeutrals=300]
+
+#include "FWCore/FWLite/interface/FWLiteEnabler.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/FileInPath.h"
+#include "DataFormats/CaloRecHit/interface/CaloCluster.h"
+#include "DataFormats/EgammaReco/interface/SuperCluster.h"
+#include "DataFormats/EgammaCandidates/interface/PhotonCore.h"
+#include "DataFormats/EgammaCandidates/interface/Photon.h"
+#include "DataFormats/Math/interface/LorentzVector.h"
+
+#include "flashgg/MicroAOD/interface/VertexSelectorBase.h"
+#include "flashgg/MicroAOD/interface/PhotonIdUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    double elapsed( std::chrono::steady_clock::time_point start )
+    {
+        return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    // the Refs and Ptrs point into the vectors: they are sized once and never reallocated
+    struct Event {
+        std::vector<reco::Vertex> vertices;
+        std::vector<pat::PackedCandidate> charged, neutrals;
+        std::vector<reco::CaloCluster> clusters;
+        std::vector<reco::SuperCluster> superClusters;
+        std::vector<reco::PhotonCore> cores;
+        std::vector<flashgg::Photon> photons;
+
+        std::vector<edm::Ptr<reco::Vertex> > vertexPtrs;
+        std::vector<edm::Ptr<pat::PackedCandidate> > neutralPtrs;
+        flashgg::VertexCandidateMap vertexCandidateMap;
+    };
+
+    void makeEvent( Event &event, std::mt19937 &rng, unsigned int nVertices, unsigned int nPerVertex, unsigned int nNeutrals )
+    {
+        std::normal_distribution<double> zDist( 0., 4. ), xyDist( 0., 0.002 );
+        std::exponential_distribution<double> ptDist( 1. / 1.5 );
+        std::uniform_real_distribution<double> etaDist( -2.5, 2.5 ), phiDist( -M_PI, M_PI ), phoEtaDist( -1.4, 1.4 ), phoPtDist( 30., 80. );
+
+        event.vertices.clear();
+        for( unsigned int iv = 0; iv < nVertices; ++iv ) {
+            reco::Vertex::Point position( xyDist( rng ), xyDist( rng ), zDist( rng ) );
+            event.vertices.emplace_back( position, reco::Vertex::Error(), 1., 1., nPerVertex );
+        }
+
+        event.charged.clear();
+        event.charged.reserve( nVertices * nPerVertex );
+        for( unsigned int iv = 0; iv < nVertices; ++iv ) {
+            for( unsigned int ic = 0; ic < nPerVertex; ++ic ) {
+                double pt = 0.2 + ptDist( rng ), eta = etaDist( rng ), phi = phiDist( rng );
+                math::XYZTLorentzVector p4( math::PtEtaPhiMLorentzVector( pt, eta, phi, 0.140 ) );
+                event.charged.emplace_back( p4, event.vertices[iv].position(), pt, eta, phi, ( ic % 2 ? 211 : -211 ), reco::VertexRefProd(), iv );
+                event.charged.back().setTrackHighPurity( ic % 10 != 0 );
+            }
+        }
+
+        event.neutrals.clear();
+        event.neutrals.reserve( nNeutrals );
+        for( unsigned int in = 0; in < nNeutrals; ++in ) {
+            double pt = 0.5 + ptDist( rng ), eta = etaDist( rng ), phi = phiDist( rng );
+            math::XYZTLorentzVector p4( math::PtEtaPhiMLorentzVector( pt, eta, phi, 0. ) );
+            event.neutrals.emplace_back( p4, event.vertices[0].position(), pt, eta, phi, ( in % 3 ? 22 : 130 ), reco::VertexRefProd(), 0 );
+        }
+
+        // two barrel photons, with the supercluster at the ECAL surface
+        event.clusters.clear();
+        event.superClusters.clear();
+        event.cores.clear();
+        event.photons.clear();
+        std::vector<math::XYZTLorentzVector> photonP4;
+        for( unsigned int ip = 0; ip < 2; ++ip ) {
+            double eta = phoEtaDist( rng ), phi = phiDist( rng );
+            photonP4.push_back( math::XYZTLorentzVector( math::PtEtaPhiMLorentzVector( phoPtDist( rng ), eta, phi, 0. ) ) );
+            math::XYZPoint position( 129. * cos( phi ), 129. * sin( phi ), 129. * sinh( eta ) );
+            event.clusters.emplace_back( photonP4.back().energy(), position );
+        }
+        for( unsigned int ip = 0; ip < 2; ++ip ) {
+            reco::CaloClusterPtr cluster( &event.clusters[ip], ip );
+            event.superClusters.emplace_back( event.clusters[ip].energy(), event.clusters[ip].position() );
+            event.superClusters.back().setSeed( cluster );
+            event.superClusters.back().addCluster( cluster );
+        }
+        for( unsigned int ip = 0; ip < 2; ++ip ) {
+            event.cores.emplace_back();
+            event.cores.back().setSuperCluster( reco::SuperClusterRef( &event.superClusters, ip ) );
+        }
+        for( unsigned int ip = 0; ip < 2; ++ip ) {
+            reco::Photon photon( photonP4[ip], event.superClusters[ip].position(), reco::PhotonCoreRef( &event.cores, ip ), event.vertices[0].position() );
+            reco::Photon::FiducialFlags flags;
+            flags.isEB = true;
+            photon.setFiducialVolumeFlags( flags );
+            event.photons.push_back( flashgg::Photon( pat::Photon( photon ) ) );
+        }
+
+        event.vertexPtrs.clear();
+        for( unsigned int iv = 0; iv < nVertices; ++iv ) { event.vertexPtrs.emplace_back( &event.vertices[iv], iv ); }
+        event.neutralPtrs.clear();
+        for( unsigned int in = 0; in < nNeutrals; ++in ) { event.neutralPtrs.emplace_back( &event.neutrals[in], in ); }
+        event.vertexCandidateMap.clear();
+        for( unsigned int ic = 0; ic < event.charged.size(); ++ic ) {
+            event.vertexCandidateMap.emplace_back( event.vertexPtrs[ic / nPerVertex], edm::Ptr<pat::PackedCandidate>( &event.charged[ic], ic ) );
+        }
+        std::stable_sort( event.vertexCandidateMap.begin(), event.vertexCandidateMap.end(), flashgg::compare_by_vtx() );
+    }
+
+    edm::ParameterSet legacyVertexSelectorConfig()
+    {
+        // as in flashggDiPhotons_cfi and the MetaConditions
+        edm::ParameterSet pset;
+        pset.addParameter<std::string>( "VertexSelectorName", "FlashggLegacyVertexSelector" );
+        pset.addParameter<edm::FileInPath>( "vertexIdMVAweightfile", edm::FileInPath( "flashgg/MicroAOD/data/TMVAClassification_BDTVtxId_SL_2016.xml" ) );
+        pset.addParameter<edm::FileInPath>( "vertexProbMVAweightfile", edm::FileInPath( "flashgg/MicroAOD/data/TMVAClassification_BDTVtxProb_SL_2016.xml" ) );
+        pset.addUntrackedParameter<unsigned int>( "nVtxSaveInfo", 3 );
+        pset.addParameter<bool>( "trackHighPurity", false );
+        pset.addParameter<bool>( "pureGeomConvMatching", true );
+        pset.addParameter<double>( "dRexclude", 0.05 );
+        const std::vector<std::pair<std::string, double> > sigmas = {
+            { "sigma1Pix", 0.0125255 }, { "sigma1Tib", 0.716301 }, { "sigma1Tob", 3.17615 },
+            { "sigma1PixFwd", 0.0581667 }, { "sigma1Tid", 0.38521 }, { "sigma1Tec", 1.67937 },
+            { "sigma2Pix", 0.0298574 }, { "sigma2Tib", 0.414393 }, { "sigma2Tob", 1.06805 },
+            { "sigma2PixFwd", 0.180419 }, { "sigma2Tid", 0.494722 }, { "sigma2Tec", 1.21941 },
+            { "singlelegsigma1Pix", 0.0178107 }, { "singlelegsigma1Tib", 1.3188 }, { "singlelegsigma1Tob", 2.23662 },
+            { "singlelegsigma1PixFwd", 0.152157 }, { "singlelegsigma1Tid", 0.702755 }, { "singlelegsigma1Tec", 2.46599 },
+            { "singlelegsigma2Pix", 0.0935307 }, { "singlelegsigma2Tib", 0.756568 }, { "singlelegsigma2Tob", 0.62143 },
+            { "singlelegsigma2PixFwd", 0.577081 }, { "singlelegsigma2Tid", 0.892751 }, { "singlelegsigma2Tec", 1.56638 }
+        };
+        for( const auto &sigma : sigmas ) { pset.addParameter<double>( sigma.first, sigma.second ); }
+        return pset;
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    for( int i = 1; i < argc; ++i ) {
+        if( atoi( argv[i] ) < 1 ) {
+            std::cerr << "usage: " << argv[0] << " [nEvents=200] [nVertices=50] [candidatesPerVertex=40] [nNeutrals=300]" << std::endl << "all the counts must be at least 1" << std::endl;
+            return 1;
+        }
+    }
+    unsigned int nEvents = ( argc > 1 ? atoi( argv[1] ) : 200 );
+    unsigned int nVertices = ( argc > 2 ? atoi( argv[2] ) : 50 );
+    unsigned int nPerVertex = ( argc > 3 ? atoi( argv[3] ) : 40 );
+    unsigned int nNeutrals = ( argc > 4 ? atoi( argv[4] ) : 300 );
+
+    FWLiteEnabler::enable();
+
+    edm::ParameterSet selectorConfig = legacyVertexSelectorConfig();
+    std::unique_ptr<flashgg::VertexSelectorBase> selector( FlashggVertexSelectorFactory::get()->create( "FlashggLegacyVertexSelector", selectorConfig ) );
+    flashgg::PhotonIdUtils idUtils;
+
+    // fixed seed: identical events from run to run
+    std::mt19937 rng( 12345 );
+    Event event;
+    std::vector<edm::Ptr<reco::Conversion> > noConversions;
+    math::XYZPoint beamSpot( 0., 0., 0. );
+
+    double selectTime = 0., chargedIsoTime = 0., photonIsoTime = 0.;
+    double checksum = 0.;
+    unsigned long nDiphotons = 0, nPhotons = 0;
+
+    for( unsigned int ievent = 0; ievent < nEvents; ++ievent ) {
+        makeEvent( event, rng, nVertices, nPerVertex, nNeutrals );
+        edm::Ptr<flashgg::Photon> g1( &event.photons[0], 0 ), g2( &event.photons[1], 1 );
+
+        auto start = std::chrono::steady_clock::now();
+        edm::Ptr<reco::Vertex> chosen = selector->select( g1, g2, event.vertexPtrs, event.vertexCandidateMap, noConversions, noConversions, beamSpot, true );
+        selectTime += elapsed( start );
+        checksum += chosen.key();
+        ++nDiphotons;
+
+        for( unsigned int ip = 0; ip < event.photons.size(); ++ip ) {
+            edm::Ptr<pat::Photon> photon( &event.photons[ip], ip );
+
+            start = std::chrono::steady_clock::now();
+            auto isoMap = idUtils.pfIsoChgWrtAllVtx( photon, event.vertexPtrs, event.vertexCandidateMap, 0.3, 0.02, 0.02, 0.1 );
+            float worst = idUtils.pfIsoChgWrtWorstVtx( isoMap );
+            chargedIsoTime += elapsed( start );
+
+            start = std::chrono::steady_clock::now();
+            float photonIso = idUtils.pfCaloIso( photon, event.neutralPtrs, 0.3, 0.0, 0.070, 0.015, 0.0, 0.0, 0.0, reco::PFCandidate::gamma,
+                                                 event.vertexPtrs[0].get() );
+            photonIsoTime += elapsed( start );
+
+            checksum += worst + photonIso;
+            ++nPhotons;
+        }
+    }
+
+    std::cout << "events: " << nEvents << " vertices: " << nVertices << " charged candidates/vertex: " << nPerVertex << " neutrals: " << nNeutrals << std::endl;
+    std::cout << "LegacyVertexSelector::select  : " << selectTime / nDiphotons << " ns/diphoton, "
+              << selectTime / ( nDiphotons * nVertices ) << " ns/vertex" << std::endl;
+    std::cout << "charged isolation, all vertices: " << chargedIsoTime / nPhotons << " ns/photon, "
+              << chargedIsoTime / ( nPhotons * nVertices ) << " ns/vertex" << std::endl;
+    std::cout << "photon isolation               : " << photonIsoTime / nPhotons << " ns/photon" << std::endl;
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,220 @@
+// CPU benchmark of the systematics bookkeeping on synthetic photons: the building of the central and
+// shifted collections as done in ObjectSystematicProducer::produce (clone, corrections of every method,
+// per-label weights, 2N shifted copies), the WeightedObject lookups done downstream by the taggers and
+// dumpers, and PDFWeightObject::uncompress.
+// ObjectSystematicProducer needs an edm::Event, so its event loop is reproduced here around the same per-object
+// corrections (ObjectSystematicCorrections), with a set of simple energy scale and weight methods in place of the
+// configured plugins.
+//
+// usage: systematicsBenchmark [nEvents=2000] [photonsPerEvent=4] [scaleMethods=6] [weightMethods=6] [pdfWeights=100]
+
+#include "flashgg/DataFormats/interface/Photon.h"
+#include "flashgg/DataFormats/interface/PDFWeightObject.h"
+#include "flashgg/Systematics/interface/BaseSystMethod.h"
+#include "flashgg/Systematics/interface/ObjectSystematicCorrections.h"
+
+#include "DataFormats/Math/interface/libminifloat.h"
+#include "TString.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    double elapsed( std::chrono::steady_clock::time_point start )
+    {
+        return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    typedef flashgg::ObjectSystematicCorrections<flashgg::Photon, int> Corrections;
+    typedef Corrections::Method Method;
+
+    // same labels as PhotonScale and PhotonWeight
+    std::string sigmaLabel( const std::string &label, int syst_value )
+    {
+        if( syst_value == 0 ) { return Form( "%sCentral", label.c_str() ); }
+        if( syst_value > 0 ) { return Form( "%sUp%.2dsigma", label.c_str(), syst_value ); }
+        return Form( "%sDown%.2dsigma", label.c_str(), -1 * syst_value );
+    }
+
+    class ScaleMethod : public Method
+    {
+    public:
+        ScaleMethod( const std::string &label, float shift, float error ) : label_( label ), shift_( shift ), error_( error ) { setMakesWeight( false ); }
+
+        std::string shiftLabel( int syst_value ) const override { return sigmaLabel( label_, syst_value ); }
+
+        void applyCorrection( flashgg::Photon &y, int syst_shift ) override
+        {
+            float scale = 1 + ( std::abs( y.eta() ) < 1.5 ? shift_ : 2 * shift_ ) + syst_shift * error_;
+            y.updateEnergy( shiftLabel( syst_shift ), scale * y.energy() );
+        }
+
+    private:
+        std::string label_;
+        float shift_, error_;
+    };
+
+    class WeightMethod : public Method
+    {
+    public:
+        WeightMethod( const std::string &label, float error ) : label_( label ), error_( error ) { setMakesWeight( true ); }
+
+        std::string shiftLabel( int syst_value ) const override { return sigmaLabel( label_, syst_value ); }
+
+        float makeWeight( const flashgg::Photon &y, int syst_shift ) override
+        {
+            return 0.98 + 0.01 * std::abs( y.eta() ) + syst_shift * error_;
+        }
+
+    private:
+        std::string label_;
+        float error_;
+    };
+}
+
+int main( int argc, char *argv[] )
+{
+    // every count is used as a divisor or an index: 0 (or a negative count) is rejected
+    for( int i = 1; i < argc; ++i ) {
+        if( atoi( argv[i] ) < 1 ) {
+            std::cerr << "usage: " << argv[0] << " [nEvents=2000] [photonsPerEvent=4] [scaleMethods=6] [weightMethods=6] [pdfWeights=100]" << std::endl << "all the counts must be at least 1" << std::endl;
+            return 1;
+        }
+    }
+    unsigned int nEvents = ( argc > 1 ? atoi( argv[1] ) : 2000 );
+    unsigned int nPhotons = ( argc > 2 ? atoi( argv[2] ) : 4 );
+    unsigned int nScales = ( argc > 3 ? atoi( argv[3] ) : 6 );
+    unsigned int nWeights = ( argc > 4 ? atoi( argv[4] ) : 6 );
+    unsigned int nPdfs = ( argc > 5 ? atoi( argv[5] ) : 100 );
+
+    // fixed seed: identical events from run to run
+    std::mt19937 rng( 12345 );
+    std::uniform_real_distribution<double> ptDist( 20., 150. ), etaDist( -2.5, 2.5 ), phiDist( -M_PI, M_PI ), pdfDist( 0.9, 1.1 );
+
+    Corrections::Methods methods;
+    const Corrections::Methods2D methods2D;
+    for( unsigned int k = 0; k < nScales; ++k ) {
+        methods.emplace_back( new ScaleMethod( "MCScale" + std::to_string( k ), 0.001 * k, 0.002 ) );
+    }
+    for( unsigned int k = 0; k < nWeights; ++k ) {
+        methods.emplace_back( new WeightMethod( "PhotonWeight" + std::to_string( k ), 0.005 ) );
+    }
+    std::vector<int> sigmas = { -1, 1 };
+    const std::vector<std::vector<int> > methodSigmas( methods.size(), sigmas );
+    const std::vector<std::vector<Corrections::param_pair> > methodSigmas2D;
+    const Corrections::param_pair zero2D( 0, 0 );
+
+    std::vector<std::string> weightLabels, missingLabels;
+    for( const auto &method : methods ) {
+        if( !method->makesWeight() ) { continue; }
+        for( int sig : { -1, 0, 1 } ) { weightLabels.push_back( method->shiftLabel( sig ) ); }
+        missingLabels.push_back( method->shiftLabel( 2 ) );
+    }
+
+    double buildTime = 0., lookupTime = 0., includeTime = 0., pdfTime = 0.;
+    unsigned long nObjects = 0, nShifted = 0, nLookups = 0, nIncludes = 0, nPdfWeights = 0;
+    double checksum = 0.;
+
+    flashgg::PDFWeightObject pdfObject;
+    for( unsigned int ievent = 0; ievent < nEvents; ++ievent ) {
+        std::vector<flashgg::Photon> photons( nPhotons );
+        for( auto &photon : photons ) {
+            double pt = ptDist( rng ), eta = etaDist( rng );
+            photon.setP4( reco::Candidate::LorentzVector( reco::Candidate::PolarLorentzVector( pt, eta, phiDist( rng ), 0. ) ) );
+        }
+
+        // central collection, then one shifted collection per sigma of every scale method
+        auto start = std::chrono::steady_clock::now();
+        std::vector<float> centralWeights;
+        std::vector<flashgg::Photon> central;
+        for( const auto &photon : photons ) {
+            flashgg::Photon *p_obj = photon.clone();
+            flashgg::Photon obj = *p_obj;
+            delete p_obj;
+            Corrections::apply( obj, methods, methods2D, nullptr, 0, nullptr, zero2D );
+            Corrections::applyNonCentralWeights( obj, methods, methods2D, methodSigmas, methodSigmas2D );
+            centralWeights.push_back( obj.centralWeight() );
+            central.push_back( obj );
+        }
+        std::vector<std::vector<flashgg::Photon> > shifted( nScales * sigmas.size() );
+        for( unsigned int i = 0; i < photons.size(); ++i ) {
+            unsigned int ncoll = 0;
+            for( const auto &method : methods ) {
+                if( method->makesWeight() ) { continue; }
+                for( int sig : sigmas ) {
+                    flashgg::Photon *p_obj = photons[i].clone();
+                    flashgg::Photon obj = *p_obj;
+                    delete p_obj;
+                    Corrections::apply( obj, methods, methods2D, method, sig, nullptr, zero2D );
+                    obj.setCentralWeight( centralWeights[i] );
+                    shifted[ncoll++].push_back( obj );
+                    ++nShifted;
+                }
+            }
+        }
+        buildTime += elapsed( start );
+        nObjects += photons.size();
+        for( auto &coll : shifted ) { checksum += coll.back().energy(); }
+
+        // per-label weights, as read by the dumpers, and weights carried over to a composite object
+        start = std::chrono::steady_clock::now();
+        for( const auto &photon : central ) {
+            for( const auto &label : weightLabels ) { checksum += photon.weight( label ); }
+            for( const auto &label : missingLabels ) { checksum += photon.hasWeight( label ); }
+            checksum += photon.centralWeight();
+        }
+        lookupTime += elapsed( start );
+        nLookups += central.size() * ( weightLabels.size() + missingLabels.size() + 1 );
+
+        start = std::chrono::steady_clock::now();
+        for( unsigned int i = 0; i + 1 < central.size(); i += 2 ) {
+            flashgg::WeightedObject pair;
+            pair.includeWeights( central[i] );
+            pair.includeWeights( central[i + 1] );
+            checksum += pair.centralWeight();
+            nIncludes += 2;
+        }
+        includeTime += elapsed( start );
+
+        // compressed as in PDFWeightObjectProducer
+        pdfObject.pdf_weight_container.clear();
+        pdfObject.alpha_s_container.clear();
+        pdfObject.qcd_scale_container.clear();
+        for( unsigned int k = 0; k < nPdfs; ++k ) { pdfObject.pdf_weight_container.push_back( MiniFloatConverter::float32to16( pdfDist( rng ) ) ); }
+        for( unsigned int k = 0; k < 2; ++k ) { pdfObject.alpha_s_container.push_back( MiniFloatConverter::float32to16( pdfDist( rng ) ) ); }
+        for( unsigned int k = 0; k < 9; ++k ) { pdfObject.qcd_scale_container.push_back( MiniFloatConverter::float32to16( pdfDist( rng ) ) ); }
+        start = std::chrono::steady_clock::now();
+        std::vector<float> pdfs = pdfObject.uncompress( pdfObject.pdf_weight_container );
+        std::vector<float> alphas = pdfObject.uncompress( pdfObject.alpha_s_container );
+        std::vector<float> scales = pdfObject.uncompress( pdfObject.qcd_scale_container );
+        pdfTime += elapsed( start );
+        nPdfWeights += pdfs.size() + alphas.size() + scales.size();
+        checksum += pdfs.back() + alphas.back() + scales.back();
+    }
+
+    std::cout << "events: " << nEvents << " photons: " << nObjects << " scale methods: " << nScales << " weight methods: " << nWeights
+              << " shifted copies: " << nShifted << std::endl;
+    std::cout << "central + shifted collections: " << buildTime / nObjects << " ns/photon (" << buildTime / ( nObjects + nShifted ) << " ns/copy)" << std::endl;
+    std::cout << "weight lookups               : " << lookupTime / nLookups << " ns/lookup (" << weightLabels.size() + missingLabels.size() + 1
+              << " per photon)" << std::endl;
+    if( nIncludes > 0 ) {
+        std::cout << "includeWeights               : " << includeTime / nIncludes << " ns/object" << std::endl;
+    }
+    std::cout << "PDF weights uncompress       : " << pdfTime / nPdfWeights << " ns/weight (" << pdfTime / nEvents << " ns/event)" << std::endl;
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -62,6 +62,9 @@ namespace flashgg {
         TrivialClassifier( const edm::ParameterSet &cfg ) {}
 
         std::pair<std::string, int> operator()( const T &obj ) const { return std::make_pair( "", 0 ); }
+        std::pair<int, int> classify( const T &obj ) const { return std::make_pair( 0, 0 ); }
+        int categoryIndex( const std::string &name ) const { return ( name.empty() ? 0 : -1 ); }
+        std::string categoryName( int icat ) const { return ""; }
     };
 
     template<class CollectionT, class CandidateT = typename CollectionT::value_type, class ClassifierT = TrivialClassifier<CandidateT> >
@@ -124,7 +127,7 @@ namespace flashgg {
         std::string workspaceName_;
         bool dumpHistos_, dumpGlobalVariables_;
 
-        std::map< KeyT, bool> hasSubcat_;
+        std::vector<bool> hasSubcat_;
         bool throwOnUnclassified_;
         
         // event weight
@@ -155,8 +158,9 @@ namespace flashgg {
         edm::FileInPath NNLOPSWeightFile_;
         std::vector<std::unique_ptr<TGraph> > NNLOPSWeights_;
 
-        //std::map<std::string, std::vector<dumper_type> > dumpers_; FIXME template key
-        std::map< KeyT, std::vector<dumper_type> > dumpers_;
+        // one entry per configured category key, and the entry to fill for each classifier category (-1 if none)
+        std::vector<std::vector<dumper_type> > dumpers_;
+        std::vector<int> dumperIndex_;
         RooWorkspace *ws_;
         /// TTree * bookTree(const std::string & name, TFileDirectory& fs);
         /// void fillTreeBranches(const flashgg::Photon & pho)
@@ -274,6 +278,7 @@ namespace flashgg {
        
         pdfWeightHistosBooked_=false;
 
+        std::map<KeyT, size_t> keys;
         auto categories = cfg.getParameter<std::vector<edm::ParameterSet> >( "categories" );
         for( auto &cat : categories ) {
             auto label   = cat.getParameter<std::string>( "label" );
@@ -318,8 +323,21 @@ namespace flashgg {
                 key += label;
             }
             
-            hasSubcat_[key] = ( subcats > 0 );
-            auto &dumpers = dumpers_[key];
+            // categories sharing the same key share the dumpers
+            auto ikey = keys.find( key );
+            if( ikey == keys.end() ) {
+                ikey = keys.insert( std::make_pair( key, dumpers_.size() ) ).first;
+                dumpers_.resize( dumpers_.size() + 1 );
+                hasSubcat_.push_back( false );
+                // keys that the classifier cannot produce are still booked, and stay empty
+                int icat = classifier_.categoryIndex( key );
+                if( icat >= 0 ) {
+                    if( icat >= ( int )dumperIndex_.size() ) { dumperIndex_.resize( icat + 1, -1 ); }
+                    dumperIndex_[icat] = ikey->second;
+                }
+            }
+            hasSubcat_[ikey->second] = ( subcats > 0 );
+            auto &dumpers = dumpers_[ikey->second];
             if( subcats == 0 ) {
                 name = replaceString( replaceString( replaceString( name, "_$SUBCAT", "" ), "$SUBCAT_", "" ), "$SUBCAT", "" );
                 dumpers.push_back( dumper_type( name, cat, globalVarsDumper_ ) );
@@ -358,8 +376,9 @@ namespace flashgg {
         } else {
             ws_ = 0;
         }
-        for( auto &dumpers : dumpers_ ) {
-            for( auto &dumper : dumpers.second ) {
+        // booked in key order, as when the dumpers were looked up by key
+        for( auto &key : keys ) {
+            for( auto &dumper : dumpers_[key.second] ) {
                 if( dumpWorkspace_ ) {
                     dumper.bookRooDataset( *ws_, "weight", replacements);
                 }
@@ -399,10 +418,10 @@ namespace flashgg {
         {
          if(dumpPdfWeights_){
           for (auto &dumper: dumpers_){
-            for (unsigned int i =0; i < dumper.second.size() ; i++){
-              if (dumper.second[i].isBinnedOnly()) continue;
+            for (unsigned int i =0; i < dumper.size() ; i++){
+              if (dumper[i].isBinnedOnly()) continue;
               else {
-                if (ws_ != NULL) dumper.second[i].compressPdfWeightDatasets(ws_); 
+                if (ws_ != NULL) dumper[i].compressPdfWeightDatasets(ws_); 
               }
             }
            }
@@ -639,21 +658,22 @@ namespace flashgg {
             int nfilled = maxCandPerEvent_;
 
             for( auto &cand : collection ) {
-                auto cat = classifier_( cand );
-                auto which = dumpers_.find( cat.first );
+                auto cat = classifier_.classify( cand );
+                int which = ( cat.first >= 0 && cat.first < ( int )dumperIndex_.size() ? dumperIndex_[cat.first] : -1 );
 
-                if( which != dumpers_.end() ) {
-                    int isub = ( hasSubcat_[cat.first] ? cat.second : 0 );
+                if( which >= 0 ) {
+                    int isub = ( hasSubcat_[which] ? cat.second : 0 );
                    double fillWeight =weight_;
                    const  WeightedObject* tag = dynamic_cast<const WeightedObject* >( &cand );
                     if ( tag != NULL ){
 
                     fillWeight =fillWeight*(tag->centralWeight());
                     }
-                    which->second[isub].fill( cand, fillWeight, pdfWeights_, maxCandPerEvent_ - nfilled, stage0cat_ );
+                    dumpers_[which][isub].fill( cand, fillWeight, pdfWeights_, maxCandPerEvent_ - nfilled, stage0cat_ );
                     --nfilled;
                 } else if( throwOnUnclassified_ ) {
-                    throw cms::Exception( "Runtime error" ) << "could not find dumper for category [" << cat.first << "," << cat.second << "]"
+                    throw cms::Exception( "Runtime error" ) << "could not find dumper for category ["
+                        << ( cat.first >= 0 ? classifier_.categoryName( cat.first ) : "" ) << "," << cat.second << "]"
                         << "If you want to allow this (eg because you don't want to dump some of the candidates in the collection)\n"
                         << "please set throwOnUnclassified in the dumper configuration\n";
                 }
@@ -0,0 +1,74 @@
+#ifndef flashgg_DoubleHReweightGrid_h
+#define flashgg_DoubleHReweightGrid_h
+
+#include <algorithm>
+#include <iosfwd>
+#include <vector>
+
+class TAxis;
+class TH2;
+
+namespace flashgg {
+
+    // Set of (mHH, |cos theta*|) reweighting histograms sharing the same binning, converted into
+    // a single contiguous float array. The weights of all the points are stored next to each other
+    // for each bin ([mHH bin][cos theta* bin][point]), so that the bin is found once per event and
+    // the weights of all the points are read in one go.
+    class DoubleHReweightGrid
+    {
+    public:
+        DoubleHReweightGrid() : nPoints_( 0 ) {}
+
+        // a null histogram stands for a point without weights, which gets a weight of 0
+        void build( const std::vector<const TH2 *> &hists );
+
+        bool read( std::istream &in );
+        void write( std::ostream &out ) const;
+
+        unsigned int nPoints() const { return nPoints_; }
+
+        // global bin number, including under- and overflows, as TH2::FindBin
+        int findBin( double mhh, double absCosTheta ) const
+        {
+            return xAxis_.findBin( mhh ) + ( xAxis_.nbins + 2 ) * yAxis_.findBin( absCosTheta );
+        }
+        const float *weights( int bin ) const { return &weights_[bin * nPoints_]; }
+        float weight( int bin, unsigned int point ) const { return weights_[bin * nPoints_ + point]; }
+
+    private:
+        struct Axis {
+            Axis() : nbins( 0 ), xmin( 0. ), xmax( 0. ) {}
+            Axis( const TAxis &axis );
+            bool operator==( const Axis &other ) const
+            { return nbins == other.nbins && xmin == other.xmin && xmax == other.xmax && edges == other.edges; }
+            // same as TAxis::FindBin for non-extendable axes
+            int findBin( double x ) const;
+
+            int nbins;
+            double xmin, xmax;
+            std::vector<double> edges; // only for variable size bins
+        };
+
+        Axis xAxis_, yAxis_;
+        unsigned int nPoints_;
+        std::vector<float> weights_;
+    };
+
+    inline int DoubleHReweightGrid::Axis::findBin( double x ) const
+    {
+        if( x < xmin ) { return 0; }
+        if( !( x < xmax ) ) { return nbins + 1; }
+        if( edges.empty() ) { return 1 + int( nbins * ( x - xmin ) / ( xmax - xmin ) ); }
+        return std::upper_bound( edges.begin(), edges.end(), x ) - edges.begin();
+    }
+
+}
+
+#endif // flashgg_DoubleHReweightGrid_h
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -11,6 +11,8 @@
 #include "THnSparse.h"
 #include "TList.h"
 
+#include "flashgg/MicroAOD/interface/GraphLookupTable.h"
+
 #include <list>
 #include <set>
 #include <algorithm>
@@ -148,17 +150,18 @@ private:
 
 
 // -----------------------------------------------------------------------------------------------
+// Linear interpolation of a TGraph, evaluated through a uniform-grid lookup table.
 class  LinGraphToTF1 : public HistoConverter
 {
 public:
     LinGraphToTF1( TString name, TGraph *g ) : capped_( false )
-    { g_ = ( TGraph * )g->Clone( name ); };
+    { g_ = ( TGraph * )g->Clone( name ); table_ = flashgg::GraphLookupTable( *g_ ); };
     LinGraphToTF1( TString name, TGraph *g, double xmin, double valmin, double xmax, double valmax ) :
         capped_( true ), xmin_( xmin ), valmin_( valmin ), xmax_( xmax ), valmax_( valmax )
-    { g_ = ( TGraph * )g->Clone( name ); };
+    { g_ = ( TGraph * )g->Clone( name ); table_ = flashgg::GraphLookupTable( *g_ ); };
     double operator()( double *x, double *p )
     {
-        double val = g_->Eval( x[0] );
+        double val = table_.eval( x[0] );
         if( capped_ ) {
             if( x[0] <= xmin_ || val < valmin_ ) { return valmin_; }
             if( x[0] >= xmax_ || val > valmax_ ) { return valmax_; }
@@ -172,6 +175,7 @@ public:
 private:
     bool capped_;
     double xmin_, valmin_, xmax_, valmax_;
+    flashgg::GraphLookupTable table_;
 
 };
 
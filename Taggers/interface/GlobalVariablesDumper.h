@@ -5,6 +5,8 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "DataFormats/Provenance/interface/ParameterSetID.h"
+#include "FWCore/Common/interface/TriggerNames.h"
 
 #include "flashgg/MicroAOD/interface/GlobalVariablesComputer.h"
 
@@ -35,10 +37,16 @@ namespace flashgg {
     private:
 
         void _init( const edm::ParameterSet &cfg );
+        std::vector<int> triggerBits( const edm::TriggerNames &trigNames ) const;
+        void resolveExtraFloat( const edm::EventBase &evt, const edm::Event *fullEvent, size_t iextra );
+
+        enum ExtraFloatType { extraUnresolved, extraFloat, extraDouble, extraVectorFloat };
 
         edm::InputTag triggerTag_;
         edm::EDGetTokenT<edm::TriggerResults> triggerToken_;
         std::vector<std::pair<std::string, bool>> bits_;
+        // per trigger menu: index in bits_ of the first pattern found in each path name, -1 if none
+        std::map<edm::ParameterSetID, std::vector<int> > triggerBitsByMenu_;
         
         bool dumpLumiFactor_;
         double lumiFactor_;
@@ -52,6 +60,7 @@ namespace flashgg {
         std::vector<edm::InputTag> extraFloatTags_;
         std::vector<std::string> extraFloatNames_;
         std::vector<float> extraFloatVariables_;
+        std::vector<ExtraFloatType> extraFloatTypes_;
         
     };
 
@@ -26,6 +26,7 @@
 #include "TTree.h"
 #include "TROOT.h"
 #include "TSystem.h"
+#include "TFileMerger.h"
 
 // RooFit includes
 #include "RooDataHist.h"
@@ -59,6 +60,9 @@
 #include <sstream>
 #include <algorithm>
 #include <iterator>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 
 using namespace std;
@@ -87,9 +91,35 @@ public:
 
     void Save( bool doTreesAndHistograms );
 
+    // Merges the inputs into the output with up to nWorkers merges running at the same time, each in its own
+    // process: first in chunks of filesPerMerge consecutive files (default: one chunk per worker), then
+    // pairwise, through temporary files next to the output. Returns false if a merge failed.
+    // Limits:
+    // - every merge loads all the datasets of its inputs in memory, and the last pairwise merge holds the whole
+    //   merged output: filesPerMerge does not bound the memory, it only sets how many files a first-level merge reads;
+    // - the trees and histograms (doTreesAndHistograms) are merged afterwards, in a separate TFileMerger pass over
+    //   all the inputs that updates the merged file;
+    // - the entries of each dataset keep the order of the inputs, but the file is not identical to the serial
+    //   output: the order of the datasets and workspaces may differ, and RooDataHist bins can differ by rounding.
+    bool MergeParallel( unsigned int nWorkers, unsigned int filesPerMerge, bool doTreesAndHistograms );
+
+    void SetVerbose( bool verbose_ ) { verbose = verbose_; }
+
 
 private :
 
+    pid_t SpawnMerge( const string &output, const vector<string> &inputs );
+
+    bool WaitForMerge( pid_t pid );
+
+    void CollectWorkspaceNames( TDirectory *dir, std::set<string> &names );
+
+    std::ostream &log() { return ( verbose ? std::cout : nullStream ); }
+
+    bool verbose;
+
+    std::ostream nullStream;
+
     vector<string> inputFileNames;
 
     string outputFileName;
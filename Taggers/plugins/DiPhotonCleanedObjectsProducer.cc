@@ -0,0 +1,422 @@
+#include "FWCore/Framework/interface/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "flashgg/DataFormats/interface/DiPhotonCandidate.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
+#include "flashgg/DataFormats/interface/Electron.h"
+#include "flashgg/DataFormats/interface/Jet.h"
+#include "flashgg/DataFormats/interface/Muon.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "flashgg/Taggers/interface/LeptonSelection.h"
+
+#include "DataFormats/Math/interface/deltaR.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include "TLorentzVector.h"
+
+using namespace std;
+using namespace edm;
+
+namespace flashgg {
+
+    // Selects the leptons and the jets used by the tag producers once per event and cleans them against each
+    // diphoton. Every entry of "selections" is the set of cuts of one or more tags, and is written as one
+    // collection whose product instance is the selection name.
+    // The photon-independent part of the selection (kinematics, ID, isolation, b-tag) is evaluated once per
+    // event, and once per jet collection for the jets; only the overlap removal against the photons and the
+    // selected leptons is done per diphoton.
+    // Leptons: "2018" is selectMuons/selectElectrons of LeptonSelection2018, "Std" is selectMuons/selectStdElectrons
+    // of LeptonSelection, "None" selects none.
+    class DiPhotonCleanedObjectsProducer : public EDProducer
+    {
+
+    public:
+        DiPhotonCleanedObjectsProducer( const ParameterSet & );
+
+    private:
+        void produce( Event &, const EventSetup & ) override;
+
+        enum LeptonSelectionType { NoLeptons, Leptons2018, StdLeptons };
+
+        struct Selection {
+            string name;
+
+            LeptonSelectionType leptons;
+            double MuonEtaCut;
+            double MuonPtCut;
+            double MuonIsoCut;
+            double MuonPhotonDrCut;
+            double ElePtCut;
+            std::vector<double> EleEtaCuts;
+            double ElePhotonDrCut;
+            double ElePhotonZMassCut;
+            double leptonPtThreshold;
+            double muonEtaThreshold;
+            double muPFIsoSumRelThreshold;
+            double deltaRMuonPhoThreshold;
+            std::vector<double> electronEtaThresholds;
+            bool useElectronMVARecipe;
+            bool useElectronLooseID;
+            double deltaRPhoElectronThreshold;
+            double DeltaRTrkElec;
+            double deltaMassElectronZThreshold;
+            double LeptonsZMassCut;
+
+            bool useJetID;
+            flashgg::JetIDLevel jetIDLevel;
+            double jetPtThreshold;
+            double jetEtaThreshold;
+            double deltaRJetLeadPhoThreshold;
+            double deltaRJetSubLeadPhoThreshold;
+            bool jetPhotonDrWithSuperCluster;
+            double deltaRJetMuonThreshold;
+            double deltaRJetElectronThreshold;
+            std::vector<string> bTag;
+            std::vector<double> bDiscriminator;
+        };
+
+        struct SelectedJet {
+            edm::Ptr<flashgg::Jet> jet;
+            float bDiscriminator;
+        };
+
+        float bDiscriminator( const flashgg::Jet &jet, const std::vector<string> &bTag ) const;
+        template <class T> void removeZPairs( std::vector<edm::Ptr<T> > &leptons, std::vector<float> &photonDr, double cut ) const;
+
+        EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
+        std::vector<edm::InputTag> inputTagJets_;
+        std::vector<edm::EDGetTokenT<View<flashgg::Jet> > > tokenJets_;
+        EDGetTokenT<View<flashgg::Muon> > muonToken_;
+        EDGetTokenT<View<flashgg::Electron> > electronToken_;
+        EDGetTokenT<View<reco::Vertex> > vertexToken_;
+        EDGetTokenT<double> rhoTag_;
+
+        std::vector<Selection> selections_;
+        bool useLeptons_;
+        bool useStdLeptons_;
+    };
+
+    DiPhotonCleanedObjectsProducer::DiPhotonCleanedObjectsProducer( const ParameterSet &iConfig ) :
+        diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
+        inputTagJets_( iConfig.getParameter<std::vector<edm::InputTag> >( "inputTagJets" ) ),
+        useLeptons_( false ),
+        useStdLeptons_( false )
+    {
+        for( auto &pset : iConfig.getParameter<std::vector<edm::ParameterSet> >( "selections" ) ) {
+            Selection sel;
+            sel.name = pset.getParameter<string>( "name" );
+            for( auto &other : selections_ ) {
+                if( other.name == sel.name ) {
+                    throw cms::Exception( "Configuration" ) << " DiPhotonCleanedObjectsProducer: selection " << sel.name << " defined twice";
+                }
+            }
+
+            string leptons = pset.getParameter<string>( "leptonSelection" );
+            if( leptons == "None" ) {
+                sel.leptons = NoLeptons;
+            } else if( leptons == "2018" ) {
+                sel.leptons = Leptons2018;
+                sel.MuonEtaCut = pset.getParameter<double>( "MuonEtaCut" );
+                sel.MuonPtCut = pset.getParameter<double>( "MuonPtCut" );
+                sel.MuonIsoCut = pset.getParameter<double>( "MuonIsoCut" );
+                sel.MuonPhotonDrCut = pset.getParameter<double>( "MuonPhotonDrCut" );
+                sel.ElePtCut = pset.getParameter<double>( "ElePtCut" );
+                sel.EleEtaCuts = pset.getParameter<std::vector<double> >( "EleEtaCuts" );
+                sel.ElePhotonDrCut = pset.getParameter<double>( "ElePhotonDrCut" );
+                sel.ElePhotonZMassCut = pset.getParameter<double>( "ElePhotonZMassCut" );
+                if( sel.EleEtaCuts.size() != 3 ) {
+                    throw cms::Exception( "Configuration" ) << " DiPhotonCleanedObjectsProducer: EleEtaCuts of " << sel.name << " needs 3 values, got "
+                                                            << sel.EleEtaCuts.size();
+                }
+            } else if( leptons == "Std" ) {
+                sel.leptons = StdLeptons;
+                sel.leptonPtThreshold = pset.getParameter<double>( "leptonPtThreshold" );
+                sel.muonEtaThreshold = pset.getParameter<double>( "muonEtaThreshold" );
+                sel.muPFIsoSumRelThreshold = pset.getParameter<double>( "muPFIsoSumRelThreshold" );
+                sel.deltaRMuonPhoThreshold = pset.getParameter<double>( "deltaRMuonPhoThreshold" );
+                sel.electronEtaThresholds = pset.getParameter<std::vector<double> >( "electronEtaThresholds" );
+                sel.useElectronMVARecipe = pset.getParameter<bool>( "useElectronMVARecipe" );
+                sel.useElectronLooseID = pset.getParameter<bool>( "useElectronLooseID" );
+                sel.deltaRPhoElectronThreshold = pset.getParameter<double>( "deltaRPhoElectronThreshold" );
+                sel.DeltaRTrkElec = pset.getParameter<double>( "DeltaRTrkElec" );
+                sel.deltaMassElectronZThreshold = pset.getParameter<double>( "deltaMassElectronZThreshold" );
+                if( sel.electronEtaThresholds.size() != 3 ) {
+                    throw cms::Exception( "Configuration" ) << " DiPhotonCleanedObjectsProducer: electronEtaThresholds of " << sel.name
+                                                            << " needs 3 values, got " << sel.electronEtaThresholds.size();
+                }
+                useStdLeptons_ = true;
+            } else {
+                throw cms::Exception( "Configuration" ) << " DiPhotonCleanedObjectsProducer: unknown leptonSelection " << leptons << " in " << sel.name;
+            }
+            useLeptons_ |= ( sel.leptons != NoLeptons );
+            sel.LeptonsZMassCut = ( pset.exists( "LeptonsZMassCut" ) ? pset.getParameter<double>( "LeptonsZMassCut" ) : 0. );
+
+            string jetIDLevel = pset.getParameter<string>( "JetIDLevel" );
+            sel.useJetID = true;
+            if( jetIDLevel == "None" ) { sel.useJetID = false; }
+            else if( jetIDLevel == "Loose" ) { sel.jetIDLevel = flashgg::Loose; }
+            else if( jetIDLevel == "Tight" ) { sel.jetIDLevel = flashgg::Tight; }
+            else if( jetIDLevel == "Tight2017" ) { sel.jetIDLevel = flashgg::Tight2017; }
+            else {
+                throw cms::Exception( "Configuration" ) << " DiPhotonCleanedObjectsProducer: unknown JetIDLevel " << jetIDLevel << " in " << sel.name;
+            }
+            sel.jetPtThreshold = pset.getParameter<double>( "jetPtThreshold" );
+            sel.jetEtaThreshold = pset.getParameter<double>( "jetEtaThreshold" );
+            sel.deltaRJetLeadPhoThreshold = pset.getParameter<double>( "deltaRJetLeadPhoThreshold" );
+            sel.deltaRJetSubLeadPhoThreshold = pset.getParameter<double>( "deltaRJetSubLeadPhoThreshold" );
+            sel.jetPhotonDrWithSuperCluster = pset.getParameter<bool>( "jetPhotonDrWithSuperCluster" );
+            sel.deltaRJetMuonThreshold = ( pset.exists( "deltaRJetMuonThreshold" ) ? pset.getParameter<double>( "deltaRJetMuonThreshold" ) : 0. );
+            sel.deltaRJetElectronThreshold = ( pset.exists( "deltaRJetElectronThreshold" ) ? pset.getParameter<double>( "deltaRJetElectronThreshold" ) : 0. );
+            sel.bTag = pset.getParameter<std::vector<string> >( "bTag" );
+            sel.bDiscriminator = ( pset.exists( "bDiscriminator" ) ? pset.getParameter<std::vector<double> >( "bDiscriminator" ) : std::vector<double>() );
+
+            selections_.push_back( sel );
+            produces<vector<DiPhotonCleanedObjects> >( sel.name );
+        }
+
+        if( useLeptons_ ) {
+            muonToken_ = consumes<View<flashgg::Muon> >( iConfig.getParameter<InputTag>( "MuonTag" ) );
+            electronToken_ = consumes<View<flashgg::Electron> >( iConfig.getParameter<InputTag>( "ElectronTag" ) );
+        }
+        if( useStdLeptons_ ) {
+            vertexToken_ = consumes<View<reco::Vertex> >( iConfig.getParameter<InputTag>( "VertexTag" ) );
+            rhoTag_ = consumes<double>( iConfig.getParameter<InputTag>( "rhoTag" ) );
+        }
+        for( unsigned i = 0 ; i < inputTagJets_.size() ; i++ ) {
+            tokenJets_.push_back( consumes<View<flashgg::Jet> >( inputTagJets_[i] ) );
+        }
+    }
+
+    // sum of the listed discriminators, "pfDeepCSV" standing for probb + probbb as in the tag producers
+    float DiPhotonCleanedObjectsProducer::bDiscriminator( const flashgg::Jet &jet, const std::vector<string> &bTag ) const
+    {
+        float value = 0.;
+        for( auto &name : bTag ) {
+            if( name == "pfDeepCSV" ) { value += jet.bDiscriminator( "pfDeepCSVJetTags:probb" ) + jet.bDiscriminator( "pfDeepCSVJetTags:probbb" ); }
+            else { value += jet.bDiscriminator( name ); }
+        }
+        return value;
+    }
+
+    // Z veto of TTHDiLeptonTagProducer: both leptons of any same-flavour pair within cut of the Z mass are
+    // removed, and a flavour with fewer than two leptons is dropped altogether
+    template <class T> void DiPhotonCleanedObjectsProducer::removeZPairs( std::vector<edm::Ptr<T> > &leptons, std::vector<float> &photonDr, double cut ) const
+    {
+        std::vector<bool> isBad( leptons.size(), leptons.size() < 2 );
+        for( unsigned int i = 0 ; i < leptons.size() ; i++ ) {
+            for( unsigned int j = i + 1 ; j < leptons.size() ; j++ ) {
+                TLorentzVector l1, l2;
+                l1.SetPtEtaPhiE( leptons[i]->pt(), leptons[i]->eta(), leptons[i]->phi(), leptons[i]->energy() );
+                l2.SetPtEtaPhiE( leptons[j]->pt(), leptons[j]->eta(), leptons[j]->phi(), leptons[j]->energy() );
+                if( fabs( ( l1 + l2 ).M() - 91.187 ) < cut ) { isBad[i] = isBad[j] = true; }
+            }
+        }
+        unsigned int nGood = 0;
+        for( unsigned int i = 0 ; i < leptons.size() ; i++ ) {
+            if( isBad[i] ) { continue; }
+            leptons[nGood] = leptons[i];
+            photonDr[nGood] = photonDr[i];
+            nGood++;
+        }
+        leptons.resize( nGood );
+        photonDr.resize( nGood );
+    }
+
+    void DiPhotonCleanedObjectsProducer::produce( Event &evt, const EventSetup & )
+    {
+        Handle<View<flashgg::DiPhotonCandidate> > diPhotons;
+        evt.getByToken( diPhotonToken_, diPhotons );
+
+        Handle<View<flashgg::Muon> > theMuons;
+        Handle<View<flashgg::Electron> > theElectrons;
+        if( useLeptons_ ) {
+            evt.getByToken( muonToken_, theMuons );
+            evt.getByToken( electronToken_, theElectrons );
+        }
+
+        Handle<View<reco::Vertex> > vertices;
+        double rho_ = 0.;
+        if( useStdLeptons_ ) {
+            evt.getByToken( vertexToken_, vertices );
+            Handle<double> rho;
+            evt.getByToken( rhoTag_, rho );
+            rho_ = *rho;
+        }
+
+        // photon-independent lepton selection, once per event and selection
+        std::vector<std::vector<edm::Ptr<flashgg::Muon> > > muons( selections_.size() );
+        std::vector<std::vector<edm::Ptr<flashgg::Electron> > > electrons( selections_.size() );
+        std::vector<std::vector<TLorentzVector> > electronP4s( selections_.size() );
+        for( unsigned int isel = 0 ; isel < selections_.size() ; isel++ ) {
+            const Selection &sel = selections_[isel];
+            if( sel.leptons == Leptons2018 ) {
+                for( unsigned int imu = 0 ; imu < theMuons->size() ; imu++ ) {
+                    const flashgg::Muon &mu = theMuons->at( imu );
+                    if( mu.pt() < sel.MuonPtCut ) { continue; }
+                    if( fabs( mu.eta() ) > sel.MuonEtaCut ) { continue; }
+                    if( !mu.innerTrack() ) { continue; }
+                    if( !mu.isMediumMuon() ) { continue; }
+                    float Iso = mu.pfIsolationR04().sumChargedHadronPt + max( 0., mu.pfIsolationR04().sumNeutralHadronEt + mu.pfIsolationR04().sumPhotonEt - 0.5 * mu.pfIsolationR04().sumPUPt );
+                    if( Iso / mu.pt() > sel.MuonIsoCut ) { continue; }
+                    muons[isel].push_back( theMuons->ptrAt( imu ) );
+                }
+                for( unsigned int iele = 0 ; iele < theElectrons->size() ; iele++ ) {
+                    const flashgg::Electron &ele = theElectrons->at( iele );
+                    if( !ele.passMVAMediumId() ) { continue; }
+                    if( ele.pt() < sel.ElePtCut ) { continue; }
+                    if( fabs( ele.eta() ) > sel.EleEtaCuts[2] || ( fabs( ele.eta() ) > sel.EleEtaCuts[0] && fabs( ele.eta() ) < sel.EleEtaCuts[1] ) ) { continue; }
+                    if( ele.hasMatchedConversion() ) { continue; }
+                    electrons[isel].push_back( theElectrons->ptrAt( iele ) );
+                    electronP4s[isel].push_back( TLorentzVector() );
+                    electronP4s[isel].back().SetPtEtaPhiE( ele.pt(), ele.eta(), ele.phi(), ele.energy() );
+                }
+            } else if( sel.leptons == StdLeptons ) {
+                muons[isel] = selectAllMuons( theMuons->ptrs(), vertices->ptrs(), sel.muonEtaThreshold, sel.leptonPtThreshold, sel.muPFIsoSumRelThreshold );
+                electrons[isel] = selectStdAllElectrons( theElectrons->ptrs(), vertices->ptrs(), sel.leptonPtThreshold, sel.electronEtaThresholds,
+                                                         sel.useElectronMVARecipe, sel.useElectronLooseID, rho_, evt.isRealData() );
+            }
+        }
+
+        // photon-independent jet selection, once per selection and jet collection actually used by a diphoton
+        std::vector<edm::Handle<edm::View<flashgg::Jet> > > Jets( inputTagJets_.size() );
+        std::vector<std::vector<std::vector<SelectedJet> > > selectedJets( selections_.size(), std::vector<std::vector<SelectedJet> >( inputTagJets_.size() ) );
+        std::vector<bool> jetsDone( inputTagJets_.size(), false );
+
+        std::vector<std::unique_ptr<vector<DiPhotonCleanedObjects> > > cleaned;
+        for( unsigned int isel = 0 ; isel < selections_.size() ; isel++ ) {
+            cleaned.emplace_back( new vector<DiPhotonCleanedObjects> );
+            cleaned.back()->reserve( diPhotons->size() );
+        }
+
+        for( unsigned int diphoIndex = 0 ; diphoIndex < diPhotons->size() ; diphoIndex++ ) {
+            edm::Ptr<flashgg::DiPhotonCandidate> dipho = diPhotons->ptrAt( diphoIndex );
+            const flashgg::Photon *lead = dipho->leadingPhoton();
+            const flashgg::Photon *sublead = dipho->subLeadingPhoton();
+
+            unsigned int jetCollectionIndex = dipho->jetCollectionIndex();
+            if( jetCollectionIndex >= inputTagJets_.size() ) {
+                throw cms::Exception( "Configuration" ) << " DiPhotonCleanedObjectsProducer: diphoton uses jet collection " << jetCollectionIndex
+                                                        << " but only " << inputTagJets_.size() << " are configured";
+            }
+            if( !jetsDone[jetCollectionIndex] ) {
+                evt.getByToken( tokenJets_[jetCollectionIndex], Jets[jetCollectionIndex] );
+                for( unsigned int jetIndex = 0 ; jetIndex < Jets[jetCollectionIndex]->size() ; jetIndex++ ) {
+                    const flashgg::Jet &jet = Jets[jetCollectionIndex]->at( jetIndex );
+                    for( unsigned int isel = 0 ; isel < selections_.size() ; isel++ ) {
+                        const Selection &sel = selections_[isel];
+                        if( fabs( jet.eta() ) > sel.jetEtaThreshold ) { continue; }
+                        if( jet.pt() < sel.jetPtThreshold ) { continue; }
+                        if( sel.useJetID && !jet.passesJetID( sel.jetIDLevel ) ) { continue; }
+                        selectedJets[isel][jetCollectionIndex].push_back( SelectedJet{ Jets[jetCollectionIndex]->ptrAt( jetIndex ), bDiscriminator( jet, sel.bTag ) } );
+                    }
+                }
+                jetsDone[jetCollectionIndex] = true;
+            }
+
+            TLorentzVector Ph1, Ph2;
+            Ph1.SetPtEtaPhiE( lead->pt(), lead->eta(), lead->phi(), lead->energy() );
+            Ph2.SetPtEtaPhiE( sublead->pt(), sublead->eta(), sublead->phi(), sublead->energy() );
+
+            for( unsigned int isel = 0 ; isel < selections_.size() ; isel++ ) {
+                const Selection &sel = selections_[isel];
+                cleaned[isel]->emplace_back( dipho );
+                DiPhotonCleanedObjects &objects = cleaned[isel]->back();
+                objects.setBWorkingPoints( sel.bDiscriminator );
+
+                std::vector<edm::Ptr<flashgg::Muon> > diphoMuons;
+                std::vector<edm::Ptr<flashgg::Electron> > diphoElectrons;
+                std::vector<float> muonPhotonDr, electronPhotonDr;
+
+                if( sel.leptons == Leptons2018 ) {
+                    for( auto &muon : muons[isel] ) {
+                        float dRPhoLeadMuon = deltaR( muon->eta(), muon->phi(), lead->eta(), lead->phi() ) ;
+                        float dRPhoSubLeadMuon = deltaR( muon->eta(), muon->phi(), sublead->eta(), sublead->phi() ) ;
+                        if( dRPhoLeadMuon < sel.MuonPhotonDrCut || dRPhoSubLeadMuon < sel.MuonPhotonDrCut ) { continue; }
+                        diphoMuons.push_back( muon );
+                        muonPhotonDr.push_back( std::min( dRPhoLeadMuon, dRPhoSubLeadMuon ) );
+                    }
+                    for( unsigned int iele = 0 ; iele < electrons[isel].size() ; iele++ ) {
+                        const edm::Ptr<flashgg::Electron> &ele = electrons[isel][iele];
+                        float dRPhoLeadEle = deltaR( ele->eta(), ele->phi(), lead->eta(), lead->phi() ) ;
+                        float dRPhoSubLeadEle = deltaR( ele->eta(), ele->phi(), sublead->eta(), sublead->phi() );
+                        if( dRPhoLeadEle < sel.ElePhotonDrCut || dRPhoSubLeadEle < sel.ElePhotonDrCut ) { continue; }
+                        if( fabs( ( electronP4s[isel][iele] + Ph1 ).M() - 91.187 ) < sel.ElePhotonZMassCut ) { continue; }
+                        if( fabs( ( electronP4s[isel][iele] + Ph2 ).M() - 91.187 ) < sel.ElePhotonZMassCut ) { continue; }
+                        diphoElectrons.push_back( ele );
+                        electronPhotonDr.push_back( std::min( dRPhoLeadEle, dRPhoSubLeadEle ) );
+                    }
+                } else if( sel.leptons == StdLeptons ) {
+                    for( auto &muon : muons[isel] ) {
+                        float dRPhoLeadMuon = deltaR( muon->eta(), muon->phi(), lead->superCluster()->eta(), lead->superCluster()->phi() ) ;
+                        float dRPhoSubLeadMuon = deltaR( muon->eta(), muon->phi(), sublead->superCluster()->eta(), sublead->superCluster()->phi() );
+                        if( dRPhoLeadMuon < sel.deltaRMuonPhoThreshold || dRPhoSubLeadMuon < sel.deltaRMuonPhoThreshold ) { continue; }
+                        diphoMuons.push_back( muon );
+                        muonPhotonDr.push_back( std::min( dRPhoLeadMuon, dRPhoSubLeadMuon ) );
+                    }
+                    for( auto &ele : electrons[isel] ) {
+                        if( phoVeto( ele, dipho, sel.deltaRPhoElectronThreshold, sel.DeltaRTrkElec, sel.deltaMassElectronZThreshold ) ) { continue; }
+                        float dRPhoLeadEle = deltaR( ele->eta(), ele->phi(), lead->superCluster()->eta(), lead->superCluster()->phi() ) ;
+                        float dRPhoSubLeadEle = deltaR( ele->eta(), ele->phi(), sublead->superCluster()->eta(), sublead->superCluster()->phi() );
+                        diphoElectrons.push_back( ele );
+                        electronPhotonDr.push_back( std::min( dRPhoLeadEle, dRPhoSubLeadEle ) );
+                    }
+                }
+
+                if( sel.LeptonsZMassCut > 0. ) {
+                    removeZPairs( diphoMuons, muonPhotonDr, sel.LeptonsZMassCut );
+                    removeZPairs( diphoElectrons, electronPhotonDr, sel.LeptonsZMassCut );
+                }
+
+                for( unsigned int imu = 0 ; imu < diphoMuons.size() ; imu++ ) { objects.addMuon( diphoMuons[imu], muonPhotonDr[imu] ); }
+                for( unsigned int iele = 0 ; iele < diphoElectrons.size() ; iele++ ) { objects.addElectron( diphoElectrons[iele], electronPhotonDr[iele] ); }
+
+                for( auto &selected : selectedJets[isel][jetCollectionIndex] ) {
+                    const edm::Ptr<flashgg::Jet> &thejet = selected.jet;
+                    float dRPhoLeadJet, dRPhoSubLeadJet;
+                    if( sel.jetPhotonDrWithSuperCluster ) {
+                        dRPhoLeadJet = deltaR( thejet->eta(), thejet->phi(), lead->superCluster()->eta(), lead->superCluster()->phi() ) ;
+                        dRPhoSubLeadJet = deltaR( thejet->eta(), thejet->phi(), sublead->superCluster()->eta(), sublead->superCluster()->phi() );
+                    } else {
+                        dRPhoLeadJet = deltaR( thejet->eta(), thejet->phi(), lead->eta(), lead->phi() ) ;
+                        dRPhoSubLeadJet = deltaR( thejet->eta(), thejet->phi(), sublead->eta(), sublead->phi() );
+                    }
+                    if( dRPhoLeadJet < sel.deltaRJetLeadPhoThreshold || dRPhoSubLeadJet < sel.deltaRJetSubLeadPhoThreshold ) { continue; }
+
+                    bool passDrLeptons = true;
+                    for( auto &muon : diphoMuons ) {
+                        if( deltaR( thejet->eta(), thejet->phi(), muon->eta(), muon->phi() ) < sel.deltaRJetMuonThreshold ) { passDrLeptons = false; break; }
+                    }
+                    for( auto &ele : diphoElectrons ) {
+                        if( !passDrLeptons ) { break; }
+                        if( deltaR( thejet->eta(), thejet->phi(), ele->eta(), ele->phi() ) < sel.deltaRJetElectronThreshold ) { passDrLeptons = false; }
+                    }
+                    if( !passDrLeptons ) { continue; }
+
+                    objects.addJet( thejet, selected.bDiscriminator );
+                }
+            }
+        }
+
+        for( unsigned int isel = 0 ; isel < selections_.size() ; isel++ ) {
+            evt.put( std::move( cleaned[isel] ), selections_[isel].name );
+        }
+    }
+}
+
+typedef flashgg::DiPhotonCleanedObjectsProducer FlashggDiPhotonCleanedObjectsProducer;
+DEFINE_FWK_MODULE( FlashggDiPhotonCleanedObjectsProducer );
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
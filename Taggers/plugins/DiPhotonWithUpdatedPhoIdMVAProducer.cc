@@ -7,6 +7,7 @@
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 #include "flashgg/MicroAOD/interface/PhotonIdUtils.h"
+#include "flashgg/MicroAOD/interface/GraphLookupTable.h"
 #include "flashgg/DataFormats/interface/DiPhotonCandidate.h"
 #include "RecoEgamma/EgammaTools/interface/EffectiveAreas.h"
 // #include "RecoEgamma/EgammaTools/plugins/EGExtraInfoModifierFromDB.cc"
@@ -45,10 +46,10 @@ namespace flashgg {
         bool debug_;
         //        std::vector<TGraph*> corrections_;
         bool correctInputs_;
-        std::vector<std::unique_ptr<TGraph> > corrections_;
+        std::vector<GraphLookupTable> corrections_;
 
         bool doNon5x5transformation_;
-        std::vector<std::unique_ptr<TGraph> > non5x5corrections_;
+        std::vector<GraphLookupTable> non5x5corrections_;
 
         bool useNewPhoId_;
         bool is2017_;
@@ -98,14 +99,10 @@ namespace flashgg {
         if (correctInputs_) {
             correctionFile_ = ps.getParameter<edm::FileInPath>( "correctionFile" );
             TFile* f = TFile::Open(correctionFile_.fullPath().c_str());
-            corrections_.emplace_back((TGraph*)((TGraph*) f->Get("transffull5x5R9EB"))->Clone() );
-            corrections_.emplace_back((TGraph*)((TGraph*) f->Get("transfEtaWidthEB"))->Clone() );
-            corrections_.emplace_back((TGraph*)((TGraph*) f->Get("transfS4EB"))->Clone() );
-            corrections_.emplace_back((TGraph*)((TGraph*) f->Get("transffull5x5sieieEB"))->Clone() );
-            corrections_.emplace_back((TGraph*)((TGraph*) f->Get("transffull5x5R9EE"))->Clone() );
-            corrections_.emplace_back((TGraph*)((TGraph*) f->Get("transfEtaWidthEE"))->Clone() );
-            corrections_.emplace_back((TGraph*)((TGraph*) f->Get("transfS4EE"))->Clone() );
-            corrections_.emplace_back((TGraph*)((TGraph*) f->Get("transffull5x5sieieEE"))->Clone() );
+            for( auto name : { "transffull5x5R9EB", "transfEtaWidthEB", "transfS4EB", "transffull5x5sieieEB",
+                        "transffull5x5R9EE", "transfEtaWidthEE", "transfS4EE", "transffull5x5sieieEE" } ) {
+                corrections_.emplace_back( *( (TGraph*) f->Get( name ) ) );
+            }
             f->Close();
         }
 
@@ -113,14 +110,10 @@ namespace flashgg {
         if (doNon5x5transformation_) {
             non5x5correctionFile_ = ps.getParameter<edm::FileInPath>( "non5x5correctionFile" );
             TFile* non5x5_f = TFile::Open(non5x5correctionFile_.fullPath().c_str());
-            non5x5corrections_.emplace_back((TGraph*)((TGraph*) non5x5_f->Get("transfr9EB"))->Clone() );
-            non5x5corrections_.emplace_back((TGraph*)((TGraph*) non5x5_f->Get("transfsieieEB"))->Clone() );
-            non5x5corrections_.emplace_back((TGraph*)((TGraph*) non5x5_f->Get("transfsipipEB"))->Clone() );
-            non5x5corrections_.emplace_back((TGraph*)((TGraph*) non5x5_f->Get("transfsieipEB"))->Clone() );
-            non5x5corrections_.emplace_back((TGraph*)((TGraph*) non5x5_f->Get("transfr9EE"))->Clone() );
-            non5x5corrections_.emplace_back((TGraph*)((TGraph*) non5x5_f->Get("transfsieieEE"))->Clone() );
-            non5x5corrections_.emplace_back((TGraph*)((TGraph*) non5x5_f->Get("transfsipipEE"))->Clone() );
-            non5x5corrections_.emplace_back((TGraph*)((TGraph*) non5x5_f->Get("transfsieipEE"))->Clone() );
+            for( auto name : { "transfr9EB", "transfsieieEB", "transfsipipEB", "transfsieipEB",
+                        "transfr9EE", "transfsieieEE", "transfsipipEE", "transfsieipEE" } ) {
+                non5x5corrections_.emplace_back( *( (TGraph*) non5x5_f->Get( name ) ) );
+            }
             non5x5_f->Close();
         }
 
@@ -167,12 +160,12 @@ namespace flashgg {
         ph.addUserFloat("uncorr_s4",ph.s4());
         ph.addUserFloat("uncorr_sigmaIetaIeta",ph.full5x5_sigmaIetaIeta());
 
-        newShowerShapes.e3x3 = corrections_[corr_index+0]->Eval(ph.full5x5_r9())*ph.superCluster()->rawEnergy();
-        newShowerShapes.sigmaIetaIeta = corrections_[corr_index+3]->Eval(ph.full5x5_sigmaIetaIeta());
+        newShowerShapes.e3x3 = corrections_[corr_index+0](ph.full5x5_r9())*ph.superCluster()->rawEnergy();
+        newShowerShapes.sigmaIetaIeta = corrections_[corr_index+3](ph.full5x5_sigmaIetaIeta());
 
-        float correctedEtaWidth = corrections_[corr_index+1]->Eval(ph.superCluster()->etaWidth());
+        float correctedEtaWidth = corrections_[corr_index+1](ph.superCluster()->etaWidth());
         ph.getSuperCluster()->setEtaWidth(correctedEtaWidth);
-        ph.setS4(corrections_[corr_index+2]->Eval(ph.s4()));
+        ph.setS4(corrections_[corr_index+2](ph.s4()));
 
         ph.full5x5_setShowerShapeVariables(newShowerShapes);
         return correctedEtaWidth;
@@ -192,10 +185,10 @@ namespace flashgg {
         ph.addUserFloat("uncorr_non5x5_sigmaIphiIphi",non5x5ShowerShapes.sigmaIphiIphi);
         ph.addUserFloat("uncorr_non5x5_sigmaIetaIphi",non5x5ShowerShapes.sigmaIetaIphi);
 
-        non5x5ShowerShapes.e3x3          = non5x5corrections_[corr_index+0]->Eval(ph.old_r9())*ph.superCluster()->rawEnergy();
-        non5x5ShowerShapes.sigmaIetaIeta = non5x5corrections_[corr_index+1]->Eval(non5x5ShowerShapes.sigmaIetaIeta);
-        non5x5ShowerShapes.sigmaIphiIphi = non5x5corrections_[corr_index+2]->Eval(non5x5ShowerShapes.sigmaIphiIphi);
-        non5x5ShowerShapes.sigmaIetaIphi = non5x5corrections_[corr_index+3]->Eval(non5x5ShowerShapes.sigmaIetaIphi);
+        non5x5ShowerShapes.e3x3          = non5x5corrections_[corr_index+0](ph.old_r9())*ph.superCluster()->rawEnergy();
+        non5x5ShowerShapes.sigmaIetaIeta = non5x5corrections_[corr_index+1](non5x5ShowerShapes.sigmaIetaIeta);
+        non5x5ShowerShapes.sigmaIphiIphi = non5x5corrections_[corr_index+2](non5x5ShowerShapes.sigmaIphiIphi);
+        non5x5ShowerShapes.sigmaIetaIphi = non5x5corrections_[corr_index+3](non5x5ShowerShapes.sigmaIetaIphi);
 
         ph.setShowerShapeVariables(non5x5ShowerShapes);
         return;
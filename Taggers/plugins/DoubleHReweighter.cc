@@ -6,12 +6,14 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/EDMException.h"
+#include "FWCore/Utilities/interface/Digest.h"
 
 #include "flashgg/DataFormats/interface/DiPhotonCandidate.h"
 #include "flashgg/DataFormats/interface/Jet.h"
 #include "flashgg/DataFormats/interface/DiPhotonMVAResult.h"
 #include "flashgg/DataFormats/interface/DoubleHTag.h"
 #include "flashgg/DataFormats/interface/TagTruthBase.h"
+#include "flashgg/Taggers/interface/DoubleHReweightGrid.h"
 #include "DataFormats/Common/interface/RefToPtr.h"
 
 #include "TLorentzVector.h"
@@ -19,6 +21,9 @@
 
 #include <vector>
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
 #include "TH2F.h"
 #include "TFile.h"
 
@@ -36,6 +41,10 @@ namespace flashgg {
         void produce( Event &, const EventSetup & ) override;
         float getWeight( int targetNode,float gen_mHH, float gen_cosTheta);
         float getCosThetaStar_CS(TLorentzVector h1, TLorentzVector h2, float ebeam);
+        void loadGridsFromHistograms();
+        bool readGridCache();
+        void writeGridCache() const;
+        static std::string fileDigest( const std::string &path );
 
         EDGetTokenT<View<reco::GenParticle> > genParticleToken_;
         int targetNode_;
@@ -43,9 +52,11 @@ namespace flashgg {
         edm::FileInPath benchmarksWeightsFile_;
         const unsigned int NUM_benchmarks = 12; // number of becnhmarks for reweighting
         const unsigned int NUM_gridsize = 1507; // size of the grid used for reweighting
-        std::vector<TH2F*> hists_fullgrid;
-        TFile* f_fullgrid_ ;
-        TFile* f_benchmarks_ ;
+        std::string gridCacheFile_;
+        std::string gridCacheKey_;
+        DoubleHReweightGrid fullGrid_;
+        DoubleHReweightGrid benchmarksGrid_;
+        std::vector<float> NRWeights_;
 
     };
 
@@ -53,41 +64,111 @@ namespace flashgg {
         genParticleToken_( consumes<View<reco::GenParticle> >( iConfig.getParameter<InputTag> ( "GenParticleTag" ) ) ),
         targetNode_( iConfig.getParameter<int> ( "targetNode" ) ),
         fullGridWeightsFile_(iConfig.getUntrackedParameter<edm::FileInPath>("fullGridWeightsFile")),
-        benchmarksWeightsFile_(iConfig.getUntrackedParameter<edm::FileInPath>("benchmarksWeightsFile"))
+        benchmarksWeightsFile_(iConfig.getUntrackedParameter<edm::FileInPath>("benchmarksWeightsFile")),
+        gridCacheFile_(iConfig.getUntrackedParameter<std::string>("gridCacheFile", ""))
     {
         //Get the taget node from the config file
         //also write in the config file the path and name for the root files needed for the reweighting
 
-            f_fullgrid_ = new TFile((fullGridWeightsFile_.fullPath()).c_str(), "READ");
-            f_benchmarks_ = new TFile((benchmarksWeightsFile_.fullPath()).c_str(), "READ");
-            
-            for (unsigned int n=0; n<NUM_gridsize; n++){
-               // The points do not exist in the input file provided by Alexandra (and wont ever be added)
-                if (n==324 || n==910 || n==985 || n==990)  hists_fullgrid.push_back((TH2F*)f_fullgrid_->Get("point_0_weights"));
-                else hists_fullgrid.push_back((TH2F*)f_fullgrid_->Get(Form("point_%i_weights",n)));
-                if (!(hists_fullgrid[n])) throw cms::Exception( "Configuration" ) << "The file "<<fullGridWeightsFile_.fullPath()<<" provided for reweighting full grid does not contain the expected histograms."<<std::endl;
-            }
-            for (unsigned int n=0; n<NUM_benchmarks; n++){
-                hists_fullgrid.push_back((TH2F*)f_benchmarks_->Get(Form("point_%i_weights",n)));
-                if (!(hists_fullgrid[NUM_gridsize+n])) throw cms::Exception( "Configuration" ) << "The file "<<benchmarksWeightsFile_.fullPath()<<" provided for reweighting benchmarks does not contain the expected histograms."<<std::endl;
+        // the weights are converted once into contiguous arrays; optionally these are cached in a binary file,
+        // which is used as long as the input files do not change, to avoid reading ~1500 histograms at start-up;
+        // the cache is keyed on the MD5 of the content of the input files
+        if( ! gridCacheFile_.empty() ) {
+            gridCacheKey_ = Form( "%s %s %u %u", fullGridWeightsFile_.relativePath().c_str(), benchmarksWeightsFile_.relativePath().c_str(),
+                                  NUM_gridsize, NUM_benchmarks );
+            for( auto &path : { fullGridWeightsFile_.fullPath(), benchmarksWeightsFile_.fullPath() } ) {
+                gridCacheKey_ += " " + fileDigest( path );
             }
+        }
+        if( gridCacheFile_.empty() || ! readGridCache() ) {
+            loadGridsFromHistograms();
+            if( ! gridCacheFile_.empty() ) { writeGridCache(); }
+        }
+        NRWeights_.resize( NUM_benchmarks );
 
         produces<float>();
     }
     
 
-    float DoubleHReweighter::getWeight( int targetNode,float gen_mHH, float gen_cosTheta)
+    void DoubleHReweighter::loadGridsFromHistograms()
     {
-        float w = 0.;
-          // The points do not exist in the input file provided by Alexandra (and wont ever be added)
-        if (targetNode==324 || targetNode==910 || targetNode==985 || targetNode==990)  w=0;
-        else 
+        TFile* f_fullgrid = TFile::Open((fullGridWeightsFile_.fullPath()).c_str(), "READ");
+        TFile* f_benchmarks = TFile::Open((benchmarksWeightsFile_.fullPath()).c_str(), "READ");
+        if (!f_fullgrid || !f_benchmarks) throw cms::Exception( "Configuration" ) << "Could not open the files provided for reweighting: "<<fullGridWeightsFile_.fullPath()<<" "<<benchmarksWeightsFile_.fullPath()<<std::endl;
+
+        std::vector<const TH2*> hists_fullgrid;
+        for (unsigned int n=0; n<NUM_gridsize; n++){
+            // The points do not exist in the input file provided by Alexandra (and wont ever be added): their weight is 0
+            if (n==324 || n==910 || n==985 || n==990) {
+                hists_fullgrid.push_back(nullptr);
+                continue;
+            }
+            hists_fullgrid.push_back((TH2F*)f_fullgrid->Get(Form("point_%i_weights",n)));
+            if (!(hists_fullgrid[n])) throw cms::Exception( "Configuration" ) << "The file "<<fullGridWeightsFile_.fullPath()<<" provided for reweighting full grid does not contain the expected histograms."<<std::endl;
+        }
+        std::vector<const TH2*> hists_benchmarks;
+        for (unsigned int n=0; n<NUM_benchmarks; n++){
+            hists_benchmarks.push_back((TH2F*)f_benchmarks->Get(Form("point_%i_weights",n)));
+            if (!(hists_benchmarks[n])) throw cms::Exception( "Configuration" ) << "The file "<<benchmarksWeightsFile_.fullPath()<<" provided for reweighting benchmarks does not contain the expected histograms."<<std::endl;
+        }
+        fullGrid_.build(hists_fullgrid);
+        benchmarksGrid_.build(hists_benchmarks);
+
+        f_fullgrid->Close();
+        f_benchmarks->Close();
+        delete f_fullgrid;
+        delete f_benchmarks;
+    }
+
+    bool DoubleHReweighter::readGridCache()
+    {
+        std::ifstream in( gridCacheFile_, std::ios::binary );
+        if( ! in ) { return false; }
+        std::string key;
+        if( ! std::getline( in, key, '\0' ) || key != gridCacheKey_ ) {
+            std::cout << "DoubleHReweighter: grid cache " << gridCacheFile_ << " does not match the weights files, it will be rebuilt." << std::endl;
+            return false;
+        }
+        return fullGrid_.read( in ) && benchmarksGrid_.read( in )
+            && fullGrid_.nPoints() == NUM_gridsize && benchmarksGrid_.nPoints() == NUM_benchmarks;
+    }
+
+    std::string DoubleHReweighter::fileDigest( const std::string &path )
+    {
+        std::ifstream in( path, std::ios::binary );
+        if( ! in ) { throw cms::Exception( "Configuration" ) << "Could not open the file provided for reweighting: " << path << std::endl; }
+        cms::Digest digest;
+        std::vector<char> buffer( 1 << 20 );
+        while( in.read( buffer.data(), buffer.size() ) || in.gcount() > 0 ) {
+            digest.append( buffer.data(), in.gcount() );
+        }
+        return digest.digest().toString();
+    }
+
+    void DoubleHReweighter::writeGridCache() const
+    {
+        // write to a temporary file and rename it, so that concurrent jobs never read a partial cache
+        std::string tmpName = Form( "%s.%d.tmp", gridCacheFile_.c_str(), getpid() );
         {
-            unsigned int binNum = hists_fullgrid[targetNode]->FindBin(gen_mHH, fabs(gen_cosTheta));
-            w = hists_fullgrid[targetNode]->GetBinContent(binNum);
+            std::ofstream out( tmpName, std::ios::binary );
+            out.write( gridCacheKey_.c_str(), gridCacheKey_.size() + 1 );
+            fullGrid_.write( out );
+            benchmarksGrid_.write( out );
+            if( ! out ) {
+                std::cout << "DoubleHReweighter: could not write grid cache " << gridCacheFile_ << std::endl;
+                std::remove( tmpName.c_str() );
+                return;
+            }
+        }
+        std::rename( tmpName.c_str(), gridCacheFile_.c_str() );
+    }
+
+    float DoubleHReweighter::getWeight( int targetNode,float gen_mHH, float gen_cosTheta)
+    {
+        if ((unsigned int)targetNode < NUM_gridsize) {
+            return fullGrid_.weight(fullGrid_.findBin(gen_mHH, fabs(gen_cosTheta)), targetNode);
         }
-  
-    return w;
+        return benchmarksGrid_.weight(benchmarksGrid_.findBin(gen_mHH, fabs(gen_cosTheta)), targetNode - NUM_gridsize);
     }
 
     
@@ -140,11 +221,10 @@ namespace flashgg {
             // histograms are provided only up to gen_mHH < 1800 GeV
             if (gen_mHH<1800) {
                 float gen_cosTheta = getCosThetaStar_CS(H1,H2,6500.);   //beam energy 6500
-                // Now, lets fill in the weigts for the 12 benchmarks.
-                std::vector<float> NRWeights; //we will use this in the future when we would like to save all weights
-                for (unsigned int n=0; n<NUM_benchmarks; n++) 
-                    NRWeights.push_back(getWeight(NUM_gridsize+n, gen_mHH, gen_cosTheta));
-                float NRWeight_target =  NRWeights[-2+targetNode_]; //In our convention nodes start from node_2 and go up to node_13, therefore shift -2
+                // Now, lets fill in the weigts for the 12 benchmarks: a single bin lookup for all of them
+                const float *weights = benchmarksGrid_.weights(benchmarksGrid_.findBin(gen_mHH, fabs(gen_cosTheta)));
+                std::copy(weights, weights + NUM_benchmarks, NRWeights_.begin()); //we will use this in the future when we would like to save all weights
+                float NRWeight_target =  NRWeights_[-2+targetNode_]; //In our convention nodes start from node_2 and go up to node_13, therefore shift -2
                 ( *final_weight ) = NRWeight_target;
             }
         } 
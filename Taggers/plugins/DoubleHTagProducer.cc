@@ -9,6 +9,7 @@
 
 #include "flashgg/DataFormats/interface/DiPhotonCandidate.h"
 #include "flashgg/DataFormats/interface/Jet.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
 #include "flashgg/DataFormats/interface/DiPhotonMVAResult.h"
 #include "flashgg/DataFormats/interface/DoubleHTag.h"
 #include "flashgg/DataFormats/interface/TagTruthBase.h"
@@ -38,14 +39,14 @@ namespace flashgg {
         int chooseCategory( float mva, float mx );
         
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
-        std::vector<edm::EDGetTokenT<edm::View<flashgg::Jet> > > jetTokens_;
+        // jets selected and cleaned against the diphotons by the DiPhotonCleanedObjectsProducer
+        EDGetTokenT<vector<DiPhotonCleanedObjects> > cleanedObjectsToken_;
         EDGetTokenT<View<reco::GenParticle> > genParticleToken_;
         string systLabel_;
 
         double minLeadPhoPt_, minSubleadPhoPt_;
         bool scalingPtCuts_, doPhotonId_, doMVAFlattening_, doCategorization_;
         double photonIDCut_;
-        double vetoConeSize_;         
         unsigned int doSigmaMDecorr_;
         edm::FileInPath sigmaMDecorrFile_;
         std::vector<int> photonElectronVeto_;
@@ -55,14 +56,9 @@ namespace flashgg {
         DecorrTransform* transfNotEBEB_;
 
 
-        double minJetPt_;
-        double maxJetEta_;
         vector<double>mjjBoundaries_;
         vector<double>mjjBoundariesLower_;
         vector<double>mjjBoundariesUpper_;
-        vector<std::string> bTagType_;
-        bool       useJetID_;
-        string     JetIDLevel_;        
 
         GlobalVariablesDumper globalVariablesDumper_;
         MVAComputer<DoubleHTag> mvaComputer_;
@@ -77,17 +73,12 @@ namespace flashgg {
 
     DoubleHTagProducer::DoubleHTagProducer( const ParameterSet &iConfig ) :
         diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
+        cleanedObjectsToken_( consumes<vector<DiPhotonCleanedObjects> >( iConfig.getParameter<InputTag> ( "CleanedObjectsTag" ) ) ),
         genParticleToken_( consumes<View<reco::GenParticle> >( iConfig.getParameter<InputTag> ( "GenParticleTag" ) ) ),
         systLabel_( iConfig.getParameter<string> ( "SystLabel" ) ),
         minLeadPhoPt_( iConfig.getParameter<double> ( "MinLeadPhoPt" ) ),
         minSubleadPhoPt_( iConfig.getParameter<double> ( "MinSubleadPhoPt" ) ),
         scalingPtCuts_( iConfig.getParameter<bool> ( "ScalingPtCuts" ) ),
-        vetoConeSize_( iConfig.getParameter<double> ( "VetoConeSize" ) ),
-        minJetPt_( iConfig.getParameter<double> ( "MinJetPt" ) ),
-        maxJetEta_( iConfig.getParameter<double> ( "MaxJetEta" ) ),
-        bTagType_( iConfig.getParameter<vector<std::string>>( "BTagType") ),
-        useJetID_( iConfig.getParameter<bool>   ( "UseJetID"     ) ),
-        JetIDLevel_( iConfig.getParameter<string> ( "JetIDLevel"   ) ),
         globalVariablesDumper_(iConfig.getParameter<edm::ParameterSet>("globalVariables")),
         mvaComputer_(iConfig.getParameter<edm::ParameterSet>("MVAConfig"),  &globalVariablesDumper_)
     {
@@ -98,9 +89,6 @@ namespace flashgg {
         mjjBoundariesUpper_ = iConfig.getParameter<vector<double > >( "MJJBoundariesUpper" ); 
         multiclassSignalIdx_ = (iConfig.getParameter<edm::ParameterSet>("MVAConfig")).getParameter<int>("multiclassSignalIdx"); 
 
-        auto jetTags = iConfig.getParameter<std::vector<edm::InputTag> > ( "JetTags" ); 
-        for( auto & tag : jetTags ) { jetTokens_.push_back( consumes<edm::View<flashgg::Jet> >( tag ) ); }
-        
         assert(is_sorted(mvaBoundaries_.begin(), mvaBoundaries_.end()) && "mva boundaries are not in ascending order (we count on that for categorization)");
         assert(is_sorted(mxBoundaries_.begin(), mxBoundaries_.end()) && "mx boundaries are not in ascending order (we count on that for categorization)");
         doPhotonId_ = iConfig.getUntrackedParameter<bool>("ApplyEGMPhotonID");        
@@ -193,6 +181,12 @@ namespace flashgg {
         // read diphotons
         Handle<View<flashgg::DiPhotonCandidate> > diPhotons;
         evt.getByToken( diPhotonToken_, diPhotons );
+        Handle<vector<DiPhotonCleanedObjects> > cleanedObjects;
+        evt.getByToken( cleanedObjectsToken_, cleanedObjects );
+        if( cleanedObjects->size() != diPhotons->size() ) {
+            throw cms::Exception( "Configuration" ) << " DoubleHTagProducer: " << cleanedObjects->size() << " cleaned objects for " << diPhotons->size()
+                                                    << " diphotons, CleanedObjectsTag must be built from DiPhotonTag";
+        }
 
         // prepare output
         std::unique_ptr<vector<DoubleHTag> > tags( new vector<DoubleHTag> );
@@ -258,29 +252,15 @@ namespace flashgg {
             }
             
             
-            // find vertex associated to diphoton object
-            size_t vtx = (size_t)dipho->jetCollectionIndex();
-            // and read corresponding jet collection
-            edm::Handle<edm::View<flashgg::Jet> > jets;
-            evt.getByToken( jetTokens_[vtx], jets);
-            
-            // photon-jet cross-cleaning and pt/eta/btag/jetid cuts for jets
+            // jets passing the pt/eta/jetid cuts and cleaned against the photons, with their summed b-tag
+            const DiPhotonCleanedObjects &objects = cleanedObjects->at( candIndex );
             std::vector<edm::Ptr<flashgg::Jet> > cleaned_jets;
-            for( size_t ijet=0; ijet < jets->size(); ++ijet ) {//jets are ordered in pt
-                auto jet = jets->ptrAt(ijet);
-                if (jet->pt()<minJetPt_ || fabs(jet->eta())>maxJetEta_)continue;
-                double btag=0.;
-                for (unsigned int btag_num=0;btag_num<bTagType_.size();btag_num++)
-                        btag+=jet->bDiscriminator(bTagType_[btag_num]); 
+            std::vector<double> cleaned_btags;
+            for( size_t ijet=0; ijet < objects.nJets(); ++ijet ) {//jets are ordered in pt
+                double btag = objects.jetBDiscriminators()[ijet];
                 if (btag<0) continue;//FIXME threshold might not be 0? For CMVA and DeepCSV it is 0.
-                if( useJetID_ ){
-                    if( JetIDLevel_ == "Loose" && !jet->passesJetID  ( flashgg::Loose ) ) continue;
-                    if( JetIDLevel_ == "Tight" && !jet->passesJetID  ( flashgg::Tight ) ) continue;
-                    if( JetIDLevel_ == "Tight2017" && !jet->passesJetID  ( flashgg::Tight2017 ) ) continue;
-                }
-                if( reco::deltaR( *jet, *(dipho->leadingPhoton()) ) > vetoConeSize_ && reco::deltaR( *jet, *(dipho->subLeadingPhoton()) ) > vetoConeSize_ ) {
-                    cleaned_jets.push_back( jet );
-                }
+                cleaned_jets.push_back( objects.jets()[ijet] );
+                cleaned_btags.push_back( btag );
             }
             if( cleaned_jets.size() < 2 ) { continue; }
             //dijet pair selection. Do pair according to pt and choose the pair with highest b-tag
@@ -293,9 +273,7 @@ namespace flashgg {
                     auto jet_2 = cleaned_jets[kjet];
                     auto dijet_mass = (jet_1->p4()+jet_2->p4()).mass(); 
                     if (dijet_mass<mjjBoundaries_[0] || dijet_mass>mjjBoundaries_[1]) continue;
-                    double sumbtag=0.;
-                    for (unsigned int btag_num=0;btag_num<bTagType_.size();btag_num++)
-                        sumbtag+=jet_1->bDiscriminator(bTagType_[btag_num]) + jet_2->bDiscriminator(bTagType_[btag_num]);
+                    double sumbtag = cleaned_btags[ijet] + cleaned_btags[kjet];
                     if (sumbtag > sumbtag_ref) {
                         hasDijet = true;
                         sumbtag_ref = sumbtag;
@@ -14,6 +14,7 @@
 #include "flashgg/DataFormats/interface/DiPhotonMVAResult.h"
 #include "flashgg/DataFormats/interface/Electron.h"
 #include "flashgg/DataFormats/interface/Muon.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
 
 #include "flashgg/Taggers/interface/LeptonSelection2018.h"
 #include "flashgg/DataFormats/interface/Met.h"
@@ -52,24 +53,18 @@ namespace flashgg {
         void produce( Event &, const EventSetup & ) override;
         int  chooseCategory( float );
 
-        std::vector<edm::EDGetTokenT<View<flashgg::Jet> > > tokenJets_;
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
-        std::vector<edm::InputTag> inputTagJets_;
-        EDGetTokenT<View<Electron> > electronToken_;
-        EDGetTokenT<View<flashgg::Muon> > muonToken_;
-        EDGetTokenT<View<reco::Vertex> > vertexToken_;
+        EDGetTokenT<vector<DiPhotonCleanedObjects> > cleanedObjectsToken_;
         EDGetTokenT<View<DiPhotonMVAResult> > mvaResultToken_;
         EDGetTokenT<View<flashgg::Met> > METToken_;
         EDGetTokenT<View<reco::GenParticle> > genParticleToken_;
         EDGetTokenT<int> stage0catToken_, stage1catToken_, njetsToken_;
         EDGetTokenT<HTXS::HiggsClassification> newHTXSToken_;
         EDGetTokenT<float> pTHToken_,pTVToken_;
-        EDGetTokenT<double> rhoTag_;
         EDGetTokenT<edm::TriggerResults> triggerRECO_;
         string systLabel_;
 
 
-        typedef std::vector<edm::Handle<edm::View<flashgg::Jet> > > JetCollectionVector;
         bool useTTHHadronicMVA_;
         bool applyMETfilters_;
 
@@ -86,11 +81,6 @@ namespace flashgg {
         bool   subleadPhoUseVariableTh_;
         double subleadPhoOverMassThreshold_;
         //---jets
-        double jetPtThreshold_;
-        double jetEtaThreshold_;
-        double dRJetPhoLeadCut_;
-        double dRJetPhoSubleadCut_;
-        vector<double> bDiscriminator_;
         double jetsNumberThreshold_;
         double bjetsNumberThreshold_;
         double bjetsLooseNumberThreshold_;
@@ -98,20 +88,7 @@ namespace flashgg {
         double bjetsNumberTTHHMVAThreshold_;
         double bjetsLooseNumberTTHHMVAThreshold_;
         double secondMaxBTagTTHHMVAThreshold_;
-      string bTag_;
 
-        //leptons
-
-        double MuonEtaCut_;
-        double MuonPtCut_;
-        double MuonIsoCut_;
-        double MuonPhotonDrCut_;
-
-        double ElePtCut_;
-        std::vector<double> EleEtaCuts_;
-        double ElePhotonDrCut_;
-        double ElePhotonZMassCut_;
-        double DeltaRTrkEle_;
         bool debug_;
 
         unique_ptr<TMVA::Reader>TThMva_;
@@ -181,14 +158,11 @@ namespace flashgg {
 
     TTHHadronicTagProducer::TTHHadronicTagProducer( const ParameterSet &iConfig ) :
         diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
-        inputTagJets_( iConfig.getParameter<std::vector<edm::InputTag> >( "inputTagJets" ) ),
-        electronToken_( consumes<View<flashgg::Electron> >( iConfig.getParameter<InputTag>( "ElectronTag" ) ) ),
-        muonToken_( consumes<View<flashgg::Muon> >( iConfig.getParameter<InputTag>( "MuonTag" ) ) ),
-        vertexToken_( consumes<View<reco::Vertex> >( iConfig.getParameter<InputTag> ( "VertexTag" ) ) ),
+        // lepton veto and jets selected and cleaned against the diphotons by the DiPhotonCleanedObjectsProducer
+        cleanedObjectsToken_( consumes<vector<DiPhotonCleanedObjects> >( iConfig.getParameter<InputTag> ( "CleanedObjectsTag" ) ) ),
         mvaResultToken_( consumes<View<flashgg::DiPhotonMVAResult> >( iConfig.getParameter<InputTag>( "MVAResultTag" ) ) ),
         METToken_( consumes<View<flashgg::Met> >( iConfig.getParameter<InputTag> ( "METTag" ) ) ),
         genParticleToken_( consumes<View<reco::GenParticle> >( iConfig.getParameter<InputTag> ( "GenParticleTag" ) ) ),
-        rhoTag_( consumes<double>( iConfig.getParameter<InputTag>( "rhoTag" ) ) ),
 	triggerRECO_( consumes<edm::TriggerResults>(iConfig.getParameter<InputTag>("RECOfilters") ) ),
         systLabel_( iConfig.getParameter<string> ( "SystLabel" ) ),
         _MVAMethod( iConfig.getParameter<string> ( "MVAMethod" ) )
@@ -216,25 +190,8 @@ namespace flashgg {
         subleadPhoPtThreshold_ = iConfig.getParameter<double>( "subleadPhoPtThreshold");
         subleadPhoUseVariableTh_ = iConfig.getParameter<bool>( "subleadPhoUseVariableThreshold");
         subleadPhoOverMassThreshold_ = iConfig.getParameter<double>( "subleadPhoOverMassThreshold");
-        jetPtThreshold_ = iConfig.getParameter<double>( "jetPtThreshold");
-        jetEtaThreshold_ = iConfig.getParameter<double>( "jetEtaThreshold");
-        dRJetPhoLeadCut_ = iConfig.getParameter<double>( "dRJetPhoLeadCut");
-        dRJetPhoSubleadCut_ = iConfig.getParameter<double>( "dRJetPhoSubleadCut");
-        bDiscriminator_ = iConfig.getParameter<vector<double > >( "bDiscriminator");
         jetsNumberThreshold_ = iConfig.getParameter<int>( "jetsNumberThreshold");
         bjetsNumberThreshold_ = iConfig.getParameter<int>( "bjetsNumberThreshold");
-        bTag_ = iConfig.getParameter<string> ( "bTag");
-        MuonEtaCut_ = iConfig.getParameter<double>( "MuonEtaCut");
-        MuonPtCut_ = iConfig.getParameter<double>( "MuonPtCut");
-        MuonIsoCut_ = iConfig.getParameter<double>( "MuonIsoCut");
-        MuonPhotonDrCut_ = iConfig.getParameter<double>( "MuonPhotonDrCut");
- 
-        EleEtaCuts_ = iConfig.getParameter<std::vector<double>>( "EleEtaCuts");
-        ElePtCut_ = iConfig.getParameter<double>( "ElePtCut");
-        ElePhotonDrCut_ = iConfig.getParameter<double>( "ElePhotonDrCut");
-        ElePhotonZMassCut_ = iConfig.getParameter<double>( "ElePhotonZMassCut");
-        DeltaRTrkEle_ = iConfig.getParameter<double>( "DeltaRTrkEle");
-
         debug_ = iConfig.getParameter<bool>( "debug" );
 
         useTTHHadronicMVA_ = iConfig.getParameter<bool>( "useTTHHadronicMVA");
@@ -341,11 +298,6 @@ namespace flashgg {
         
         }       
 
-        for (unsigned i = 0 ; i < inputTagJets_.size() ; i++) {
-            auto token = consumes<View<flashgg::Jet> >(inputTagJets_[i]);
-            tokenJets_.push_back(token);
-        }
-
         produces<vector<TTHHadronicTag> >();
         produces<vector<TagTruthBase> >();
     }
@@ -377,27 +329,17 @@ namespace flashgg {
         //Handle<View<flashgg::Jet> > theJets;
         //evt.getByToken( thejetToken_, theJets );
         // const PtrVector<flashgg::Jet>& jetPointers = theJets->ptrVector();
-        JetCollectionVector Jets( inputTagJets_.size() );
-        for( size_t j = 0; j < inputTagJets_.size(); ++j ) {
-            evt.getByToken( tokenJets_[j], Jets[j] );
-        }
 
         Handle<View<flashgg::DiPhotonCandidate> > diPhotons;
         evt.getByToken( diPhotonToken_, diPhotons );
         // const PtrVector<flashgg::DiPhotonCandidate>& diPhotonPointers = diPhotons->ptrVector();
 
-        Handle<View<flashgg::Muon> > theMuons;
-        evt.getByToken( muonToken_, theMuons );
-
-        Handle<View<flashgg::Electron> > theElectrons;
-        evt.getByToken( electronToken_, theElectrons );
-
-        edm::Handle<double>  rho;
-        evt.getByToken(rhoTag_,rho);
-        double rho_    = *rho;
-
-        Handle<View<reco::Vertex> > vertices;
-        evt.getByToken( vertexToken_, vertices );
+        Handle<vector<DiPhotonCleanedObjects> > cleanedObjects;
+        evt.getByToken( cleanedObjectsToken_, cleanedObjects );
+        if( cleanedObjects->size() != diPhotons->size() ) {
+            throw cms::Exception( "Configuration" ) << " TTHHadronicTagProducer: " << cleanedObjects->size() << " cleaned objects for "
+                                                    << diPhotons->size() << " diphotons, CleanedObjectsTag must be built from DiPhotonTag";
+        }
 
         Handle<View<flashgg::DiPhotonMVAResult> > mvaResults;
         evt.getByToken( mvaResultToken_, mvaResults );
@@ -475,15 +417,9 @@ namespace flashgg {
 
 	    if(!passMETfilters && applyMETfilters_) continue;
 
-            std::vector<edm::Ptr<flashgg::Muon> >     Muons;
-            std::vector<edm::Ptr<flashgg::Electron> > Electrons;
-
-            if(theMuons->size()>0)
-                Muons = selectMuons(theMuons->ptrs(), dipho, vertices->ptrs(), MuonPtCut_, MuonEtaCut_, MuonIsoCut_, MuonPhotonDrCut_, debug_);
-            if(theElectrons->size()>0)
-                Electrons = selectElectrons(theElectrons->ptrs(), dipho, ElePtCut_, EleEtaCuts_, ElePhotonDrCut_, ElePhotonZMassCut_, DeltaRTrkEle_, debug_);
+            const DiPhotonCleanedObjects &objects = cleanedObjects->at( diphoIndex );
 
-            if( (Muons.size() + Electrons.size()) != 0) continue;
+            if( (objects.muons().size() + objects.electrons().size()) != 0) continue;
 
             jetcount_ = 0;
 
@@ -548,8 +484,6 @@ namespace flashgg {
             tthMvaVal_ = -999.;
 
 
-            unsigned int jetCollectionIndex = diPhotons->ptrAt( diphoIndex )->jetCollectionIndex();
-
             std::vector<edm::Ptr<flashgg::Jet> > JetVect;
             JetVect.clear();
             std::vector<edm::Ptr<flashgg::Jet> > BJetVect;
@@ -589,16 +523,12 @@ namespace flashgg {
             if( dipho->leadingPhoton()->pt() < leadPhoPtCut || dipho->subLeadingPhoton()->pt() < subleadPhoPtCut ) { continue; }
             if( mvares->mvaValue() < diphoMVAcut ) { continue; }
 
-            for( unsigned int jetIndex = 0; jetIndex < Jets[jetCollectionIndex]->size() ; jetIndex++ ) {
-                edm::Ptr<flashgg::Jet> thejet = Jets[jetCollectionIndex]->ptrAt( jetIndex );
-                if( fabs( thejet->eta() ) > jetEtaThreshold_ ) { continue; }
-                if(!thejet->passesJetID  ( flashgg::Tight2017 ) ) { continue; }
-                float dRPhoLeadJet = deltaR( thejet->eta(), thejet->phi(), dipho->leadingPhoton()->superCluster()->eta(), dipho->leadingPhoton()->superCluster()->phi() ) ;
-                float dRPhoSubLeadJet = deltaR( thejet->eta(), thejet->phi(), dipho->subLeadingPhoton()->superCluster()->eta(),
-                                                dipho->subLeadingPhoton()->superCluster()->phi() );
+            njets_btagloose_ = objects.nBJets( 0 );
+            njets_btagmedium_ = objects.nBJets( 1 );
+            njets_btagtight_ = objects.nBJets( 2 );
 
-                if( dRPhoLeadJet < dRJetPhoLeadCut_ || dRPhoSubLeadJet < dRJetPhoSubleadCut_ ) { continue; }
-                if( thejet->pt() < jetPtThreshold_ ) { continue; }
+            for( unsigned int jetIndex = 0; jetIndex < objects.nJets() ; jetIndex++ ) {
+                edm::Ptr<flashgg::Jet> thejet = objects.jets()[jetIndex];
 
                 jetcount_++;
                 nJets_ = jetcount_;
@@ -607,11 +537,7 @@ namespace flashgg {
                 //genJetVect.push_back( thejet->genJet());
                 //cout<<"TTH Jet "<< jetcount_<<" Pt:"<<thejet->pt()<<" genPt:"<<thejet->genJet()->pt()<<" hflav: "<<thejet->hadronFlavour()<<" pFlav:"<<thejet->partonFlavour()<< endl;
 
-                float bDiscriminatorValue = -2.;
-                if(bTag_ == "pfDeepCSV") bDiscriminatorValue = thejet->bDiscriminator("pfDeepCSVJetTags:probb")+thejet->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                else  bDiscriminatorValue = thejet->bDiscriminator( bTag_ );
-
-                
+                float bDiscriminatorValue = objects.jetBDiscriminators()[jetIndex];
 
                 float jetPt = thejet->pt();
                 if(jetPt > leadJetPt_){
@@ -655,13 +581,7 @@ namespace flashgg {
 
                 JetBTagVal.push_back( bDiscriminatorValue );
 
-                if( bDiscriminatorValue > bDiscriminator_[0] ) njets_btagloose_++;
-                if( bDiscriminatorValue > bDiscriminator_[1] ){
-                    
-                    njets_btagmedium_++;
-                    BJetVect.push_back( thejet );
-                }
-                if( bDiscriminatorValue > bDiscriminator_[2] ) njets_btagtight_++;
+                if( objects.jetPassesBWorkingPoint( jetIndex, 1 ) ) { BJetVect.push_back( thejet ); }
             }
         
             if( METs->size() != 1 ) { std::cout << "WARNING - #MET is not 1" << std::endl;}
@@ -699,64 +619,27 @@ namespace flashgg {
 		MET_ = theMET->getCorPt();
 
                 if(JetVect.size()>0){
-                    if(bTag_ == "pfDeepCSV") btag_1_=JetVect[0]->bDiscriminator("pfDeepCSVJetTags:probb")+JetVect[0]->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  btag_1_ = JetVect[0]->bDiscriminator( bTag_ );
-                    jetPt_1_=JetVect[0]->pt();
-                    jetEta_1_=JetVect[0]->eta();
-                    jetPhi_1_=JetVect[0]->phi();
-                }
-
-                if(JetVect.size()>1){
-                    if(bTag_ == "pfDeepCSV") btag_2_=JetVect[1]->bDiscriminator("pfDeepCSVJetTags:probb")+JetVect[1]->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  btag_2_ = JetVect[1]->bDiscriminator( bTag_ );
-                    jetPt_2_=JetVect[1]->pt();
-                    jetEta_2_=JetVect[1]->eta();
-                    jetPhi_2_=JetVect[1]->phi();
-                }
-
-                if(JetVect.size()>2){
-                    if(bTag_ == "pfDeepCSV") btag_3_=JetVect[2]->bDiscriminator("pfDeepCSVJetTags:probb")+JetVect[2]->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  btag_3_ = JetVect[2]->bDiscriminator( bTag_ );
-                    jetPt_3_=JetVect[2]->pt();
-                    jetEta_3_=JetVect[2]->eta();
-                    jetPhi_3_=JetVect[2]->phi();
-                }
-                if(JetVect.size()>3){
-                    if(bTag_ == "pfDeepCSV") btag_4_=JetVect[3]->bDiscriminator("pfDeepCSVJetTags:probb")+JetVect[3]->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  btag_4_ = JetVect[3]->bDiscriminator( bTag_ );
-                    jetPt_4_=JetVect[3]->pt();
-                    jetEta_4_=JetVect[3]->eta();
-                    jetPhi_4_=JetVect[3]->phi();
-                }
-
-
-
-                if(JetVect.size()>0){
-                    if(bTag_ == "pfDeepCSV") btag_1_=JetVect[0]->bDiscriminator("pfDeepCSVJetTags:probb")+JetVect[0]->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  btag_1_ = JetVect[0]->bDiscriminator( bTag_ );
+                    btag_1_=JetBTagVal[0];
                     jetPt_1_=JetVect[0]->pt();
                     jetEta_1_=JetVect[0]->eta();
                     jetPhi_1_=JetVect[0]->phi();
                 }
 
                 if(JetVect.size()>1){
-                    if(bTag_ == "pfDeepCSV") btag_2_=JetVect[1]->bDiscriminator("pfDeepCSVJetTags:probb")+JetVect[1]->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  btag_2_ = JetVect[1]->bDiscriminator( bTag_ );
+                    btag_2_=JetBTagVal[1];
                     jetPt_2_=JetVect[1]->pt();
                     jetEta_2_=JetVect[1]->eta();
                     jetPhi_2_=JetVect[1]->phi();
                 }
 
                 if(JetVect.size()>2){
-                    if(bTag_ == "pfDeepCSV") btag_3_=JetVect[2]->bDiscriminator("pfDeepCSVJetTags:probb")+JetVect[2]->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  btag_3_ = JetVect[2]->bDiscriminator( bTag_ );
+                    btag_3_=JetBTagVal[2];
                     jetPt_3_=JetVect[2]->pt();
                     jetEta_3_=JetVect[2]->eta();
                     jetPhi_3_=JetVect[2]->phi();
                 }
                 if(JetVect.size()>3){
-                    if(bTag_ == "pfDeepCSV") btag_4_=JetVect[3]->bDiscriminator("pfDeepCSVJetTags:probb")+JetVect[3]->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  btag_4_ = JetVect[3]->bDiscriminator( bTag_ );
+                    btag_4_=JetBTagVal[3];
                     jetPt_4_=JetVect[3]->pt();
                     jetEta_4_=JetVect[3]->eta();
                     jetPhi_4_=JetVect[3]->phi();
@@ -11,6 +11,7 @@
 #include "flashgg/DataFormats/interface/Jet.h"
 #include "flashgg/DataFormats/interface/DiPhotonCandidate.h"
 #include "flashgg/DataFormats/interface/TTHLeptonicTag.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
 #include "flashgg/DataFormats/interface/Electron.h"
 #include "flashgg/DataFormats/interface/Muon.h"
 #include "flashgg/DataFormats/interface/Met.h"
@@ -65,56 +66,32 @@ namespace flashgg {
         };
         
 
-        std::vector<edm::EDGetTokenT<View<flashgg::Jet> > > tokenJets_;
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
         //EDGetTokenT<View<Jet> > thejetToken_;
-        std::vector<edm::InputTag> inputTagJets_;
-        EDGetTokenT<View<Electron> > electronToken_;
-        EDGetTokenT<View<flashgg::Muon> > muonToken_;
         EDGetTokenT<View<flashgg::Met> > METToken_;
         EDGetTokenT<View<DiPhotonMVAResult> > mvaResultToken_;
         EDGetTokenT<View<Photon> > photonToken_;
-        EDGetTokenT<View<reco::Vertex> > vertexToken_;
         EDGetTokenT<View<reco::GenParticle> > genParticleToken_;
         EDGetTokenT<int> stage0catToken_, stage1catToken_, njetsToken_;
         EDGetTokenT<HTXS::HiggsClassification> newHTXSToken_;
         EDGetTokenT<float> pTHToken_,pTVToken_;
-        EDGetTokenT<double> rhoTag_;
+        EDGetTokenT<vector<DiPhotonCleanedObjects> > cleanedObjectsToken_;
         string systLabel_;
 
-        typedef std::vector<edm::Handle<edm::View<flashgg::Jet> > > JetCollectionVector;
-
         unique_ptr<TMVA::Reader> DiphotonMva_;
         FileInPath MVAweightfile_;
 
         //Thresholds
 
-        double MuonEtaCut_;
-        double MuonPtCut_;
-        double MuonIsoCut_;
-        double MuonPhotonDrCut_;
         int    MinNLep_;
         int    MaxNLep_;
 
-        double ElePtCut_;
-        std::vector<double> EleEtaCuts_;
-        double ElePhotonDrCut_;
-        double ElePhotonZMassCut_;
-        double DeltaRTrkEle_;
-
         double leadPhoOverMassThreshold_;
         double subleadPhoOverMassThreshold_;
         vector<double> MVAThreshold_;
-        double deltaRJetLeadPhoThreshold_;
-        double deltaRJetSubLeadPhoThreshold_;
         double jetsNumberThreshold_;
         double bjetsNumberThreshold_;
-        double jetPtThreshold_;
-        double jetEtaThreshold_;
-        double deltaRJetLepton_;
         double leadingJetPtThreshold_;
-        vector<double> bDiscriminator_;
-        string bTag_;
         double PhoMVAThreshold_;
 
         bool UseCutBasedDiphoId_;
@@ -301,14 +278,11 @@ namespace flashgg {
     TTHLeptonicTagProducer::TTHLeptonicTagProducer( const ParameterSet &iConfig ) :
         diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
         //thejetToken_( consumes<View<flashgg::Jet> >( iConfig.getParameter<InputTag>( "JetTag" ) ) ),
-        inputTagJets_( iConfig.getParameter<std::vector<edm::InputTag> >( "inputTagJets" ) ),
-        electronToken_( consumes<View<flashgg::Electron> >( iConfig.getParameter<InputTag>( "ElectronTag" ) ) ),
-        muonToken_( consumes<View<flashgg::Muon> >( iConfig.getParameter<InputTag>( "MuonTag" ) ) ),
         METToken_( consumes<View<flashgg::Met> >( iConfig.getParameter<InputTag>( "MetTag" ) ) ),
         mvaResultToken_( consumes<View<flashgg::DiPhotonMVAResult> >( iConfig.getParameter<InputTag> ( "MVAResultTag" ) ) ),
-        vertexToken_( consumes<View<reco::Vertex> >( iConfig.getParameter<InputTag> ( "VertexTag" ) ) ),
         genParticleToken_( consumes<View<reco::GenParticle> >( iConfig.getParameter<InputTag> ( "GenParticleTag" ) ) ),
-        rhoTag_( consumes<double>( iConfig.getParameter<InputTag>( "rhoTag" ) ) ),
+        // leptons and jets selected and cleaned against the diphotons by the DiPhotonCleanedObjectsProducer
+        cleanedObjectsToken_( consumes<vector<DiPhotonCleanedObjects> >( iConfig.getParameter<InputTag> ( "CleanedObjectsTag" ) ) ),
         systLabel_( iConfig.getParameter<string> ( "SystLabel" ) )
     {
         leadPhoOverMassThreshold_ = iConfig.getParameter<double>( "leadPhoOverMassThreshold");
@@ -317,30 +291,10 @@ namespace flashgg {
         PhoMVAThreshold_ = iConfig.getParameter<double>( "PhoMVAThreshold");
         jetsNumberThreshold_ = iConfig.getParameter<double>( "jetsNumberThreshold");
         bjetsNumberThreshold_ = iConfig.getParameter<double>( "bjetsNumberThreshold");
-        jetPtThreshold_ = iConfig.getParameter<double>( "jetPtThreshold");
-        jetEtaThreshold_ = iConfig.getParameter<double>( "jetEtaThreshold");
-        deltaRJetLepton_ = iConfig.getParameter<double>( "deltaRJetLepton");
         leadingJetPtThreshold_ = iConfig.getParameter<double>("leadingJetPtThreshold");
 
-        MuonEtaCut_ = iConfig.getParameter<double>( "MuonEtaCut");
-        MuonPtCut_ = iConfig.getParameter<double>( "MuonPtCut");
-        MuonIsoCut_ = iConfig.getParameter<double>( "MuonIsoCut");
-        MuonPhotonDrCut_ = iConfig.getParameter<double>( "MuonPhotonDrCut");
-
         MinNLep_ = iConfig.getParameter<int>( "MinNLep");
         MaxNLep_ = iConfig.getParameter<int>( "MaxNLep");
- 
-        EleEtaCuts_ = iConfig.getParameter<std::vector<double>>( "EleEtaCuts");
-        ElePtCut_ = iConfig.getParameter<double>( "ElePtCut");
-        ElePhotonDrCut_ = iConfig.getParameter<double>( "ElePhotonDrCut");
-        ElePhotonZMassCut_ = iConfig.getParameter<double>( "ElePhotonZMassCut");
-        DeltaRTrkEle_ = iConfig.getParameter<double>( "DeltaRTrkEle");
-
-        deltaRJetLeadPhoThreshold_ = iConfig.getParameter<double>( "deltaRJetLeadPhoThreshold");
-        deltaRJetSubLeadPhoThreshold_ = iConfig.getParameter<double>( "deltaRJetSubLeadPhoThreshold");
-
-        bDiscriminator_ = iConfig.getParameter<vector<double > >( "bDiscriminator");
-        bTag_ = iConfig.getParameter<string>( "bTag");
 
         UseCutBasedDiphoId_ = iConfig.getParameter<bool>( "UseCutBasedDiphoId" );
         debug_ = iConfig.getParameter<bool>( "debug" );
@@ -382,11 +336,6 @@ namespace flashgg {
 
         DiphotonMva_->BookMVA( "BDT", MVAweightfile_.fullPath() );
 
-        for (unsigned i = 0 ; i < inputTagJets_.size() ; i++) {
-            auto token = consumes<View<flashgg::Jet> >(inputTagJets_[i]);
-            tokenJets_.push_back(token);
-        }
-
         produces<vector<TTHLeptonicTag> >();
         produces<vector<TagTruthBase> >();
     }
@@ -417,32 +366,21 @@ namespace flashgg {
         //Handle<View<flashgg::Jet> > theJets;
         //evt.getByToken( thejetToken_, theJets );
         //const PtrVector<flashgg::Jet>& jetPointers = theJets->ptrVector();
-        JetCollectionVector Jets( inputTagJets_.size() );
-        for( size_t j = 0; j < inputTagJets_.size(); ++j ) {
-            evt.getByToken( tokenJets_[j], Jets[j] );
-        }
-
         Handle<View<flashgg::DiPhotonCandidate> > diPhotons;
         evt.getByToken( diPhotonToken_, diPhotons );
 
-        Handle<View<flashgg::Muon> > theMuons;
-        evt.getByToken( muonToken_, theMuons );
-
-        Handle<View<flashgg::Electron> > theElectrons;
-        evt.getByToken( electronToken_, theElectrons );
-
-        edm::Handle<double>  rho;
-        evt.getByToken(rhoTag_,rho);
-        double rho_    = *rho;
+        Handle<vector<DiPhotonCleanedObjects> > cleanedObjects;
+        evt.getByToken( cleanedObjectsToken_, cleanedObjects );
+        if( cleanedObjects->size() != diPhotons->size() ) {
+            throw cms::Exception( "Configuration" ) << " TTHLeptonicTagProducer: " << cleanedObjects->size() << " cleaned objects for "
+                                                    << diPhotons->size() << " diphotons, CleanedObjectsTag must be built from DiPhotonTag";
+        }
 
         Handle<View<flashgg::DiPhotonMVAResult> > mvaResults;
         evt.getByToken( mvaResultToken_, mvaResults );
 
         Handle<View<reco::GenParticle> > genParticles;
 
-        Handle<View<reco::Vertex> > vertices;
-        evt.getByToken( vertexToken_, vertices );
-
         Handle<View<flashgg::Met> > theMet_;
         evt.getByToken( METToken_, theMet_ );
 
@@ -475,8 +413,6 @@ namespace flashgg {
 
         for( unsigned int diphoIndex = 0; diphoIndex < diPhotons->size(); diphoIndex++ )
         {
-            unsigned int jetCollectionIndex = diPhotons->ptrAt( diphoIndex )->jetCollectionIndex();
-
             edm::Ptr<flashgg::DiPhotonCandidate> dipho = diPhotons->ptrAt( diphoIndex );
             edm::Ptr<flashgg::DiPhotonMVAResult> mvares = mvaResults->ptrAt( diphoIndex );
 
@@ -504,8 +440,9 @@ namespace flashgg {
 
             if(!passDiphotonSelection) continue;
 
-            std::vector<edm::Ptr<flashgg::Muon> >     Muons;
-            std::vector<edm::Ptr<flashgg::Electron> > Electrons;
+            const DiPhotonCleanedObjects &objects = cleanedObjects->at( diphoIndex );
+            const std::vector<edm::Ptr<flashgg::Muon> > &Muons = objects.muons();
+            const std::vector<edm::Ptr<flashgg::Electron> > &Electrons = objects.electrons();
 
             std::vector<double> lepPt;
             std::vector<double> lepEta;
@@ -513,11 +450,6 @@ namespace flashgg {
             std::vector<double> lepE;
             std::vector<int>    lepType;
 
-            if(theMuons->size()>0)
-                Muons = selectMuons(theMuons->ptrs(), dipho, vertices->ptrs(), MuonPtCut_, MuonEtaCut_, MuonIsoCut_, MuonPhotonDrCut_, debug_);
-            if(theElectrons->size()>0)
-                Electrons = selectElectrons(theElectrons->ptrs(), dipho, ElePtCut_, EleEtaCuts_, ElePhotonDrCut_, ElePhotonZMassCut_, DeltaRTrkEle_, debug_);
-
             if( (Muons.size() + Electrons.size()) < (unsigned) MinNLep_ || (Muons.size() + Electrons.size()) > (unsigned) MaxNLep_) continue;
  
             // Fill lepton vectors            
@@ -576,71 +508,20 @@ namespace flashgg {
                 }                
             }
             
-            int njet_ = 0;
-            int njets_btagloose_ = 0;
-            int njets_btagmedium_ = 0;
-            int njets_btagtight_ = 0;
-            std::vector<edm::Ptr<flashgg::Jet>> tagJets;
+            int njet_ = objects.nJets();
+            int njets_btagmedium_ = objects.nBJets( 1 );
+            const std::vector<edm::Ptr<flashgg::Jet>> &tagJets = objects.jets();
             std::vector<edm::Ptr<flashgg::Jet>> tagBJets;
             std::vector<float> bTags;
 
-            for( unsigned int jetIndex = 0; jetIndex < Jets[jetCollectionIndex]->size() ; jetIndex++ )
+            for( unsigned int jetIndex = 0; jetIndex < objects.nJets() ; jetIndex++ )
             {
-                edm::Ptr<flashgg::Jet> thejet = Jets[jetCollectionIndex]->ptrAt( jetIndex );
-
-                if( fabs( thejet->eta() ) > jetEtaThreshold_ ) { continue; }
-                if(!thejet->passesJetID  ( flashgg::Loose ) ) { continue; }
-                if( thejet->pt() < jetPtThreshold_ ) { continue; }
-
-                float dRPhoLeadJet = deltaR( thejet->eta(), thejet->phi(), dipho->leadingPhoton()->eta(), dipho->leadingPhoton()->phi() ) ;
-                float dRPhoSubLeadJet = deltaR( thejet->eta(), thejet->phi(), dipho->subLeadingPhoton()->eta(), dipho->subLeadingPhoton()->phi() );
+                float bDiscriminatorValue = objects.jetBDiscriminators()[jetIndex];
 
-                if( dRPhoLeadJet < deltaRJetLeadPhoThreshold_ || dRPhoSubLeadJet < deltaRJetSubLeadPhoThreshold_ ) { continue; }
+                bDiscriminatorValue >= 0. ? bTags.push_back(bDiscriminatorValue) : bTags.push_back(-1.);
 
-                bool passDrLeptons = 1;                
-
-                for( unsigned int muonIndex = 0; muonIndex < Muons.size(); muonIndex++ )
-                {
-                    Ptr<flashgg::Muon> muon = Muons[muonIndex];
-
-                    float dRLept = deltaR( thejet->eta(), thejet->phi(), muon->eta(),  muon->phi() ) ;
-                    if( dRLept > deltaRJetLepton_) { continue; }
-
-                    passDrLeptons = 0;
-                    break;
-                }
-
-                if(passDrLeptons)
-                {   for( unsigned int eleIndex = 0; eleIndex < Electrons.size(); eleIndex++ )
-                    {
-                        Ptr<flashgg::Electron> ele = Electrons[eleIndex];
-                    
-                        float dRLept = deltaR( thejet->eta(), thejet->phi(), ele->eta(),  ele->phi() ) ;
-                        if( dRLept > deltaRJetLepton_) { continue; }
-
-                        passDrLeptons = 0;
-                        break;
-                    }
-                }
-
-                if(passDrLeptons)
-                {
-                    njet_++;
-                    tagJets.push_back( thejet );
-                    float bDiscriminatorValue = -2.;
-                    if(bTag_ == "pfDeepCSV") bDiscriminatorValue = thejet->bDiscriminator("pfDeepCSVJetTags:probb")+thejet->bDiscriminator("pfDeepCSVJetTags:probbb") ;
-                    else  bDiscriminatorValue = thejet->bDiscriminator( bTag_ );
-
-                    bDiscriminatorValue >= 0. ? bTags.push_back(bDiscriminatorValue) : bTags.push_back(-1.);
-
-                    if( bDiscriminatorValue > bDiscriminator_[0] ) njets_btagloose_++;
-                    if( bDiscriminatorValue > bDiscriminator_[1] ) njets_btagmedium_++;
-                    if( bDiscriminatorValue > bDiscriminator_[2] ) njets_btagtight_++;
-
-                    if( bDiscriminatorValue > bDiscriminator_[1] )
-                        tagBJets.push_back( thejet );
-                }
-                 
+                if( objects.jetPassesBWorkingPoint( jetIndex, 1 ) )
+                    tagBJets.push_back( objects.jets()[jetIndex] );
             }
 
             if(njet_ < jetsNumberThreshold_ || njets_btagmedium_ < bjetsNumberThreshold_) continue;
@@ -16,14 +16,17 @@
 #include "DataFormats/Common/interface/RefToPtr.h"
 #include "flashgg/DataFormats/interface/VBFTag.h"
 #include "flashgg/DataFormats/interface/NoTag.h"
+#include "flashgg/MetaData/interface/JobProfiler.h"
 
 #include "SimDataFormats/HTXS/interface/HiggsTemplateCrossSections.h"
 
 #include "TMVA/Reader.h"
 #include "TMath.h"
+#include "TString.h"
 //#include <typeinfo>
 
 #include <algorithm>
+#include <chrono>
 
 
 using namespace std;
@@ -53,11 +56,28 @@ namespace flashgg {
         TagSorter( const ParameterSet & );
     private:
         void produce( Event &, const EventSetup & ) override;
+        void endJob() override;
 
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
         std::vector<edm::EDGetTokenT<View<flashgg::DiPhotonTagBase> > > TagList_;
         std::vector<TagPriorityRange> TagPriorityRanges;
 
+        // per tag collection accounting: with the tag producers run on demand, the time spent in getByToken
+        // is the time spent producing the tag, and the events where the collection is not requested are saved
+        struct TagAccounting {
+            TagAccounting() : nRequested( 0 ), nSkipped( 0 ), time( 0. ) {}
+            unsigned long nRequested;
+            unsigned long nSkipped;
+            double time;
+        };
+        std::vector<std::string> tagLabels_;
+        std::vector<TagAccounting> tagAccounting_;
+        std::vector<bool> tagRequested_;
+        unsigned long nEvents_;
+        bool onDemandTags_;
+        bool tagAccountingSummary_;
+        ProfilerSubTimers subTimers_; // one per tag collection, for the JobProfiler service
+
         double massCutUpper;
         double massCutLower;
 
@@ -82,7 +102,8 @@ namespace flashgg {
     };
 
     TagSorter::TagSorter( const ParameterSet &iConfig ) :
-        diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) )
+        diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
+        nEvents_( 0 )
     {
 
         massCutUpper = iConfig.getParameter<double>( "MassCutUpper" );
@@ -97,6 +118,11 @@ namespace flashgg {
         storeOtherTagInfo_ = iConfig.getParameter<bool>( "StoreOtherTagInfo" );
         blindedSelectionPrintout_ = iConfig.getParameter<bool>("BlindedSelectionPrintout");
         createNoTag_ = iConfig.getParameter<bool>("CreateNoTag");
+        // With OnDemandTags the tag collections are declared as mayConsume, so that they are not prefetched:
+        // tag producers which are not on a path (i.e. in a Task) then only run when requested below,
+        // in priority order, and the lower priority ones are never run once a tag has been chosen
+        onDemandTags_ = iConfig.getUntrackedParameter<bool>( "OnDemandTags", false );
+        tagAccountingSummary_ = iConfig.getUntrackedParameter<bool>( "TagAccountingSummary", false );
 
         const auto &vpset = iConfig.getParameterSetVector( "TagPriorityRanges" );
 
@@ -112,11 +138,20 @@ namespace flashgg {
             }
             if( i == TagList_.size() ) {
                 labels.push_back( tag.label() );
-                TagList_.push_back( consumes<View<flashgg::DiPhotonTagBase> >( tag ) );
+                if( onDemandTags_ ) {
+                    TagList_.push_back( mayConsume<View<flashgg::DiPhotonTagBase> >( tag ) );
+                } else {
+                    TagList_.push_back( consumes<View<flashgg::DiPhotonTagBase> >( tag ) );
+                }
             }
             TagPriorityRanges.emplace_back( tag.label(), c1, c2, i );
         }
 
+        tagLabels_ = labels;
+        tagAccounting_.resize( TagList_.size() );
+        tagRequested_.resize( TagList_.size() );
+        for( const auto &label : tagLabels_ ) { subTimers_.add( label ); }
+
         ParameterSet HTXSps = iConfig.getParameterSet( "HTXSTags" );
         stage0catToken_ = consumes<int>( HTXSps.getParameter<InputTag>("stage0cat") );
         stage1catToken_ = consumes<int>( HTXSps.getParameter<InputTag>("stage1cat") );
@@ -141,11 +176,25 @@ namespace flashgg {
 
         bool alreadyChosen = false;
 
+        ++nEvents_;
+        std::fill( tagRequested_.begin(), tagRequested_.end(), false );
+
         for( auto tpr = TagPriorityRanges.begin() ; tpr != TagPriorityRanges.end() ; tpr++ ) {
             priority += 1; // for debug
 
             Handle<View<flashgg::DiPhotonTagBase> > TagVectorEntry;
-            evt.getByToken( TagList_[tpr->collIndex], TagVectorEntry );
+            // a collection read by several priority ranges is only produced (and timed) the first time
+            if( ! tagRequested_[tpr->collIndex] ) {
+                auto fetchStart = std::chrono::steady_clock::now();
+                subTimers_.start( tpr->collIndex );
+                evt.getByToken( TagList_[tpr->collIndex], TagVectorEntry );
+                subTimers_.stop( tpr->collIndex );
+                tagRequested_[tpr->collIndex] = true;
+                tagAccounting_[tpr->collIndex].nRequested++;
+                tagAccounting_[tpr->collIndex].time += std::chrono::duration<double>( std::chrono::steady_clock::now() - fetchStart ).count();
+            } else {
+                evt.getByToken( TagList_[tpr->collIndex], TagVectorEntry );
+            }
 
             edm::RefProd<edm::OwnVector<TagTruthBase> > rTagTruth = evt.getRefBeforePut<edm::OwnVector<TagTruthBase> >();
 
@@ -250,6 +299,10 @@ namespace flashgg {
             }
         } 
 
+        for( unsigned int i = 0 ; i < tagRequested_.size() ; i++ ) {
+            if( ! tagRequested_[i] ) { tagAccounting_[i].nSkipped++; }
+        }
+
         if ( SelectedTag->size() == 1  && storeOtherTagInfo_ && debug_ ) {
             if ( SelectedTag->back().nOtherTags() > 0 ) {
                 std::cout << "[TagSorter DEBUG] List of other tags: (" << SelectedTag->back().nOtherTags() << " total):" << std::endl;
@@ -354,6 +407,27 @@ namespace flashgg {
         evt.put( std::move( SelectedTagTruth ) );
     }
 
+    void TagSorter::endJob()
+    {
+        if( ! tagAccountingSummary_ || nEvents_ == 0 ) { return; }
+        std::cout << "[TagSorter] Tag collection accounting over " << nEvents_ << " events"
+                  << ( onDemandTags_ ? " (tags produced on demand: fetch time is tag production time)" : " (tags not produced on demand: fetch time excludes production)" )
+                  << std::endl;
+        std::cout << Form( "    %-40s %10s %10s %14s %16s", "tag", "requested", "skipped", "ms/request", "ms/event saved" ) << std::endl;
+        double totSaved = 0.;
+        for( unsigned int i = 0 ; i < tagAccounting_.size() ; i++ ) {
+            const TagAccounting &acc = tagAccounting_[i];
+            double perRequest = ( acc.nRequested > 0 ? acc.time / acc.nRequested : 0. );
+            double savedPerEvent = perRequest * acc.nSkipped / nEvents_;
+            if( onDemandTags_ ) { totSaved += savedPerEvent; }
+            std::cout << Form( "    %-40s %10lu %10lu %14.3f %16.3f", tagLabels_[i].c_str(), acc.nRequested, acc.nSkipped,
+                               1.e3 * perRequest, onDemandTags_ ? 1.e3 * savedPerEvent : 0. ) << std::endl;
+        }
+        if( onDemandTags_ ) {
+            std::cout << "    Estimated tag producer time avoided: " << Form( "%.3f", 1.e3 * totSaved ) << " ms/event" << std::endl;
+        }
+    }
+
     string TagSorter::tagName(DiPhotonTagBase::tag_t tagEnumVal) const {
         switch(tagEnumVal) {
         case DiPhotonTagBase::tag_t::kUndefined:
@@ -13,6 +13,7 @@
 #include "flashgg/DataFormats/interface/Jet.h"
 #include "flashgg/DataFormats/interface/DiPhotonCandidate.h"
 #include "flashgg/DataFormats/interface/VHHadronicTag.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
 
 #include "flashgg/DataFormats/interface/VHTagTruth.h"
 #include "DataFormats/Common/interface/RefToPtr.h"
@@ -44,26 +45,20 @@ namespace flashgg {
 
         void produce( Event &, const EventSetup & ) override;
 
-        std::vector<edm::EDGetTokenT<View<flashgg::Jet> > > tokenJets_;
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
+        EDGetTokenT<vector<DiPhotonCleanedObjects> > cleanedObjectsToken_;
         //EDGetTokenT<View<Jet> > thejetToken_;
         EDGetTokenT<View<DiPhotonMVAResult> > mvaResultToken_;
         EDGetTokenT<View<reco::GenParticle> > genParticleToken_;
         EDGetTokenT<int> stage0catToken_, stage1catToken_, njetsToken_;
         EDGetTokenT<HTXS::HiggsClassification> newHTXSToken_;
         EDGetTokenT<float> pTHToken_,pTVToken_;
-        std::vector<edm::InputTag> inputTagJets_;
-        typedef std::vector<edm::Handle<edm::View<flashgg::Jet> > > JetCollectionVector;
 
         //Thresholds
         double leadPhoOverMassThreshold_;
         double subleadPhoOverMassThreshold_;
         double diphoMVAThreshold_;
         double jetsNumberThreshold_;
-        double jetPtThreshold_;
-        double jetEtaThreshold_;
-        double dRJetToPhoLThreshold_;
-        double dRJetToPhoSThreshold_;
         double dijetMassLowThreshold_;
         double dijetMassHighThreshold_;
         double cosThetaStarThreshold_;
@@ -79,6 +74,8 @@ namespace flashgg {
 
         diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
         //thejetToken_     ( consumes<View<flashgg::Jet> >( iConfig.getParameter<InputTag>( "JetTag" ) ) ),
+        // jets selected and cleaned against the diphotons by the DiPhotonCleanedObjectsProducer
+        cleanedObjectsToken_( consumes<vector<DiPhotonCleanedObjects> >( iConfig.getParameter<InputTag> ( "CleanedObjectsTag" ) ) ),
         mvaResultToken_( consumes<View<flashgg::DiPhotonMVAResult> >( iConfig.getParameter<InputTag> ( "MVAResultTag" ) ) ),
         genParticleToken_( consumes<View<reco::GenParticle> >( iConfig.getParameter<InputTag> ( "GenParticleTag" ) ) ),
         systLabel_( iConfig.getParameter<string> ( "SystLabel" ) )
@@ -90,10 +87,6 @@ namespace flashgg {
         subleadPhoOverMassThreshold_ = iConfig.getParameter<double>( "subleadPhoOverMassThreshold" );
         diphoMVAThreshold_           = iConfig.getParameter<double>( "diphoMVAThreshold" );
         jetsNumberThreshold_         = iConfig.getParameter<double>( "jetsNumberThreshold" );
-        jetPtThreshold_              = iConfig.getParameter<double>( "jetPtThreshold" );
-        jetEtaThreshold_             = iConfig.getParameter<double>( "jetEtaThreshold" );
-        dRJetToPhoLThreshold_        = iConfig.getParameter<double>( "dRJetToPhoLThreshold" );
-        dRJetToPhoSThreshold_        = iConfig.getParameter<double>( "dRJetToPhoSThreshold" );
         dijetMassLowThreshold_       = iConfig.getParameter<double>( "dijetMassLowThreshold" );
         dijetMassHighThreshold_      = iConfig.getParameter<double>( "dijetMassHighThreshold" );
         cosThetaStarThreshold_       = iConfig.getParameter<double>( "cosThetaStarThreshold" );
@@ -107,16 +100,8 @@ namespace flashgg {
         pTVToken_ = consumes<float>( HTXSps.getParameter<InputTag>("pTV") );
         newHTXSToken_ = consumes<HTXS::HiggsClassification>( HTXSps.getParameter<InputTag>("ClassificationObj") );
 
-
-        // yacine: new recipe for flashgg jets
-        inputTagJets_                = iConfig.getParameter<std::vector<edm::InputTag> >( "inputTagJets" );
-
         // *************************************************
 
-        for (unsigned i = 0 ; i < inputTagJets_.size() ; i++) {
-            auto token = consumes<View<flashgg::Jet> >(inputTagJets_[i]);
-            tokenJets_.push_back(token);
-        }
         produces<vector<VHHadronicTag> >();
         produces<vector<VHTagTruth> >();
     }
@@ -144,9 +129,11 @@ namespace flashgg {
         //  evt.getByToken( thejetToken_, theJets );
         //  const PtrVector<flashgg::Jet>& jetPointers = theJets->ptrVector();
 
-        JetCollectionVector Jets( inputTagJets_.size() );
-        for( size_t j = 0; j < inputTagJets_.size(); ++j ) {
-            evt.getByToken( tokenJets_[j], Jets[j] );
+        Handle<vector<DiPhotonCleanedObjects> > cleanedObjects;
+        evt.getByToken( cleanedObjectsToken_, cleanedObjects );
+        if( cleanedObjects->size() != diPhotons->size() ) {
+            throw cms::Exception( "Configuration" ) << " VHHadronicTagProducer: " << cleanedObjects->size() << " cleaned objects for "
+                                                    << diPhotons->size() << " diphotons, CleanedObjectsTag must be built from DiPhotonTag";
         }
 
         Handle<View<flashgg::DiPhotonMVAResult> > mvaResults;
@@ -258,31 +245,7 @@ namespace flashgg {
             // cut on pt_gg / m_gg
             if( dipho->pt() / dipho->mass() < 1. )   {continue;}
             
-            std::vector<edm::Ptr<flashgg::Jet> > goodJets;
-
-            unsigned int jetCollectionIndex = diPhotons->ptrAt( diphoIndex )->jetCollectionIndex();
-            
-            for( size_t ijet = 0; ijet < Jets[jetCollectionIndex]->size(); ijet++ ) {
-
-                edm::Ptr<flashgg::Jet> thejet = Jets[jetCollectionIndex]->ptrAt( ijet );
-                
-                if(!thejet->passesJetID  ( flashgg::Tight2017 ) ) { continue; }
-                if( fabs( thejet->eta() ) > jetEtaThreshold_ )  { continue; }
-                if( thejet->pt() < jetPtThreshold_ )            { continue; }
-
-                float dPhiJetToPhoL = deltaPhi( dipho->leadingPhoton()->phi(), thejet->phi() );
-                float dEtaJetToPhoL = dipho->leadingPhoton()->eta() - thejet->eta();
-                float dRJetToPhoL   = sqrt( dEtaJetToPhoL * dEtaJetToPhoL + dPhiJetToPhoL * dPhiJetToPhoL );
-
-                float dPhiJetToPhoS = deltaPhi( dipho->subLeadingPhoton()->phi(), thejet->phi() );
-                float dEtaJetToPhoS = dipho->subLeadingPhoton()->eta() - thejet->eta();
-                float dRJetToPhoS   = sqrt( dEtaJetToPhoS * dEtaJetToPhoS + dPhiJetToPhoS * dPhiJetToPhoS );
-
-                if( abs( dRJetToPhoL ) < dRJetToPhoLThreshold_ )            { continue; }
-                if( abs( dRJetToPhoS ) < dRJetToPhoSThreshold_ )            { continue; }
-
-                goodJets.push_back( thejet );
-            }
+            const std::vector<edm::Ptr<flashgg::Jet> > &goodJets = cleanedObjects->at( diphoIndex ).jets();
             
             // *********************************************************************
             //            std::cout << "-----------------------------------------------------number of jets: " << goodJets.size() << std::endl;
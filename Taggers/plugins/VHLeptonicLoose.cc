@@ -14,6 +14,7 @@
 #include "flashgg/DataFormats/interface/Met.h"
 #include "flashgg/DataFormats/interface/Electron.h"
 #include "flashgg/DataFormats/interface/Muon.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
 
 #include "FWCore/Common/interface/TriggerNames.h"
 #include "DataFormats/Common/interface/TriggerResults.h"
@@ -49,116 +50,72 @@ namespace flashgg {
     private:
         void produce( Event &, const EventSetup & ) override;
 
-        std::vector<edm::EDGetTokenT<View<flashgg::Jet> > > tokenJets_;
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
-        std::vector<edm::InputTag> inputTagJets_;
+        EDGetTokenT<vector<DiPhotonCleanedObjects> > cleanedObjectsToken_;
 
-        EDGetTokenT<View<flashgg::Electron> > electronToken_;
-        EDGetTokenT<View<flashgg::Muon> > muonToken_;
         EDGetTokenT<View<DiPhotonMVAResult> > mvaResultToken_;
         EDGetTokenT<View<flashgg::Met> > METToken_;
-        EDGetTokenT<View<reco::Vertex> > vertexToken_;
         EDGetTokenT<View<reco::GenParticle> > genParticleToken_;
         EDGetTokenT<int> stage0catToken_, stage1catToken_, njetsToken_;
         EDGetTokenT<HTXS::HiggsClassification> newHTXSToken_;
         EDGetTokenT<float> pTHToken_,pTVToken_;
-        EDGetTokenT<double> rhoTag_;
         string systLabel_;
         edm::EDGetTokenT<edm::TriggerResults> triggerRECO_;
         edm::EDGetTokenT<edm::TriggerResults> triggerPAT_;
         edm::EDGetTokenT<edm::TriggerResults> triggerFLASHggMicroAOD_;
-        
-        typedef std::vector<edm::Handle<edm::View<flashgg::Jet> > > JetCollectionVector;
 
         //Thresholds
-        double leptonPtThreshold_;
-        double muonEtaThreshold_;
         double leadPhoOverMassThreshold_;
         double subleadPhoOverMassThreshold_;
         double MVAThreshold_;
-        double deltaRMuonPhoThreshold_;
         double jetsNumberThreshold_;
-        double jetPtThreshold_;
-        double jetEtaThreshold_;
-        double muPFIsoSumRelThreshold_;
         double PhoMVAThreshold_;
         double METThreshold_;
         bool useVertex0only_;
         
-        double deltaRJetMuonThreshold_;
-        double deltaRJetElectronThreshold_;
         double invMassLepLowThreshold_;
         double invMassLepHighThreshold_;
 
-        double deltaRPhoLeadJet_;
-        double deltaRPhoSubLeadJet_;
-
-        double DeltaRTrkElec_;
         double TransverseImpactParam_;
         double LongitudinalImpactParam_;
 
-        double deltaRPhoElectronThreshold_;
-        double deltaMassElectronZThreshold_;
-
 
         vector<double> nonTrigMVAThresholds_;
         vector<double> nonTrigMVAEtaCuts_;
         double electronIsoThreshold_;
         double electronNumOfHitsThreshold_;
-        vector<double> electronEtaThresholds_;
-        bool useElectronMVARecipe_;
-        bool useElectronLooseID_;
     };
 
     VHLeptonicLooseTagProducer::VHLeptonicLooseTagProducer( const ParameterSet &iConfig ) :
         diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
-        inputTagJets_( iConfig.getParameter<std::vector<edm::InputTag> >( "inputTagJets" ) ),
-        electronToken_( consumes<View<flashgg::Electron> >( iConfig.getParameter<InputTag> ( "ElectronTag" ) ) ),
-        muonToken_( consumes<View<flashgg::Muon> >( iConfig.getParameter<InputTag>( "MuonTag" ) ) ),
+        // leptons and jets selected and cleaned against the diphotons by the DiPhotonCleanedObjectsProducer
+        cleanedObjectsToken_( consumes<vector<DiPhotonCleanedObjects> >( iConfig.getParameter<InputTag> ( "CleanedObjectsTag" ) ) ),
         mvaResultToken_( consumes<View<flashgg::DiPhotonMVAResult> >( iConfig.getParameter<InputTag> ( "MVAResultTag" ) ) ),
         METToken_( consumes<View<flashgg::Met> >( iConfig.getParameter<InputTag> ( "METTag" ) ) ),
-        vertexToken_( consumes<View<reco::Vertex> >( iConfig.getParameter<InputTag> ( "VertexTag" ) ) ),
         genParticleToken_( consumes<View<reco::GenParticle> >( iConfig.getParameter<InputTag> ( "GenParticleTag" ) ) ),
-        rhoTag_( consumes<double>( iConfig.getParameter<InputTag>( "rhoTag" ) ) ),
         systLabel_( iConfig.getParameter<string> ( "SystLabel" ) ),
         triggerRECO_( consumes<edm::TriggerResults>(iConfig.getParameter<InputTag>("RECOfilters") ) ),
         triggerPAT_( consumes<edm::TriggerResults>(iConfig.getParameter<InputTag>("PATfilters") ) ),
         triggerFLASHggMicroAOD_( consumes<edm::TriggerResults>( iConfig.getParameter<InputTag>("FLASHfilters") ) )
     {
 
-        leptonPtThreshold_ = iConfig.getParameter<double>( "leptonPtThreshold");
-        muonEtaThreshold_ = iConfig.getParameter<double>( "muonEtaThreshold");
         leadPhoOverMassThreshold_ = iConfig.getParameter<double>( "leadPhoOverMassThreshold");
         subleadPhoOverMassThreshold_ = iConfig.getParameter<double>( "subleadPhoOverMassThreshold");
         MVAThreshold_ = iConfig.getParameter<double>( "MVAThreshold");
-        deltaRMuonPhoThreshold_ = iConfig.getParameter<double>( "deltaRMuonPhoThreshold");
         jetsNumberThreshold_ = iConfig.getParameter<double>( "jetsNumberThreshold");
-        jetPtThreshold_ = iConfig.getParameter<double>( "jetPtThreshold");
-        jetEtaThreshold_ = iConfig.getParameter<double>( "jetEtaThreshold");
-        muPFIsoSumRelThreshold_ = iConfig.getParameter<double>( "muPFIsoSumRelThreshold");
         PhoMVAThreshold_ = iConfig.getParameter<double>( "PhoMVAThreshold");
         METThreshold_ = iConfig.getParameter<double>( "METThreshold");
         useVertex0only_              = iConfig.getParameter<bool>("useVertex0only");
         
-        deltaRJetMuonThreshold_ = iConfig.getParameter<double>( "deltaRJetMuonThreshold");
-        deltaRJetElectronThreshold_ = iConfig.getParameter<double>( "deltaRJetElectronThreshold");
         invMassLepLowThreshold_ = iConfig.getParameter<double>( "invMassLepLowThreshold");
         invMassLepHighThreshold_ = iConfig.getParameter<double>( "invMassLepHighThreshold");
-        deltaRPhoLeadJet_ = iConfig.getParameter<double>( "deltaRPhoLeadJet");
-        deltaRPhoSubLeadJet_ = iConfig.getParameter<double>( "deltaRPhoSubLeadJet");
 
-        DeltaRTrkElec_ = iConfig.getParameter<double>( "DeltaRTrkElec");
         TransverseImpactParam_ = iConfig.getParameter<double>( "TransverseImpactParam");
         LongitudinalImpactParam_ = iConfig.getParameter<double>( "LongitudinalImpactParam");
         nonTrigMVAThresholds_ =  iConfig.getParameter<vector<double > >( "nonTrigMVAThresholds");
         nonTrigMVAEtaCuts_ =  iConfig.getParameter<vector<double > >( "nonTrigMVAEtaCuts");
-        deltaRPhoElectronThreshold_ = iConfig.getParameter<double>( "deltaRPhoElectronThreshold");
-        deltaMassElectronZThreshold_ = iConfig.getParameter<double>( "deltaMassElectronZThreshold");
         electronIsoThreshold_ = iConfig.getParameter<double>( "electronIsoThreshold");
         electronNumOfHitsThreshold_ = iConfig.getParameter<double>( "electronNumOfHitsThreshold");
-        electronEtaThresholds_ = iConfig.getParameter<vector<double > >( "electronEtaThresholds");
-        useElectronMVARecipe_=iConfig.getParameter<bool>("useElectronMVARecipe");
-        useElectronLooseID_=iConfig.getParameter<bool>("useElectronLooseID");
 
         ParameterSet HTXSps = iConfig.getParameterSet( "HTXSTags" );
         stage0catToken_ = consumes<int>( HTXSps.getParameter<InputTag>("stage0cat") );
@@ -168,11 +125,6 @@ namespace flashgg {
         pTVToken_ = consumes<float>( HTXSps.getParameter<InputTag>("pTV") );
         newHTXSToken_ = consumes<HTXS::HiggsClassification>( HTXSps.getParameter<InputTag>("ClassificationObj") );
 
-        
-        for (unsigned i = 0 ; i < inputTagJets_.size() ; i++) {
-            auto token = consumes<View<flashgg::Jet> >(inputTagJets_[i]);
-            tokenJets_.push_back(token);
-        }
         produces<vector<VHLeptonicLooseTag> >();
         produces<vector<VHTagTruth> >();
     }
@@ -190,23 +142,15 @@ namespace flashgg {
         evt.getByToken(newHTXSToken_,htxsClassification);
 
 
-        JetCollectionVector Jets( inputTagJets_.size() );
-        for( size_t j = 0; j < inputTagJets_.size(); ++j ) {
-            evt.getByToken( tokenJets_[j], Jets[j] );
-        }
-        
         Handle<View<flashgg::DiPhotonCandidate> > diPhotons;
         evt.getByToken( diPhotonToken_, diPhotons );
 
-        Handle<View<flashgg::Muon> > theMuons;
-        evt.getByToken( muonToken_, theMuons );
-
-        Handle<View<flashgg::Electron> > theElectrons;
-        evt.getByToken( electronToken_, theElectrons );
-
-        edm::Handle<double>  rho;
-        evt.getByToken(rhoTag_,rho);
-        double rho_    = *rho;
+        Handle<vector<DiPhotonCleanedObjects> > cleanedObjects;
+        evt.getByToken( cleanedObjectsToken_, cleanedObjects );
+        if( cleanedObjects->size() != diPhotons->size() ) {
+            throw cms::Exception( "Configuration" ) << " VHLeptonicLooseTagProducer: " << cleanedObjects->size() << " cleaned objects for "
+                                                    << diPhotons->size() << " diphotons, CleanedObjectsTag must be built from DiPhotonTag";
+        }
 
         Handle<View<flashgg::DiPhotonMVAResult> > mvaResults;
         evt.getByToken( mvaResultToken_, mvaResults );
@@ -340,9 +284,6 @@ namespace flashgg {
         Handle<View<flashgg::Met> > METs;
         evt.getByToken( METToken_, METs );
 
-        Handle<View<reco::Vertex> > vertices;
-        evt.getByToken( vertexToken_, vertices );
-
         assert( diPhotons->size() == mvaResults->size() );
 
         bool photonSelection = false;
@@ -360,13 +301,7 @@ namespace flashgg {
             if(useVertex0only_)
                 if(diPhotons->ptrAt(diphoIndex)->vertexIndex()!=0)
                     continue;
-            unsigned int jetCollectionIndex = diPhotons->ptrAt( diphoIndex )->jetCollectionIndex();
-            
-            std::vector<edm::Ptr<flashgg::Muon> > tagMuons;
-            std::vector<edm::Ptr<flashgg::Electron> > tagElectrons;
 
-            std::vector<edm::Ptr<Jet> > tagJets;
-            
             edm::Ptr<flashgg::DiPhotonCandidate> dipho = diPhotons->ptrAt( diphoIndex );
             edm::Ptr<flashgg::DiPhotonMVAResult> mvares = mvaResults->ptrAt( diphoIndex );
 
@@ -380,14 +315,9 @@ namespace flashgg {
             if( mvares->result < MVAThreshold_ ) { continue; }
 
             photonSelection = true;
-            tagMuons = selectMuons( theMuons->ptrs(), dipho, vertices->ptrs(), muonEtaThreshold_, leptonPtThreshold_, muPFIsoSumRelThreshold_,
-                                    deltaRMuonPhoThreshold_, deltaRMuonPhoThreshold_ );
-            
-            tagElectrons = selectStdElectrons( theElectrons->ptrs(), dipho, vertices->ptrs(), leptonPtThreshold_,  electronEtaThresholds_,
-                                               useElectronMVARecipe_,useElectronLooseID_,
-                                               deltaRPhoElectronThreshold_,DeltaRTrkElec_,deltaMassElectronZThreshold_,
-                                               rho_, evt.isRealData() );
-            
+            const DiPhotonCleanedObjects &objects = cleanedObjects->at( diphoIndex );
+            const std::vector<edm::Ptr<flashgg::Muon> > &tagMuons = objects.muons();
+            const std::vector<edm::Ptr<flashgg::Electron> > &tagElectrons = objects.electrons();
 
         
             if( !(tagElectrons.size() > 0) && !(tagMuons.size()>0) ) { continue; }
@@ -408,40 +338,8 @@ namespace flashgg {
                         tagged_electrons = true;
                     }
             */
-            //count jets that don't overlap with leptons
-            for( unsigned int candIndex_outer = 0; candIndex_outer < Jets[jetCollectionIndex]->size() ; candIndex_outer++ ) 
-                {
-                    bool keepJet=true;
-                    edm::Ptr<flashgg::Jet> thejet = Jets[jetCollectionIndex]->ptrAt( candIndex_outer );
-                    if(!thejet->passesJetID  ( flashgg::Tight2017 ) ) { keepJet=false; }
-                    if( fabs( thejet->eta() ) > jetEtaThreshold_ ) { keepJet=false; }
-                    if( thejet->pt() < jetPtThreshold_ ) { keepJet=false; }
-                    float dRPhoLeadJet = deltaR( thejet->eta(), thejet->phi(), dipho->leadingPhoton()->superCluster()->eta(), dipho->leadingPhoton()->superCluster()->phi() ) ;
-                    float dRPhoSubLeadJet = deltaR( thejet->eta(), thejet->phi(), dipho->subLeadingPhoton()->superCluster()->eta(),
-                                                    dipho->subLeadingPhoton()->superCluster()->phi() );
-                    if( dRPhoLeadJet < deltaRPhoLeadJet_ || dRPhoSubLeadJet < deltaRPhoSubLeadJet_ ) { keepJet=false; }
-                    if( tagElectrons.size() > 0 ) 
-                        {
-                            for( unsigned int elecIndex = 0; elecIndex < tagElectrons.size(); elecIndex++ ) 
-                                {
-                                    Ptr<Electron> elec = tagElectrons[elecIndex];
-                                    float dRJetElec = deltaR( thejet->eta(), thejet->phi(), elec->eta(), elec->phi() ) ;
-                                    if( dRJetElec < deltaRJetElectronThreshold_ ) { keepJet=false; }
-                                }
-                            
-                        }
-                    if( tagMuons.size() > 0 ) 
-                        {
-                            for( unsigned int muonIndex = 0; muonIndex < tagMuons.size(); muonIndex++ ) 
-                                {
-                                    Ptr<flashgg::Muon> muon = tagMuons[muonIndex];
-                                    float dRJetMuon = deltaR( thejet->eta(), thejet->phi(), muon->eta(), muon->phi() ) ;
-                                    if( dRJetMuon < deltaRJetMuonThreshold_ ) { keepJet=false; }
-                                }   
-                        }
-                    if(keepJet)
-                        tagJets.push_back( thejet );        
-                }
+            //jets that don't overlap with leptons
+            const std::vector<edm::Ptr<Jet> > &tagJets = objects.jets();
             
             if( METs->size() != 1 ) { std::cout << "WARNING - #MET is not 1" << std::endl;}
             Ptr<flashgg::Met> theMET = METs->ptrAt( 0 );
@@ -16,6 +16,7 @@
 //#include "flashgg/DataFormats/interface/VBFDiPhoDiJetMVAResult.h"
 //#include "flashgg/DataFormats/interface/VBFMVAResult.h"
 #include "flashgg/DataFormats/interface/VHMetTag.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
 
 #include "flashgg/DataFormats/interface/VHTagTruth.h"
 #include "DataFormats/Common/interface/RefToPtr.h"
@@ -40,11 +41,10 @@ namespace flashgg {
     private:
         void produce( Event &, const EventSetup & ) override;
 
-        std::vector<edm::EDGetTokenT<View<flashgg::Jet> > > tokenJets_;
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
         EDGetTokenT<View<DiPhotonMVAResult> > mvaResultToken_;
         //EDGetTokenT<View<pat::MET> > METToken_;
-        std::vector<edm::InputTag> inputTagJets_;
+        EDGetTokenT<vector<DiPhotonCleanedObjects> > cleanedObjectsToken_;
         EDGetTokenT<View<flashgg::Met> > METToken_;
         EDGetTokenT<View<reco::GenParticle> > genParticleToken_;
         string systLabel_;
@@ -57,18 +57,12 @@ namespace flashgg {
         EDGetTokenT<HTXS::HiggsClassification> newHTXSToken_;
         EDGetTokenT<float> pTHToken_,pTVToken_;
 
-        typedef std::vector<edm::Handle<edm::View<flashgg::Jet> > > JetCollectionVector;        
-
         //configurable selection variables
         bool useVertex0only_;
         double leadPhoOverMassThreshold_;
         double subleadPhoOverMassThreshold_;
         double diphoMVAThreshold_;
         double metPtThreshold_;
-        double jetEtaThreshold_;
-        double jetPtThreshold_;
-        double deltaRPhoLeadJet_;
-        double deltaRPhoSubLeadJet_;
         double deltaPhiJetMetThreshold_;
         double phoIdMVAThreshold_;
         double dPhiDiphotonMetThreshold_;
@@ -78,7 +72,8 @@ namespace flashgg {
         diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
         mvaResultToken_( consumes<View<flashgg::DiPhotonMVAResult> >( iConfig.getParameter<InputTag> ( "MVAResultTag" ) ) ),
         //METToken_( consumes<View<pat::MET> >( iConfig.getParameter<InputTag> ( "METTag" ) ) ),
-        inputTagJets_( iConfig.getParameter<std::vector<edm::InputTag> >( "inputTagJets" ) ),
+        // jets selected and cleaned against the diphotons by the DiPhotonCleanedObjectsProducer
+        cleanedObjectsToken_( consumes<vector<DiPhotonCleanedObjects> >( iConfig.getParameter<InputTag> ( "CleanedObjectsTag" ) ) ),
         METToken_( consumes<View<flashgg::Met> >( iConfig.getParameter<InputTag> ( "METTag" ) ) ),
         genParticleToken_( consumes<View<reco::GenParticle> >( iConfig.getParameter<InputTag> ( "GenParticleTag" ) ) ),
         systLabel_( iConfig.getParameter<string> ( "SystLabel" ) ),
@@ -91,18 +86,9 @@ namespace flashgg {
         subleadPhoOverMassThreshold_ = iConfig.getParameter<double>( "subleadPhoOverMassThreshold" );
         diphoMVAThreshold_           = iConfig.getParameter<double>( "diphoMVAThreshold" );
         metPtThreshold_              = iConfig.getParameter<double>( "metPtThreshold" );
-        jetPtThreshold_              = iConfig.getParameter<double>( "jetPtThreshold");
-        jetEtaThreshold_             = iConfig.getParameter<double>( "jetEtaThreshold");
-        deltaRPhoLeadJet_            = iConfig.getParameter<double>( "deltaRPhoLeadJet");
-        deltaRPhoSubLeadJet_         = iConfig.getParameter<double>( "deltaRPhoSubLeadJet");
         deltaPhiJetMetThreshold_     = iConfig.getParameter<double>( "dPhiJetMetThreshold");
         phoIdMVAThreshold_           = iConfig.getParameter<double>( "phoIdMVAThreshold" );
         dPhiDiphotonMetThreshold_    = iConfig.getParameter<double>( "dPhiDiphotonMetThreshold" );
-
-        for (unsigned i = 0 ; i < inputTagJets_.size() ; i++) {
-            auto token = consumes<View<flashgg::Jet> >(inputTagJets_[i]);
-            tokenJets_.push_back(token);
-        }
         
         ParameterSet HTXSps = iConfig.getParameterSet( "HTXSTags" );
         stage0catToken_ = consumes<int>( HTXSps.getParameter<InputTag>("stage0cat") );
@@ -133,13 +119,14 @@ namespace flashgg {
         evt.getByToken(newHTXSToken_,htxsClassification);
 
 
-        JetCollectionVector Jets( inputTagJets_.size() );
-        for( size_t j = 0; j < inputTagJets_.size(); ++j ) 
-            {
-                evt.getByToken( tokenJets_[j], Jets[j] );
-            }
         Handle<View<flashgg::DiPhotonCandidate> > diPhotons;
         evt.getByToken( diPhotonToken_, diPhotons );
+        Handle<vector<DiPhotonCleanedObjects> > cleanedObjects;
+        evt.getByToken( cleanedObjectsToken_, cleanedObjects );
+        if( cleanedObjects->size() != diPhotons->size() ) {
+            throw cms::Exception( "Configuration" ) << " VHMetTagProducer: " << cleanedObjects->size() << " cleaned objects for "
+                                                    << diPhotons->size() << " diphotons, CleanedObjectsTag must be built from DiPhotonTag";
+        }
         Handle<View<flashgg::DiPhotonMVAResult> > mvaResults;
         evt.getByToken( mvaResultToken_, mvaResults );
 
@@ -280,21 +267,7 @@ namespace flashgg {
             //diphoton MVA preselection
             if( mvares->result < diphoMVAThreshold_ )          { continue; }
 
-            unsigned int jetCollectionIndex = diPhotons->ptrAt( candIndex )->jetCollectionIndex();
-            //edm::Ptr<flashgg::Jet> maxJet();
-            std::vector<edm::Ptr<Jet> > tagJets;
-            for( unsigned int jetIndex = 0; jetIndex < Jets[jetCollectionIndex]->size() ; jetIndex++ )
-                {
-                    edm::Ptr<flashgg::Jet> thejet = Jets[jetCollectionIndex]->ptrAt( jetIndex );
-                    if(!thejet->passesJetID  ( flashgg::Tight2017 ) ) { continue; }
-                    if( fabs( thejet->eta() ) > jetEtaThreshold_ ) { continue; }
-                    if( thejet->pt() < jetPtThreshold_ ) { continue; }
-                    float dRPhoLeadJet = deltaR( thejet->eta(), thejet->phi(), diPhotons->ptrAt( candIndex )->leadingPhoton()->superCluster()->eta(), diPhotons->ptrAt( candIndex )->leadingPhoton()->superCluster()->phi() ) ;
-                    float dRPhoSubLeadJet = deltaR( thejet->eta(), thejet->phi(), diPhotons->ptrAt( candIndex )->subLeadingPhoton()->superCluster()->eta(),diPhotons->ptrAt( candIndex )->subLeadingPhoton()->superCluster()->phi() );
-                    if( dRPhoLeadJet < deltaRPhoLeadJet_ || dRPhoSubLeadJet < deltaRPhoSubLeadJet_ ) { continue;}
-                    //maxJet = thejet;
-                    tagJets.push_back( thejet);
-                }
+            const std::vector<edm::Ptr<Jet> > &tagJets = cleanedObjects->at( candIndex ).jets();
             
             
             VHMetTag tag_obj( dipho, mvares );
@@ -9,10 +9,11 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/EDMException.h"
+#include "DataFormats/Common/interface/PtrVector.h"
 
 #include "flashgg/DataFormats/interface/Jet.h"
 
-#include <stdio.h>
+#include <string>
 
 using namespace std;
 using namespace edm;
@@ -27,13 +28,21 @@ namespace flashgg {
         void produce( Event &, const EventSetup & ) override;
 
         EDGetTokenT<View<vector<Jet> > > jetsToken_;
+        EDGetTokenT<vector<PtrVector<Jet> > > jetRefsToken_;
         unsigned int nCollections_;
+        // input made by the collector with StoreReferences: the PtrVectors are passed on, the jets are not copied
+        bool jetsAreReferences_;
     };
 
     VectorVectorJetUnpacker::VectorVectorJetUnpacker( const ParameterSet &iConfig ) :
-        jetsToken_( consumes<View<vector<flashgg::Jet> > >( iConfig.getParameter<InputTag>( "JetsTag" ) ) ),
-        nCollections_( iConfig.getParameter<unsigned int>( "NCollections" ) )
+        nCollections_( iConfig.getParameter<unsigned int>( "NCollections" ) ),
+        jetsAreReferences_( iConfig.exists( "JetsAreReferences" ) ? iConfig.getParameter<bool>( "JetsAreReferences" ) : false )
     {
+        if( jetsAreReferences_ ) {
+            jetRefsToken_ = consumes<vector<PtrVector<flashgg::Jet> > >( iConfig.getParameter<InputTag>( "JetsTag" ) );
+        } else {
+            jetsToken_ = consumes<View<vector<flashgg::Jet> > >( iConfig.getParameter<InputTag>( "JetsTag" ) );
+        }
         if( nCollections_ > 99 ) {
             throw cms::Exception( "Configuration" ) << " Number of jet collections more than 2 digits long is extremely unreasonable";
             // We never needed more than 3 in tests; 5 should be safe. 10 would be bonkers
@@ -42,14 +51,32 @@ namespace flashgg {
             // [0] Processing run: 277127 lumi: 809 event: 1511130886
         }
         for( unsigned int i = 0 ; i < nCollections_ ; i++ ) {
-            char number[2];
-            sprintf( number, "%u", i );
-            produces<vector<Jet> >( number );
+            std::string number = std::to_string( i );
+            if( jetsAreReferences_ ) {
+                produces<PtrVector<Jet> >( number );
+            } else {
+                produces<vector<Jet> >( number );
+            }
         }
     }
 
     void VectorVectorJetUnpacker::produce( Event &evt, const EventSetup & )
     {
+        if( jetsAreReferences_ ) {
+            Handle<vector<PtrVector<flashgg::Jet> > > theJetRefs;
+            evt.getByToken( jetRefsToken_, theJetRefs );
+
+            if( theJetRefs->size() > nCollections_ ) {
+                throw cms::Exception( "Configuration" ) << " Too many collections in input vector - inconsistency with MicroAOD";
+            }
+
+            for( unsigned int i = 0 ; i < nCollections_ ; i++ ) {
+                unique_ptr<PtrVector<Jet> > result( theJetRefs->size() > i ? new PtrVector<Jet>( theJetRefs->at( i ) ) : new PtrVector<Jet> );
+                std::string number = std::to_string( i );
+                evt.put( std::move( result ), number );
+            }
+            return;
+        }
 
         Handle<View<vector<flashgg::Jet> > > theJets;
         evt.getByToken( jetsToken_, theJets );
@@ -65,8 +92,7 @@ namespace flashgg {
                     result->push_back( theJets->at( i )[j] );
                 }
             }
-            char number[2];
-            sprintf( number, "%u", i );
+            std::string number = std::to_string( i );
             evt.put( std::move( result) , number );
         }
     }
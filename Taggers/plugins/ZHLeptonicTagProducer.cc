@@ -11,6 +11,7 @@
 #include "flashgg/DataFormats/interface/ZHLeptonicTag.h"
 #include "flashgg/DataFormats/interface/Electron.h"
 #include "flashgg/DataFormats/interface/Muon.h"
+#include "flashgg/DataFormats/interface/DiPhotonCleanedObjects.h"
 
 #include "FWCore/Common/interface/TriggerNames.h"
 #include "DataFormats/TrackReco/interface/HitPattern.h"
@@ -46,13 +47,10 @@ namespace flashgg {
         void produce( Event &, const EventSetup & ) override;
 
         EDGetTokenT<View<DiPhotonCandidate> > diPhotonToken_;
+        EDGetTokenT<vector<DiPhotonCleanedObjects> > cleanedObjectsToken_;
 
-        EDGetTokenT<View<flashgg::Electron> > electronToken_;
-        EDGetTokenT<View<flashgg::Muon> > muonToken_;
         EDGetTokenT<View<DiPhotonMVAResult> > mvaResultToken_;
-        EDGetTokenT<View<reco::Vertex> > vertexToken_;
         EDGetTokenT<View<reco::GenParticle> > genParticleToken_;
-        EDGetTokenT<double> rhoTag_;
         EDGetTokenT<int> stage0catToken_, stage1catToken_, njetsToken_;
         EDGetTokenT<float> pTHToken_,pTVToken_;
         EDGetTokenT<HTXS::HiggsClassification> newHTXSToken_;
@@ -60,13 +58,9 @@ namespace flashgg {
         
 
         //Thresholds
-        double leptonPtThreshold_;
-        double muonEtaThreshold_;
         double leadPhoOverMassThreshold_;
         double subleadPhoOverMassThreshold_;
         double MVAThreshold_;
-        double deltaRMuonPhoThreshold_;
-        double muPFIsoSumRelThreshold_;
         double PhoMVAThreshold_;
         bool useVertex0only_;
         
@@ -76,42 +70,29 @@ namespace flashgg {
 
 
         double ElectronPtThreshold_;
-        double DeltaRTrkElec_;
         double TransverseImpactParam_;
         double LongitudinalImpactParam_;
 
-        double deltaRPhoElectronThreshold_;
-        double deltaMassElectronZThreshold_;
-
 
         vector<double> nonTrigMVAThresholds_;
         vector<double> nonTrigMVAEtaCuts_;
         double electronIsoThreshold_;
         double electronNumOfHitsThreshold_;
-        vector<double> electronEtaThresholds_;
-        bool useElectronMVARecipe_;
-        bool useElectronLooseID_;
         
     };
 
     ZHLeptonicTagProducer::ZHLeptonicTagProducer( const ParameterSet &iConfig ) :
         diPhotonToken_( consumes<View<flashgg::DiPhotonCandidate> >( iConfig.getParameter<InputTag> ( "DiPhotonTag" ) ) ),
-        electronToken_( consumes<View<flashgg::Electron> >( iConfig.getParameter<InputTag> ( "ElectronTag" ) ) ),
-        muonToken_( consumes<View<flashgg::Muon> >( iConfig.getParameter<InputTag>( "MuonTag" ) ) ),
+        // leptons selected against the diphotons by the DiPhotonCleanedObjectsProducer
+        cleanedObjectsToken_( consumes<vector<DiPhotonCleanedObjects> >( iConfig.getParameter<InputTag> ( "CleanedObjectsTag" ) ) ),
         mvaResultToken_( consumes<View<flashgg::DiPhotonMVAResult> >( iConfig.getParameter<InputTag> ( "MVAResultTag" ) ) ),
-        vertexToken_( consumes<View<reco::Vertex> >( iConfig.getParameter<InputTag> ( "VertexTag" ) ) ),
         genParticleToken_( consumes<View<reco::GenParticle> >( iConfig.getParameter<InputTag> ( "GenParticleTag" ) ) ),
-        rhoTag_( consumes<double>( iConfig.getParameter<InputTag>( "rhoTag" ) ) ),
         systLabel_( iConfig.getParameter<string> ( "SystLabel" ) )
     {
         
-        leptonPtThreshold_ = iConfig.getParameter<double>( "leptonPtThreshold");
-        muonEtaThreshold_ = iConfig.getParameter<double>( "muonEtaThreshold");
         leadPhoOverMassThreshold_ = iConfig.getParameter<double>( "leadPhoOverMassThreshold");
         subleadPhoOverMassThreshold_ = iConfig.getParameter<double>( "subleadPhoOverMassThreshold");
         MVAThreshold_ = iConfig.getParameter<double>( "MVAThreshold");
-        deltaRMuonPhoThreshold_ = iConfig.getParameter<double>( "deltaRMuonPhoThreshold");
-        muPFIsoSumRelThreshold_ = iConfig.getParameter<double>( "muPFIsoSumRelThreshold");
         PhoMVAThreshold_ = iConfig.getParameter<double>( "PhoMVAThreshold");
         useVertex0only_              = iConfig.getParameter<bool>("useVertex0only");
         
@@ -120,18 +101,12 @@ namespace flashgg {
         deltaRLowPtMuonPhoThreshold_ = iConfig.getParameter<double>( "deltaRLowPtMuonPhoThreshold");
 
         ElectronPtThreshold_ = iConfig.getParameter<double>( "ElectronPtThreshold");
-        DeltaRTrkElec_ = iConfig.getParameter<double>( "DeltaRTrkElec");
         TransverseImpactParam_ = iConfig.getParameter<double>( "TransverseImpactParam");
         LongitudinalImpactParam_ = iConfig.getParameter<double>( "LongitudinalImpactParam");
         nonTrigMVAThresholds_ =  iConfig.getParameter<vector<double > >( "nonTrigMVAThresholds");
         nonTrigMVAEtaCuts_ =  iConfig.getParameter<vector<double > >( "nonTrigMVAEtaCuts");
-        deltaRPhoElectronThreshold_ = iConfig.getParameter<double>( "deltaRPhoElectronThreshold");
-        deltaMassElectronZThreshold_ = iConfig.getParameter<double>( "deltaMassElectronZThreshold");
         electronIsoThreshold_ = iConfig.getParameter<double>( "electronIsoThreshold");
         electronNumOfHitsThreshold_ = iConfig.getParameter<double>( "electronNumOfHitsThreshold");
-        electronEtaThresholds_ = iConfig.getParameter<vector<double > >( "electronEtaThresholds");
-        useElectronMVARecipe_=iConfig.getParameter<bool>("useElectronMVARecipe");
-        useElectronLooseID_=iConfig.getParameter<bool>("useElectronLooseID");
 
         ParameterSet HTXSps = iConfig.getParameterSet( "HTXSTags" );
         stage0catToken_ = consumes<int>( HTXSps.getParameter<InputTag>("stage0cat") );
@@ -162,15 +137,12 @@ namespace flashgg {
         Handle<View<flashgg::DiPhotonCandidate> > diPhotons;
         evt.getByToken( diPhotonToken_, diPhotons );
 
-        Handle<View<flashgg::Muon> > theMuons;
-        evt.getByToken( muonToken_, theMuons );
-
-        Handle<View<flashgg::Electron> > theElectrons;
-        evt.getByToken( electronToken_, theElectrons );
-
-        edm::Handle<double>  rho;
-        evt.getByToken(rhoTag_,rho);
-        double rho_    = *rho;
+        Handle<vector<DiPhotonCleanedObjects> > cleanedObjects;
+        evt.getByToken( cleanedObjectsToken_, cleanedObjects );
+        if( cleanedObjects->size() != diPhotons->size() ) {
+            throw cms::Exception( "Configuration" ) << " ZHLeptonicTagProducer: " << cleanedObjects->size() << " cleaned objects for "
+                                                    << diPhotons->size() << " diphotons, CleanedObjectsTag must be built from DiPhotonTag";
+        }
 
         Handle<View<flashgg::DiPhotonMVAResult> > mvaResults;
         evt.getByToken( mvaResultToken_, mvaResults );
@@ -243,9 +215,6 @@ namespace flashgg {
         unsigned int idx = 0;
 
 
-        Handle<View<reco::Vertex> > vertices;
-        evt.getByToken( vertexToken_, vertices );
-
         assert( diPhotons->size() == mvaResults->size() );
 
         bool photonSelection = false;
@@ -258,8 +227,6 @@ namespace flashgg {
             if(useVertex0only_)
                 if(diPhotons->ptrAt(diphoIndex)->vertexIndex()!=0)
                     {continue;}
-            std::vector<edm::Ptr<flashgg::Muon> > tagMuonsTemp;
-            std::vector<edm::Ptr<Electron> > tagElectronsTemp;
             std::vector<edm::Ptr<flashgg::Muon> > tagMuons;
             std::vector<edm::Ptr<Electron> > tagElectrons;
 
@@ -278,12 +245,8 @@ namespace flashgg {
             if( idmva1 <= PhoMVAThreshold_ || idmva2 <= PhoMVAThreshold_ ) { continue; }
             if( mvares->result < MVAThreshold_ ) { continue; }
             photonSelection = true;
-            tagMuonsTemp = selectMuons( theMuons->ptrs(), dipho, vertices->ptrs(), muonEtaThreshold_, leptonPtThreshold_, muPFIsoSumRelThreshold_,
-                                           deltaRMuonPhoThreshold_, deltaRMuonPhoThreshold_ );
-            tagElectronsTemp = selectStdElectrons( theElectrons->ptrs(), dipho, vertices->ptrs(), leptonPtThreshold_,  electronEtaThresholds_,
-                                                      useElectronMVARecipe_,useElectronLooseID_,
-                                                   deltaRPhoElectronThreshold_,DeltaRTrkElec_,deltaMassElectronZThreshold_,
-                                                   rho_, evt.isRealData() );
+            const std::vector<edm::Ptr<flashgg::Muon> > &tagMuonsTemp = cleanedObjects->at( diphoIndex ).muons();
+            const std::vector<edm::Ptr<Electron> > &tagElectronsTemp = cleanedObjects->at( diphoIndex ).electrons();
             
             if( tagElectronsTemp.size() < 2 && tagMuonsTemp.size()<2) { continue; }
             //check for two good muons
@@ -46,17 +46,20 @@ namespace flashgg {
         ~bRegressionProducer(){};
         void InitJet();
         void SetNNVectorVar();
-        std::vector<float> EvaluateNN();
+        std::vector<float> EvaluateNN( unsigned int nJets );
     private:
         void produce( Event &, const EventSetup & ) override;
-        //        std::vector<edm::InputTag> inputTagJets_;
-        edm::InputTag inputTagJets_;
+        void applyCorrection( flashgg::Jet &fjet, float corr, float res );
+        std::vector<edm::InputTag> inputTagJets_;
         edm::EDGetTokenT<double> rhoToken_;        
         string bRegressionWeightfileName_;
         double y_mean_;
         double y_std_;
         string year_;
-        EDGetTokenT<View<flashgg::Jet> > jetToken_;
+        int intraOpThreads_;
+        int interOpThreads_;
+        std::vector<EDGetTokenT<View<flashgg::Jet> > > jetTokens_;
+        bool multipleCollections_;
 
         #ifdef CMSSW9
            tensorflow::Session* session;
@@ -64,7 +67,8 @@ namespace flashgg {
            dnn::tf::Graph NNgraph_;
         #endif
         std::vector<float> NNvectorVar_; 
-        //add vector of mva for each jet
+        // inputs of all the jets in the event to be regressed, evaluated as a single batch
+        std::vector<float> NNinputs_;
 
         //mva variables
         float Jet_pt ;
@@ -116,19 +120,33 @@ namespace flashgg {
 
 
     bRegressionProducer::bRegressionProducer( const ParameterSet &iConfig ) :
-        inputTagJets_( iConfig.getParameter<edm::InputTag>( "JetTag" )) ,
         rhoToken_( consumes<double>(iConfig.getParameter<edm::InputTag>( "rhoFixedGridCollection" ) ) ),
         bRegressionWeightfileName_( iConfig.getUntrackedParameter<std::string>("bRegressionWeightfile")),
         y_mean_(iConfig.getUntrackedParameter<double>("y_mean")),
         y_std_(iConfig.getUntrackedParameter<double>("y_std")),
-        year_(iConfig.getUntrackedParameter<std::string>("year"))
+        year_(iConfig.getUntrackedParameter<std::string>("year")),
+        intraOpThreads_(iConfig.getUntrackedParameter<int>("intraOpThreads", 1)),
+        interOpThreads_(iConfig.getUntrackedParameter<int>("interOpThreads", 1))
     {
-        jetToken_= consumes<View<flashgg::Jet> >(inputTagJets_);
+        // JetTags: regress all the per-vertex collections in one go, putting one output per collection
+        // with the collection index as instance label; JetTag: single collection, unlabelled output
+        multipleCollections_ = iConfig.exists( "JetTags" );
+        if( multipleCollections_ ) {
+            inputTagJets_ = iConfig.getParameter<std::vector<edm::InputTag> >( "JetTags" );
+        } else {
+            inputTagJets_.push_back( iConfig.getParameter<edm::InputTag>( "JetTag" ) );
+        }
+        for( auto &tag : inputTagJets_ ) {
+            jetTokens_.push_back( consumes<View<flashgg::Jet> >( tag ) );
+        }
 
 
         #ifdef CMSSW9
            tensorflow::GraphDef* graphDef= tensorflow::loadGraphDef(bRegressionWeightfileName_.c_str());
-           session = tensorflow::createSession(graphDef);
+           tensorflow::SessionOptions sessionOptions;
+           sessionOptions.config.set_intra_op_parallelism_threads(intraOpThreads_);
+           sessionOptions.config.set_inter_op_parallelism_threads(interOpThreads_);
+           session = tensorflow::createSession(graphDef, sessionOptions);
 
            
         #elif CMSSW8
@@ -179,185 +197,209 @@ namespace flashgg {
         Jet_mass = 0.;
         Jet_withPtd = 0.;
 
-        produces<vector<flashgg::Jet> > ();
+        if( multipleCollections_ ) {
+            for( unsigned int icoll = 0 ; icoll < inputTagJets_.size() ; icoll++ ) {
+                produces<vector<flashgg::Jet> > ( std::to_string( icoll ) );
+            }
+        } else {
+            produces<vector<flashgg::Jet> > ();
+        }
     }
 
 
 
     void bRegressionProducer::produce( Event &evt, const EventSetup & )
     {
-        // input jets
-        Handle<View<flashgg::Jet> > jets;
-        evt.getByToken( jetToken_, jets );//just to try get the first one
-       unique_ptr<vector<flashgg::Jet> > jetColl( new vector<flashgg::Jet> );
-        for( unsigned int i = 0 ; i < jets->size() ; i++ ) {
-
-            InitJet();
-            
-            Ptr<flashgg::Jet> pjet = jets->ptrAt( i );
-            flashgg::Jet fjet = flashgg::Jet( *pjet );
-
-
-            //variables needed for regression
-            //you need to take uncorrected jet for variables
-            Jet_pt = fjet.correctedJet("Uncorrected").pt() ;
-            Jet_eta = fjet.eta() ;
-            Jet_leadTrackPt = fjet.userFloat("leadTrackPt");
-            edm::Handle<double> rhoHandle;
-            evt.getByToken( rhoToken_, rhoHandle );
-            const double rhoFixedGrd = *( rhoHandle.product() );
-            rho = rhoFixedGrd;
-            Jet_mt = sqrt(fjet.correctedJet("Uncorrected").energy()*fjet.correctedJet("Uncorrected").energy()-fjet.correctedJet("Uncorrected").pz()*fjet.correctedJet("Uncorrected").pz());
-
-            //this max probably not needed, it's just heppy
-            Jet_leptonPtRel = std::max(float(0.),fjet.userFloat("softLepPtRel"));
-            Jet_leptonDeltaR = std::max(float(0.),fjet.userFloat("softLepDr"));
-            Jet_neHEF = fjet.neutralHadronEnergyFraction();
-            Jet_neEmEF = fjet.neutralEmEnergyFraction();
-            Jet_chHEF = fjet.chargedHadronEnergyFraction();
-            Jet_chEmEF = fjet.chargedEmEnergyFraction();
-            Jet_leptonPtRelInv = fjet.userFloat("softLepPtRelInv")*Jet_pt/fjet.pt();
+        edm::Handle<double> rhoHandle;
+        evt.getByToken( rhoToken_, rhoHandle );
+        const double rhoFixedGrd = *( rhoHandle.product() );
+
+        // first pass: copy the jets and collect the NN inputs of all the jets to be regressed
+        std::vector<unique_ptr<vector<flashgg::Jet> > > jetColls;
+        std::vector<flashgg::Jet *> regressedJets;
+        NNinputs_.clear();
+        for( auto &jetToken : jetTokens_ ) {
+            Handle<View<flashgg::Jet> > jets;
+            evt.getByToken( jetToken, jets );
+            jetColls.emplace_back( new vector<flashgg::Jet> );
+            vector<flashgg::Jet> &jetColl = *jetColls.back();
+            jetColl.reserve( jets->size() );
+            for( unsigned int i = 0 ; i < jets->size() ; i++ ) {
+
+                InitJet();
             
-            int lepPdgID = fjet.userInt("softLepPdgId");
-            if (abs(lepPdgID)==13){
-                isMu=1; 
-            }else if (abs(lepPdgID)==11){
-                isEle=1;
-            }else{
-                isOther=1;
-            }
-            Jet_mass=fjet.correctedJet("Uncorrected").mass();
-            Jet_withPtd=fjet.userFloat("ptD");
+                jetColl.push_back( jets->at( i ) );
+                flashgg::Jet &fjet = jetColl.back();
+
+
+                //variables needed for regression
+                //you need to take uncorrected jet for variables
+                Jet_pt = fjet.correctedJet("Uncorrected").pt() ;
+                Jet_eta = fjet.eta() ;
+                Jet_leadTrackPt = fjet.userFloat("leadTrackPt");
+                rho = rhoFixedGrd;
+                Jet_mt = sqrt(fjet.correctedJet("Uncorrected").energy()*fjet.correctedJet("Uncorrected").energy()-fjet.correctedJet("Uncorrected").pz()*fjet.correctedJet("Uncorrected").pz());
+
+                //this max probably not needed, it's just heppy
+                Jet_leptonPtRel = std::max(float(0.),fjet.userFloat("softLepPtRel"));
+                Jet_leptonDeltaR = std::max(float(0.),fjet.userFloat("softLepDr"));
+                Jet_neHEF = fjet.neutralHadronEnergyFraction();
+                Jet_neEmEF = fjet.neutralEmEnergyFraction();
+                Jet_chHEF = fjet.chargedHadronEnergyFraction();
+                Jet_chEmEF = fjet.chargedEmEnergyFraction();
+                Jet_leptonPtRelInv = fjet.userFloat("softLepPtRelInv")*Jet_pt/fjet.pt();
             
-            if(fjet.userFloat("nSecVertices")>0){
-//                float vertexX=fjet.userFloat("vtxPosX")-fjet.userFloat("vtxPx");//check if it's correct
-//                float vertexY=fjet.userFloat("vtxPosY")-fjet.userFloat("vtxPy");                
-//                Jet_vtxPt = sqrt(vertexX*vertexX+vertexY*vertexY);
-                Jet_vtxPt=sqrt(fjet.userFloat("vtxPx")*fjet.userFloat("vtxPx")+fjet.userFloat("vtxPy")*fjet.userFloat("vtxPy"));
-                Jet_vtxMass = std::max(float(0.),fjet.userFloat("vtxMass"));
-                Jet_vtx3dL = std::max(float(0.),fjet.userFloat("vtx3DVal"));
-                Jet_vtxNtrk = std::max(float(0.),fjet.userFloat("vtxNTracks"));
-                Jet_vtx3deL = std::max(float(0.),fjet.userFloat("vtx3DSig"));
-                if (year_=="2017") {
-                    if (Jet_vtx3deL!=0.) Jet_vtx3deL = Jet_vtx3dL/Jet_vtx3deL ;
+                int lepPdgID = fjet.userInt("softLepPdgId");
+                if (abs(lepPdgID)==13){
+                    isMu=1; 
+                }else if (abs(lepPdgID)==11){
+                    isEle=1;
+                }else{
+                    isOther=1;
                 }
-            }
-            if (fjet.emEnergies().size()>0){//since in order to save space we save this info only if the candidate has a minimum pt or eta
-                Jet_energyRing_dR0_em_Jet_e = fjet.emEnergies()[0]/fjet.correctedJet("Uncorrected").energy();//remember to divide by jet energy
-                Jet_energyRing_dR1_em_Jet_e = fjet.emEnergies()[1]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR2_em_Jet_e = fjet.emEnergies()[2]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR3_em_Jet_e = fjet.emEnergies()[3]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR4_em_Jet_e = fjet.emEnergies()[4]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR0_neut_Jet_e = fjet.neEnergies()[0]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR1_neut_Jet_e = fjet.neEnergies()[1]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR2_neut_Jet_e = fjet.neEnergies()[2]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR3_neut_Jet_e = fjet.neEnergies()[3]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR4_neut_Jet_e = fjet.neEnergies()[4]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR0_ch_Jet_e = fjet.chEnergies()[0]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR1_ch_Jet_e = fjet.chEnergies()[1]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR2_ch_Jet_e = fjet.chEnergies()[2]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR3_ch_Jet_e = fjet.chEnergies()[3]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR4_ch_Jet_e = fjet.chEnergies()[4]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR0_mu_Jet_e = fjet.muEnergies()[0]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR1_mu_Jet_e = fjet.muEnergies()[1]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR2_mu_Jet_e = fjet.muEnergies()[2]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR3_mu_Jet_e = fjet.muEnergies()[3]/fjet.correctedJet("Uncorrected").energy();
-                Jet_energyRing_dR4_mu_Jet_e = fjet.muEnergies()[4]/fjet.correctedJet("Uncorrected").energy();
-            }
-            Jet_numDaughters_pt03 = fjet.userInt("numDaug03");
+                Jet_mass=fjet.correctedJet("Uncorrected").mass();
+                Jet_withPtd=fjet.userFloat("ptD");
             
-            std::vector<float> bRegNN(3,-999);
+                if(fjet.userFloat("nSecVertices")>0){
+    //                float vertexX=fjet.userFloat("vtxPosX")-fjet.userFloat("vtxPx");//check if it's correct
+    //                float vertexY=fjet.userFloat("vtxPosY")-fjet.userFloat("vtxPy");                
+    //                Jet_vtxPt = sqrt(vertexX*vertexX+vertexY*vertexY);
+                    Jet_vtxPt=sqrt(fjet.userFloat("vtxPx")*fjet.userFloat("vtxPx")+fjet.userFloat("vtxPy")*fjet.userFloat("vtxPy"));
+                    Jet_vtxMass = std::max(float(0.),fjet.userFloat("vtxMass"));
+                    Jet_vtx3dL = std::max(float(0.),fjet.userFloat("vtx3DVal"));
+                    Jet_vtxNtrk = std::max(float(0.),fjet.userFloat("vtxNTracks"));
+                    Jet_vtx3deL = std::max(float(0.),fjet.userFloat("vtx3DSig"));
+                    if (year_=="2017") {
+                        if (Jet_vtx3deL!=0.) Jet_vtx3deL = Jet_vtx3dL/Jet_vtx3deL ;
+                    }
+                }
+                if (fjet.emEnergies().size()>0){//since in order to save space we save this info only if the candidate has a minimum pt or eta
+                    Jet_energyRing_dR0_em_Jet_e = fjet.emEnergies()[0]/fjet.correctedJet("Uncorrected").energy();//remember to divide by jet energy
+                    Jet_energyRing_dR1_em_Jet_e = fjet.emEnergies()[1]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR2_em_Jet_e = fjet.emEnergies()[2]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR3_em_Jet_e = fjet.emEnergies()[3]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR4_em_Jet_e = fjet.emEnergies()[4]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR0_neut_Jet_e = fjet.neEnergies()[0]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR1_neut_Jet_e = fjet.neEnergies()[1]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR2_neut_Jet_e = fjet.neEnergies()[2]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR3_neut_Jet_e = fjet.neEnergies()[3]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR4_neut_Jet_e = fjet.neEnergies()[4]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR0_ch_Jet_e = fjet.chEnergies()[0]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR1_ch_Jet_e = fjet.chEnergies()[1]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR2_ch_Jet_e = fjet.chEnergies()[2]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR3_ch_Jet_e = fjet.chEnergies()[3]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR4_ch_Jet_e = fjet.chEnergies()[4]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR0_mu_Jet_e = fjet.muEnergies()[0]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR1_mu_Jet_e = fjet.muEnergies()[1]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR2_mu_Jet_e = fjet.muEnergies()[2]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR3_mu_Jet_e = fjet.muEnergies()[3]/fjet.correctedJet("Uncorrected").energy();
+                    Jet_energyRing_dR4_mu_Jet_e = fjet.muEnergies()[4]/fjet.correctedJet("Uncorrected").energy();
+                }
+                Jet_numDaughters_pt03 = fjet.userInt("numDaug03");
             
 
-            if(debug){
-                cout<<"Jet_pt :"<<Jet_pt <<endl;
-                cout<<"Jet_eta :"<<Jet_eta <<endl;
-                cout<<"rho :"<<rho <<endl;
-                cout<<"Jet_mt :"<<Jet_mt <<endl;
-                cout<<"Jet_leadTrackPt :"<<Jet_leadTrackPt <<endl;
-                cout<<"Jet_leptonPtRel :"<<Jet_leptonPtRel <<endl;
-                cout<<"Jet_leptonDeltaR :"<<Jet_leptonDeltaR <<endl;
-                cout<<"Jet_neHEF :"<<Jet_neHEF <<endl;
-                cout<<"Jet_neEmEF :"<<Jet_neEmEF <<endl;
-                cout<<"Jet_vtxPt :"<<Jet_vtxPt <<endl;
-                cout<<"Jet_vtxMass :"<<Jet_vtxMass <<endl;
-                cout<<"Jet_vtx3dL :"<<Jet_vtx3dL <<endl;
-                cout<<"Jet_vtxNtrk :"<<Jet_vtxNtrk <<endl;
-                cout<<"Jet_vtx3deL :"<<Jet_vtx3deL <<endl;
-                cout<<"Jet_numDaughters_pt03 :"<<Jet_numDaughters_pt03 <<endl;
-                cout<<"Jet_energyRing_dR0_em_Jet_e :"<<Jet_energyRing_dR0_em_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR1_em_Jet_e :"<<Jet_energyRing_dR1_em_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR2_em_Jet_e :"<<Jet_energyRing_dR2_em_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR3_em_Jet_e :"<<Jet_energyRing_dR3_em_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR4_em_Jet_e :"<<Jet_energyRing_dR4_em_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR0_neut_Jet_e :"<<Jet_energyRing_dR0_neut_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR1_neut_Jet_e :"<<Jet_energyRing_dR1_neut_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR2_neut_Jet_e :"<<Jet_energyRing_dR2_neut_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR3_neut_Jet_e :"<<Jet_energyRing_dR3_neut_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR4_neut_Jet_e :"<<Jet_energyRing_dR4_neut_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR0_ch_Jet_e :"<<Jet_energyRing_dR0_ch_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR1_ch_Jet_e :"<<Jet_energyRing_dR1_ch_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR2_ch_Jet_e :"<<Jet_energyRing_dR2_ch_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR3_ch_Jet_e :"<<Jet_energyRing_dR3_ch_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR4_ch_Jet_e :"<<Jet_energyRing_dR4_ch_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR0_mu_Jet_e :"<<Jet_energyRing_dR0_mu_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR1_mu_Jet_e :"<<Jet_energyRing_dR1_mu_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR2_mu_Jet_e :"<<Jet_energyRing_dR2_mu_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR3_mu_Jet_e :"<<Jet_energyRing_dR3_mu_Jet_e <<endl;
-                cout<<"Jet_energyRing_dR4_mu_Jet_e :"<<Jet_energyRing_dR4_mu_Jet_e <<endl;
-                cout<<"Jet_chHEF:"<<Jet_chHEF<<endl;
-                cout<<"Jet_chEmEF:"<<Jet_chEmEF<<endl;
-                cout<<"Jet_leptonPtRelInv:"<<Jet_leptonPtRelInv<<endl;
-                cout<<"isEle:"<<isEle<<endl;
-                cout<<"isMu:"<<isMu<<endl;
-                cout<<"isOther:"<<isOther<<endl;
-                cout<<"Jet_mass:"<<Jet_mass<<endl;
-                cout<<"Jet_withPtd:"<<Jet_withPtd<<endl;
-            }
-            SetNNVectorVar();
-            bRegNN = EvaluateNN();
-            NNvectorVar_.clear();
-
-            if (fjet.pt()<20) {//b-jet regression should not be applied to low-pt jets since not trained. just set a correction of 1
-                float corr=1., res=0.2;
-                fjet.addUserFloat("bRegNNCorr", corr);
-                fjet.addUserFloat("bRegNNResolution",res);
-            }else{
-                float corr = 1., res=0.2;
-                if ( (TMath::Finite(bRegNN[0])) && (TMath::Finite(bRegNN[1])) && (TMath::Finite(bRegNN[2])) )  {
-                      corr = bRegNN[0]*y_std_+y_mean_;
-                      res = 0.5*(bRegNN[2]-bRegNN[1])*y_std_;
-                      if (!( (corr>0.1)&&(corr<2)&&(res>0.005)&&(res<0.9) )) {
-                           corr = 1.;
-                           res = 0.2;
-                      } 
-                } 
-                fjet.addUserFloat("bRegNNCorr",corr) ;
-                fjet.addUserFloat("bRegNNResolution",res);
+                if(debug){
+                    cout<<"Jet_pt :"<<Jet_pt <<endl;
+                    cout<<"Jet_eta :"<<Jet_eta <<endl;
+                    cout<<"rho :"<<rho <<endl;
+                    cout<<"Jet_mt :"<<Jet_mt <<endl;
+                    cout<<"Jet_leadTrackPt :"<<Jet_leadTrackPt <<endl;
+                    cout<<"Jet_leptonPtRel :"<<Jet_leptonPtRel <<endl;
+                    cout<<"Jet_leptonDeltaR :"<<Jet_leptonDeltaR <<endl;
+                    cout<<"Jet_neHEF :"<<Jet_neHEF <<endl;
+                    cout<<"Jet_neEmEF :"<<Jet_neEmEF <<endl;
+                    cout<<"Jet_vtxPt :"<<Jet_vtxPt <<endl;
+                    cout<<"Jet_vtxMass :"<<Jet_vtxMass <<endl;
+                    cout<<"Jet_vtx3dL :"<<Jet_vtx3dL <<endl;
+                    cout<<"Jet_vtxNtrk :"<<Jet_vtxNtrk <<endl;
+                    cout<<"Jet_vtx3deL :"<<Jet_vtx3deL <<endl;
+                    cout<<"Jet_numDaughters_pt03 :"<<Jet_numDaughters_pt03 <<endl;
+                    cout<<"Jet_energyRing_dR0_em_Jet_e :"<<Jet_energyRing_dR0_em_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR1_em_Jet_e :"<<Jet_energyRing_dR1_em_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR2_em_Jet_e :"<<Jet_energyRing_dR2_em_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR3_em_Jet_e :"<<Jet_energyRing_dR3_em_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR4_em_Jet_e :"<<Jet_energyRing_dR4_em_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR0_neut_Jet_e :"<<Jet_energyRing_dR0_neut_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR1_neut_Jet_e :"<<Jet_energyRing_dR1_neut_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR2_neut_Jet_e :"<<Jet_energyRing_dR2_neut_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR3_neut_Jet_e :"<<Jet_energyRing_dR3_neut_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR4_neut_Jet_e :"<<Jet_energyRing_dR4_neut_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR0_ch_Jet_e :"<<Jet_energyRing_dR0_ch_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR1_ch_Jet_e :"<<Jet_energyRing_dR1_ch_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR2_ch_Jet_e :"<<Jet_energyRing_dR2_ch_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR3_ch_Jet_e :"<<Jet_energyRing_dR3_ch_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR4_ch_Jet_e :"<<Jet_energyRing_dR4_ch_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR0_mu_Jet_e :"<<Jet_energyRing_dR0_mu_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR1_mu_Jet_e :"<<Jet_energyRing_dR1_mu_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR2_mu_Jet_e :"<<Jet_energyRing_dR2_mu_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR3_mu_Jet_e :"<<Jet_energyRing_dR3_mu_Jet_e <<endl;
+                    cout<<"Jet_energyRing_dR4_mu_Jet_e :"<<Jet_energyRing_dR4_mu_Jet_e <<endl;
+                    cout<<"Jet_chHEF:"<<Jet_chHEF<<endl;
+                    cout<<"Jet_chEmEF:"<<Jet_chEmEF<<endl;
+                    cout<<"Jet_leptonPtRelInv:"<<Jet_leptonPtRelInv<<endl;
+                    cout<<"isEle:"<<isEle<<endl;
+                    cout<<"isMu:"<<isMu<<endl;
+                    cout<<"isOther:"<<isOther<<endl;
+                    cout<<"Jet_mass:"<<Jet_mass<<endl;
+                    cout<<"Jet_withPtd:"<<Jet_withPtd<<endl;
+                }
+                if (fjet.pt()<20) {//b-jet regression should not be applied to low-pt jets since not trained. just set a correction of 1
+                    applyCorrection( fjet, 1., 0.2 );
+                    continue;
+                }
+                SetNNVectorVar();
+                NNinputs_.insert( NNinputs_.end(), NNvectorVar_.begin(), NNvectorVar_.end() );
+                NNvectorVar_.clear();
+                regressedJets.push_back( &fjet );
             }
+        }
 
-            TLorentzVector jetCorrected;
-            jetCorrected.SetPtEtaPhiE(fjet.pt()*fjet.userFloat("bRegNNCorr"),fjet.eta(),fjet.phi(),fjet.p4().e()*fjet.userFloat("bRegNNCorr"));
-
-            math::XYZTLorentzVector jetCorr;
-            jetCorr.SetPxPyPzE(jetCorrected.Px(),jetCorrected.Py(),jetCorrected.Pz(),jetCorrected.E()); 
-
-            fjet.setP4(jetCorr);//set the jet  with the regressed pt
+        // single NN evaluation for all the jets of all the collections
+        std::vector<float> bRegNN = EvaluateNN( regressedJets.size() );
+
+        // second pass: scatter the outputs back to the jets
+        for( unsigned int ijet = 0 ; ijet < regressedJets.size() ; ijet++ ) {
+            const float *jetNN = &bRegNN[3 * ijet];
+            float corr = 1., res=0.2;
+            if ( (TMath::Finite(jetNN[0])) && (TMath::Finite(jetNN[1])) && (TMath::Finite(jetNN[2])) )  {
+                corr = jetNN[0]*y_std_+y_mean_;
+                res = 0.5*(jetNN[2]-jetNN[1])*y_std_;
+                if (!( (corr>0.1)&&(corr<2)&&(res>0.005)&&(res<0.9) )) {
+                    corr = 1.;
+                    res = 0.2;
+                } 
+            } 
+            applyCorrection( *regressedJets[ijet], corr, res );
 
             if (debug){
-                cout<<"bRegNNCorr:"<<bRegNN[0]*y_std_+y_mean_<<endl;
-                cout<<"bRegNNResolution:"<<0.5*(bRegNN[2]-bRegNN[1])*y_std_<<endl;
+                cout<<"bRegNNCorr:"<<jetNN[0]*y_std_+y_mean_<<endl;
+                cout<<"bRegNNResolution:"<<0.5*(jetNN[2]-jetNN[1])*y_std_<<endl;
                 std::cout<<"--------------------------------------------------------------"<<std::endl;
                 std::cout<<"--------------------------------------------------------------"<<std::endl;
             }
-            
+        }
+
+        if( multipleCollections_ ) {
+            for( unsigned int icoll = 0 ; icoll < jetColls.size() ; icoll++ ) {
+                evt.put( std::move( jetColls[icoll] ), std::to_string( icoll ) );
+            }
+        } else {
+            evt.put( std::move( jetColls[0] ) );
+        }
+    }
 
-            jetColl->push_back( fjet );
+    void bRegressionProducer::applyCorrection( flashgg::Jet &fjet, float corr, float res )
+    {
+        fjet.addUserFloat("bRegNNCorr",corr) ;
+        fjet.addUserFloat("bRegNNResolution",res);
 
-            
+        TLorentzVector jetCorrected;
+        jetCorrected.SetPtEtaPhiE(fjet.pt()*fjet.userFloat("bRegNNCorr"),fjet.eta(),fjet.phi(),fjet.p4().e()*fjet.userFloat("bRegNNCorr"));
 
-        }
-        evt.put( std::move( jetColl ) );
+        math::XYZTLorentzVector jetCorr;
+        jetCorr.SetPxPyPzE(jetCorrected.Px(),jetCorrected.Py(),jetCorrected.Pz(),jetCorrected.E()); 
+
+        fjet.setP4(jetCorr);//set the jet  with the regressed pt
     }
     
     void bRegressionProducer::InitJet(){
@@ -461,31 +503,36 @@ namespace flashgg {
 
     }
     
-    std::vector<float> bRegressionProducer::EvaluateNN(){
-        unsigned int shape=NNvectorVar_.size();
-        std::vector<float> correction(3);//3 outputs, first value is mean and then other 2 quantiles
+    std::vector<float> bRegressionProducer::EvaluateNN( unsigned int nJets ){
+        std::vector<float> correction(3*nJets);//3 outputs per jet, first value is mean and then other 2 quantiles
+        if( nJets == 0 ) { return correction; }
+        unsigned int shape=NNinputs_.size()/nJets;
         #ifdef CMSSW9
-           tensorflow::Tensor input(tensorflow::DT_FLOAT, {1,shape});
-           for (unsigned int i = 0; i < NNvectorVar_.size(); i++){
-               input.matrix<float>()(0,i) =  float(NNvectorVar_[i]);
-           }
+           tensorflow::Tensor input(tensorflow::DT_FLOAT, {nJets,shape});
+           std::copy(NNinputs_.begin(), NNinputs_.end(), input.flat<float>().data());
            std::vector<tensorflow::Tensor> outputs;
            tensorflow::run(session, { { "ffwd_inp:0",input } }, { "ffwd_out/BiasAdd:0" }, &outputs);
-           correction[0] = outputs[0].matrix<float>()(0, 0);
-           correction[1] = outputs[0].matrix<float>()(0, 1);
-           correction[2] = outputs[0].matrix<float>()(0, 2);
+           auto output = outputs[0].matrix<float>();
+           for (unsigned int ijet = 0; ijet < nJets; ijet++){
+               correction[3*ijet+0] = output(ijet, 0);
+               correction[3*ijet+1] = output(ijet, 1);
+               correction[3*ijet+2] = output(ijet, 2);
+           }
         #elif CMSSW8
-           dnn::tf::Shape xShape[] = { 1, shape };
+           dnn::tf::Shape xShape[] = { nJets, shape };
            dnn::tf::Tensor* x = NNgraph_.defineInput(new dnn::tf::Tensor("ffwd_inp:0", 2, xShape));
            dnn::tf::Tensor* y = NNgraph_.defineOutput(new dnn::tf::Tensor("ffwd_out/BiasAdd:0"));
-           for (int i = 0; i < x->getShape(1); i++){
-                          // std::cout<<"i:"<<i<<" x:"<<NNvectorVar_[i]<<std::endl;
-               x->setValue<float>(0, i, NNvectorVar_[i]);
+           for (unsigned int ijet = 0; ijet < nJets; ijet++){
+               for (unsigned int i = 0; i < shape; i++){
+                   x->setValue<float>(ijet, i, NNinputs_[ijet*shape+i]);
+               }
            }
            NNgraph_.eval();
-           correction[0] = y->getValue<float>(0, 0);
-           correction[1] = y->getValue<float>(0, 1);            
-           correction[2] = y->getValue<float>(0, 2);   
+           for (unsigned int ijet = 0; ijet < nJets; ijet++){
+               correction[3*ijet+0] = y->getValue<float>(ijet, 0);
+               correction[3*ijet+1] = y->getValue<float>(ijet, 1);
+               correction[3*ijet+2] = y->getValue<float>(ijet, 2);
+           }
         #endif         
         return correction;
     }//end EvaluateNN
@@ -1,5 +1,5 @@
 import FWCore.ParameterSet.Config as cms
 
-from flashggDoubleHTag_cfi import flashggDoubleHTag
+from flashggDoubleHTag_cfi import flashggDoubleHCleanedObjects,flashggDoubleHTag
 
-flashggDoubleHTagSequence = cms.Sequence( flashggDoubleHTag )
+flashggDoubleHTagSequence = cms.Sequence( flashggDoubleHCleanedObjects * flashggDoubleHTag )
@@ -28,13 +28,31 @@ elif year == "2017":
 
 
 
+# jets selected and cleaned against each diphoton for flashggDoubleHTag: its own instance of the shared producer,
+# since the b-jet regression replaces the input jets (see doubleHCustomize)
+flashggDoubleHCleanedObjects = cms.EDProducer("FlashggDiPhotonCleanedObjectsProducer",
+                                              DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
+                                              inputTagJets= UnpackedJetCollectionVInputTag, # one jet per vertex
+                                              selections = cms.VPSet(
+        cms.PSet(name = cms.string("DoubleH"),
+                 leptonSelection = cms.string("None"),
+                 JetIDLevel = cms.string(jetPUID), # "None" for no jet id
+                 jetPtThreshold = cms.double(25.),
+                 jetEtaThreshold = cms.double(2.5),
+                 deltaRJetLeadPhoThreshold = cms.double(0.4),
+                 deltaRJetSubLeadPhoThreshold = cms.double(0.4),
+                 jetPhotonDrWithSuperCluster = cms.bool(False),
+                 bTag = cms.vstring('pfDeepCSVJetTags:probb','pfDeepCSVJetTags:probbb') # summed, for the b-tag ordering of the dijet pairs
+                 )
+        )
+                                              )
+
 flashggDoubleHTag = cms.EDProducer("FlashggDoubleHTagProducer",
                                    DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'), # diphoton collection (will be replaced by systematics machinery at run time)
-                                   JetTags= UnpackedJetCollectionVInputTag, # one jet per vertex
+                                   CleanedObjectsTag = cms.InputTag('flashggDoubleHCleanedObjects','DoubleH'),
                                    GenParticleTag = cms.InputTag( "flashggPrunedGenParticles" ), # to compute MC-truth info
                                    SystLabel      = cms.string(""), # used by systematics machinery
                                    
-                                   VetoConeSize   = cms.double(0.4),
                                    MinLeadPhoPt   = cms.double(1./3.),
                                    MinSubleadPhoPt   = cms.double(0.25),
                                    ScalingPtCuts = cms.bool(True),
@@ -44,14 +62,7 @@ flashggDoubleHTag = cms.EDProducer("FlashggDoubleHTagProducer",
                                    PhotonIDCut = cms.double(0.2),#this is loose id for 2016
                                    PhotonElectronVeto =cms.untracked.vint32(1, 1), #0: Pho1, 1: Pho2
 
-                                   MinJetPt   = cms.double(25.),
-                                   MaxJetEta   = cms.double(2.5),
                                    MJJBoundaries = cms.vdouble(70.,190.),
-                                  # BTagType = cms.untracked.string('pfCombinedInclusiveSecondaryVertexV2BJetTags'), #string for btag algorithm
-                                 #c  BTagType = cms.untracked.string('pfDeepCSVJetTags:probb'), #string for btag algorithm
-                                   BTagType = cms.vstring('pfDeepCSVJetTags:probb','pfDeepCSVJetTags:probbb'), #string for btag algorithm
-                                   UseJetID = cms.bool(True),
-                                   JetIDLevel = cms.string(jetPUID),
 
                                    MVABoundaries  = cms.vdouble(0.29,0.441, 0.724), # category boundaries for MVA
                                    MXBoundaries   = cms.vdouble(250., 354., 478., 560.), # .. and MX
@@ -19,6 +19,7 @@ def flashggPrepareTagSequence(options):
                                       * flashggUnpackedJets
                                       * flashggVBFMVA
                                       * flashggVBFDiPhoDiJetMVA
+                                      * flashggDiPhotonCleanedObjects
                                       * ( flashggUntagged
                                       #                                  *( flashggSigmaMoMpToMTag
                                           + flashggVBFTag
@@ -42,3 +43,29 @@ def flashggPrepareTagSequence(options):
                                   )
 
     return flashggTagSequence
+
+def runTagProducersOnDemand(process,path,accountingSummary=True):
+    """Moves the tag producers read by the tag sorters in path to a Task, so that they only run when
+    the sorter asks for them: with StoreOtherTagInfo off, the tags below the chosen one are never produced."""
+    task = cms.Task()
+    tagLabels = []
+    for name in path.moduleNames():
+        module = getattr(process,name)
+        if module.type_() != "FlashggTagSorter":
+            continue
+        module.OnDemandTags = cms.untracked.bool(True)
+        module.TagAccountingSummary = cms.untracked.bool(accountingSummary)
+        for pset in module.TagPriorityRanges:
+            label = pset.TagName.getModuleLabel()
+            if label not in tagLabels and hasattr(process,label):
+                tagLabels.append(label)
+    # removed through path only (Path.remove also looks into the sequences of path), not from every sequence of
+    # the process: the other paths are left as they are
+    for label in tagLabels:
+        module = getattr(process,label)
+        while path.remove(module):
+            pass
+        task.add(module)
+    # one Task per path, so that the function can be called for several paths
+    setattr(process,path.label_()+"OnDemandTagsTask",task)
+    path.associate(task)
@@ -32,6 +32,8 @@ flashggTagSorter = cms.EDProducer('FlashggTagSorter',
                                   BlindedSelectionPrintout = cms.bool(False),
                                   Debug = cms.untracked.bool(False),
                                   CreateNoTag = cms.bool(False),  # Placeholder for tracking rejected events
+                                  OnDemandTags = cms.untracked.bool(False), # tag collections are not prefetched, see runTagProducersOnDemand
+                                  TagAccountingSummary = cms.untracked.bool(False), # end of job summary of the time spent per tag collection
                                   HTXSTags = HTXSInputTags 
                                   )
 
@@ -8,7 +8,8 @@ bDiscriminator94X= cms.vdouble(0.1522,0.4941,0.8001)
 
 flashggUnpackedJets = cms.EDProducer("FlashggVectorVectorJetUnpacker",
                                      JetsTag = cms.InputTag("flashggFinalJets"),
-                                     NCollections = cms.uint32(maxJetCollections)
+                                     NCollections = cms.uint32(maxJetCollections),
+                                     JetsAreReferences = cms.bool(False) # for MicroAODs made with jetReferences=True
                                      )
 
 UnpackedJetCollectionVInputTag = cms.VInputTag()
@@ -52,14 +53,11 @@ flashggSigmaMoMpToMTag = cms.EDProducer("FlashggSigmaMpTTagProducer",
 
 flashggTTHHadronicTag = cms.EDProducer("FlashggTTHHadronicTagProducer",
                                        DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
+                                       CleanedObjectsTag = cms.InputTag('flashggDiPhotonCleanedObjects','TTHHadronic'),
                                        SystLabel=cms.string(""),
                                        MVAResultTag=cms.InputTag('flashggDiPhotonMVA'),
-                                       ElectronTag=cms.InputTag('flashggSelectedElectrons'),
-                                       MuonTag=cms.InputTag('flashggSelectedMuons'),
-                                       VertexTag=cms.InputTag('offlineSlimmedPrimaryVertices'),
                                        METTag=cms.InputTag('flashggMets'),
                                        GenParticleTag=cms.InputTag( 'flashggPrunedGenParticles' ),  
-                                       rhoTag = cms.InputTag('fixedGridRhoFastjetAll'),
 #                                       tthMVAweightfile = cms.FileInPath("flashgg/Taggers/data/TMVAClassification_tth_hadronic_2017Data_35vars_v0.weights.xml"),
                                        tthMVAweightfile = cms.FileInPath("flashgg/Taggers/data/TMVAClassification_tth_hadronic_2017Data_30vars_v0.weights.xml"),
                                        MVAMethod = cms.string("BDT"),     
@@ -72,13 +70,8 @@ flashggTTHHadronicTag = cms.EDProducer("FlashggTTHHadronicTagProducer",
                                        subleadPhoUseVariableThreshold =  cms.bool(True),
                                        MVAThreshold = cms.double(-1.0),
                                        PhoMVAThreshold = cms.double(-0.2),
-                                       inputTagJets= UnpackedJetCollectionVInputTag, 
-                                       jetPtThreshold = cms.double(25.),
-                                       jetEtaThreshold = cms.double(2.4),
 #                                       bDiscriminator = bDiscriminator80XReReco, #bDiscriminator76X
 #                                       bTag = cms.string(flashggBTag),
-                                       bDiscriminator = bDiscriminator94X,
-                                       bTag = cms.string(flashggDeepCSV),
                                        jetsNumberThreshold = cms.int32(5),
                                        bjetsNumberThreshold = cms.int32(1),
 				       bjetsLooseNumberThreshold = cms.int32(0),
@@ -92,17 +85,6 @@ flashggTTHHadronicTag = cms.EDProducer("FlashggTTHHadronicTagProducer",
                                        secondMaxBTagTTHHMVAThreshold = cms.double(0.0),  
 #                                       Boundaries = cms.vdouble( 0.29, 0.36, 0.43 ),
                                        Boundaries = cms.vdouble( 0.38, 0.48, 0.56 ),
-                                       dRJetPhoLeadCut =  cms.double(0.4),
-                                       dRJetPhoSubleadCut = cms.double(0.4),                          
-				       MuonEtaCut = cms.double(2.4),
-				       MuonPtCut = cms.double(5),
-				       MuonIsoCut = cms.double(0.25),
-				       MuonPhotonDrCut = cms.double(0.),
-				       EleEtaCuts = cms.vdouble(1.4442,1.566,2.5),
-				       ElePtCut = cms.double(10),
-				       ElePhotonDrCut = cms.double(0.),
-				       ElePhotonZMassCut = cms.double(5),
-				       DeltaRTrkEle = cms.double(0.),
 				       debug = cms.bool(False),
                                        HTXSTags     = HTXSInputTags                                     
                                        )
@@ -163,17 +145,156 @@ flashggVHEtTag = cms.EDProducer("FlashggVHEtTagProducer",
 )
 
 
+# leptons and jets selected once per event and cleaned against each diphoton for the tags below, which do not
+# take these cuts themselves: each selection is written as the product instance of its name and read by its tags
+# through CleanedObjectsTag. Photon-jet dR is computed with the photon supercluster if jetPhotonDrWithSuperCluster.
+# bDiscriminator gives the b-tag working points (loose, medium, tight) counted in the product.
+flashggDiPhotonCleanedObjects = cms.EDProducer("FlashggDiPhotonCleanedObjectsProducer",
+                                               DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
+                                               inputTagJets= UnpackedJetCollectionVInputTag,
+                                               ElectronTag=cms.InputTag('flashggSelectedElectrons'),
+                                               MuonTag=cms.InputTag('flashggSelectedMuons'),
+                                               VertexTag=cms.InputTag('offlineSlimmedPrimaryVertices'),
+                                               rhoTag = cms.InputTag('fixedGridRhoFastjetAll'),
+                                               selections = cms.VPSet(
+        cms.PSet(name = cms.string("TTHLeptonic"),
+                 leptonSelection = cms.string("2018"),
+                 MuonEtaCut = cms.double(2.4),
+                 MuonPtCut = cms.double(5),
+                 MuonIsoCut = cms.double(0.25),
+                 MuonPhotonDrCut = cms.double(0.2),
+                 EleEtaCuts = cms.vdouble(1.4442,1.566,2.5),
+                 ElePtCut = cms.double(10),
+                 ElePhotonDrCut = cms.double(0.2),
+                 ElePhotonZMassCut = cms.double(5),
+                 JetIDLevel = cms.string("Loose"),
+                 jetPtThreshold = cms.double(25.),
+                 jetEtaThreshold= cms.double(2.4),
+                 deltaRJetLeadPhoThreshold = cms.double(0.4),
+                 deltaRJetSubLeadPhoThreshold = cms.double(0.4),
+                 jetPhotonDrWithSuperCluster = cms.bool(False),
+                 deltaRJetMuonThreshold = cms.double(0.4),
+                 deltaRJetElectronThreshold = cms.double(0.4),
+                 bTag = cms.vstring(flashggDeepCSV),
+                 bDiscriminator = bDiscriminator94X
+                 ),
+        # as TTHLeptonic, without the same-flavour lepton pairs close to the Z mass
+        cms.PSet(name = cms.string("TTHDiLepton"),
+                 leptonSelection = cms.string("2018"),
+                 MuonEtaCut = cms.double(2.4),
+                 MuonPtCut = cms.double(5),
+                 MuonIsoCut = cms.double(0.25),
+                 MuonPhotonDrCut = cms.double(0.2),
+                 EleEtaCuts = cms.vdouble(1.4442,1.566,2.5),
+                 ElePtCut = cms.double(10),
+                 ElePhotonDrCut = cms.double(0.2),
+                 ElePhotonZMassCut = cms.double(5),
+                 LeptonsZMassCut = cms.double(5),
+                 JetIDLevel = cms.string("Loose"),
+                 jetPtThreshold = cms.double(25.),
+                 jetEtaThreshold= cms.double(2.4),
+                 deltaRJetLeadPhoThreshold = cms.double(0.4),
+                 deltaRJetSubLeadPhoThreshold = cms.double(0.4),
+                 jetPhotonDrWithSuperCluster = cms.bool(False),
+                 deltaRJetMuonThreshold = cms.double(0.4),
+                 deltaRJetElectronThreshold = cms.double(0.4),
+                 bTag = cms.vstring(flashggDeepCSV),
+                 bDiscriminator = bDiscriminator94X
+                 ),
+        # leptons only used as a veto
+        cms.PSet(name = cms.string("TTHHadronic"),
+                 leptonSelection = cms.string("2018"),
+                 MuonEtaCut = cms.double(2.4),
+                 MuonPtCut = cms.double(5),
+                 MuonIsoCut = cms.double(0.25),
+                 MuonPhotonDrCut = cms.double(0.),
+                 EleEtaCuts = cms.vdouble(1.4442,1.566,2.5),
+                 ElePtCut = cms.double(10),
+                 ElePhotonDrCut = cms.double(0.),
+                 ElePhotonZMassCut = cms.double(5),
+                 JetIDLevel = cms.string("Tight2017"),
+                 jetPtThreshold = cms.double(25.),
+                 jetEtaThreshold= cms.double(2.4),
+                 deltaRJetLeadPhoThreshold = cms.double(0.4),
+                 deltaRJetSubLeadPhoThreshold = cms.double(0.4),
+                 jetPhotonDrWithSuperCluster = cms.bool(True),
+                 bTag = cms.vstring(flashggDeepCSV),
+                 bDiscriminator = bDiscriminator94X
+                 ),
+        cms.PSet(name = cms.string("WHLeptonic"),
+                 leptonSelection = cms.string("Std"),
+                 leptonPtThreshold = cms.double(20),
+                 muonEtaThreshold = cms.double(2.4),
+                 muPFIsoSumRelThreshold = cms.double(0.25),
+                 deltaRMuonPhoThreshold = cms.double(0.5),
+                 electronEtaThresholds=cms.vdouble(1.4442,1.566,2.5),
+                 useElectronMVARecipe = cms.bool(False),
+                 useElectronLooseID = cms.bool(True),
+                 deltaRPhoElectronThreshold = cms.double(1.),
+                 DeltaRTrkElec = cms.double(.4),
+                 deltaMassElectronZThreshold = cms.double(10.),
+                 JetIDLevel = cms.string("Tight2017"),
+                 jetPtThreshold = cms.double(20.),
+                 jetEtaThreshold= cms.double(2.4),
+                 deltaRJetLeadPhoThreshold = cms.double(0.4),
+                 deltaRJetSubLeadPhoThreshold = cms.double(0.4),
+                 jetPhotonDrWithSuperCluster = cms.bool(True),
+                 deltaRJetMuonThreshold = cms.double(0.4),
+                 deltaRJetElectronThreshold = cms.double(0.4),
+                 bTag = cms.vstring(flashggDeepCSV)
+                 ),
+        # ZHLeptonic (leptons only) and VHLeptonicLoose
+        cms.PSet(name = cms.string("VHLeptonic"),
+                 leptonSelection = cms.string("Std"),
+                 leptonPtThreshold = cms.double(20),
+                 muonEtaThreshold = cms.double(2.4),
+                 muPFIsoSumRelThreshold = cms.double(0.25),
+                 deltaRMuonPhoThreshold = cms.double(1),
+                 electronEtaThresholds=cms.vdouble(1.4442,1.566,2.5),
+                 useElectronMVARecipe = cms.bool(False),
+                 useElectronLooseID = cms.bool(True),
+                 deltaRPhoElectronThreshold = cms.double(1.),
+                 DeltaRTrkElec = cms.double(0.4),
+                 deltaMassElectronZThreshold = cms.double(10.),
+                 JetIDLevel = cms.string("Tight2017"),
+                 jetPtThreshold = cms.double(20.),
+                 jetEtaThreshold= cms.double(2.4),
+                 deltaRJetLeadPhoThreshold = cms.double(0.4),
+                 deltaRJetSubLeadPhoThreshold = cms.double(0.4),
+                 jetPhotonDrWithSuperCluster = cms.bool(True),
+                 deltaRJetMuonThreshold = cms.double(0.4),
+                 deltaRJetElectronThreshold = cms.double(0.4),
+                 bTag = cms.vstring(flashggDeepCSV)
+                 ),
+        cms.PSet(name = cms.string("VHHadronic"),
+                 leptonSelection = cms.string("None"),
+                 JetIDLevel = cms.string("Tight2017"),
+                 jetPtThreshold = cms.double(40.),
+                 jetEtaThreshold= cms.double(2.4),
+                 deltaRJetLeadPhoThreshold = cms.double(0.4),
+                 deltaRJetSubLeadPhoThreshold = cms.double(0.4),
+                 jetPhotonDrWithSuperCluster = cms.bool(False),
+                 bTag = cms.vstring(flashggDeepCSV)
+                 ),
+        cms.PSet(name = cms.string("VHMet"),
+                 leptonSelection = cms.string("None"),
+                 JetIDLevel = cms.string("Tight2017"),
+                 jetPtThreshold = cms.double(50.),
+                 jetEtaThreshold= cms.double(2.4),
+                 deltaRJetLeadPhoThreshold = cms.double(0.5),
+                 deltaRJetSubLeadPhoThreshold = cms.double(0.5),
+                 jetPhotonDrWithSuperCluster = cms.bool(True),
+                 bTag = cms.vstring(flashggDeepCSV)
+                 )
+        )
+                                               )
+
 flashggTTHLeptonicTag = cms.EDProducer("FlashggTTHLeptonicTagProducer",
                                        DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
                                        SystLabel=cms.string(""),
                                        MVAResultTag=cms.InputTag('flashggDiPhotonMVA'),
-                                       inputTagJets= UnpackedJetCollectionVInputTag,
-                                       ElectronTag=cms.InputTag('flashggSelectedElectrons'),
-                                       MuonTag=cms.InputTag('flashggSelectedMuons'),
 				       MetTag=cms.InputTag( 'flashggMets' ), 
-                                       VertexTag=cms.InputTag('offlineSlimmedPrimaryVertices'),
                                        GenParticleTag=cms.InputTag( "flashggPrunedGenParticles" ),
-				       rhoTag = cms.InputTag('fixedGridRhoFastjetAll'),
                                        MVAweightfile = cms.FileInPath("flashgg/Taggers/data/TMVAClassification_BDT_training_v2.json.weights.xml"),
                                        leadPhoOverMassThreshold = cms.double(0.33),
                                        subleadPhoOverMassThreshold = cms.double(0.25),
@@ -181,25 +302,10 @@ flashggTTHLeptonicTag = cms.EDProducer("FlashggTTHLeptonicTagProducer",
                                        PhoMVAThreshold = cms.double(-0.2), 
                                        jetsNumberThreshold = cms.double(1.),
                                        bjetsNumberThreshold = cms.double(1.),
-                                       jetPtThreshold = cms.double(25.), 
-                                       jetEtaThreshold= cms.double(2.4),
-                                       deltaRJetLeadPhoThreshold = cms.double(0.4),
-                                       deltaRJetSubLeadPhoThreshold = cms.double(0.4),
-				       deltaRJetLepton = cms.double(0.4),
 				       leadingJetPtThreshold = cms.double(0),
-                                       bDiscriminator = bDiscriminator94X, #bDiscriminator76X,
-                                       bTag = cms.string(flashggDeepCSV),
                                        MinNLep = cms.int32(1),
                                        MaxNLep = cms.int32(1),
-				       MuonEtaCut = cms.double(2.4),
-				       MuonPtCut = cms.double(5),
-				       MuonIsoCut = cms.double(0.25),
-				       MuonPhotonDrCut = cms.double(0.2),
-				       EleEtaCuts = cms.vdouble(1.4442,1.566,2.5),
-				       ElePtCut = cms.double(10),
-				       ElePhotonDrCut = cms.double(0.2),
-				       ElePhotonZMassCut = cms.double(5),
-				       DeltaRTrkEle = cms.double(0.35),
+				       CleanedObjectsTag = cms.InputTag('flashggDiPhotonCleanedObjects','TTHLeptonic'),
 				       UseCutBasedDiphoId = cms.bool(False),
 				       debug = cms.bool(False),
 				       CutBasedDiphoId = cms.vdouble(0.4,0.3,0.0,-0.5,2.0,2.5),    # pT/m lead, pT/m sublead, leadIdMVA, subleadIdMVA, DeltaEta, DeltaPhi
@@ -211,13 +317,8 @@ flashggTTHDiLeptonTag = cms.EDProducer("FlashggTTHDiLeptonTagProducer",
                                         DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
                                        SystLabel=cms.string(""),
                                        MVAResultTag=cms.InputTag('flashggDiPhotonMVA'),
-                                       inputTagJets= UnpackedJetCollectionVInputTag,
-                                       ElectronTag=cms.InputTag('flashggSelectedElectrons'),
-                                       MuonTag=cms.InputTag('flashggSelectedMuons'),
 				       MetTag=cms.InputTag( 'flashggMets' ), 
-                                       VertexTag=cms.InputTag('offlineSlimmedPrimaryVertices'),
                                        GenParticleTag=cms.InputTag( "flashggPrunedGenParticles" ),
-				       rhoTag = cms.InputTag('fixedGridRhoFastjetAll'),
                                        MVAweightfile = cms.FileInPath("flashgg/Taggers/data/TMVAClassification_BDT_training_v2.json.weights.xml"),
                                        leadPhoOverMassThreshold = cms.double(0.33),
                                        subleadPhoOverMassThreshold = cms.double(0.25),
@@ -225,24 +326,8 @@ flashggTTHDiLeptonTag = cms.EDProducer("FlashggTTHDiLeptonTagProducer",
                                        PhoMVAThreshold = cms.double(-0.2), 
                                        jetsNumberThreshold = cms.double(1.),
                                        bjetsNumberThreshold = cms.double(1.),
-                                       jetPtThreshold = cms.double(25.), 
-                                       jetEtaThreshold= cms.double(2.4),
-                                       deltaRJetLeadPhoThreshold = cms.double(0.4),
-                                       deltaRJetSubLeadPhoThreshold = cms.double(0.4),
-				       deltaRJetLepton = cms.double(0.4),
 				       leadingJetPtThreshold = cms.double(0),
-                                       bDiscriminator = bDiscriminator94X, #bDiscriminator76X,
-                                       bTag = cms.string(flashggDeepCSV),
-				       MuonEtaCut = cms.double(2.4),
-				       MuonPtCut = cms.double(5),
-				       MuonIsoCut = cms.double(0.25),
-				       MuonPhotonDrCut = cms.double(0.2),
-				       EleEtaCuts = cms.vdouble(1.4442,1.566,2.5),
-				       ElePtCut = cms.double(10),
-				       ElePhotonDrCut = cms.double(0.2),
-				       ElePhotonZMassCut = cms.double(5),
-				       DeltaRTrkEle = cms.double(0.35),
-				       LeptonsZMassCut = cms.double(5),
+				       CleanedObjectsTag = cms.InputTag('flashggDiPhotonCleanedObjects','TTHDiLepton'),
 				       UseCutBasedDiphoId = cms.bool(False),
 				       debug = cms.bool(False),
 				       CutBasedDiphoId = cms.vdouble(0.4,0.3,0.0,-0.5,2.0,2.5),    # pT/m lead, pT/m sublead, leadIdMVA, subleadIdMVA, DeltaEta, DeltaPhi
@@ -251,6 +336,8 @@ flashggTTHDiLeptonTag = cms.EDProducer("FlashggTTHDiLeptonTagProducer",
 )
 
 
+
+
 flashggVHLooseTag = cms.EDProducer("FlashggVHLooseTagProducer",
                                    DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
                                    SystLabel=cms.string(""),
@@ -358,8 +445,8 @@ flashggVHMetTag = cms.EDProducer("FlashggVHMetTagProducer",
                                  RECOfilters = cms.InputTag('TriggerResults::RECO'),
                                  PATfilters = cms.InputTag('TriggerResults::PAT'),
                                  FLASHfilters = cms.InputTag('TriggerResults::FLASHggMicroAOD'),
-                                 inputTagJets= UnpackedJetCollectionVInputTag,
                                  DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
+                                 CleanedObjectsTag = cms.InputTag('flashggDiPhotonCleanedObjects','VHMet'),
                                  SystLabel=cms.string(""),
                                  GenParticleTag=cms.InputTag( "flashggPrunedGenParticles" ),
                                  MVAResultTag=cms.InputTag('flashggDiPhotonMVA'),
@@ -370,10 +457,6 @@ flashggVHMetTag = cms.EDProducer("FlashggVHMetTagProducer",
                                  metPtThreshold = cms.double(85),
                                  dPhiDiphotonMetThreshold = cms.double(2.4),
                                  dPhiJetMetThreshold = cms.double(999.),
-                                 jetPtThreshold = cms.double(50.),
-                                 jetEtaThreshold= cms.double(2.4),
-                                 deltaRPhoLeadJet = cms.double(0.5),
-                                 deltaRPhoSubLeadJet = cms.double(0.5),
                                  diphoMVAThreshold= cms.double(0.6),
                                  phoIdMVAThreshold= cms.double(-0.9),
                                  HTXSTags     = HTXSInputTags
@@ -382,134 +465,78 @@ flashggVHMetTag = cms.EDProducer("FlashggVHMetTagProducer",
 
 flashggZHLeptonicTag = cms.EDProducer("FlashggZHLeptonicTagProducer",
                                    DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
+                                   CleanedObjectsTag = cms.InputTag('flashggDiPhotonCleanedObjects','VHLeptonic'),
                                    SystLabel=cms.string(""),
-                                   inputTagJets= UnpackedJetCollectionVInputTag,
-                                   ElectronTag=cms.InputTag('flashggSelectedElectrons'),
-                                   MuonTag=cms.InputTag('flashggSelectedMuons'),
-                                   VertexTag=cms.InputTag('offlineSlimmedPrimaryVertices'),
                                    MVAResultTag=cms.InputTag('flashggDiPhotonMVA'),
-                                   METTag=cms.InputTag('flashggMets'),
                                    useVertex0only=cms.bool(False),
                                    GenParticleTag=cms.InputTag( "flashggPrunedGenParticles" ),
-				   rhoTag = cms.InputTag('fixedGridRhoFastjetAll'),
-                                   leptonPtThreshold = cms.double(20),
-                                   muonEtaThreshold = cms.double(2.4),
                                    leadPhoOverMassThreshold = cms.double(0.375),
                                    subleadPhoOverMassThreshold = cms.double(0.25),
                                    MVAThreshold = cms.double(-0.405),
-                                   deltaRMuonPhoThreshold = cms.double(1),
-                                   muPFIsoSumRelThreshold = cms.double(0.25),
                                    PhoMVAThreshold = cms.double(-0.9),
                                    invMassLepLowThreshold = cms.double(70.),
                                    invMassLepHighThreshold = cms.double(110.),
                                    deltaRLowPtMuonPhoThreshold = cms.double(0.5),
                                    ElectronPtThreshold = cms.double(20.),
-                                   DeltaRTrkElec = cms.double(0.4),
                                    TransverseImpactParam = cms.double(0.02),
                                    LongitudinalImpactParam = cms.double(0.2),
-                                   deltaRPhoElectronThreshold = cms.double(1.),
-                                   deltaMassElectronZThreshold = cms.double(10.),
-                                   electronEtaThresholds=cms.vdouble(1.4442,1.566,2.5),
                                    nonTrigMVAThresholds = cms.vdouble(0.913286,0.805013,0.358969),
                                    nonTrigMVAEtaCuts = cms.vdouble(0.8,1.479,2.5),
                                    electronIsoThreshold = cms.double(0.15),
                                    electronNumOfHitsThreshold = cms.double(1),
-                                   useElectronMVARecipe = cms.bool(False),
-                                   useElectronLooseID = cms.bool(True),
                                       HTXSTags     = HTXSInputTags
 )
 
 flashggWHLeptonicTag = cms.EDProducer("FlashggWHLeptonicTagProducer",
                                    DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
+                                   CleanedObjectsTag = cms.InputTag('flashggDiPhotonCleanedObjects','WHLeptonic'),
                                    SystLabel=cms.string(""),
                                    RECOfilters = cms.InputTag('TriggerResults::RECO'),
                                    PATfilters = cms.InputTag('TriggerResults::PAT'),
                                    FLASHfilters = cms.InputTag('TriggerResults::FLASHggMicroAOD'),
-                                   inputTagJets= UnpackedJetCollectionVInputTag,
-                                   ElectronTag=cms.InputTag('flashggSelectedElectrons'),
-                                   MuonTag=cms.InputTag('flashggSelectedMuons'),
-                                   VertexTag=cms.InputTag('offlineSlimmedPrimaryVertices'),
                                    MVAResultTag=cms.InputTag('flashggDiPhotonMVA'),
                                    METTag=cms.InputTag('flashggMets'),
                                    useVertex0only=cms.bool(False),
                                    GenParticleTag=cms.InputTag( "flashggPrunedGenParticles" ),
-				   rhoTag = cms.InputTag('fixedGridRhoFastjetAll'),
-                                   leptonPtThreshold = cms.double(20),
-                                   muonEtaThreshold = cms.double(2.4),
                                    leadPhoOverMassThreshold = cms.double(0.375),
                                    subleadPhoOverMassThreshold = cms.double(0.25),
                                    MVAThreshold = cms.double(0.0),                                                     
-                                   deltaRMuonPhoThreshold = cms.double(0.5),
                                    jetsNumberThreshold = cms.double(3.),
-                                   jetPtThreshold = cms.double(20.),
-                                   jetEtaThreshold= cms.double(2.4),
-                                   deltaRPhoLeadJet = cms.double(0.4),
-                                   deltaRPhoSubLeadJet = cms.double(0.4),
-                                   muPFIsoSumRelThreshold = cms.double(0.25),
-                                   deltaRJetMuonThreshold = cms.double(0.4),
-                                   PuIDCutoffThreshold = cms.double(0.8),
                                    PhoMVAThreshold = cms.double(-0.9),
                                    METThreshold = cms.double(45.),
-                                   DeltaRTrkElec = cms.double(.4),
                                    TransverseImpactParam = cms.double(0.02),
                                    LongitudinalImpactParam = cms.double(0.2),
-                                   deltaRPhoElectronThreshold = cms.double(1.),
-                                   deltaMassElectronZThreshold = cms.double(10.),
-                                   electronEtaThresholds=cms.vdouble(1.4442,1.566,2.5),
                                    nonTrigMVAThresholds = cms.vdouble(0.913286,0.805013,0.358969),
                                    nonTrigMVAEtaCuts = cms.vdouble(0.8,1.479,2.5),
                                    electronIsoThreshold = cms.double(0.15),
                                    electronNumOfHitsThreshold = cms.double(1),
-                                   useElectronMVARecipe = cms.bool(False),
-                                   useElectronLooseID = cms.bool(True),
                                       HTXSTags     = HTXSInputTags
                                     )
 flashggVHLeptonicLooseTag = cms.EDProducer("FlashggVHLeptonicLooseTagProducer",
                                    DiPhotonTag=cms.InputTag('flashggPreselectedDiPhotons'),
+                                   CleanedObjectsTag = cms.InputTag('flashggDiPhotonCleanedObjects','VHLeptonic'),
                                    SystLabel=cms.string(""),
                                    RECOfilters = cms.InputTag('TriggerResults::RECO'),
                                    PATfilters = cms.InputTag('TriggerResults::PAT'),
                                    FLASHfilters = cms.InputTag('TriggerResults::FLASHggMicroAOD'),
-                                   inputTagJets= UnpackedJetCollectionVInputTag,
-                                   ElectronTag=cms.InputTag('flashggSelectedElectrons'),
-                                   MuonTag=cms.InputTag('flashggSelectedMuons'),
-                                   VertexTag=cms.InputTag('offlineSlimmedPrimaryVertices'),
                                    MVAResultTag=cms.InputTag('flashggDiPhotonMVA'),
                                    METTag=cms.InputTag('flashggMets'),
                                    useVertex0only=cms.bool(False),
                                    GenParticleTag=cms.InputTag( "flashggPrunedGenParticles" ),
-                                   rhoTag = cms.InputTag('fixedGridRhoFastjetAll'),
-				   leptonPtThreshold = cms.double(20),
-                                   muonEtaThreshold = cms.double(2.4),
                                    leadPhoOverMassThreshold = cms.double(0.375),
                                    subleadPhoOverMassThreshold = cms.double(0.25),
                                    MVAThreshold = cms.double(0.0),
-                                   deltaRMuonPhoThreshold = cms.double(1),
                                    jetsNumberThreshold = cms.double(3.),
-                                   jetPtThreshold = cms.double(20.),
-                                   jetEtaThreshold= cms.double(2.4),
-                                   muPFIsoSumRelThreshold = cms.double(0.25),
-                                   PuIDCutoffThreshold = cms.double(0.8),
                                    PhoMVAThreshold = cms.double(-0.9),
                                    METThreshold = cms.double(45.),
-                                   deltaRJetMuonThreshold = cms.double(0.4),
-                                   deltaRJetElectronThreshold = cms.double(0.4),
                                    invMassLepLowThreshold = cms.double(70.),
                                    invMassLepHighThreshold = cms.double(110.),
-                                   deltaRPhoLeadJet = cms.double(0.4),
-                                   deltaRPhoSubLeadJet = cms.double(0.4),
-                                   DeltaRTrkElec = cms.double(0.4),
                                    TransverseImpactParam = cms.double(0.02),
                                    LongitudinalImpactParam = cms.double(0.2),
-                                   deltaRPhoElectronThreshold = cms.double(1.),
-                                   deltaMassElectronZThreshold = cms.double(10.),
-                                   electronEtaThresholds=cms.vdouble(1.4442,1.566,2.5),
                                    nonTrigMVAThresholds = cms.vdouble(0.913286,0.805013,0.358969),
                                    nonTrigMVAEtaCuts = cms.vdouble(0.8,1.479,2.5),
                                    electronIsoThreshold = cms.double(0.15),
                                    electronNumOfHitsThreshold = cms.double(1),
-                                   useElectronMVARecipe = cms.bool(False),
-                                   useElectronLooseID = cms.bool(True),
                                            HTXSTags     = HTXSInputTags
 )
 
@@ -517,19 +544,15 @@ flashggVHLeptonicLooseTag = cms.EDProducer("FlashggVHLeptonicLooseTagProducer",
 
 flashggVHHadronicTag = cms.EDProducer("FlashggVHHadronicTagProducer",
                                       DiPhotonTag = cms.InputTag('flashggPreselectedDiPhotons'),
+                                      CleanedObjectsTag = cms.InputTag('flashggDiPhotonCleanedObjects','VHHadronic'),
                                       SystLabel=cms.string(""),
                                       MVAResultTag=cms.InputTag('flashggDiPhotonMVA'),
                                       #JetTag = cms.InputTag('flashggSelectedJets'),
-                                      inputTagJets= UnpackedJetCollectionVInputTag,
                                       GenParticleTag=cms.InputTag( "flashggPrunedGenParticles" ),
                                       leadPhoOverMassThreshold = cms.double(0.5),
                                       subleadPhoOverMassThreshold = cms.double(0.25),
                                       diphoMVAThreshold = cms.double(0.6),
                                       jetsNumberThreshold = cms.double(2.),
-                                      jetPtThreshold = cms.double(40.),
-                                      jetEtaThreshold= cms.double(2.4),
-                                      dRJetToPhoLThreshold = cms.double(0.4),
-                                      dRJetToPhoSThreshold = cms.double(0.4),
                                       dijetMassLowThreshold = cms.double(60.),
                                       dijetMassHighThreshold = cms.double(120.),
                                       cosThetaStarThreshold = cms.double(0.5),
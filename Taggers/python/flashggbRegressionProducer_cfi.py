@@ -29,6 +29,13 @@ flashggbRegressionProducer= cms.EDProducer('flashggbRegressionProducer',
                                            bRegressionWeightfile= bRegressionWeightfile_str, 
                                            y_mean = y_mean_str ,
                                            y_std = y_std_str,
-                                           year = year_str
+                                           year = year_str,
+                                           intraOpThreads = cms.untracked.int32(1),
+                                           interOpThreads = cms.untracked.int32(1)
                                            )
 
+# regresses all the per-vertex jet collections with a single NN evaluation per event,
+# output collections are labelled by collection index as for flashggUnpackedJets
+flashggbRegressionProducerAllCollections = flashggbRegressionProducer.clone(JetTags = UnpackedJetCollectionVInputTag)
+del flashggbRegressionProducerAllCollections.JetTag
+
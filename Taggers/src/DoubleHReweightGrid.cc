@@ -0,0 +1,97 @@
+#include "flashgg/Taggers/interface/DoubleHReweightGrid.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TAxis.h"
+#include "TH2.h"
+
+#include <istream>
+#include <ostream>
+
+namespace {
+    template<class T> void writeValue( std::ostream &out, const T &val ) { out.write( reinterpret_cast<const char *>( &val ), sizeof( T ) ); }
+    template<class T> bool readValue( std::istream &in, T &val ) { return bool( in.read( reinterpret_cast<char *>( &val ), sizeof( T ) ) ); }
+
+    template<class T> void writeVector( std::ostream &out, const std::vector<T> &vec )
+    {
+        writeValue( out, ( unsigned long long ) vec.size() );
+        if( ! vec.empty() ) { out.write( reinterpret_cast<const char *>( &vec[0] ), vec.size() * sizeof( T ) ); }
+    }
+
+    template<class T> bool readVector( std::istream &in, std::vector<T> &vec, unsigned long long maxSize )
+    {
+        unsigned long long size;
+        if( ! readValue( in, size ) || size > maxSize ) { return false; }
+        vec.resize( size );
+        return size == 0 || bool( in.read( reinterpret_cast<char *>( &vec[0] ), size * sizeof( T ) ) );
+    }
+}
+
+namespace flashgg {
+
+    DoubleHReweightGrid::Axis::Axis( const TAxis &axis ) :
+        nbins( axis.GetNbins() ), xmin( axis.GetXmin() ), xmax( axis.GetXmax() )
+    {
+        if( axis.GetXbins()->GetSize() > 0 ) {
+            edges.assign( axis.GetXbins()->GetArray(), axis.GetXbins()->GetArray() + axis.GetXbins()->GetSize() );
+        }
+    }
+
+    void DoubleHReweightGrid::build( const std::vector<const TH2 *> &hists )
+    {
+        auto ref = std::find_if( hists.begin(), hists.end(), []( const TH2 * hist ) { return hist != nullptr; } );
+        if( ref == hists.end() ) {
+            throw cms::Exception( "Configuration" ) << "DoubleHReweightGrid: no histogram to build the reweighting grid from.";
+        }
+        xAxis_ = Axis( *( *ref )->GetXaxis() );
+        yAxis_ = Axis( *( *ref )->GetYaxis() );
+        nPoints_ = hists.size();
+
+        int nx = xAxis_.nbins + 2, ny = yAxis_.nbins + 2;
+        weights_.assign( nx * ny * nPoints_, 0. );
+        for( unsigned int ipoint = 0; ipoint < nPoints_; ++ipoint ) {
+            const TH2 *hist = hists[ipoint];
+            if( ! hist ) { continue; }
+            if( !( Axis( *hist->GetXaxis() ) == xAxis_ && Axis( *hist->GetYaxis() ) == yAxis_ ) ) {
+                throw cms::Exception( "Configuration" ) << "DoubleHReweightGrid: histogram " << hist->GetName()
+                                                        << " does not have the same binning as " << ( *ref )->GetName();
+            }
+            for( int bin = 0; bin < nx * ny; ++bin ) {
+                weights_[bin * nPoints_ + ipoint] = hist->GetBinContent( bin );
+            }
+        }
+    }
+
+    bool DoubleHReweightGrid::read( std::istream &in )
+    {
+        for( auto axis : { &xAxis_, &yAxis_ } ) {
+            if( !( readValue( in, axis->nbins ) && readValue( in, axis->xmin ) && readValue( in, axis->xmax )
+                    && readVector( in, axis->edges, 1 << 20 ) ) ) { return false; }
+            if( axis->nbins <= 0 || !( axis->edges.empty() || ( int )axis->edges.size() == axis->nbins + 1 ) ) { return false; }
+        }
+        if( ! readValue( in, nPoints_ ) ) { return false; }
+        unsigned long long size = ( unsigned long long )( xAxis_.nbins + 2 ) * ( yAxis_.nbins + 2 ) * nPoints_;
+        return readVector( in, weights_, size ) && weights_.size() == size;
+    }
+
+    void DoubleHReweightGrid::write( std::ostream &out ) const
+    {
+        for( auto axis : { &xAxis_, &yAxis_ } ) {
+            writeValue( out, axis->nbins );
+            writeValue( out, axis->xmin );
+            writeValue( out, axis->xmax );
+            writeVector( out, axis->edges );
+        }
+        writeValue( out, nPoints_ );
+        writeVector( out, weights_ );
+    }
+
+}
+
+// Local Variables:
+// mode:c++
+// indent-tabs-mode:nil
+// tab-width:4
+// c-basic-offset:4
+// End:
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
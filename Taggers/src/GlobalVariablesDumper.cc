@@ -5,12 +5,29 @@
 
 #include "DataFormats/Common/interface/TriggerResults.h"
 #include "FWCore/Common/interface/TriggerNames.h"
+#include "FWCore/Utilities/interface/Exception.h"
 
 #include "TTree.h"
 
+#include <algorithm>
+
 using namespace edm;
 using namespace reco;
 
+namespace {
+    // a missing product leaves the handle invalid, without throwing
+    template<class T> bool getExtra( const EventBase &evt, const edm::Event *fullEvent, const std::vector<EDGetTokenT<T> > &tokens,
+                                     const InputTag &tag, size_t iextra, Handle<T> &handle )
+    {
+        if( fullEvent ) {
+            fullEvent->getByToken( tokens[iextra], handle );
+        } else {
+            evt.getByLabel( tag, handle );
+        }
+        return handle.isValid();
+    }
+}
+
 namespace flashgg {
 
     void GlobalVariablesDumper::dumpLumiFactor(double lumiFactor) { 
@@ -47,6 +64,7 @@ namespace flashgg {
             const auto extraFloats = cfg.getParameter<ParameterSet>( "extraFloats" );
             extraFloatNames_ = extraFloats.getParameterNamesForType<InputTag>();
             for( auto & name : extraFloatNames_ ) {
+                extraFloatTags_.push_back( extraFloats.getParameter<InputTag>(name) );
                 extraFloatTokens_.push_back( cc.consumes<float>(extraFloats.getParameter<InputTag>(name)) );
                 extraDoubleTokens_.push_back( cc.consumes<double>(extraFloats.getParameter<InputTag>(name)) );
                 extraVectorFloatTokens_.push_back( cc.consumes<std::vector<float>>(extraFloats.getParameter<InputTag>(name)) );
@@ -74,6 +92,7 @@ namespace flashgg {
             const auto extraFloats = cfg.getParameter<ParameterSet>( "extraFloats" );
             extraFloatNames_ = extraFloats.getParameterNamesForType<InputTag>();
             extraFloatVariables_.resize(extraFloatNames_.size(),0.);
+            extraFloatTypes_.resize(extraFloatNames_.size(),extraUnresolved);
         }
     }
 
@@ -123,6 +142,21 @@ namespace flashgg {
     }
     
 
+    std::vector<int> GlobalVariablesDumper::triggerBits( const edm::TriggerNames &trigNames ) const
+    {
+        std::vector<int> pathBits( trigNames.size(), -1 );
+        for( size_t itrg = 0; itrg < trigNames.size(); ++itrg ) {
+            auto &pathName = trigNames.triggerName( itrg );
+            for( size_t ibit = 0; ibit < bits_.size(); ++ibit ) {
+                if( pathName.find( bits_[ibit].first ) != std::string::npos ) {
+                    pathBits[itrg] = ibit;
+                    break;
+                }
+            }
+        }
+        return pathBits;
+    }
+
     void GlobalVariablesDumper::fill( const EventBase &evt )
     {
         update( evt );
@@ -137,51 +171,66 @@ namespace flashgg {
 
             for( auto &bit : bits_ ) { bit.second = false; }
             auto &trigNames = evt.triggerNames( *trigResults );
-            for( size_t itrg = 0; itrg < trigNames.size(); ++itrg ) {
-                if( ! trigResults->accept( itrg ) ) { continue; }
-                auto pathName = trigNames.triggerName( itrg );
-                for( auto &bit : bits_ ) {
-                    if( pathName.find( bit.first ) != std::string::npos ) {
-                        bit.second = true;
-                        break;
-                    }
-                }
+            // the path names only change with the trigger menu
+            const auto &menuId = trigNames.parameterSetID();
+            auto menu = triggerBitsByMenu_.find( menuId );
+            std::vector<int> uncached;
+            const std::vector<int> *pathBits = &uncached;
+            if( menu != triggerBitsByMenu_.end() ) {
+                pathBits = &menu->second;
+            } else if( menuId.isValid() ) {
+                pathBits = &( triggerBitsByMenu_[menuId] = triggerBits( trigNames ) );
+            } else {
+                uncached = triggerBits( trigNames );
+            }
+            size_t npaths = std::min( pathBits->size(), ( size_t )trigResults->size() );
+            for( size_t itrg = 0; itrg < npaths; ++itrg ) {
+                int ibit = ( *pathBits )[itrg];
+                if( ibit >= 0 && trigResults->accept( itrg ) ) { bits_[ibit].second = true; }
             }
         }
-        /// for( size_t iextra = 0; iextra<extraFloatTags_.size(); ++iextra ) {
         for( size_t iextra = 0; iextra<extraFloatNames_.size(); ++iextra ) {
-            try {
-                Handle<float> ihandle; 
-                if( fullEvent ) { 
-                    fullEvent->getByToken( extraFloatTokens_[iextra], ihandle );
-                } else {
-                    evt.getByLabel( extraFloatTags_[iextra], ihandle );
-                }
+            if( extraFloatTypes_[iextra] == extraUnresolved ) { resolveExtraFloat( evt, fullEvent, iextra ); }
+            switch( extraFloatTypes_[iextra] ) {
+            case extraFloat: {
+                Handle<float> ihandle;
+                getExtra( evt, fullEvent, extraFloatTokens_, extraFloatTags_[iextra], iextra, ihandle );
                 extraFloatVariables_[iextra] = *ihandle;
-            } catch (...) {
-                try{
-                    Handle<double> ihandle; 
-                    if( fullEvent ) { 
-                        fullEvent->getByToken( extraDoubleTokens_[iextra], ihandle );
-                    } else {
-                        evt.getByLabel( extraFloatTags_[iextra], ihandle );
-                    }
-                    extraFloatVariables_[iextra] = *ihandle;
-                } catch (...) {
-                    Handle<std::vector<float> > ihandle; 
-                    if( fullEvent ) { 
-                        fullEvent->getByToken( extraVectorFloatTokens_[iextra], ihandle );
-                    } else {
-                        evt.getByLabel( extraFloatTags_[iextra], ihandle );
-                    }
-                    // assert( ihandle->size() == 1 );
-                    if( ihandle->size()  < 1 ) { std::cout << "NO extra float......... " << extraFloatTags_[iextra].label() << std::endl; continue; }
-                    extraFloatVariables_[iextra] = (*ihandle)[0];
-                }
+                break;
+            }
+            case extraDouble: {
+                Handle<double> ihandle;
+                getExtra( evt, fullEvent, extraDoubleTokens_, extraFloatTags_[iextra], iextra, ihandle );
+                extraFloatVariables_[iextra] = *ihandle;
+                break;
+            }
+            default: {
+                Handle<std::vector<float> > ihandle;
+                getExtra( evt, fullEvent, extraVectorFloatTokens_, extraFloatTags_[iextra], iextra, ihandle );
+                if( ihandle->size()  < 1 ) { std::cout << "NO extra float......... " << extraFloatTags_[iextra].label() << std::endl; continue; }
+                extraFloatVariables_[iextra] = (*ihandle)[0];
+            }
             }
         }
     }
 
+    // the type of the product is looked up once, in the first event
+    void GlobalVariablesDumper::resolveExtraFloat( const EventBase &evt, const edm::Event *fullEvent, size_t iextra )
+    {
+        Handle<float> floatHandle;
+        Handle<double> doubleHandle;
+        Handle<std::vector<float> > vectorHandle;
+        if( getExtra( evt, fullEvent, extraFloatTokens_, extraFloatTags_[iextra], iextra, floatHandle ) ) {
+            extraFloatTypes_[iextra] = extraFloat;
+        } else if( getExtra( evt, fullEvent, extraDoubleTokens_, extraFloatTags_[iextra], iextra, doubleHandle ) ) {
+            extraFloatTypes_[iextra] = extraDouble;
+        } else if( getExtra( evt, fullEvent, extraVectorFloatTokens_, extraFloatTags_[iextra], iextra, vectorHandle ) ) {
+            extraFloatTypes_[iextra] = extraVectorFloat;
+        } else {
+            throw cms::Exception( "Configuration" ) << "GlobalVariablesDumper: extraFloats " << extraFloatNames_[iextra] << " ("
+                                                    << extraFloatTags_[iextra].encode() << ") is not a float, double or vector<float> product in the event";
+        }
+    }
 
 }
 // Local Variables:
@@ -8,7 +8,9 @@ using namespace RooFit;
 
 // ----------------------------------------------------------------------------------------------------
 
-WorkspaceCombiner::WorkspaceCombiner()
+WorkspaceCombiner::WorkspaceCombiner() :
+    verbose( true ),
+    nullStream( nullptr )
 {
 }
 
@@ -43,8 +45,8 @@ void WorkspaceCombiner::Init( string outputFileName_, vector<string> inputfiles_
 TDirectoryFile *WorkspaceCombiner::GetFirstFile()
 {
 
-    std::cout << "WorkspaceCombiner::GetFirstFile" << std::endl;
-    std::cout << inputFileNames[0].c_str() << std::endl;
+    log() << "WorkspaceCombiner::GetFirstFile" << std::endl;
+    log() << inputFileNames[0].c_str() << std::endl;
     TDirectoryFile *file0 = TFile::Open( inputFileNames[0].c_str() );
     return file0;
 
@@ -53,39 +55,39 @@ TDirectoryFile *WorkspaceCombiner::GetFirstFile()
 // ----------------------------------------------------------------------------------------------------
 void WorkspaceCombiner::GetWorkspaces( TDirectoryFile *tdfile )
 {
-    std::cout << " WorkspaceCombiner::GetWorkspaces" << std::endl;
+    log() << " WorkspaceCombiner::GetWorkspaces" << std::endl;
     tdfile->Print();
     TList *listofkeys = tdfile->GetListOfKeys();
-    std::cout << "Got list of keys!" << std::endl;
+    log() << "Got list of keys!" << std::endl;
     TKey *oldkey = 0;
     for( int k = 0; k < listofkeys->GetSize(); k++ ) {
-        std::cout << k << std::endl;
+        log() << k << std::endl;
         TKey *key = ( TKey * )listofkeys->At( k );
-        std::cout << " Key: " << key->GetName() << " CycleNumber: " << key->GetCycle() << std::endl;
+        log() << " Key: " << key->GetName() << " CycleNumber: " << key->GetCycle() << std::endl;
         if( oldkey && !strcmp( oldkey->GetName(), key->GetName() ) ) {
-            std::cout << "    Duplicate key to previous, continuing (relying on order being predictable)" << std::endl;
+            log() << "    Duplicate key to previous, continuing (relying on order being predictable)" << std::endl;
             continue;
         }
         oldkey = key;
         if( strcmp( key->GetClassName(), "RooWorkspace" ) == 0 ) {
-            std::cout << " We got a workspace with name " << key->GetName() << std::endl;
+            log() << " We got a workspace with name " << key->GetName() << std::endl;
             RooWorkspace *work = ( RooWorkspace * )tdfile->Get( key->GetName() );
             //            work->Print();
-            std::cout << " made work" << std::endl;
+            log() << " made work" << std::endl;
             std::list<RooAbsData *> allData = work->allData();
             RooArgSet allVars = work->allVars();
             TIterator *vIter = allVars.createIterator();
-            std::cout << " made allData" << std::endl;
+            log() << " made allData" << std::endl;
             std::unordered_map<string, RooDataSet *> allDataClone;
             std::unordered_map<string, RooDataHist *> allDataHistClone;
             std::unordered_map<string, RooRealVar *> allVarClone;
-            std::cout << " about to iterate over allData " << std::endl;
+            log() << " about to iterate over allData " << std::endl;
             for( std::list<RooAbsData *>::iterator it = allData.begin(); it != allData.end(); ++it ) {
                 RooDataSet *dataset = dynamic_cast<RooDataSet *>( *it );
                 if (dataset) {
                     //                  allDataClone.push_back( ( RooDataSet * )dataset->Clone() );
                     allDataClone[std::string(dataset->GetName())] = ( ( RooDataSet * )dataset->Clone() );
-                  std::cout << "pushing back dataset " << *dataset << std::endl;
+                  log() << "pushing back dataset " << *dataset << std::endl;
                  }
             }
             for( std::list<RooAbsData *>::iterator it = allData.begin(); it != allData.end(); ++it ) {
@@ -93,7 +95,7 @@ void WorkspaceCombiner::GetWorkspaces( TDirectoryFile *tdfile )
                 if (datahist) {
                     //                  allDataHistClone.push_back( ( RooDataHist * )datahist->Clone() );
                     allDataHistClone[std::string(datahist->GetName())] = ( ( RooDataHist * )datahist->Clone() );
-                  std::cout << "pushing back dataHIST " << *datahist << std::endl;
+                  log() << "pushing back dataHIST " << *datahist << std::endl;
 
                 }
             }
@@ -102,35 +104,35 @@ void WorkspaceCombiner::GetWorkspaces( TDirectoryFile *tdfile )
                 if (datavar) {
                     //                allVarClone.push_back( ( RooRealVar * )datavar->Clone() );
                     allVarClone[std::string(datavar->GetName())] = ( ( RooRealVar * )datavar->Clone() );
-                 std::cout << "pushing back dataVAR " << datavar->GetName() << std::endl;
+                 log() << "pushing back dataVAR " << datavar->GetName() << std::endl;
                 }
             }
-            std::cout << " gonna push back allDataClone " << std::endl;
+            log() << " gonna push back allDataClone " << std::endl;
             data.push_back( allDataClone );
             dataH.push_back( allDataHistClone );
             vars.push_back( allVarClone );
-            std::cout << " gonna push back work " << std::endl;
+            log() << " gonna push back work " << std::endl;
             workspaceNames.push_back( work->GetName() );
             string workpath = "";
-            std::cout << " gonna build workpath" << std::endl;
+            log() << " gonna build workpath" << std::endl;
             while( tdfile->InheritsFrom( "TFile" ) == false ) {
                 workpath.insert( 0, Form( "/%s", tdfile->GetName() ) );
                 tdfile = ( TDirectoryFile * )tdfile->GetMotherDir();
             }
             workpath.erase( 0, 1 );
-            std::cout << "workpath is " << workpath << std::endl;
+            log() << "workpath is " << workpath << std::endl;
             workspacePaths.push_back( workpath );
             delete work;
         }
-        std::cout << " before TDirectoryFile check" << std::endl;
+        log() << " before TDirectoryFile check" << std::endl;
         if( strcmp( key->GetClassName(), "TDirectoryFile" ) == 0 ) {
-            std::cout << " We're gonna make a new TDirectoryFile with name " << key->GetName() << " (cycle " << key->GetCycle() << ")" << std::endl;
+            log() << " We're gonna make a new TDirectoryFile with name " << key->GetName() << " (cycle " << key->GetCycle() << ")" << std::endl;
             TDirectoryFile *newdirectory = ( TDirectoryFile * )tdfile->Get( key->GetName() );
             if( newdirectory ) {
-                std::cout << " About to recursively call GetWorkspaces on " << newdirectory << std::endl;
+                log() << " About to recursively call GetWorkspaces on " << newdirectory << std::endl;
                 GetWorkspaces( newdirectory );
             } else {
-                std::cout << " That returned null for some reason. Skipping." << std::endl;
+                log() << " That returned null for some reason. Skipping." << std::endl;
             }
         }
     }
@@ -143,17 +145,17 @@ void WorkspaceCombiner::MergeWorkspaces()
     
     for( unsigned int f = 1; f < inputFileNames.size(); f++ ) {
         
-        std::cout << " MergeWorkspaces f=" << f << std::endl;
+        log() << " MergeWorkspaces f=" << f << std::endl;
         
         TFile *file = TFile::Open( inputFileNames[f].c_str() );
         
-        cout << endl << "Combining Current File " << f << " / " << inputFileNames.size() << " - " << inputFileNames[f] << endl << endl;
+        log() << endl << "Combining Current File " << f << " / " << inputFileNames.size() << " - " << inputFileNames[f] << endl << endl;
         
         file->cd();
         
-        cout << endl << "before workspaceNames loop" << endl << endl;
+        log() << endl << "before workspaceNames loop" << endl << endl;
         for( unsigned int w = 0; w < workspaceNames.size(); w++ ) {
-            std::cout << "   " << workspaceNames[w] << " " << workspacePaths[w]  << std::endl;
+            log() << "   " << workspaceNames[w] << " " << workspacePaths[w]  << std::endl;
             RooWorkspace *work;
             if( workspacePaths[w] == "" ) { work = ( RooWorkspace * ) file->Get( workspaceNames[w].c_str() ); } //look into root folder
             else {										  //look into directory
@@ -167,8 +169,8 @@ void WorkspaceCombiner::MergeWorkspaces()
                 //                unsigned int d = 0;
                 RooDataSet *dataset = dynamic_cast<RooDataSet *>( *it );
                 RooDataHist *datahist = dynamic_cast<RooDataHist *>( *it );
-                if ( dataset) std::cout << "   Dataset name: " << dataset->GetName() << std::endl;
-                if ( datahist) std::cout << "   DataHIST name: " << datahist->GetName() << std::endl;
+                if ( dataset) log() << "   Dataset name: " << dataset->GetName() << std::endl;
+                if ( datahist) log() << "   DataHIST name: " << datahist->GetName() << std::endl;
                 
                 // loop through datasets
                 if (dataset){
@@ -208,40 +210,37 @@ void WorkspaceCombiner::MergeWorkspaces()
                     }
                     
                 }
-                //loop over RooRealVars (eg IntLumi) file under consideration.
-                //now do the same for RooRealVars
+            }
+            //loop over RooRealVars (eg IntLumi) of the file under consideration, once per workspace
+            //(the variables are the same for all the datasets of the workspace)
+            if( !allData.empty() ) {
                 RooArgSet allVars = work->allVars();
                 TIterator *vIter = allVars.createIterator();
                 RooRealVar * datavar;
                 while((datavar=(RooRealVar*)vIter->Next())) {
                     if (datavar) {
-                        std::cout << "considering dataVAR " << datavar->GetName() << " w " << w <<" vars size " <<vars.size() << std::endl;
+                        log() << "considering dataVAR " << datavar->GetName() << " w " << w <<" vars size " <<vars.size() << std::endl;
                         if( vars[w].find( std::string(datavar->GetName()) ) !=  vars[w].end() ) {
-                            //       for( d = 0 ; d < vars[w].size() ; d++ ) {
-                            //           if( vars[w][d]->GetName() == datavar->GetName() ) {
                             //////                            assert(vars[w][std::string(datavar->GetName())]->getVal() == datavar->getVal() );
-                            std::cout<<"found var"<<std::endl;
-                            //                            break;
-                            //                        }
+                            log() << "found var" << std::endl;
                         }
-                        //                        if( d == vars[w].size() ) { // no match
                         else{
-                            //                            std::map<std::string, RooRealVar *> temp_map;
-                            //                            temp_map[datavar->GetName()] = ( RooRealVar * )datavar->Clone();
                             vars[w].insert( std::pair<string, RooRealVar* >(std::string(datavar->GetName()), ( RooRealVar * )datavar->Clone()) );
                         }
                     }
                 }
-                
-                
+                delete vIter;
             }
+            // the datasets have been appended or cloned: the workspace read from the file is no longer needed
+            delete work;
         }
-        cout << endl << "after workspaceNames loop" << endl << endl;
+        log() << endl << "after workspaceNames loop" << endl << endl;
         
         
         file->Close();
+        delete file;
         
-        cout << endl << "Finished Combining File - " << inputFileNames[f] << endl << endl;
+        log() << endl << "Finished Combining File - " << inputFileNames[f] << endl << endl;
         
     }
 }
@@ -249,16 +248,16 @@ void WorkspaceCombiner::MergeWorkspaces()
 // ----------------------------------------------------------------------------------------------------
 TDirectoryFile *WorkspaceCombiner::MergeTreesAndHistograms()
 {
-
-    std::string inputchain = inputFileNames[0];
-    for( unsigned int i = 1; i < inputFileNames.size(); i++ ) {
-        inputchain.append( " " );
-        inputchain.append( inputFileNames[i] );
-    }
-
     outputAux = "outputTreesAndHistos.root";
 
-    gSystem->Exec( Form( "hadd -f %s %s", outputAux.c_str(), inputchain.c_str() ) );
+    // in-process equivalent of hadd; the workspaces, merged separately, are skipped
+    TFileMerger merger( false, false );
+    merger.SetPrintLevel( verbose ? 1 : 0 );
+    merger.OutputFile( outputAux.c_str(), "RECREATE" );
+    for( unsigned int i = 0; i < inputFileNames.size(); i++ ) { merger.AddFile( inputFileNames[i].c_str(), false ); }
+    std::set<string> skipped( workspaceNames.begin(), workspaceNames.end() );
+    for( std::set<string>::iterator it = skipped.begin(); it != skipped.end(); ++it ) { merger.AddObjectNames( it->c_str() ); }
+    merger.PartialMerge( TFileMerger::kAll | TFileMerger::kRegular | TFileMerger::kSkipListed );
 
     TDirectoryFile *outputAuxFile = TFile::Open( outputAux.c_str() );
 
@@ -266,6 +265,131 @@ TDirectoryFile *WorkspaceCombiner::MergeTreesAndHistograms()
 
 }
 
+// ----------------------------------------------------------------------------------------------------
+bool WorkspaceCombiner::MergeParallel( unsigned int nWorkers, unsigned int filesPerMerge, bool doTreesAndHistograms )
+{
+    if( inputFileNames.empty() ) { return false; }
+    if( nWorkers == 0 ) { nWorkers = 1; }
+    if( filesPerMerge == 0 ) { filesPerMerge = ( inputFileNames.size() + nWorkers - 1 ) / nWorkers; }
+    if( filesPerMerge < 2 ) { filesPerMerge = 2; }
+
+    // first level: chunks of filesPerMerge consecutive inputs; then pairs of consecutive partial outputs.
+    // The order of the inputs is kept at each level, so that the entries of each dataset are appended in the
+    // same order as in the serial merge. Each merge holds all the datasets of its inputs in memory.
+    vector<string> current = inputFileNames;
+    vector<string> temporaries;
+    unsigned int level = 0;
+    unsigned int groupSize = filesPerMerge;
+    while( current.size() > 1 || level == 0 ) {
+        vector<vector<string> > groups;
+        for( unsigned int i = 0; i < current.size(); i += groupSize ) {
+            groups.push_back( vector<string>( current.begin() + i, current.begin() + std::min<size_t>( i + groupSize, current.size() ) ) );
+        }
+        vector<string> next;
+        vector<pid_t> running;
+        bool ok = true;
+        for( unsigned int g = 0; g < groups.size(); g++ ) {
+            if( groups[g].size() == 1 && level > 0 ) {
+                next.push_back( groups[g][0] ); // nothing to merge it with at this level
+                continue;
+            }
+            string partial = Form( "%s.part%u_%u.root", outputFileName.c_str(), level, g );
+            next.push_back( partial );
+            temporaries.push_back( partial );
+            if( running.size() == nWorkers ) {
+                ok = WaitForMerge( running.front() ) && ok;
+                running.erase( running.begin() );
+            }
+            pid_t pid = SpawnMerge( partial, groups[g] );
+            if( pid < 0 ) { ok = false; break; }
+            running.push_back( pid );
+        }
+        for( unsigned int p = 0; p < running.size(); p++ ) { ok = WaitForMerge( running[p] ) && ok; }
+        // the partial outputs of the previous level are no longer needed
+        for( unsigned int t = 0; t < temporaries.size(); t++ ) {
+            if( std::find( next.begin(), next.end(), temporaries[t] ) == next.end() ) { gSystem->Unlink( temporaries[t].c_str() ); }
+        }
+        temporaries = next;
+        if( !ok ) {
+            std::cout << "WorkspaceCombiner::MergeParallel: a merge failed at level " << level << std::endl;
+            for( unsigned int t = 0; t < temporaries.size(); t++ ) {
+                if( std::find( inputFileNames.begin(), inputFileNames.end(), temporaries[t] ) == inputFileNames.end() ) { gSystem->Unlink( temporaries[t].c_str() ); }
+            }
+            return false;
+        }
+        current = next;
+        groupSize = 2;
+        level++;
+    }
+
+    if( gSystem->Rename( current[0].c_str(), outputFileName.c_str() ) != 0 ) {
+        std::cout << "WorkspaceCombiner::MergeParallel: cannot rename " << current[0] << " to " << outputFileName << std::endl;
+        return false;
+    }
+
+    if( doTreesAndHistograms ) {
+        // second pass, once the workspaces are merged: the trees and histograms of all the inputs are merged
+        // in-process with TFileMerger into the output file, opened in update mode
+        std::set<string> skipped;
+        TFile *first = TFile::Open( inputFileNames[0].c_str() );
+        if( first ) { CollectWorkspaceNames( first, skipped ); }
+        delete first;
+        TFileMerger merger( false, false );
+        merger.SetPrintLevel( verbose ? 1 : 0 );
+        merger.OutputFile( outputFileName.c_str(), "UPDATE" );
+        for( unsigned int i = 0; i < inputFileNames.size(); i++ ) { merger.AddFile( inputFileNames[i].c_str(), false ); }
+        for( std::set<string>::iterator it = skipped.begin(); it != skipped.end(); ++it ) { merger.AddObjectNames( it->c_str() ); }
+        if( !merger.PartialMerge( TFileMerger::kAll | TFileMerger::kRegular | TFileMerger::kSkipListed ) ) {
+            std::cout << "WorkspaceCombiner::MergeParallel: merging of the trees and histograms failed" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+void WorkspaceCombiner::CollectWorkspaceNames( TDirectory *dir, std::set<string> &names )
+{
+    TList *listofkeys = dir->GetListOfKeys();
+    for( int k = 0; k < listofkeys->GetSize(); k++ ) {
+        TKey *key = ( TKey * )listofkeys->At( k );
+        if( strcmp( key->GetClassName(), "RooWorkspace" ) == 0 ) { names.insert( key->GetName() ); }
+        if( strcmp( key->GetClassName(), "TDirectoryFile" ) == 0 ) {
+            TDirectory *subdir = ( TDirectory * )dir->Get( key->GetName() );
+            if( subdir ) { CollectWorkspaceNames( subdir, names ); }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+pid_t WorkspaceCombiner::SpawnMerge( const string &output, const vector<string> &inputs )
+{
+    std::cout.flush();
+    pid_t pid = fork();
+    if( pid == 0 ) {
+        // RooFit is not thread safe: each merge runs in its own process, with the serial code
+        WorkspaceCombiner merger;
+        merger.SetVerbose( verbose );
+        merger.Init( output, inputs );
+        merger.GetWorkspaces( merger.GetFirstFile() );
+        merger.MergeWorkspaces();
+        merger.Save( false );
+        std::cout.flush();
+        _exit( 0 );
+    }
+    if( pid < 0 ) { std::cout << "WorkspaceCombiner::SpawnMerge: fork failed for " << output << std::endl; }
+    return pid;
+}
+
+// ----------------------------------------------------------------------------------------------------
+bool WorkspaceCombiner::WaitForMerge( pid_t pid )
+{
+    int status = 0;
+    if( waitpid( pid, &status, 0 ) != pid ) { return false; }
+    return ( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+}
+
 // ----------------------------------------------------------------------------------------------------
 void WorkspaceCombiner::GetTreesAndHistograms( TDirectoryFile *file )
 {
@@ -334,10 +458,10 @@ void WorkspaceCombiner::Save( bool doTreesAndHistograms )
             //            RooDataSet *already_there = ( RooDataSet * ) outputws->data( data[w][d]->GetName() );
             RooDataSet *already_there = ( RooDataSet * ) outputws->data( (m_it->first).c_str() );
             if( already_there ) {
-                std::cout << " doing an append of " << m_it->first << " in WorkspaceCombiner::Save" << std::endl;
+                log() << " doing an append of " << m_it->first << " in WorkspaceCombiner::Save" << std::endl;
                 already_there->append( *(m_it->second) );
             } else {
-                std::cout << " doing an explicit import of " << m_it->first << " in WorkspaceCombiner::Save" << std::endl;
+                log() << " doing an explicit import of " << m_it->first << " in WorkspaceCombiner::Save" << std::endl;
                 outputws->import( *(m_it->second) );
             }
             //data[w][d]->Print();
@@ -347,10 +471,10 @@ void WorkspaceCombiner::Save( bool doTreesAndHistograms )
         for(std::unordered_map<std::string, RooDataHist *>::iterator m_it = dataH[w].begin(); m_it != dataH[w].end(); m_it++){
             RooDataHist *already_there = ( RooDataHist * ) outputws->data( (m_it->first).c_str() );
             if( already_there ) {
-                //  std::cout << " doing an add of dataHIST" << dataH[w][d]->GetName() << " in WorkspaceCombiner::Save" << std::endl;
+                //  log() << " doing an add of dataHIST" << dataH[w][d]->GetName() << " in WorkspaceCombiner::Save" << std::endl;
                 already_there->add( *(m_it->second) );
             } else {
-                // std::cout << " doing an explicit import of dataHIST " << dataH[w][d]->GetName() << " in WorkspaceCombiner::Save" << std::endl;
+                // log() << " doing an explicit import of dataHIST " << dataH[w][d]->GetName() << " in WorkspaceCombiner::Save" << std::endl;
                 outputws->import( *(m_it->second) );
             }
             //data[w][d]->Print();
@@ -360,22 +484,22 @@ void WorkspaceCombiner::Save( bool doTreesAndHistograms )
         for(std::unordered_map<std::string, RooRealVar *>::iterator m_it = vars[w].begin(); m_it != vars[w].end(); m_it++){
             RooRealVar *already_there = ( RooRealVar * ) outputws->var( (m_it->first).c_str() );
             if( already_there ) {
-                //  std::cout << " doing an add of dataHIST" << dataH[w][d]->GetName() << " in WorkspaceCombiner::Save" << std::endl;
+                //  log() << " doing an add of dataHIST" << dataH[w][d]->GetName() << " in WorkspaceCombiner::Save" << std::endl;
                //assert(already_there->getVal() == (vars[w][d])->getVal());
             } else {
-                // std::cout << " doing an explicit import of dataHIST " << dataH[w][d]->GetName() << " in WorkspaceCombiner::Save" << std::endl;
+                // log() << " doing an explicit import of dataHIST " << dataH[w][d]->GetName() << " in WorkspaceCombiner::Save" << std::endl;
                 outputws->import( *(m_it->second) );
             }
             //data[w][d]->Print();
         }
         if( outfile->GetDirectory( workspacePaths[w].c_str() ) == NULL ) { outfile->mkdir( workspacePaths[w].c_str() ); }
         outfile->cd( workspacePaths[w].c_str() );
-        std::cout << " ABOUT TO WRITE OUTPUT WORKSPACE" << std::endl;
+        log() << " ABOUT TO WRITE OUTPUT WORKSPACE" << std::endl;
         outputws->Write();
-        std::cout << " ABOUT TO DELETE OUTPUT WORKSPACE" << std::endl;
+        log() << " ABOUT TO DELETE OUTPUT WORKSPACE" << std::endl;
         //outputws->Print();
         delete outputws;
-        std::cout << " DONE WITH WORKSPACE " << std::endl;
+        log() << " DONE WITH WORKSPACE " << std::endl;
 
     }
 
@@ -395,16 +519,16 @@ void WorkspaceCombiner::Save( bool doTreesAndHistograms )
             //histos[h]->Print();
         }
     } else {
-        std::cout << " SKIPPING TREES AND HISTOGRAMS IN SAVE" << std::endl;
+        log() << " SKIPPING TREES AND HISTOGRAMS IN SAVE" << std::endl;
     }
 
-    std::cout << " ABOUT TO CLOSE OUTPUT FILE " << std::endl;
+    log() << " ABOUT TO CLOSE OUTPUT FILE " << std::endl;
 
     outfile->Close();
     if( doTreesAndHistograms ) {
-        gSystem->Exec( Form( "rm %s", outputAux.c_str() ) );
+        gSystem->Unlink( outputAux.c_str() );
     }
-    std::cout << " END OF WorkspaceCombiner::Save" << std::endl;
+    log() << " END OF WorkspaceCombiner::Save" << std::endl;
 }
 
 // ----------------------------------------------------------------------------------------------------
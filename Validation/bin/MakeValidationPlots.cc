@@ -5,11 +5,14 @@
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <thread>
 
 #include "TSystem.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TTreeFormula.h"
 #include "TH1F.h"
+#include "TROOT.h"
 
 #include "FWCore/FWLite/interface/AutoLibraryLoader.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
@@ -50,56 +53,170 @@ void GetAllVBFCat( vector<string> *categories )
     return;
 }
 
-//----------Variables and categories loop function----------------------------------------
-void ProcessSample( TTree *flashggTree, TTree *globeTree,
-                    vector<string> *variables, vector<string> *categories,
-                    TString *drawOption, string outputDir, string sampleName, bool doSplit )
-{
-    //---create outdir if not exists
-    std::string mkdir_command = "mkdir -p " + outputDir + sampleName;
-    system( mkdir_command.c_str() );
+//----------Histogram definitions----------------------------------------------------------
+struct PlotDef {
+    string variable;
+    int nbins;
+    float min, max;
+};
 
-    TFile *outFile = TFile::Open( ( outputDir + sampleName + "/comparison_plots.root" ).c_str(), "recreate" );
-    //---variables loop---
-    for( unsigned int iVar = 0; iVar < variables->size(); iVar++ ) {
-        istringstream splitter( variables->at( iVar ) );
-        string variable;
-        int nbins = 100;
-        float min = 0, max = 100;
+struct SamplePlots {
+    string name;
+    string flashggFileName;
+    string globeTreeName;
+    // [variable][category], null where the variable is not drawn for the category
+    vector<vector<TH1F *> > h_new, h_old;
+};
+
+vector<PlotDef> ParseVariables( const vector<string> &variables )
+{
+    vector<PlotDef> defs;
+    for( unsigned int iVar = 0; iVar < variables.size(); iVar++ ) {
+        istringstream splitter( variables.at( iVar ) );
+        PlotDef def = { "", 100, 0, 100 };
         vector<string> tokens{istream_iterator<string>{splitter},
                               istream_iterator<string>{}};
 
-        variable = tokens.at( 0 );
+        def.variable = tokens.at( 0 );
         if( tokens.size() > 1 )
-        { nbins = stoi( tokens.at( 1 ) ); }
+        { def.nbins = stoi( tokens.at( 1 ) ); }
         if( tokens.size() > 2 )
-        { min = stof( tokens.at( 2 ) ); }
+        { def.min = stof( tokens.at( 2 ) ); }
         if( tokens.size() > 3 )
-        { max = stof( tokens.at( 3 ) ); }
+        { def.max = stof( tokens.at( 3 ) ); }
+        defs.push_back( def );
+    }
+    return defs;
+}
+
+//---category name to selection: "vbfcat0" -> "vbfcat==0", "all_cat" -> "1"
+TString CategoryCut( const string &category )
+{
+    TString cat_cut( category );
+    if( category != "all_cat" )
+    { cat_cut.Insert( cat_cut.Last( 't' ) + 1, "==" ); }
+    else
+    { cat_cut = "1"; }
+    return cat_cut;
+}
+
+//---draw vbf var only for vbf categories
+bool DrawForCategory( const string &variable, const string &category )
+{
+    return !( variable.find( "dijet" ) != string::npos &&
+              category.find( "vbf" ) == string::npos &&
+              category != "all_cat" );
+}
+
+//----------Fill all the histograms of a tree in one pass----------------------------------
+//---same content as one TTree::Draw( "variable>>h", "weight*(cut)" ) per histogram: entries with a
+//---null selection are skipped and the others are filled with the selection as weight
+void FillFromTree( TTree *tree, const vector<PlotDef> &defs, const vector<string> &categories,
+                   const string &weight, vector<vector<TH1F *> > &histos )
+{
+    vector<TTreeFormula *> varFormulas( defs.size(), 0 ), cutFormulas( categories.size(), 0 );
+    for( unsigned int iVar = 0; iVar < defs.size(); iVar++ ) {
+        varFormulas[iVar] = new TTreeFormula( Form( "var%u", iVar ), defs[iVar].variable.c_str(), tree );
+        if( varFormulas[iVar]->GetNdim() == 0 ) {
+            cout << " WARNING: cannot compile " << defs[iVar].variable << " on tree " << tree->GetName() << endl;
+            delete varFormulas[iVar];
+            varFormulas[iVar] = 0;
+        }
+    }
+    for( unsigned int iCat = 0; iCat < categories.size(); iCat++ ) {
+        TString cut = CategoryCut( categories[iCat] );
+        if( weight != "" ) { cut = TString( weight + "*(" ) + cut + ")"; }
+        cutFormulas[iCat] = new TTreeFormula( Form( "cut%u", iCat ), cut, tree );
+        if( cutFormulas[iCat]->GetNdim() == 0 ) {
+            cout << " WARNING: cannot compile " << cut << " on tree " << tree->GetName() << endl;
+            delete cutFormulas[iCat];
+            cutFormulas[iCat] = 0;
+        }
+    }
+
+    //---TTree::Draw also applies the tree weight
+    double treeWeight = tree->GetWeight();
+    vector<double> cutValues( categories.size() );
+    for( Long64_t entry = 0; entry < tree->GetEntries(); entry++ ) {
+        if( tree->LoadTree( entry ) < 0 ) { break; }
+        bool any = false;
+        for( unsigned int iCat = 0; iCat < categories.size(); iCat++ ) {
+            cutValues[iCat] = 0.;
+            if( cutFormulas[iCat] && cutFormulas[iCat]->GetNdata() > 0 ) { cutValues[iCat] = treeWeight * cutFormulas[iCat]->EvalInstance( 0 ); }
+            any = any || cutValues[iCat] != 0.;
+        }
+        if( !any ) { continue; }
+        for( unsigned int iVar = 0; iVar < defs.size(); iVar++ ) {
+            if( !varFormulas[iVar] ) { continue; }
+            int ndata = varFormulas[iVar]->GetNdata();
+            for( int instance = 0; instance < ndata; instance++ ) {
+                double value = varFormulas[iVar]->EvalInstance( instance );
+                for( unsigned int iCat = 0; iCat < categories.size(); iCat++ ) {
+                    if( histos[iVar][iCat] && cutValues[iCat] != 0. ) { histos[iVar][iCat]->Fill( value, cutValues[iCat] ); }
+                }
+            }
+        }
+    }
+
+    for( unsigned int iVar = 0; iVar < varFormulas.size(); iVar++ ) { delete varFormulas[iVar]; }
+    for( unsigned int iCat = 0; iCat < cutFormulas.size(); iCat++ ) { delete cutFormulas[iCat]; }
+}
+
+//----------Fill the histograms of one sample: one loop per tree, run in its own thread-------
+void FillSample( SamplePlots *sample, const string globeFileName, const string flashggTreeName,
+                 const vector<PlotDef> *defs, const vector<string> *categories )
+{
+    sample->h_new.assign( defs->size(), vector<TH1F *>( categories->size(), 0 ) );
+    sample->h_old.assign( defs->size(), vector<TH1F *>( categories->size(), 0 ) );
+    for( unsigned int iVar = 0; iVar < defs->size(); iVar++ ) {
+        const PlotDef &def = defs->at( iVar );
+        for( unsigned int iCat = 0; iCat < categories->size(); iCat++ ) {
+            if( !DrawForCategory( def.variable, categories->at( iCat ) ) ) { continue; }
+            string h_name = categories->at( iCat ) + "_" + def.variable;
+            sample->h_new[iVar][iCat] = new TH1F( TString( h_name + "_FLASHgg" ), h_name.c_str(), def.nbins, def.min, def.max );
+            sample->h_old[iVar][iCat] = new TH1F( TString( h_name + "_GLOBE" ), h_name.c_str(), def.nbins, def.min, def.max );
+        }
+    }
+
+    //---each thread reads its own files
+    TFile *flashggFile = TFile::Open( sample->flashggFileName.c_str() );
+    TTree *flashggTree = ( flashggFile ? ( TTree * )flashggFile->Get( flashggTreeName.c_str() ) : 0 );
+    if( flashggTree )
+    { FillFromTree( flashggTree, *defs, *categories, "", sample->h_new ); }
+    else
+    { cout << " ERROR: tree " << flashggTreeName << " not found in " << sample->flashggFileName << endl; }
+    delete flashggFile;
+
+    TFile *globeFile = TFile::Open( globeFileName.c_str() );
+    TTree *globeTree = ( globeFile ? ( TTree * )globeFile->Get( sample->globeTreeName.c_str() ) : 0 );
+    if( globeTree )
+    { FillFromTree( globeTree, *defs, *categories, "full_weight", sample->h_old ); }
+    else
+    { cout << " ERROR: tree " << sample->globeTreeName << " not found in " << globeFileName << endl; }
+    delete globeFile;
+}
+
+//----------Write and draw the histograms of one sample-------------------------------------
+void ProcessSample( SamplePlots *sample, const vector<PlotDef> *defs, const vector<string> *categories,
+                    TString *drawOption, string outputDir, bool doSplit )
+{
+    const string &sampleName = sample->name;
+    //---create outdir if not exists
+    std::string mkdir_command = "mkdir -p " + outputDir + sampleName;
+    system( mkdir_command.c_str() );
 
+    TFile *outFile = TFile::Open( ( outputDir + sampleName + "/comparison_plots.root" ).c_str(), "recreate" );
+    //---variables loop---
+    for( unsigned int iVar = 0; iVar < defs->size(); iVar++ ) {
         //---categories loop---
         for( unsigned int iCat = 0; iCat < categories->size(); iCat++ ) {
-            //---draw vbf var only for vbf categories
-            if( variable.find( "dijet" ) != string::npos &&
-                    categories->at( iCat ).find( "vbf" ) == string::npos &&
-                    categories->at( iCat ) != "all_cat" )
+            TH1F *h_new = sample->h_new[iVar][iCat];
+            TH1F *h_old = sample->h_old[iVar][iCat];
+            if( !h_new || !h_old )
             { continue; }
 
             outFile->cd();
-            string h_name = categories->at( iCat ) + "_" + variable;
-            TH1F *h_new = new TH1F( TString( h_name + "_FLASHgg" ), h_name.c_str(), nbins, min, max );
-            TH1F *h_old =  new TH1F( TString( h_name + "_GLOBE" ), h_name.c_str(), nbins, min, max );
-
-            TString cat_cut( categories->at( iCat ) );
-            //---do not split in categories if cat_string is void
-            if( categories->at( iCat ) != "all_cat" )
-            { cat_cut.Insert( cat_cut.Last( 't' ) + 1, "==" ); }
-            else
-            { cat_cut = "1"; }
-            //---Draw histos from trees
-            flashggTree->Draw( TString( variable + ">>" + h_name + "_FLASHgg" ), cat_cut, "goff" );
-            globeTree->Draw( TString( variable + ">>" + h_name + "_GLOBE" ),
-                             TString( "full_weight*(" + cat_cut + ")" ), "goff" );
+            string h_name = categories->at( iCat ) + "_" + defs->at( iVar ).variable;
 
             //---Draw histos to output files---
             //---skip empty categories
@@ -190,34 +307,31 @@ int main( int argc, char *argv[] )
     bool processWZH = samplesOpt.getParameter<bool>( "WZH" );
     bool processTTH = samplesOpt.getParameter<bool>( "TTH" );
     //---process selected samples---
-    TFile *globeFile = TFile::Open( filesOpt.getParameter<string>( "globeFile" ).c_str() );
-    if( processGGH ) {
-        TFile *flashggFileGGH = TFile::Open( filesOpt.getParameter<string>( "flashggFileGGH" ).c_str() );
-        TTree *flashggTreeGGH = ( TTree * )flashggFileGGH->Get( filesOpt.getParameter<string>( "flashggTreeName" ).c_str() );
-        TTree *globeTreeGGH = ( TTree * )globeFile->Get( "ggh_m125_8TeV" );
-        ProcessSample( flashggTreeGGH, globeTreeGGH, &variables, &categories, &drawOption,
-                       outputDir, string( "ggh_m125" ), doSplit );
-    }
-    if( processVBF ) {
-        TFile *flashggFileVBF = TFile::Open( filesOpt.getParameter<string>( "flashggFileVBF" ).c_str() );
-        TTree *flashggTreeVBF = ( TTree * )flashggFileVBF->Get( filesOpt.getParameter<string>( "flashggTreeName" ).c_str() );
-        TTree *globeTreeVBF = ( TTree * )globeFile->Get( "vbf_m125_8TeV" );
-        ProcessSample( flashggTreeVBF, globeTreeVBF, &variables, &categories, &drawOption,
-                       outputDir, string( "vbf_m125" ), doSplit );
-    }
-    if( processWZH ) {
-        TFile *flashggFileWZH = TFile::Open( filesOpt.getParameter<string>( "flashggFileWZH" ).c_str() );
-        TTree *flashggTreeWZH = ( TTree * )flashggFileWZH->Get( filesOpt.getParameter<string>( "flashggTreeName" ).c_str() );
-        TTree *globeTreeWZH = ( TTree * )globeFile->Get( "wzh_m125_8TeV" );
-        ProcessSample( flashggTreeWZH, globeTreeWZH, &variables, &categories, &drawOption,
-                       outputDir, string( "wzh_m125" ), doSplit );
+    //---the trees are read in parallel, one thread per sample; writing and drawing stay serial
+    string globeFileName = filesOpt.getParameter<string>( "globeFile" );
+    string flashggTreeName = filesOpt.getParameter<string>( "flashggTreeName" );
+    vector<SamplePlots> samples;
+    if( processGGH )
+    { samples.push_back( SamplePlots{ "ggh_m125", filesOpt.getParameter<string>( "flashggFileGGH" ), "ggh_m125_8TeV", {}, {} } ); }
+    if( processVBF )
+    { samples.push_back( SamplePlots{ "vbf_m125", filesOpt.getParameter<string>( "flashggFileVBF" ), "vbf_m125_8TeV", {}, {} } ); }
+    if( processWZH )
+    { samples.push_back( SamplePlots{ "wzh_m125", filesOpt.getParameter<string>( "flashggFileWZH" ), "wzh_m125_8TeV", {}, {} } ); }
+    if( processTTH )
+    { samples.push_back( SamplePlots{ "tth_m125", filesOpt.getParameter<string>( "flashggFileTTH" ), "tth_m125_8TeV", {}, {} } ); }
+
+    vector<PlotDef> defs = ParseVariables( variables );
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory( false );
+    vector<std::thread> workers;
+    for( unsigned int iSample = 0; iSample < samples.size(); iSample++ ) {
+        workers.push_back( std::thread( FillSample, &samples[iSample], globeFileName, flashggTreeName, &defs, &categories ) );
     }
-    if( processTTH ) {
-        TFile *flashggFileTTH = TFile::Open( filesOpt.getParameter<string>( "flashggFileTTH" ).c_str() );
-        TTree *flashggTreeTTH = ( TTree * )flashggFileTTH->Get( filesOpt.getParameter<string>( "flashggTreeName" ).c_str() );
-        TTree *globeTreeTTH = ( TTree * )globeFile->Get( "tth_m125_8TeV" );
-        ProcessSample( flashggTreeTTH, globeTreeTTH, &variables, &categories, &drawOption,
-                       outputDir, string( "tth_m125" ), doSplit );
+    for( unsigned int iSample = 0; iSample < workers.size(); iSample++ )
+    { workers[iSample].join(); }
+
+    for( unsigned int iSample = 0; iSample < samples.size(); iSample++ ) {
+        ProcessSample( &samples[iSample], &defs, &categories, &drawOption, outputDir, doSplit );
     }
 }
 // Local Variables:
@@ -0,0 +1,133 @@
+#!/usr/bin/env python
+
+# Summary of the CSV files written by the FlashggJobProfiler service (MetaData/interface/JobProfiler.h):
+# per module (and sub-timer) percentiles of the wall time, mean CPU time and heap growth, and the throughput
+# of each configuration. Each file, or comma separated list of files (e.g. the jobs of a task), is one
+# configuration; it can be given a name with name=file1,file2,...
+#
+# usage: summarize_profile.py [--skip N] [--top N] [--sort wall|cpu|heap] [name=]profile.csv[,...] ...
+
+from __future__ import print_function
+from optparse import OptionParser
+
+
+def percentile(values, fraction):
+    # values must be sorted
+    if not values:
+        return 0.
+    pos = fraction * (len(values) - 1)
+    low = int(pos)
+    high = min(low + 1, len(values) - 1)
+    return values[low] + (values[high] - values[low]) * (pos - low)
+
+
+def mean(values):
+    return sum(values) / float(len(values)) if values else 0.
+
+
+class Profile(object):
+
+    def __init__(self, name):
+        self.name = name
+        self.entries = {}   # (label,type) -> { "wall" : [], "cpu" : [], "mem" : [] }
+        self.events = []    # (wall,cpu,rss)
+        self.jobEvents = 0
+        self.jobSeconds = 0.
+
+    def read(self, fname, skip):
+        labels = {}
+        seen = set()
+        for line in open(fname):
+            line = line.strip()
+            if not line:
+                continue
+            if line.startswith("#entry,"):
+                entry, label, kind = line[len("#entry,"):].split(",", 2)
+                labels[entry] = (label, kind)
+                continue
+            if line.startswith("#job,"):
+                events, seconds = line[len("#job,"):].split(",")
+                self.jobEvents += int(events)
+                self.jobSeconds += float(seconds)
+                continue
+            if line.startswith("#"):
+                continue
+            event, entry, wall, cpu, mem = line.split(",")
+            # the first events include the initialization of conditions and caches
+            if entry == "0":
+                seen.add(event)
+                if len(seen) > skip:
+                    self.events.append((float(wall), float(cpu), int(mem)))
+                continue
+            if len(seen) < skip:
+                continue
+            data = self.entries.setdefault(labels[entry], {"wall": [], "cpu": [], "mem": []})
+            data["wall"].append(float(wall))
+            data["cpu"].append(float(cpu))
+            data["mem"].append(int(mem))
+
+    def throughput(self):
+        wall = sum(ev[0] for ev in self.events)
+        return len(self.events) / (1.e-6 * wall) if wall > 0. else 0.
+
+    def summarize(self, top, sortBy):
+        print()
+        print("== %s" % self.name)
+        print("   events: %d  event loop: %.2f events/s  event wall %.1f ms (p50 %.1f p90 %.1f p99 %.1f)  max RSS %.0f MB" % (
+            len(self.events), self.throughput(),
+            1.e-3 * mean([ev[0] for ev in self.events]),
+            1.e-3 * percentile(sorted(ev[0] for ev in self.events), 0.5),
+            1.e-3 * percentile(sorted(ev[0] for ev in self.events), 0.9),
+            1.e-3 * percentile(sorted(ev[0] for ev in self.events), 0.99),
+            max([ev[2] for ev in self.events] + [0]) / 1024.))
+        if self.jobSeconds > 0.:
+            print("   whole job: %d events in %.1f s, %.2f events/s" % (self.jobEvents, self.jobSeconds, self.jobEvents / self.jobSeconds))
+        print("   %-60s %-28s %8s %9s %9s %9s %9s %9s %10s" % ("module", "type", "calls", "wall ms", "p50", "p90", "p99", "cpu ms", "heap kB"))
+
+        rows = []
+        for (label, kind), data in self.entries.items():
+            walls = sorted(data["wall"])
+            rows.append((label, kind, len(walls), mean(walls), percentile(walls, 0.5), percentile(walls, 0.9), percentile(walls, 0.99),
+                         mean(data["cpu"]), mean(data["mem"]) / 1024.))
+        key = {"wall": 3, "cpu": 7, "heap": 8}[sortBy]
+        # sub-timers are listed after their module
+        rows.sort(key=lambda row: -row[key])
+        modules = [row for row in rows if row[1] != "SubTimer"]
+        subTimers = [row for row in rows if row[1] == "SubTimer"]
+        if top > 0:
+            modules = modules[:top]
+        for row in modules:
+            print("   %-60s %-28s %8d %9.3f %9.3f %9.3f %9.3f %9.3f %10.1f" % row)
+            for sub in subTimers:
+                if sub[0].startswith(row[0] + "/"):
+                    print("     %-58s %-28s %8d %9.3f %9.3f %9.3f %9.3f %9.3f %10s" % ((sub[0][len(row[0]):],) + sub[1:8] + ("",)))
+
+
+def main():
+    parser = OptionParser(usage="%prog [options] [name=]profile.csv[,...] ...")
+    parser.add_option("--skip", type="int", default=1, help="number of events skipped at the beginning of each file [default: %default]")
+    parser.add_option("--top", type="int", default=30, help="number of modules listed, 0 for all [default: %default]")
+    parser.add_option("--sort", default="wall", choices=["wall", "cpu", "heap"], help="sort modules by mean wall, cpu or heap [default: %default]")
+    options, args = parser.parse_args()
+    if not args:
+        parser.error("no profile given")
+
+    profiles = []
+    for arg in args:
+        name, files = arg.split("=", 1) if "=" in arg else (arg, arg)
+        profile = Profile(name)
+        for fname in files.split(","):
+            profile.read(fname, options.skip)
+        profile.summarize(options.top, options.sort)
+        profiles.append(profile)
+
+    if len(profiles) > 1:
+        print()
+        print("== throughput")
+        ref = profiles[0].throughput()
+        for profile in profiles:
+            print("   %-60s %10.2f events/s  x%.2f" % (profile.name, profile.throughput(), profile.throughput() / ref if ref > 0. else 0.))
+
+
+if __name__ == "__main__":
+    main()